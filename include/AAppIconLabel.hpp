@@ -2,6 +2,9 @@
 
 #include <gtkmm/box.h>
 #include <gtkmm/image.h>
+#include <sigc++/connection.h>
+
+#include <string>
 
 #include "AIconLabel.hpp"
 
@@ -12,7 +15,7 @@ class AAppIconLabel : public AIconLabel {
   AAppIconLabel(const Json::Value& config, const std::string& name, const std::string& id,
                 const std::string& format, uint16_t interval = 0, bool ellipsize = false,
                 bool enable_click = false, bool enable_scroll = false);
-  virtual ~AAppIconLabel() = default;
+  virtual ~AAppIconLabel() { desktop_entries_changed_.disconnect(); }
   auto update() -> void override;
 
  protected:
@@ -22,6 +25,12 @@ class AAppIconLabel : public AIconLabel {
   unsigned app_icon_size_{24};
   bool update_app_icon_{true};
   std::string app_icon_name_;
+
+ private:
+  // Looked up again when the desktop entry index changes, e.g. once the first scan is done
+  std::string app_identifier_;
+  std::string alternative_app_identifier_;
+  sigc::connection desktop_entries_changed_;
 };
 
 }  // namespace waybar
@@ -7,11 +7,15 @@
 #include <gtkmm/tooltip.h>
 #include <json/json.h>
 
+#include <functional>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 
 #include "AModule.hpp"
+#include "util/icon_table.hpp"
 
 namespace waybar {
 
@@ -32,8 +36,27 @@ class ALabel : public AModule {
   bool alt_ = false;
   std::string default_format_;
 
+  // `format-icons`, compiled once at construction. getIcon() looks icons up here.
+  const util::IconTable icons_;
+
+  /// The `format-<state>` option, or nullptr if it is not set (or `state` is empty).
+  /// Like the tooltip lookup below, it is resolved without touching the JSON config.
+  const std::string* stateFormat(std::string_view state) const;
+  /// Same result as resolveTooltipFormat()
+  const std::string& tooltipFormat(std::string_view state, const std::string& defaultFormat) const;
+
   bool setLabelMarkup(const Glib::ustring& markup);
   bool setTooltipMarkup(const Glib::ustring& markup);
+  /// Sets the tooltip to what `producer` returns, but only runs it once the tooltip is shown:
+  /// right away while it is visible, otherwise when GTK next queries it. The result is kept
+  /// until the tooltip or its producer is set again, so modules only hand over a new producer
+  /// when its inputs changed.
+  void setTooltipProducer(std::function<std::string()> producer);
+
+  using FormatArgs = fmt::dynamic_format_arg_store<fmt::format_context>;
+  /// setTooltipProducer() formatting `format` with `args`, which must not refer to data that
+  /// may change before the tooltip is shown
+  void setTooltipFormat(std::string format, std::shared_ptr<const FormatArgs> args);
 
   // resolveTooltipFormat() / resolveFormat() are inherited from AModule.
 
@@ -93,6 +116,13 @@ class ALabel : public AModule {
   // no collation weight, so two different icons compare equal.
   std::optional<std::string> last_label_markup_;
   std::optional<std::string> last_tooltip_markup_;
+  // Replaces last_tooltip_markup_ on the next tooltip query, unless the tooltip is set first
+  std::function<std::string()> tooltip_producer_;
+  // String `format-<state>` and `tooltip-format-<state>` options keyed by state, and
+  // `tooltip-format`, read once at construction
+  std::map<std::string, std::string, std::less<>> state_formats_;
+  std::map<std::string, std::string, std::less<>> state_tooltip_formats_;
+  std::optional<std::string> tooltip_format_;
   Glib::RefPtr<Gtk::Tooltip> active_tooltip_;
 };
 
@@ -12,6 +12,7 @@
 #include <utility>
 
 #include "IModule.hpp"
+#include "util/sleeper_thread.hpp"
 
 namespace waybar {
 
@@ -31,8 +32,9 @@ class AModule : public IModule {
 
   bool expandEnabled() const;
 
-  virtual void suspend() {};
-  virtual void resume() {};
+  /// Called while nobody can see the module (hidden bar, output off). Pauses polling loops.
+  virtual void suspend();
+  virtual void resume();
   bool shouldSuspend() const { return disable_on_sleep_; }
 
  protected:
@@ -93,8 +95,14 @@ class AModule : public IModule {
   virtual bool handleMouseEnter(GdkEventCrossing* const& ev);
   virtual bool handleMouseLeave(GdkEventCrossing* const& ev);
   virtual bool handleScroll(GdkEventScroll*);
+  // Run the actions and commands bound to a scroll direction
+  bool handleScrollDir(SCROLL_DIR dir);
   virtual bool handleRelease(GdkEventButton* const& ev);
 
+  /// Let a loop polling for data be paused while the module is suspended, and be slowed down
+  /// while saving power (see util::PowerPolicy)
+  void adaptPolling(util::SleeperThread& thread);
+
   bool disable_on_sleep_{false};
   GObject* menu_ = nullptr;
 
@@ -113,6 +121,7 @@ class AModule : public IModule {
   gdouble distance_scrolled_y_;
   gdouble distance_scrolled_x_;
   sigc::connection cursor_timeout_conn_;
+  std::vector<util::SleeperThread*> polling_threads_;
   static const inline std::map<std::pair<uint, GdkEventType>, std::string> eventMap_{
       {std::make_pair(1, GdkEventType::GDK_BUTTON_PRESS), "on-click"},
       {std::make_pair(1, GdkEventType::GDK_BUTTON_RELEASE), "on-click-release"},
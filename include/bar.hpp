@@ -15,6 +15,7 @@
 #include "AModule.hpp"
 #include "group.hpp"
 #include "util/kill_signal.hpp"
+#include "util/update_scheduler.hpp"
 #include "xdg-output-unstable-v1-client-protocol.h"
 
 namespace waybar {
@@ -98,6 +99,11 @@ class Bar : public sigc::trackable {
   void onMap(GdkEventAny*);
   auto setupWidgets() -> void;
   void getModules(const Factory&, const std::string&, waybar::Group*);
+  // Names of the modules in a position or group, including those of nested groups
+  void collectModules(const std::string& pos, std::vector<std::string>& names);
+  // Run the setup shared by the configured modules (bus connections, the Hyprland state)
+  // concurrently. The modules themselves are still made one by one on the GTK thread afterwards.
+  void prepareModules(bool no_center);
   void setupAltFormatKeyForModule(const std::string& module_name);
   void setupAltFormatKeyForModuleList(const char* module_list_name);
   void setMode(const bar_mode&);
@@ -107,6 +113,7 @@ class Bar : public sigc::trackable {
   void onConfigure(GdkEventConfigure* ev);
   void configureGlobalOffset(int width, int height);
   void onOutputGeometryChanged();
+  void updateSuspended();
 
   /* Copy initial set of modes to allow customization */
   bar_mode_map configured_modes = PRESET_MODES;
@@ -128,10 +135,17 @@ class Bar : public sigc::trackable {
   std::unique_ptr<BarIpcClient> _ipc_client;
 #endif
   std::vector<std::shared_ptr<waybar::AModule>> modules_all_;
+  /* Set with `coalesce-updates`; declared after the modules so it is destroyed first. */
+  std::unique_ptr<util::UpdateScheduler> update_scheduler_;
 
   waybar::util::KillSignalAction onSigusr1 = util::SIGNALACTION_DEFAULT_SIGUSR1;
   waybar::util::KillSignalAction onSigusr2 = util::SIGNALACTION_DEFAULT_SIGUSR2;
 
+  /* Modules are suspended while the bar is hidden or its surface is unmapped */
+  bool hidden_ = false;
+  bool mapped_ = true;
+  bool suspended_ = false;
+
   /* Disconnected in ~Bar before the modules are destroyed (#5182). */
   sigc::connection map_conn_;
   sigc::connection unmap_conn_;
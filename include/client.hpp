@@ -39,6 +39,7 @@ class Client {
   void bindInterfaces();
   void handleOutput(struct waybar_output& output);
   auto setupCss(const std::string& css_file) -> void;
+  void setupPowerSaving(const Json::Value& config);
   struct waybar_output& getOutput(void*);
   std::vector<Json::Value> getOutputConfigs(struct waybar_output& output);
 
@@ -3,6 +3,8 @@
 #include <json/json.h>
 
 #include <AModule.hpp>
+#include <functional>
+#include <string>
 
 namespace waybar {
 
@@ -12,6 +14,10 @@ class Factory {
  public:
   Factory(const Bar& bar, const Json::Value& config);
   AModule* makeModule(const std::string& name, const std::string& pos) const;
+  /// Blocking setup that every instance of a module shares, such as connecting to the buses it
+  /// talks to or fetching the Hyprland state, so that it can run on a worker before the module
+  /// is made. Per-instance work stays in the constructor. Empty if there is nothing to prepare.
+  static std::function<void()> prepareModule(const std::string& name);
 
  private:
   const Bar& bar_;
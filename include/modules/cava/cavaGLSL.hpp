@@ -41,12 +41,10 @@ class CavaGLSL final : public AModule {
   bool mapped_{false};
   // Cava method
   void pauseResume();
-  auto onUpdate(const CavaBackend::AudioRaw& input) -> void;
+  auto onUpdate() -> void;
   auto onSilence() -> void;
   auto onBackendConfigChanged() -> void;
   void cacheConfigParams(const ::cava::config_params& src);
-  // Member variable to store audio data
-  CavaBackend::AudioRaw m_data_;
   GLuint shaderProgram_{0};
   // OpenGL variables
   GLuint fbo_{0};
@@ -8,11 +8,13 @@
 #include <string>
 #include <vector>
 
+#include <glibmm/dispatcher.h>
 #include <json/json.h>
 #include <sigc++/sigc++.h>
 
 #include "util/SafeSignal.hpp"
 #include "util/sleeper_thread.hpp"
+#include "util/triple_buffer.hpp"
 
 namespace cava {
 extern "C" {
@@ -48,22 +50,31 @@ class CavaBackend final {
     std::vector<float> previous_bars_raw;
     int number_of_bars = 0;
 
-    AudioRaw() = default;
-    explicit AudioRaw(const ::cava::audio_raw& raw) {
+    // Copies the frame in place, reusing the capacity left over from earlier frames
+    void assign(const ::cava::audio_raw& raw) {
       number_of_bars = raw.number_of_bars;
       if (raw.bars_raw != nullptr && number_of_bars > 0) {
         bars_raw.assign(raw.bars_raw, raw.bars_raw + number_of_bars);
+      } else {
+        bars_raw.clear();
       }
       if (raw.previous_bars_raw != nullptr && number_of_bars > 0) {
         previous_bars_raw.assign(raw.previous_bars_raw, raw.previous_bars_raw + number_of_bars);
+      } else {
+        previous_bars_raw.clear();
       }
     }
   };
 
+  /// Latest raw frame. Main thread only; valid until the next call.
+  const AudioRaw& audioRaw();
+
   // Signal accessor
   using SignalUpdate = SafeSignal<const std::string&>;
   SignalUpdate& signalUpdate();
-  using SignalAudioRawUpdate = SafeSignal<AudioRaw>;
+  // Emitted on the main thread when a new frame is available through audioRaw().
+  // Frames produced faster than the main loop consumes them are dropped.
+  using SignalAudioRawUpdate = sigc::signal<void()>;
   SignalAudioRawUpdate& signalAudioRawUpdate();
   using SignalSilence = SafeSignal<>;
   SignalSilence& signalSilence();
@@ -134,10 +145,15 @@ class CavaBackend final {
   void doUpdate(bool force = false);
   void loadConfig();
   void freeBackend();
+  void publishAudioRaw();
+  void onAudioRaw();
 
   // Signal
   SignalUpdate m_signal_update_;
   SignalAudioRawUpdate m_signal_audio_raw_;
+  Glib::Dispatcher audio_raw_dp_;
+  std::atomic<bool> audio_raw_pending_{false};
+  util::TripleBuffer<AudioRaw> audio_raw_frames_;
   SignalSilence m_signal_silence_;
   SignalConfigChanged m_signal_config_changed_;
 
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <map>
+#include <string>
+#include <tuple>
+
 #include "ALabel.hpp"
+#include "util/clock_tick.hpp"
 #include "util/date.hpp"
-#include "util/sleeper_thread.hpp"
 
 namespace waybar::modules {
 
@@ -28,6 +32,13 @@ class Clock final : public ALabel {
   std::string m_tlpText_{""};                 // tooltip text to print
   const Glib::RefPtr<Gtk::Label> m_tooltip_;  // tooltip as a separate Gtk::Label
   bool query_tlp_cb(int, int, bool, const Glib::RefPtr<Gtk::Tooltip>& tooltip);
+  // The tooltip is only rendered while it is shown. Otherwise update() just remembers the time
+  // it would have been rendered for, and query_tlp_cb() renders it when GTK asks for it.
+  bool tlpVisible_{false};
+  bool tlpStale_{false};
+  const date::time_zone* tlpZone_{nullptr};
+  date::sys_seconds tlpTime_;
+  auto renderTooltip(const date::zoned_seconds& now) -> void;
   // Calendar
   const bool cldInTooltip_;  // calendar in tooltip
   /*
@@ -45,13 +56,15 @@ class Clock final : public ALabel {
   WS cldWPos_{WS::HIDDEN};             // calendar week side to print
   date::months cldCurrShift_{0};       // calendar months shift
   int cldShift_{1};                    // calendar months shift factor
-  date::year_month_day cldYearShift_;  // calendar Year mode. Cached ymd
-  std::string cldYearCached_;          // calendar Year mode. Cached calendar
-  date::year_month cldMonShift_;       // calendar Month mode. Cached ym
-  std::string cldMonCached_;           // calendar Month mode. Cached calendar
-  date::day cldBaseDay_{0};      // calendar Cached day. Is used when today is changing(midnight)
   std::string cldText_{""};      // calendar text to print
   bool iso8601Calendar_{false};  // whether the calendar is in ISO8601
+  date::weekday cldFirstDow_{date::Sunday};  // calendar first day of the week
+  // Rendered calendars by (year, month or 0 in year mode, mode, time zone). The locale, the first
+  // day of the week and the formats are fixed for the module. Every calendar highlights today,
+  // so they are all dropped when the day changes.
+  using CldKey = std::tuple<int, unsigned, CldMode, const date::time_zone*>;
+  std::map<CldKey, std::string> cldCache_;
+  date::year_month_day cldCacheDay_;
   WeekNumbering weekNumbering_{WeekNumbering::LOCALE};  // week number calculation method
   CldMode cldMode_{CldMode::MONTH};
   auto get_calendar(const date::year_month_day& today, const date::year_month_day& ymd,
@@ -66,7 +79,9 @@ class Clock final : public ALabel {
   int tzCurrIdx_;                               // current time zone index for tzList_
   std::string tzText_{""};                      // time zones text to print
   std::string tzTooltipFormat_{""};             // optional timezone tooltip format
-  util::SleeperThread thread_;
+  date::sys_seconds tzTextTime_;                // time tzText_ shows
+  int tzTextIdx_{-1};                           // tzCurrIdx_ when tzText_ was rendered
+  std::string tzTextFormat_;                    // format tzText_ was rendered with
 
   // ordinal date in tooltip
   const bool ordInTooltip_;
@@ -94,6 +109,9 @@ class Clock final : public ALabel {
   static inline std::map<const std::string,
                          void (waybar::modules::Clock::* const)(const std::string& action)>
       actionWithArgsMap_{{"exec", &waybar::modules::Clock::action_exec}};
+
+  // Declared last so no tick reaches a module being destroyed
+  util::ClockTick::Subscription tick_;
 };
 
 }  // namespace waybar::modules
@@ -4,13 +4,16 @@
 
 #include <cstdint>
 #include <fstream>
+#include <memory>
 #include <numeric>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "ALabel.hpp"
-#include "util/sleeper_thread.hpp"
+#include "modules/cpu_frequency.hpp"
+#include "modules/cpu_usage.hpp"
+#include "modules/load.hpp"
 
 namespace waybar::modules {
 
@@ -21,9 +24,25 @@ class Cpu : public ALabel {
   auto update() -> void override;
 
  private:
-  std::vector<std::tuple<size_t, size_t>> prev_times_;
-
-  util::SleeperThread thread_;
+  // Once every source has a sample, only the usage source updates the module, once per interval,
+  // and the load and frequency are read as of then
+  void firstSample();
+
+  // Declared before the subscriptions, whose slots may run while they are constructed
+  bool ready_ = false;
+  // The sources of the cpu_usage, load and cpu_frequency modules, so that a bar running several
+  // of them still reads each file once per interval
+  util::SampleSubscription<CpuUsage::Sample> usage_;
+  util::SampleSubscription<Load::Sample> load_;
+  util::SampleSubscription<CpuFrequency::Sample> frequency_;
+  util::FormatTemplate label_template_;
+  util::FormatTemplate tooltip_template_;
+  CpuUsage::CoreArgs core_args_;
+  // What the label and tooltip were last rendered from, to skip formatting what is unchanged
+  std::shared_ptr<const CpuUsage::Sample> rendered_usage_;
+  std::shared_ptr<const Load::Sample> rendered_load_;
+  std::shared_ptr<const CpuFrequency::Sample> rendered_frequency_;
+  std::string rendered_state_;
 };
 
 }  // namespace waybar::modules
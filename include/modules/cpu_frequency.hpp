@@ -10,7 +10,10 @@
 #include <vector>
 
 #include "ALabel.hpp"
-#include "util/sleeper_thread.hpp"
+#include "util/sample_hub.hpp"
+#if defined(__linux__)
+#include "util/procfs.hpp"
+#endif
 
 namespace waybar::modules {
 
@@ -20,13 +23,29 @@ class CpuFrequency : public ALabel {
   virtual ~CpuFrequency() = default;
   auto update() -> void override;
 
-  // This is a static member because it is also used by the cpu module.
-  static std::tuple<float, float, float> getCpuFrequency();
+  // Maximum, minimum and average frequency, sampled once per interval and shared by every
+  // cpu_frequency and cpu module through util::SampleHub.
+  using Sample = std::tuple<float, float, float>;
+  static util::SampleSubscription<Sample> subscribe(std::chrono::milliseconds interval,
+                                                    const sigc::slot<void()>& slot);
 
  private:
-  static std::vector<float> parseCpuFrequencies();
-
-  util::SleeperThread thread_;
+  // What the shared sampler keeps between samples. It belongs to the source rather than to a
+  // thread, since each sample may be taken by another scheduler worker.
+  struct SamplerState {
+    std::vector<float> frequencies;
+#if defined(__linux__)
+    util::procfs::File cpuinfo_file{"/proc/cpuinfo"};
+#endif
+  };
+
+  // Run by the shared sampler, not by a module
+  static std::tuple<float, float, float> getCpuFrequency(SamplerState& state);
+
+  // Fills `state.frequencies` (in MHz), reusing its storage between calls.
+  static void parseCpuFrequencies(SamplerState& state);
+
+  util::SampleSubscription<Sample> frequency_;
 };
 
 }  // namespace waybar::modules
@@ -10,7 +10,7 @@
 #include <vector>
 
 #include "AGraph.hpp"
-#include "util/sleeper_thread.hpp"
+#include "modules/cpu_usage.hpp"
 
 namespace waybar::modules {
 
@@ -25,8 +25,7 @@ class CpuGraph : public AGraph {
   static constexpr const char* HIGH_CLASS = "cpu-high";
   static constexpr const char* INTENSIVE_CLASS = "cpu-intensive";
 
-  std::vector<std::tuple<size_t, size_t>> prev_times_;
-  util::SleeperThread thread_;
+  util::SampleSubscription<CpuUsage::Sample> usage_;
 };
 
 }  // namespace waybar::modules
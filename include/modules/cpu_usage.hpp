@@ -4,13 +4,21 @@
 
 #include <cstdint>
 #include <fstream>
+#include <initializer_list>
+#include <memory>
 #include <numeric>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "ALabel.hpp"
-#include "util/sleeper_thread.hpp"
+#include "util/format_template.hpp"
+#include "util/icon_table.hpp"
+#include "util/sample_hub.hpp"
+#if defined(__linux__)
+#include "util/procfs.hpp"
+#endif
 
 namespace waybar::modules {
 
@@ -20,16 +28,81 @@ class CpuUsage : public ALabel {
   virtual ~CpuUsage() = default;
   auto update() -> void override;
 
-  // This is a static member because it is also used by the cpu module.
-  static std::tuple<std::vector<uint16_t>, std::string> getCpuUsage(
-      std::vector<std::tuple<size_t, size_t>>&);
+  // Per-core usage and tooltip, sampled once per interval and shared by every cpu, cpu_usage
+  // and cpu_graph module through util::SampleHub.
+  using Sample = std::tuple<std::vector<uint16_t>, std::string>;
+  static util::SampleSubscription<Sample> subscribe(std::chrono::milliseconds interval,
+                                                    const sigc::slot<void()>& slot);
+
+  // Per-core format arguments ({usage<N>}, {icon<N>} and {icons}), shared with the cpu module.
+  // Only the arguments the templates reference are computed, and the argument names are built
+  // once and kept, since fmt::arg only stores a pointer to them.
+  class CoreArgs {
+   public:
+    struct Refs {
+      bool usage = false;
+      bool icon = false;
+      bool icons = false;
+
+      bool any() const { return usage || icon || icons; }
+    };
+    static Refs referenced(std::initializer_list<const util::FormatTemplate*> templates);
+
+    void push(fmt::dynamic_format_arg_store<fmt::format_context>& store, Refs refs,
+              const std::vector<uint16_t>& usage, const util::IconTable::Set& icons);
+
+   private:
+    std::vector<std::string> usage_names_;
+    std::vector<std::string> icon_names_;
+  };
+
+  // Which arguments changed since the label and tooltip were last rendered, so that each of them
+  // is only formatted again if its template refers to one of those. Shared with the cpu module,
+  // which adds its load and frequency arguments.
+  class Changes {
+   public:
+    // `rendered` is nullptr if nothing was rendered yet
+    Changes(const Sample* rendered, const Sample& sample, bool state_changed);
+
+    void add(std::initializer_list<std::string_view> names, bool changed);
+    /// Whether formatting `tpl` again may give a different result
+    bool affect(const util::FormatTemplate& tpl) const;
+
+   private:
+    bool all_;
+    // {usage} and {icon}
+    bool total_;
+    // {usage<N>}, {icon<N>} and {icons}
+    bool cores_;
+    std::vector<std::string_view> names_;
+  };
 
  private:
-  static std::vector<std::tuple<size_t, size_t>> parseCpuinfo();
+  // What the shared sampler keeps between samples. It belongs to the source rather than to a
+  // thread, since each sample may be taken by another scheduler worker.
+  struct SamplerState {
+    // Swapped after each sample, so both buffers are recycled
+    std::vector<std::tuple<size_t, size_t>> prev_times;
+    std::vector<std::tuple<size_t, size_t>> curr_times;
+#if defined(__linux__)
+    util::procfs::File cpu_present_file{"/sys/devices/system/cpu/present"};
+    util::procfs::File stat_file{"/proc/stat"};
+#endif
+  };
 
-  std::vector<std::tuple<size_t, size_t>> prev_times_;
+  // Run by the shared sampler, not by a module
+  static std::tuple<std::vector<uint16_t>, std::string> getCpuUsage(SamplerState& state);
+  // Fills `cpuinfo` with (idle, total) times; index 0 is the aggregate of all cores.
+  // The vector is reused between calls to avoid reallocating it on every sample.
+  static void parseCpuinfo(SamplerState& state, std::vector<std::tuple<size_t, size_t>>& cpuinfo);
 
-  util::SleeperThread thread_;
+  util::SampleSubscription<Sample> usage_;
+  util::FormatTemplate label_template_;
+  util::FormatTemplate tooltip_template_;
+  CoreArgs core_args_;
+  // What the label and tooltip were last rendered from, to skip formatting what is unchanged
+  std::shared_ptr<const Sample> rendered_;
+  std::string rendered_state_;
 };
 
 }  // namespace waybar::modules
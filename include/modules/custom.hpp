@@ -7,10 +7,10 @@
 #include <string>
 
 #include "AIconLabel.hpp"
+#include "modules/custom_script.hpp"
 #include "util/command.hpp"
-#include "util/command_line_stream.hpp"
 #include "util/json.hpp"
-#include "util/sleeper_thread.hpp"
+#include "util/latest_value.hpp"
 
 namespace waybar::modules {
 
@@ -20,16 +20,15 @@ class Custom : public AIconLabel {
   virtual ~Custom();
   auto update() -> void override;
   void refresh(int /*signal*/) override;
+  void suspend() override;
+  void resume() override;
 
  private:
-  void delayWorker();
-  void continuousWorker();
-  void startContinuousProcess(bool throw_on_failure);
-  void handleContinuousProcessExit(int exit_code);
-  void scheduleContinuousRestart();
-  void waitingWorker();
+  void handleOutput(const util::command::res& output);
+  void reapChildren();
   void parseOutputRaw();
   void parseOutputJson();
+  bool execOnEvent() const;
   void handleEvent();
   bool handleScroll(GdkEventScroll* e) override;
   bool handleToggle(GdkEventButton* const& e) override;
@@ -47,12 +46,12 @@ class Custom : public AIconLabel {
   const bool tooltip_format_enabled_;
   std::vector<std::string> class_;
   int percentage_;
-  util::command::res output_;
+  util::LatestValue<util::command::res> output_;
   util::JsonParser parser_;
-  std::unique_ptr<util::command::LineStream> continuous_stream_;
-  sigc::connection restart_connection_;
-
-  util::SleeperThread thread_;
+  // Shared with the same module on other outputs when "shared" is set
+  std::shared_ptr<CustomScript> script_;
+  // Daemon mode: the script is started once and answers requests written to its stdin
+  const bool daemon_;
 };
 
 }  // namespace waybar::modules
@@ -2,12 +2,17 @@
 
 #include <fmt/format.h>
 
+#include <atomic>
+#include <chrono>
 #include <csignal>
+#include <mutex>
+#include <stop_token>
 #include <string>
 
 #include "AGraph.hpp"
 #include "util/command.hpp"
 #include "util/json.hpp"
+#include "util/latest_value.hpp"
 #include "util/sleeper_thread.hpp"
 
 namespace waybar::modules {
@@ -18,11 +23,16 @@ class CustomGraph : public AGraph {
   virtual ~CustomGraph();
   auto update() -> void override;
   void refresh(int /*signal*/) override;
+  void suspend() override;
+  void resume() override;
 
  private:
-  void delayWorker();
+  // Run the script on the command pool after `delay`
+  void schedule(std::chrono::milliseconds delay);
   void continuousWorker();
-  void waitingWorker();
+  void runScript(std::stop_token stop);
+  void wakeUp();
+  void reapChildren();
   void parseOutputRaw();
   void parseOutputJson();
   void handleEvent();
@@ -38,9 +48,23 @@ class CustomGraph : public AGraph {
   const bool tooltip_format_enabled_;
   std::vector<std::string> class_;
   int percentage_;
+  enum class Mode {
+    NONE,
+    // The script runs on the command pool when woken up, and also every interval_ when polling
+    WAIT,
+    POLL,
+    // The script runs on thread_ and prints a line per update
+    CONTINUOUS,
+  };
+  Mode mode_ = Mode::NONE;
+  std::mutex pause_mutex_;
+  bool paused_ = false;
+  // A polled run was skipped while paused
+  bool parked_ = false;
+  // Only used by the continuous worker
   FILE* fp_;
-  int pid_;
-  util::command::res output_;
+  std::atomic<int> pid_;
+  util::LatestValue<util::command::res> output_;
   util::JsonParser parser_;
 
   util::SleeperThread thread_;
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <json/value.h>
+#include <sigc++/connection.h>
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <stop_token>
+#include <string>
+#include <string_view>
+
+#include "util/command.hpp"
+#include "util/command_line_stream.hpp"
+
+namespace waybar::modules {
+
+/**
+ * The script behind one or more custom modules, run in one of their modes: polled on the shared
+ * command pool (with an interval or a signal), continuous, or daemon.
+ *
+ * Modules with the "shared" option get the same instance when their script settings match, so a
+ * module repeated on every output runs its script once and all copies show the same output.
+ * Outputs are delivered to subscribers on the thread that produced them: a pool worker when
+ * polled, the main thread otherwise.
+ */
+class CustomScript {
+ public:
+  enum class Mode { NONE, POLL, CONTINUOUS, DAEMON };
+  using Output = std::function<void(const util::command::res&)>;
+
+  /// Script for a module, shared with other modules when `config` allows it. Starts it if new.
+  static std::shared_ptr<CustomScript> get(const Json::Value& config, const std::string& name,
+                                           const std::string& output_name,
+                                           std::chrono::milliseconds interval);
+
+  CustomScript(const Json::Value& config, std::string name, std::string output_name,
+               std::chrono::milliseconds interval);
+  CustomScript(const CustomScript&) = delete;
+  CustomScript& operator=(const CustomScript&) = delete;
+  ~CustomScript();
+
+  Mode mode() const { return mode_; }
+
+  /// Receive every output from now on, starting with the latest one if there is any
+  void subscribe(const void* owner, Output on_output);
+  /// Stop receiving outputs. Waits for a delivery to `owner` in progress on another thread.
+  void unsubscribe(const void* owner);
+
+  /// Run the script again now, or ask the daemon for an update
+  void refresh();
+  /// Forward a click or scroll event (e.g. "click left"). Re-runs a polled script.
+  void event(std::string_view line);
+
+  /// Stop polling while the module of `owner` can't be seen. A script shared between modules is
+  /// paused once all of its subscribers are, and runs again as soon as one of them resumes.
+  void pause(const void* owner);
+  void resume(const void* owner);
+
+ private:
+  void start();
+  void schedule(std::chrono::milliseconds delay);
+  void run(std::stop_token stop);
+  void request(std::string_view line);
+  void startStream(bool throw_on_failure);
+  void handleExit(int exit_code);
+  void scheduleRestart();
+  void publish(util::command::res output);
+  // Called with mutex_ held
+  bool allPaused() const;
+
+  const Json::Value config_;
+  const std::string name_;
+  const std::string output_name_;
+  const std::chrono::milliseconds interval_;
+  Mode mode_ = Mode::NONE;
+  // Zero when the script may run for as long as it wants
+  std::chrono::milliseconds exec_timeout_{0};
+
+  std::mutex mutex_;
+  std::map<const void*, Output> subscribers_;
+  std::optional<util::command::res> last_;
+  std::set<const void*> paused_;
+  // A polled run was skipped while paused
+  bool parked_ = false;
+
+  std::unique_ptr<util::command::LineStream> stream_;
+  sigc::connection restart_connection_;
+  sigc::connection tick_connection_;
+  // Daemon requests that may still be answered: the last update, and events sent since the last
+  // output line. A reply lost by the daemon is given up on at the next interval tick.
+  bool awaiting_reply_ = false;
+  bool event_pending_ = false;
+};
+
+}  // namespace waybar::modules
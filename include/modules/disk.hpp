@@ -4,11 +4,12 @@
 #include <sys/statvfs.h>
 
 #include <fstream>
+#include <optional>
 #include <vector>
 
 #include "ALabel.hpp"
 #include "util/format.hpp"
-#include "util/sleeper_thread.hpp"
+#include "util/sample_hub.hpp"
 
 namespace waybar::modules {
 
@@ -19,13 +20,21 @@ class Disk : public ALabel {
   auto update() -> void override;
 
  private:
-  util::SleeperThread thread_;
+  // statvfs() results for each configured path, in the same order as paths_
+  using Sample = std::vector<std::optional<struct statvfs>>;
+
+  static Sample statPaths(const std::vector<std::string>& paths);
+
+  util::SampleSubscription<Sample> stats_;
   std::string header_;
   std::vector<std::string> paths_;
   std::string separator_;
   std::string unit_;
 
   float calc_specific_divisor(const std::string& divisor);
+  // `format` with the arguments of one path, for the label and the tooltip
+  std::string formatDisk(const std::string& format, const struct statvfs& stats,
+                         const std::string& path);
 };
 
 }  // namespace waybar::modules
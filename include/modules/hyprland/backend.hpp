@@ -9,6 +9,7 @@
 #include <thread>
 #include <utility>
 
+#include "modules/hyprland/state.hpp"
 #include "util/json.hpp"
 
 namespace waybar::modules::hyprland {
@@ -36,6 +37,10 @@ class IPC {
   Json::Value getSocket1JsonReply(const std::string& rq);
   static std::filesystem::path getSocketFolder(const char* instanceSig);
 
+  /// Mirror of Hyprland's monitors, workspaces, clients and active workspace. Prefer it over
+  /// getSocket1JsonReply() for those, it only queries Hyprland when an event made them stale.
+  State& state() { return state_; }
+
   /// Dispatch a Hyprland command. Automatically uses the correct protocol
   /// (legacy text or Lua-based) depending on the running Hyprland version.
   static std::string dispatch(const std::string& dispatcher, const std::string& arg);
@@ -53,13 +58,16 @@ class IPC {
   static std::optional<bool> s_luaProtocolDetected_;  // cached detection result
 
  private:
-  void socketListener();
+  // Connects to the event socket, or returns -1
+  static int connectSocket2();
+  void socketListener(int socketfd);
   void parseIPC(const std::string&);
 
   std::thread ipcThread_;
   std::mutex callbackMutex_;
   std::mutex socketMutex_;
   util::JsonParser parser_;
+  State state_;
   std::list<std::pair<std::string, EventHandler*>> callbacks_;
   int socketfd_ = -1;  // the hyprland socket file descriptor
   pid_t socketOwnerPid_ = -1;
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <json/json.h>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "util/json.hpp"
+
+namespace waybar::modules::hyprland {
+
+/**
+ * In-process mirror of Hyprland's monitors, workspaces, clients and active workspace.
+ *
+ * Each section is fetched with one socket1 query the first time it is read, and then kept current
+ * from socket2 events: focus, title and rename events are patched into the cached JSON, while
+ * events that change the layout mark the affected sections stale. A stale section is queried
+ * again on its next read, so a burst of events costs at most one query per section no matter how
+ * many modules read the state in between.
+ *
+ * Until the event stream is connected (see setLive()) nothing is cached and every read queries
+ * Hyprland, as before. Thread-safe.
+ */
+class State {
+ public:
+  using Snapshot = std::shared_ptr<const Json::Value>;
+  /// Runs a socket1 request such as "j/clients" and returns the raw reply
+  using Query = std::function<std::string(const std::string&)>;
+
+  enum Section : uint8_t {
+    MONITORS = 1 << 0,
+    WORKSPACES = 1 << 1,
+    CLIENTS = 1 << 2,
+    ACTIVE_WORKSPACE = 1 << 3,
+    ALL = MONITORS | WORKSPACES | CLIENTS | ACTIVE_WORKSPACE,
+  };
+
+  explicit State(Query query);
+
+  /// Equivalent to the "monitors", "workspaces", "clients" and "activeworkspace" replies.
+  /// The returned snapshots are immutable and stay valid after the mirror moves on.
+  Snapshot monitors() { return get(MONITORS); }
+  Snapshot workspaces() { return get(WORKSPACES); }
+  Snapshot clients() { return get(CLIENTS); }
+  Snapshot activeWorkspace() { return get(ACTIVE_WORKSPACE); }
+
+  /// Update the mirror for one socket2 event ("name>>payload")
+  void apply(const std::string& ev);
+
+  void invalidate(uint8_t sections = ALL);
+
+  /// Whether socket2 events are being applied. While not live, reads always query.
+  void setLive(bool live);
+
+ private:
+  static constexpr std::size_t kSections = 4;
+
+  Snapshot get(Section section);
+  // Returns the cached section, or nullptr if it is stale
+  const Json::Value* cached(Section section) const;
+  // Returns the cached section for patching, copying it first if a reader still holds it,
+  // or nullptr if the section is stale and will be re-queried anyway.
+  Json::Value* mutableSection(Section section);
+  // Marks sections stale, and any reply to a query for them in flight as outdated
+  void markStale(uint8_t sections);
+
+  void onActiveWindow(const std::string& address);
+  void onWindowTitle(const std::string& address, const std::string& title);
+  void onWorkspace(int id);
+  void onFocusedMonitor(const std::string& monitor, int workspaceId);
+  void onWorkspaceRenamed(int id, const std::string& name);
+  void setActiveWorkspace(int id);
+
+  // Not held while querying
+  std::mutex mutex_;
+  Query query_;
+  util::JsonParser parser_;
+  std::array<std::shared_ptr<Json::Value>, kSections> sections_;
+  uint8_t stale_ = ALL;
+  // Bumped by every event that touches a section, to tell whether a reply predates it
+  std::array<uint64_t, kSections> generations_{};
+  bool live_ = false;
+};
+
+}  // namespace waybar::modules::hyprland
@@ -8,6 +8,7 @@
 #include "bar.hpp"
 #include "modules/hyprland/backend.hpp"
 #include "util/json.hpp"
+#include "util/rewrite_string.hpp"
 
 namespace waybar::modules::hyprland {
 
@@ -50,6 +51,7 @@ class Window : public waybar::AAppIconLabel, public EventHandler {
   bool separateOutputs_ = false;
   std::mutex mutex_;
   const Bar& bar_;
+  util::RewriteRuleSet rewrite_;
   util::JsonParser parser_;
   WindowData windowData_;
   Workspace workspace_;
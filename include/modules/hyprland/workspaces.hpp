@@ -105,7 +105,7 @@ class Workspaces : public AModule, public EventHandler {
   void onSpecialWorkspaceActivated(std::string const& payload);
   void onWorkspaceDestroyed(std::string const& payload);
   void onWorkspaceCreated(std::string const& payload,
-                          Json::Value const& clientsData = Json::Value::nullRef);
+                          State::Snapshot const& clientsData = nullptr);
   void onWorkspaceMoved(std::string const& payload);
   void onWorkspaceRenamed(std::string const& payload);
   static std::optional<int> parseWorkspaceId(std::string const& workspaceIdStr);
@@ -147,7 +147,7 @@ class Workspaces : public AModule, public EventHandler {
 
   void initializeWorkspaces();
   void setCurrentMonitorId();
-  void loadPersistentWorkspacesFromConfig(Json::Value const& clientsJson);
+  void loadPersistentWorkspacesFromConfig(State::Snapshot const& clientsJson);
   void loadPersistentWorkspacesFromWorkspaceRules(const Json::Value& clientsJson);
 
   bool m_allOutputs = false;
@@ -192,7 +192,7 @@ class Workspaces : public AModule, public EventHandler {
   int m_activeWorkspaceId;
   std::string m_activeSpecialWorkspaceName;
   std::vector<std::unique_ptr<Workspace>> m_workspaces;
-  std::vector<std::pair<Json::Value, Json::Value>> m_workspacesToCreate;
+  std::vector<std::pair<Json::Value, State::Snapshot>> m_workspacesToCreate;
   std::vector<std::string> m_workspacesToRemove;
   std::vector<WindowCreationPayload> m_windowsToCreate;
 
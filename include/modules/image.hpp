@@ -3,14 +3,17 @@
 #include <fmt/format.h>
 #include <gtkmm/image.h>
 
+#include <chrono>
 #include <csignal>
+#include <stop_token>
 #include <string>
 
 #include "ALabel.hpp"
 #include "gtkmm/box.h"
 #include "util/command.hpp"
+#include "util/command_pool.hpp"
 #include "util/json.hpp"
-#include "util/sleeper_thread.hpp"
+#include "util/latest_value.hpp"
 
 namespace waybar::modules {
 
@@ -21,7 +24,7 @@ class IStrategy {
   virtual ~IStrategy() = default;
   // Runs on the worker thread before update(). Use it for blocking work (e.g.
   // spawning a user script) so the GTK main loop isn't stalled. Default no-op.
-  virtual void fetch() {}
+  virtual void fetch(std::stop_token /*stop*/) {}
   virtual void update() = 0;
 };
 
@@ -30,12 +33,13 @@ class SingleImageStrategy : public IStrategy {
   SingleImageStrategy(const std::string&, const Json::Value&, const std::string&, Gtk::EventBox&,
                       bool);
   ~SingleImageStrategy() override = default;
+  void fetch(std::stop_token stop) override;
   void update() override;
 
  private:
   void parseOutputRaw();
 
-  util::command::res output_;
+  util::LatestValue<util::command::res> output_;
   Json::Value config_;
   Gtk::Image image_;
   std::string path_;
@@ -49,7 +53,7 @@ class MultipleImageStrategy : public IStrategy {
  public:
   MultipleImageStrategy(const std::string&, const Json::Value&, const std::string&, Gtk::EventBox&);
   ~MultipleImageStrategy() override = default;
-  void fetch() override;
+  void fetch(std::stop_token stop) override;
   void update() override;
 
  private:
@@ -72,7 +76,7 @@ class MultipleImageStrategy : public IStrategy {
   Gtk::Box box_;
   std::vector<ImageData> images_data_;
   // stdout captured by fetch() on the worker thread and consumed by update()
-  std::string exec_output_;
+  util::LatestValue<std::string> exec_output_;
 };
 
 }  // namespace image
@@ -80,19 +84,18 @@ class MultipleImageStrategy : public IStrategy {
 class Image : public AModule {
  public:
   Image(const std::string&, const Json::Value&);
-  virtual ~Image() = default;
+  virtual ~Image();
   auto update() -> void override;
   void refresh(int /*signal*/) override;
 
  private:
-  void delayWorker();
+  void schedule(std::chrono::milliseconds delay);
   void handleEvent();
   static std::unique_ptr<image::IStrategy> getStrategy(const std::string&, const Json::Value&,
                                                        const std::string&, Gtk::EventBox&, bool);
 
   std::chrono::milliseconds interval_;
   std::unique_ptr<image::IStrategy> strategy_;
-  util::SleeperThread thread_;
 };
 
 }  // namespace waybar::modules
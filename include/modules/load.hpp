@@ -10,7 +10,7 @@
 #include <vector>
 
 #include "ALabel.hpp"
-#include "util/sleeper_thread.hpp"
+#include "util/sample_hub.hpp"
 
 namespace waybar::modules {
 
@@ -20,11 +20,17 @@ class Load : public ALabel {
   virtual ~Load() = default;
   auto update() -> void override;
 
-  // This is a static member because it is also used by the cpu module.
-  static std::tuple<double, double, double> getLoad();
+  // Load averages, sampled once per interval and shared by every load and cpu module through
+  // util::SampleHub.
+  using Sample = std::tuple<double, double, double>;
+  static util::SampleSubscription<Sample> subscribe(std::chrono::milliseconds interval,
+                                                    const sigc::slot<void()>& slot);
 
  private:
-  util::SleeperThread thread_;
+  // Run by the shared sampler, not by a module
+  static std::tuple<double, double, double> getLoad();
+
+  util::SampleSubscription<Sample> load_;
 };
 
 }  // namespace waybar::modules
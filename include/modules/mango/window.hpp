@@ -8,6 +8,7 @@
 #include "AAppIconLabel.hpp"
 #include "bar.hpp"
 #include "modules/mango/backend.hpp"
+#include "util/rewrite_string.hpp"
 
 namespace waybar::modules::mango {
 
@@ -23,6 +24,7 @@ class Window : public AAppIconLabel, public EventHandler {
   void setClass(const std::string& className, bool enable);
 
   const Bar& bar_;
+  util::RewriteRuleSet rewrite_;
   std::string oldAppId_;
   std::mutex mutex_;
 };
@@ -2,11 +2,15 @@
 
 #include <fmt/format.h>
 
+#include <cstdint>
 #include <fstream>
 #include <unordered_map>
 
 #include "ALabel.hpp"
-#include "util/sleeper_thread.hpp"
+#include "util/sample_hub.hpp"
+#if defined(__linux__)
+#include "util/procfs.hpp"
+#endif
 
 namespace waybar::modules {
 
@@ -17,11 +21,33 @@ class Memory : public ALabel {
   auto update() -> void override;
 
  private:
-  void parseMeminfo();
-
-  std::unordered_map<std::string, unsigned long> meminfo_;
-
-  util::SleeperThread thread_;
+  // Values in kiB. Fixed layout so /proc/meminfo can be parsed straight into it.
+  struct Meminfo {
+    uint64_t mem_total{0};
+    uint64_t mem_free{0};
+    uint64_t mem_available{0};
+    uint64_t buffers{0};
+    uint64_t cached{0};
+    uint64_t s_reclaimable{0};
+    uint64_t shmem{0};
+    uint64_t swap_total{0};
+    uint64_t swap_free{0};
+    uint64_t zfs_size{0};
+    bool has_mem_available{false};
+  };
+
+  // What the shared sampler keeps between samples. It belongs to the source rather than to a
+  // thread, since each sample may be taken by another scheduler worker.
+  struct SamplerState {
+#if defined(__linux__)
+    util::procfs::File meminfo_file{"/proc/meminfo"};
+    util::procfs::File zfs_arc_stats_file{"/proc/spl/kstat/zfs/arcstats"};
+#endif
+  };
+
+  static Meminfo parseMeminfo(SamplerState& state);
+
+  util::SampleSubscription<Meminfo> meminfo_;
 
   std::string unit_;
 };
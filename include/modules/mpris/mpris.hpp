@@ -1,5 +1,7 @@
 #pragma once
 
+#include <glibmm/dispatcher.h>
+
 #include <iostream>
 #include <optional>
 #include <string>
@@ -12,6 +14,7 @@ extern "C" {
 }
 
 #include "ALabel.hpp"
+#include "util/latest_value.hpp"
 #include "util/sleeper_thread.hpp"
 
 namespace waybar::modules::mpris {
@@ -44,6 +47,11 @@ class Mpris : public ALabel {
     std::optional<std::string> position;  // same format
   };
 
+  // Read the player state and publish it. Runs on the main context, where playerctl keeps that
+  // state up to date from D-Bus signals.
+  auto fetch() -> void;
+  // Fetch once the main loop is idle, so that a burst of player signals is read only once
+  auto scheduleFetch() -> void;
   auto getPlayerInfo() -> std::optional<PlayerInfo>;
   auto getIconFromJson(const Json::Value&, const std::string&) -> std::string;
   auto getArtistStr(const PlayerInfo&, bool) -> std::string;
@@ -85,6 +93,10 @@ class Mpris : public ALabel {
   std::string lastStatus;
   std::string lastPlayer;
 
+  util::LatestValue<std::optional<PlayerInfo>> info_;
+  sigc::connection fetch_idle_;
+  // Asks the main context for a fetch on every interval
+  Glib::Dispatcher fetch_dp_;
   util::SleeperThread thread_;
   std::chrono::time_point<std::chrono::system_clock> last_update_;
 };
@@ -1,24 +1,20 @@
 #pragma once
 
-#include <arpa/inet.h>
 #include <fmt/format.h>
-#include <linux/nl80211.h>
-#include <netlink/genl/ctrl.h>
-#include <netlink/genl/genl.h>
-#include <netlink/netlink.h>
-#include <sys/epoll.h>
 
-#include <optional>
+#include <chrono>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include "ALabel.hpp"
+#include "util/latest_value.hpp"
+#include "util/network_monitor.hpp"
 #include "util/sleeper_thread.hpp"
 #ifdef WANT_RFKILL
 #include "util/rfkill.hpp"
 #endif
 
-#define ETH_ALEN 6
-
 enum ip_addr_pref : uint8_t { IPV4, IPV6, IPV4_6 };
 
 namespace waybar::modules {
@@ -26,63 +22,40 @@ namespace waybar::modules {
 class Network : public ALabel {
  public:
   Network(const std::string&, const Json::Value&);
-  virtual ~Network();
+  virtual ~Network() = default;
   auto update() -> void override;
 
  private:
-  static const uint8_t MAX_RETRY{5};
-  static const uint8_t EPOLL_MAX{200};
-
-  static int handleEvents(struct nl_msg*, void*);
-  static int handleEventsDone(struct nl_msg*, void*);
-  static int handleScan(struct nl_msg*, void*);
-  static int handleStationGet(struct nl_msg *msg, void *data);
-
-  void askForStateDump(void);
+  /// Traffic of the tracked interface over the last sampling interval, in bytes per second
+  struct BandwidthSample {
+    double down{0};
+    double up{0};
+  };
 
   void worker();
-  void createInfoSocket();
-  void createEventSocket();
-  void parseEssid(struct nlattr**);
-  void parseSignal(struct nlattr**);
-  void parseFreq(struct nlattr**);
-  void parseBssid(struct nlattr**);
-  bool associatedOrJoined(struct nlattr**);
+  void sampleBandwidth(int ifid);
+  void selectInterface();
+  void setAddresses(const util::NetworkMonitor::Interface&);
   bool matchInterface(const std::string& ifname, const std::vector<std::string>& altnames,
                       std::string& matched) const;
-  auto getInfo() -> void;
   bool isWireless() const;
   const std::string getNetworkState() const;
   void clearIface();
-  std::optional<std::pair<unsigned long long, unsigned long long>> readBandwidthUsage();
   uint32_t readLinkSpeed() const;
 
   int ifid_{-1};
   ip_addr_pref addr_pref_{ip_addr_pref::IPV4};
-  struct sockaddr_nl nladdr_{0};
-  struct nl_sock* sock_{nullptr};
-  struct nl_sock* ev_sock_{nullptr};
-  struct nl_sock* station_sock_{nullptr};
-  int efd_{-1};
-  int ev_fd_{-1};
-  int nl80211_id_{-1};
+  // Guards the interface state, which the timer thread fills in as well
   std::mutex mutex_;
 
-  bool want_route_dump_{false};
-  bool want_link_dump_{false};
-  bool want_addr_dump_{false};
-  bool dump_in_progress_{false};
-  bool is_p2p_{false};
-
-  unsigned long long bandwidth_down_total_{0};
-  unsigned long long bandwidth_up_total_{0};
-  unsigned long long bandwidth_down_prev_{0};
-  unsigned long long bandwidth_up_prev_{0};
-  std::chrono::steady_clock::time_point bandwidth_last_sample_time_;
+  // Counters of the previous sample, only touched by the timer thread
+  int stats_ifid_{-1};
+  uint64_t stats_rx_bytes_{0};
+  uint64_t stats_tx_bytes_{0};
+  std::chrono::steady_clock::time_point stats_time_;
+  util::LatestValue<BandwidthSample> bandwidth_;
 
   std::string state_;
-  std::string essid_;
-  std::string bssid_;
   bool carrier_{false};
   std::string ifname_;
   std::string ipaddr_;
@@ -92,20 +65,17 @@ class Network : public ALabel {
   std::string netmask6_;
   int cidr_{0};
   int cidr6_{0};
-  int32_t signal_strength_dbm_;
-  uint8_t signal_strength_;
-  std::string signal_strength_app_;
-  uint32_t route_priority;
+  util::NetworkMonitor::WirelessInfo wireless_;
   uint32_t link_speed_{0};
+  // Cleared when the link changes, link_speed_ is read again on the next tick
+  bool link_speed_valid_{false};
 
-  util::SleeperThread thread_;
+  // Declared before the loops, so that they are stopped before the subscription is dropped
+  std::shared_ptr<util::NetworkMonitor> monitor_;
   util::SleeperThread thread_timer_;
 #ifdef WANT_RFKILL
   util::Rfkill rfkill_{RFKILL_TYPE_WLAN};
 #endif
-  float frequency_{0};
-  uint32_t tx_bitrate_{0};
-  uint32_t rx_bitrate_{0};
 };
 
 }  // namespace waybar::modules
@@ -6,6 +6,7 @@
 #include "AAppIconLabel.hpp"
 #include "bar.hpp"
 #include "modules/niri/backend.hpp"
+#include "util/rewrite_string.hpp"
 
 namespace waybar::modules::niri {
 
@@ -21,6 +22,7 @@ class Window : public AAppIconLabel, public EventHandler {
   void setClass(const std::string& className, bool enable);
 
   const Bar& bar_;
+  util::RewriteRuleSet rewrite_;
 
   std::string oldAppId_;
 };
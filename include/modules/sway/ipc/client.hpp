@@ -6,6 +6,7 @@
 #include <cstdint>
 #include <functional>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -31,8 +32,13 @@ class Ipc {
   ::waybar::SafeSignal<const struct ipc_response&> signal_cmd;
 
   void sendCmd(uint32_t type, const std::string& payload = "");
+  // Like sendCmd(), but hands the reply back to the caller instead of emitting signal_cmd.
+  struct ipc_response query(uint32_t type, const std::string& payload = "");
   void subscribe(const std::string& payload);
   void handleEvent();
+  // Blocking read of the next event. Returns std::nullopt if the event connection was lost and
+  // re-established (events may have been missed) or the Ipc is shutting down.
+  std::optional<struct ipc_response> readEvent();
   void setWorker(std::function<void()>&& func);
 
  protected:
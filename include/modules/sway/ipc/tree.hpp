@@ -0,0 +1,64 @@
+#pragma once
+
+#include <glibmm/dispatcher.h>
+#include <json/json.h>
+#include <sigc++/sigc++.h>
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "modules/sway/ipc/client.hpp"
+#include "util/json.hpp"
+#include "util/sleeper_thread.hpp"
+
+namespace waybar::modules::sway {
+
+/**
+ * Process-wide model of the sway layout tree, shared by the window, workspaces and scratchpad
+ * modules of every bar.
+ *
+ * One event connection listens for window and workspace events. Events that only change the
+ * properties of a single container (title, marks, urgency) or move the focus within a workspace
+ * are patched into a copy of the current snapshot. Anything structural triggers one IPC_GET_TREE;
+ * events that arrive while it is in flight are folded into at most one follow-up fetch. Must be
+ * acquired on the main thread.
+ */
+class Tree {
+ public:
+  using snapshot_t = std::shared_ptr<const Json::Value>;
+
+  static std::shared_ptr<Tree> getInstance();
+
+  Tree(const Tree&) = delete;
+  Tree& operator=(const Tree&) = delete;
+  ~Tree();
+
+  /// Most recent tree, or nullptr until the first fetch completes. Thread-safe.
+  snapshot_t snapshot() const;
+
+  /// Emitted on the main thread each time a new snapshot is published
+  sigc::signal<void(const Json::Value&)> signal_tree;
+
+ private:
+  Tree();
+
+  void onEvent(std::optional<struct Ipc::ipc_response> event);
+  void fetchWorker();
+  void fetch();
+  void publish(snapshot_t tree);
+
+  mutable std::mutex mutex_;
+  std::vector<struct Ipc::ipc_response> pending_;
+  bool refresh_requested_{true};
+  snapshot_t snapshot_;
+
+  Glib::Dispatcher dp_;
+  util::JsonParser parser_;
+  util::SleeperThread fetch_thread_;
+  // Declared last: its event thread feeds fetch_thread_ and must be stopped first
+  Ipc ipc_;
+};
+
+}  // namespace waybar::modules::sway
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <json/json.h>
+
+#include <cstdint>
+
+namespace waybar::modules::sway {
+
+/**
+ * Whether an event can be applied to a cached tree with patchTree(): window title, mark, urgency
+ * and focus changes, and workspace urgency changes. Anything else may change the layout and
+ * requires a full IPC_GET_TREE.
+ */
+bool isPatchableEvent(uint32_t type, const Json::Value& event);
+
+/**
+ * Apply a patchable event to `tree` in place. Returns false, possibly leaving `tree` partially
+ * patched, if the event names a container that is not in the tree or moves the focus to another
+ * workspace, in which case the tree has to be fetched again.
+ */
+bool patchTree(Json::Value& tree, uint32_t type, const Json::Value& event);
+
+}  // namespace waybar::modules::sway
@@ -2,34 +2,29 @@
 
 #include <gtkmm/label.h>
 
-#include <mutex>
+#include <memory>
 #include <string>
 
 #include "ALabel.hpp"
 #include "bar.hpp"
 #include "client.hpp"
-#include "modules/sway/ipc/client.hpp"
-#include "util/json.hpp"
+#include "modules/sway/ipc/tree.hpp"
 
 namespace waybar::modules::sway {
-class Scratchpad : public ALabel {
+class Scratchpad : public ALabel, public sigc::trackable {
  public:
   Scratchpad(const std::string&, const Json::Value&);
   virtual ~Scratchpad() = default;
   auto update() -> void override;
 
  private:
-  auto getTree() -> void;
-  auto onCmd(const struct Ipc::ipc_response&) -> void;
-  auto onEvent(const struct Ipc::ipc_response&) -> void;
+  auto onTree(const Json::Value& tree) -> void;
 
   std::string tooltip_format_;
   bool show_empty_;
   bool tooltip_enabled_;
   std::string tooltip_text_;
   int count_;
-  std::mutex mutex_;
-  Ipc ipc_;
-  util::JsonParser parser_;
+  std::shared_ptr<Tree> tree_;
 };
 }  // namespace waybar::modules::sway
@@ -2,13 +2,14 @@
 
 #include <fmt/format.h>
 
+#include <memory>
 #include <tuple>
 
 #include "AAppIconLabel.hpp"
 #include "bar.hpp"
 #include "client.hpp"
-#include "modules/sway/ipc/client.hpp"
-#include "util/json.hpp"
+#include "modules/sway/ipc/tree.hpp"
+#include "util/rewrite_string.hpp"
 
 namespace waybar::modules::sway {
 
@@ -20,14 +21,13 @@ class Window : public AAppIconLabel, public sigc::trackable {
 
  private:
   void setClass(const std::string& classname, bool enable);
-  void onEvent(const struct Ipc::ipc_response&);
-  void onCmd(const struct Ipc::ipc_response&);
+  void onTree(const Json::Value& tree);
   std::tuple<std::size_t, int, int, std::string, std::string, std::string, std::string, std::string,
              std::string>
   getFocusedNode(const Json::Value& nodes, std::string& output);
-  void getTree();
 
   const Bar& bar_;
+  util::RewriteRuleSet rewrite_;
   std::string window_;
   int windowId_;
   std::string app_id_;
@@ -38,9 +38,7 @@ class Window : public AAppIconLabel, public sigc::trackable {
   std::string shell_;
   std::string marks_;
   int floating_count_;
-  util::JsonParser parser_;
-  std::mutex mutex_;
-  Ipc ipc_;
+  std::shared_ptr<Tree> tree_;
 };
 
 }  // namespace waybar::modules::sway
@@ -4,6 +4,7 @@
 #include <gtkmm/button.h>
 #include <gtkmm/label.h>
 
+#include <memory>
 #include <optional>
 #include <string_view>
 #include <unordered_map>
@@ -12,6 +13,7 @@
 #include "bar.hpp"
 #include "client.hpp"
 #include "modules/sway/ipc/client.hpp"
+#include "modules/sway/ipc/tree.hpp"
 #include "util/json.hpp"
 #include "util/regex_collection.hpp"
 
@@ -34,8 +36,7 @@ class Workspaces : public AModule, public sigc::trackable {
 
   auto populateIgnoreWorkspacesConfig(const Json::Value& config) -> void;
   bool isWorkspaceIgnored(std::string const& name);
-  void onCmd(const struct Ipc::ipc_response&);
-  void onEvent(const struct Ipc::ipc_response&);
+  void onTree(const Json::Value& tree);
   bool filterButtons();
   static bool hasFlag(const Json::Value&, const std::string&);
   void updateWindows(const Json::Value&, std::string&);
@@ -56,10 +57,11 @@ class Workspaces : public AModule, public sigc::trackable {
   std::string m_formatWindowSeparator;
   std::vector<std::regex> m_ignoreWorkspaces;
   util::RegexCollection m_windowRewriteRules;
-  util::JsonParser parser_;
   std::unordered_map<std::string, Gtk::Button> buttons_;
   std::unordered_map<std::string, uint16_t> custom_sort_priorities_;
   std::mutex mutex_;
+  std::shared_ptr<Tree> tree_;
+  // Only used to send commands, so it opens no event socket; tree updates come from tree_
   Ipc ipc_;
 };
 
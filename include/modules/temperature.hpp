@@ -14,8 +14,6 @@ class Temperature : public ALabel {
   Temperature(const std::string&, const Json::Value&);
   virtual ~Temperature() = default;
   auto update() -> void override;
-  void suspend() override;
-  void resume() override;
 
  private:
   float getTemperature();
@@ -23,6 +23,7 @@
 #include "giomm/desktopappinfo.h"
 #include "util/icon_loader.hpp"
 #include "util/json.hpp"
+#include "util/rewrite_string.hpp"
 #include "wlr-foreign-toplevel-management-unstable-v1-client-protocol.h"
 
 namespace waybar::modules::wlr {
@@ -175,6 +176,7 @@ class Taskbar : public waybar::AModule {
   std::unordered_set<std::string> ignore_list_;
   std::unordered_set<std::string> squash_list_;
   std::map<std::string, std::string> app_ids_replace_map_;
+  util::RewriteRuleSet rewrite_rules_;
 
   struct zwlr_foreign_toplevel_manager_v1* manager_;
   struct ext_workspace_manager_v1* workspace_manager_;
@@ -214,6 +216,7 @@ class Taskbar : public waybar::AModule {
   const std::unordered_set<std::string>& ignore_list() const;
   const std::unordered_set<std::string>& squash_list() const;
   const std::map<std::string, std::string>& app_ids_replace_map() const;
+  const util::RewriteRuleSet& rewrite_rules() const;
   std::size_t task_id_count(std::string_view id) const;
   std::size_t task_title_count(std::string_view title) const;
 
@@ -3,10 +3,13 @@
 #include <glibmm/dispatcher.h>
 #include <sigc++/signal.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
-#include <mutex>
-#include <queue>
+#include <memory>
+#include <optional>
 #include <thread>
 #include <tuple>
 #include <type_traits>
@@ -16,17 +19,62 @@ namespace waybar {
 
 /**
  * Thread-safe signal wrapper.
- * Uses Glib::Dispatcher to pass events to another thread and locked queue to pass the arguments.
+ * Uses Glib::Dispatcher to pass events to another thread and a lock-free queue to pass the
+ * arguments.
+ *
+ * Producers put events in a bounded ring (a multi-producer queue after Dmitry Vyukov's) and only
+ * wake the dispatcher when no wakeup is pending; the main thread then delivers everything queued
+ * at that point in emission order. A producer that finds the ring full drops the oldest event to
+ * make room, so a stalled main loop holds at most max_queued_events and still gets the latest
+ * ones. In coalescing mode only the latest pending event is kept, for signals that carry a state
+ * rather than a change.
  */
 template <typename... Args>
 struct SafeSignal : sigc::signal<void(std::decay_t<Args>...)> {
  public:
+  static constexpr std::size_t DEFAULT_MAX_QUEUED_EVENTS = 4096;
+
+  struct Stats {
+    uint64_t enqueued = 0;
+    // Events dropped because max_queued_events were pending
+    uint64_t dropped = 0;
+    // Events waiting for the main loop
+    std::size_t queued = 0;
+    // Events superseded by a later one in coalescing mode
+    uint64_t coalesced = 0;
+    // Most events delivered by a single dispatcher wakeup
+    std::size_t max_depth = 0;
+  };
+
   SafeSignal() { dp_.connect(sigc::mem_fun(*this, &SafeSignal::handle_event)); }
+  SafeSignal(const SafeSignal&) = delete;
+  SafeSignal& operator=(const SafeSignal&) = delete;
+  ~SafeSignal() { delete latest_.exchange(nullptr); }
 
+  /// At least one event is kept. Pending events past the new limit are dropped right away, oldest
+  /// first. Must be set before other threads start emitting.
   void set_max_queued_events(std::size_t max_queued_events) {
-    std::unique_lock lock(mutex_);
-    max_queued_events_ = max_queued_events;
-    trim_queue_locked();
+    Ring ring(std::max<std::size_t>(1, max_queued_events));
+    while (auto args = ring_.pop()) {
+      if (!ring.try_push(std::move(*args))) {
+        ring.pop();
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        ring.try_push(std::move(*args));
+      }
+    }
+    ring_ = std::move(ring);
+  }
+
+  /// Only deliver the latest event emitted between two dispatcher wakeups.
+  /// Must be set before other threads start emitting.
+  void set_coalescing(bool coalescing) { coalescing_ = coalescing; }
+
+  Stats stats() const {
+    return {.enqueued = enqueued_.load(std::memory_order_relaxed),
+            .dropped = dropped_.load(std::memory_order_relaxed),
+            .queued = ring_.size(),
+            .coalesced = coalesced_.load(std::memory_order_relaxed),
+            .max_depth = max_depth_.load(std::memory_order_relaxed)};
   }
 
   template <typename... EmitArgs>
@@ -40,14 +88,34 @@ struct SafeSignal : sigc::signal<void(std::decay_t<Args>...)> {
        * disrupts chronological order.
        */
       signal_t::emit(std::forward<EmitArgs>(args)...);
-    } else {
-      {
-        std::unique_lock lock(mutex_);
-        if (max_queued_events_ != 0 && queue_.size() >= max_queued_events_) {
-          queue_.pop();
-        }
-        queue_.emplace(std::forward<EmitArgs>(args)...);
+      return;
+    }
+
+    enqueued_.fetch_add(1, std::memory_order_relaxed);
+    if (coalescing_) {
+      auto* node = new arg_tuple_t(std::forward<EmitArgs>(args)...);
+      if (auto* previous = latest_.exchange(node, std::memory_order_acq_rel)) {
+        // Not delivered yet, so a wakeup is already on its way
+        delete previous;
+        coalesced_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      dp_.emit();
+      return;
+    }
+
+    arg_tuple_t event(std::forward<EmitArgs>(args)...);
+    while (!ring_.try_push(std::move(event))) {
+      // Full: make room by dropping the oldest event. Nothing to drop means the oldest one is
+      // still being written or delivered, which takes a moment.
+      if (ring_.pop()) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        std::this_thread::yield();
       }
+    }
+    // Pairs with handle_event(), which clears the flag before it takes the queued events
+    if (!wakeup_pending_.exchange(true, std::memory_order_acq_rel)) {
       dp_.emit();
     }
   }
@@ -65,28 +133,134 @@ struct SafeSignal : sigc::signal<void(std::decay_t<Args>...)> {
   using signal_t::emit_reverse;
   using signal_t::make_slot;
 
-  void trim_queue_locked() {
-    if (max_queued_events_ == 0) {
+  /**
+   * Bounded queue for any number of producers and consumers. Each cell has a sequence number
+   * telling whether it is free for the push at a position or holds the event for the pop at that
+   * position, so that pushes and pops only race on claiming a position.
+   */
+  class Ring {
+   public:
+    explicit Ring(std::size_t capacity)
+        : capacity_(capacity), cells_(std::make_unique<Cell[]>(capacity)) {
+      for (std::size_t i = 0; i < capacity_; ++i) {
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    Ring& operator=(Ring&& other) noexcept {
+      capacity_ = other.capacity_;
+      cells_ = std::move(other.cells_);
+      head_.store(other.head_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      tail_.store(other.tail_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      return *this;
+    }
+
+    /// Returns false, leaving `args` untouched, when the ring is full
+    bool try_push(arg_tuple_t&& args) {
+      auto pos = head_.load(std::memory_order_relaxed);
+      while (true) {
+        auto& cell = cells_[pos % capacity_];
+        const auto sequence = cell.sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+        if (diff == 0) {
+          if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+            cell.args.emplace(std::move(args));
+            cell.sequence.store(pos + 1, std::memory_order_release);
+            return true;
+          }
+        } else if (diff < 0) {
+          return false;
+        } else {
+          pos = head_.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    /// The oldest event, or nullopt when the ring is empty or the oldest event is still being
+    /// pushed
+    std::optional<arg_tuple_t> pop() {
+      auto pos = tail_.load(std::memory_order_relaxed);
+      while (true) {
+        auto& cell = cells_[pos % capacity_];
+        const auto sequence = cell.sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(sequence - (pos + 1));
+        if (diff == 0) {
+          if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+            std::optional<arg_tuple_t> args = std::move(cell.args);
+            cell.args.reset();
+            cell.sequence.store(pos + capacity_, std::memory_order_release);
+            return args;
+          }
+        } else if (diff < 0) {
+          return std::nullopt;
+        } else {
+          pos = tail_.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    /// Events pushed and not popped yet, give or take the ones in flight
+    std::size_t size() const {
+      const auto tail = tail_.load(std::memory_order_relaxed);
+      const auto head = head_.load(std::memory_order_relaxed);
+      return head > tail ? head - tail : 0;
+    }
+
+   private:
+    struct Cell {
+      std::atomic<std::size_t> sequence;
+      std::optional<arg_tuple_t> args;
+    };
+
+    std::size_t capacity_;
+    std::unique_ptr<Cell[]> cells_;
+    // Next positions to push to and to pop from, on their own cache lines
+    alignas(64) std::atomic<std::size_t> head_ = 0;
+    alignas(64) std::atomic<std::size_t> tail_ = 0;
+  };
+
+  void handle_event() {
+    if (auto* args = latest_.exchange(nullptr, std::memory_order_acquire)) {
+      record_depth(1);
+      std::apply(cached_fn_, *args);
+      delete args;
+    }
+
+    // Cleared first, so that every event queued from now on comes with a wakeup of its own
+    if (!wakeup_pending_.exchange(false, std::memory_order_acq_rel)) {
       return;
     }
-    while (queue_.size() > max_queued_events_) {
-      queue_.pop();
+    // Only the events queued so far, so that a storm can't keep the main loop here
+    std::size_t depth = 0;
+    for (auto left = ring_.size(); left > 0; --left) {
+      auto args = ring_.pop();
+      if (!args) {
+        // The oldest one is still being pushed, its producer will wake us up again
+        break;
+      }
+      ++depth;
+      std::apply(cached_fn_, *args);
     }
+    record_depth(depth);
   }
 
-  void handle_event() {
-    for (std::unique_lock lock(mutex_); !queue_.empty(); lock.lock()) {
-      auto args = queue_.front();
-      queue_.pop();
-      lock.unlock();
-      std::apply(cached_fn_, args);
+  void record_depth(std::size_t depth) {
+    if (depth > max_depth_.load(std::memory_order_relaxed)) {
+      max_depth_.store(depth, std::memory_order_relaxed);
     }
   }
 
   Glib::Dispatcher dp_;
-  std::mutex mutex_;
-  std::queue<arg_tuple_t> queue_;
-  std::size_t max_queued_events_ = 4096;
+  Ring ring_{DEFAULT_MAX_QUEUED_EVENTS};
+  // Set by the producer that woke the dispatcher, until the main thread takes the events
+  std::atomic<bool> wakeup_pending_ = false;
+  // The latest event in coalescing mode
+  std::atomic<arg_tuple_t*> latest_ = nullptr;
+  bool coalescing_ = false;
+  std::atomic<uint64_t> enqueued_ = 0;
+  std::atomic<uint64_t> dropped_ = 0;
+  std::atomic<uint64_t> coalesced_ = 0;
+  std::atomic<std::size_t> max_depth_ = 0;
   const std::thread::id main_tid_ = std::this_thread::get_id();
   // cache functor for signal emission to avoid recreating it on each event
   const slot_t cached_fn_ = make_slot();
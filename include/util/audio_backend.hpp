@@ -28,7 +28,13 @@ class AudioBackend {
   static void serverInfoCb(pa_context*, const pa_server_info*, void*);
   static void volumeModifyCb(pa_context*, int, void*);
   static void sourceVolumeModifyCb(pa_context*, int, void*);
+  static void notifyCb(pa_mainloop_api*, pa_defer_event*, void*);
   void connectContext();
+  // Called with the mainloop lock held. Subscribers hear about every change made during one
+  // iteration of the mainloop once, at its end.
+  void notifyChanged();
+  void setIgnoredSinks(const Json::Value& config);
+  void setSinkMapping(const Json::Value& config);
   // Non-throwing reconnect used from the PulseAudio callback thread. Throwing
   // across the libpulse C callback boundary calls std::terminate, so this
   // swallows any failure and reports it via the return value instead.
@@ -66,7 +72,8 @@ class AudioBackend {
   std::vector<std::string> ignored_sinks_;
   std::map<std::string, std::string> sink_mapping_;
 
-  std::function<void()> on_updated_cb_ = NOOP;
+  pa_defer_event* notify_event_{nullptr};
+  BackendSubscribers subscribers_;
 
   /* Hack to keep constructor inaccessible but still public.
    * This is required to be able to use std::make_shared.
@@ -77,9 +84,13 @@ class AudioBackend {
   struct private_constructor_tag {};
 
  public:
-  static std::shared_ptr<AudioBackend> getInstance(std::function<void()> on_updated_cb = NOOP);
+  /// Backend shared by every module whose `ignored-sinks` and `sink-mapping` match those in
+  /// `config`, with a single connection to the server. `on_updated_cb` is called from the
+  /// PulseAudio thread after changes, for as long as the returned handle is kept.
+  static std::shared_ptr<AudioBackend> getInstance(const Json::Value& config,
+                                                   std::function<void()> on_updated_cb = NOOP);
 
-  AudioBackend(std::function<void()> on_updated_cb, private_constructor_tag tag);
+  AudioBackend(const Json::Value& config, private_constructor_tag tag);
   ~AudioBackend();
 
   void changeVolume(uint16_t volume, uint16_t min_volume = 0, uint16_t max_volume = 100,
@@ -87,9 +98,6 @@ class AudioBackend {
   void changeVolume(ChangeType change_type, double step = 1, uint16_t max_volume = 100,
                     PulseaudioTarget target = PulseaudioTarget::Sink);
 
-  void setIgnoredSinks(const Json::Value& config);
-  void setSinkMapping(const Json::Value& config);
-
   std::string getSinkPortName() const { return port_name_; }
   std::string getFormFactor() const { return form_factor_; }
   std::string getSinkDesc() const { return desc_; }
@@ -1,5 +1,12 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
 #include "AModule.hpp"
 
 namespace waybar::util {
@@ -7,4 +14,55 @@ namespace waybar::util {
 const static auto NOOP = []() {};
 enum class ChangeType : char { Increase, Decrease };
 
-}  // namespace waybar::util
\ No newline at end of file
+/**
+ * Change callbacks of the modules sharing one backend.
+ *
+ * notify() runs them all on the backend's thread. remove() waits for a notification in progress,
+ * so the module that registered the callback may go away right after.
+ */
+class BackendSubscribers {
+ public:
+  using Id = uint64_t;
+
+  Id add(std::function<void()> on_changed) {
+    std::lock_guard lock(mutex_);
+    const auto id = next_id_++;
+    callbacks_.emplace(id, std::move(on_changed));
+    return id;
+  }
+
+  void remove(Id id) {
+    std::lock_guard lock(mutex_);
+    callbacks_.erase(id);
+  }
+
+  void notify() {
+    std::lock_guard lock(mutex_);
+    for (const auto& [id, on_changed] : callbacks_) {
+      on_changed();
+    }
+  }
+
+ private:
+  std::mutex mutex_;
+  std::map<Id, std::function<void()>> callbacks_;
+  Id next_id_ = 1;
+};
+
+/// Handle to a shared `backend` for one module. `on_changed` is registered with `subscribers`
+/// (owned by the backend) for as long as the handle lives, and the backend itself lives until its
+/// last handle is dropped.
+template <typename Backend>
+std::shared_ptr<Backend> subscribeBackend(std::shared_ptr<Backend> backend,
+                                          BackendSubscribers& subscribers,
+                                          std::function<void()> on_changed) {
+  const auto id = subscribers.add(std::move(on_changed));
+  auto* raw = backend.get();
+  return std::shared_ptr<Backend>(
+      raw, [backend = std::move(backend), &subscribers, id](Backend* /*raw*/) mutable {
+        subscribers.remove(id);
+        backend.reset();
+      });
+}
+
+}  // namespace waybar::util
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <glibmm/dispatcher.h>
+#include <sigc++/signal.h>
+
+#include <chrono>
+#include <memory>
+
+#include "util/sleeper_thread.hpp"
+
+namespace waybar::util {
+
+/**
+ * Tick on every multiple of a period of the wall clock, e.g. on every full minute.
+ *
+ * Clocks with the same period share one scheduled loop, whose ticks are announced on the main
+ * loop through one Glib::Dispatcher and then fanned out to every subscriber, so the clocks of all
+ * bars change together after a single wakeup. Modules subscribe with their own `dp.emit()`, so
+ * that their updates go through the bar like any other. Unlike SampleHub sources, ticks are never
+ * stretched to save power. Must be used from the main thread, as ticks own a Glib::Dispatcher.
+ */
+class ClockTick {
+ public:
+  /**
+   * RAII handle for a subscription to a tick.
+   * Keeps the tick alive and disconnects the subscriber slot on destruction.
+   */
+  class Subscription {
+   public:
+    Subscription() = default;
+    Subscription(std::shared_ptr<ClockTick> tick, const sigc::slot<void()>& slot);
+    Subscription(const Subscription&) = delete;
+    Subscription& operator=(const Subscription&) = delete;
+    Subscription(Subscription&& other) noexcept;
+    Subscription& operator=(Subscription&& other) noexcept;
+    ~Subscription() { conn_.disconnect(); }
+
+   private:
+    std::shared_ptr<ClockTick> tick_;
+    sigc::connection conn_;
+  };
+
+  static Subscription subscribe(std::chrono::milliseconds period, const sigc::slot<void()>& slot);
+  /// The tick shared by everyone with the same `period`. It stops with its last reference.
+  static std::shared_ptr<ClockTick> acquire(std::chrono::milliseconds period);
+
+  explicit ClockTick(std::chrono::milliseconds period);
+  ClockTick(const ClockTick&) = delete;
+  ClockTick& operator=(const ClockTick&) = delete;
+
+  sigc::connection connect(const sigc::slot<void()>& slot) { return signal_tick_.connect(slot); }
+
+ private:
+  void handleTick();
+
+  const std::chrono::milliseconds period_;
+  Glib::Dispatcher dp_;
+  sigc::signal<void()> signal_tick_;
+  // Declared last so the loop is stopped before the members it uses are destroyed
+  SleeperThread thread_;
+};
+
+}  // namespace waybar::util
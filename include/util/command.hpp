@@ -2,44 +2,59 @@
 
 #include <fcntl.h>
 #include <giomm.h>
+#include <poll.h>
+#include <spawn.h>
 #include <spdlog/spdlog.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
 #ifdef __linux__
 #include <sys/prctl.h>
+#include <sys/syscall.h>
 #endif
 #ifdef __FreeBSD__
 #include <sys/procctl.h>
 #endif
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <optional>
+#include <stop_token>
+#include <string_view>
+#include <thread>
+#include <vector>
 
+extern char** environ;
 extern std::mutex reap_mtx;
 extern std::list<pid_t> reap;
 
 namespace waybar::util::command {
 
 constexpr int kExecFailureExitCode = 127;
+// Same as timeout(1)
+constexpr int kTimeoutExitCode = 124;
 
 struct res {
   int exit_code;
   std::string out;
 };
 
+inline void trimTrailingNewline(std::string& output) {
+  if (!output.empty() && output.back() == '\n') {
+    output.pop_back();
+  }
+}
+
 inline std::string read(FILE* fp) {
-  std::array<char, 128> buffer = {0};
+  std::array<char, 4096> buffer;
   std::string output;
-  while (feof(fp) == 0) {
-    if (fgets(buffer.data(), 128, fp) != nullptr) {
-      output += buffer.data();
-    }
+  while (feof(fp) == 0 && ferror(fp) == 0) {
+    output.append(buffer.data(), fread(buffer.data(), 1, buffer.size(), fp));
   }
 
   // Remove last newline
-  if (!output.empty() && output[output.length() - 1] == '\n') {
-    output.erase(output.length() - 1);
-  }
+  trimTrailingNewline(output);
   return output;
 }
 
@@ -126,55 +141,313 @@ inline FILE* open(const std::string& cmd, int& pid, const std::string& output_na
   return fdopen(fd[0], "r");
 }
 
+/**
+ * Split a command line into argv when running it needs nothing from the shell: no quoting,
+ * expansion, redirection, globbing or control flow, and the first word isn't a builtin or a
+ * keyword of a common shell. Builtins missing from the list are caught by spawn(), which falls
+ * back to the shell when no program of that name is found.
+ * Returns nullopt when the command must go through /bin/sh.
+ */
+inline std::optional<std::vector<std::string>> splitArgv(std::string_view cmd) {
+  constexpr std::string_view metacharacters = "|&;<>()$`\\\"'*?[]#~=%{}!\n";
+  constexpr std::string_view builtins[] = {
+      ".",        ":",        "[",        "[[",      "alias",   "bg",       "bind",
+      "break",    "builtin",  "caller",   "case",    "cd",      "command",  "compgen",
+      "complete", "compopt",  "continue", "declare", "dirs",    "disown",   "do",
+      "done",     "elif",     "else",     "enable",  "esac",    "eval",     "exec",
+      "exit",     "export",   "fc",       "fg",      "fi",      "for",      "function",
+      "getopts",  "hash",     "help",     "history", "if",      "in",       "jobs",
+      "let",      "local",    "logout",   "mapfile", "popd",    "pushd",    "read",
+      "readarray", "readonly", "return",  "select",  "set",     "shift",    "shopt",
+      "source",   "suspend",  "then",     "time",    "times",   "trap",     "type",
+      "typeset",  "ulimit",   "umask",    "unalias", "unset",   "until",    "wait",
+      "while"};
+
+  if (cmd.find_first_of(metacharacters) != std::string_view::npos) {
+    return std::nullopt;
+  }
+  std::vector<std::string> argv;
+  std::size_t pos = 0;
+  while ((pos = cmd.find_first_not_of(" \t", pos)) != std::string_view::npos) {
+    const auto end = std::min(cmd.find_first_of(" \t", pos), cmd.size());
+    argv.emplace_back(cmd.substr(pos, end - pos));
+    pos = end;
+  }
+  if (argv.empty() || std::ranges::find(builtins, argv.front()) != std::end(builtins)) {
+    return std::nullopt;
+  }
+  return argv;
+}
+
+/**
+ * Start `cmd` in its own process group with an empty signal mask, its stdout on `stdout_fd`
+ * (/dev/null when negative, inherited when STDOUT_FILENO) and WAYBAR_OUTPUT_NAME set to
+ * `output_name` when not empty.
+ * Commands without shell syntax are executed directly, the others through /bin/sh -c.
+ * Returns the pid, or -1 with errno set when the command could not be executed.
+ */
+inline pid_t spawn(const std::string& cmd, const std::string& output_name, int stdout_fd) {
+  std::vector<std::string> args;
+  bool direct = true;
+  if (auto argv = splitArgv(cmd)) {
+    args = std::move(*argv);
+  } else {
+    args = {"sh", "-c", cmd};
+    direct = false;
+  }
+  std::vector<char*> argv;
+  auto setArgv = [&] {
+    argv.clear();
+    for (auto& arg : args) {
+      argv.push_back(arg.data());
+    }
+    argv.push_back(nullptr);
+  };
+  setArgv();
+
+  std::vector<char*> envp;
+  std::string output_env;
+  char** env = environ;
+  if (!output_name.empty()) {
+    output_env = "WAYBAR_OUTPUT_NAME=" + output_name;
+    for (char** it = environ; *it != nullptr; ++it) {
+      if (std::string_view(*it).starts_with("WAYBAR_OUTPUT_NAME=")) {
+        continue;
+      }
+      envp.push_back(*it);
+    }
+    envp.push_back(output_env.data());
+    envp.push_back(nullptr);
+    env = envp.data();
+  }
+
+  posix_spawn_file_actions_t actions;
+  posix_spawnattr_t attr;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawnattr_init(&attr);
+  if (stdout_fd >= 0 && stdout_fd != STDOUT_FILENO) {
+    posix_spawn_file_actions_adddup2(&actions, stdout_fd, STDOUT_FILENO);
+  } else if (stdout_fd < 0) {
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+  }
+  sigset_t mask;
+  sigemptyset(&mask);
+  posix_spawnattr_setsigmask(&attr, &mask);
+  posix_spawnattr_setpgroup(&attr, 0);
+  posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETPGROUP);
+
+  pid_t pid = -1;
+  int err = direct ? posix_spawnp(&pid, argv[0], &actions, &attr, argv.data(), env)
+                   : posix_spawn(&pid, "/bin/sh", &actions, &attr, argv.data(), env);
+  if (direct && err == ENOENT && args.front().find('/') == std::string::npos) {
+    // Not a program on PATH, but maybe a builtin of the shell, as with "type foo". Otherwise the
+    // shell reports the missing command, with the same exit code.
+    args = {"sh", "-c", cmd};
+    setArgv();
+    err = posix_spawn(&pid, "/bin/sh", &actions, &attr, argv.data(), env);
+  }
+  posix_spawn_file_actions_destroy(&actions);
+  posix_spawnattr_destroy(&attr);
+  if (err != 0) {
+    errno = err;
+    return -1;
+  }
+  return pid;
+}
+
+/// Limits for a command started by run()
+struct Options {
+  std::string output_name;
+  // Zero means no timeout
+  std::chrono::milliseconds timeout{0};
+  // Kills the command when a stop is requested
+  std::stop_token stop;
+  // Send stdout to /dev/null instead of capturing it
+  bool discard_output = false;
+};
+
+/// A pidfd of the child `pid`, which becomes readable once it exits, or -1 where there are none
+inline int openPidfd(pid_t pid) {
+#if defined(__linux__) && defined(SYS_pidfd_open)
+  // Always close-on-exec
+  return static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+#else
+  return -1;
+#endif
+}
+
+/**
+ * Reap the child `pid` into `stat` once it exits, waiting up to `timeout` for that. Sleeps on
+ * `pidfd` when there is one (see openPidfd()), and polls waitpid() otherwise.
+ * Returns false if the child is still running.
+ */
+inline bool waitExit(pid_t pid, int pidfd, int& stat, std::chrono::milliseconds timeout) {
+  using clock = std::chrono::steady_clock;
+  const auto deadline = clock::now() + timeout;
+  auto backoff = std::chrono::milliseconds(1);
+  while (true) {
+    const auto ret = waitpid(pid, &stat, WNOHANG);
+    if (ret == pid || (ret < 0 && errno != EINTR)) {
+      return true;
+    }
+    if (ret < 0) {
+      continue;
+    }
+    const auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - clock::now());
+    if (left.count() <= 0) {
+      return false;
+    }
+    if (pidfd >= 0) {
+      pollfd pfd{.fd = pidfd, .events = POLLIN, .revents = 0};
+      poll(&pfd, 1, static_cast<int>(left.count()));
+    } else {
+      std::this_thread::sleep_for(std::min(backoff, left));
+      backoff = std::min(backoff * 2, std::chrono::milliseconds(50));
+    }
+  }
+}
+
+/// SIGTERM the process group of `pid`, then SIGKILL it if it's still around after a grace period
+inline int terminate(pid_t pid) {
+  constexpr auto grace = std::chrono::milliseconds(500);
+  int stat = 0;
+  const int pidfd = openPidfd(pid);
+  kill(-pid, SIGTERM);
+  if (!waitExit(pid, pidfd, stat, grace)) {
+    kill(-pid, SIGKILL);
+    while (waitpid(pid, &stat, 0) < 0 && errno == EINTR) {
+    }
+  }
+  if (pidfd >= 0) {
+    ::close(pidfd);
+  }
+  return stat;
+}
+
+/**
+ * Run `cmd` to completion and capture its stdout, without the trailing newline. The command is
+ * killed when it outlives `options.timeout` or a stop is requested, and then reports
+ * kTimeoutExitCode. Output is read in bulk into a buffer reused across calls on the same thread.
+ */
+inline struct res run(const std::string& cmd, const Options& options = {}) {
+  using clock = std::chrono::steady_clock;
+  if (cmd.empty()) return {-1, ""};
+
+  int fd[2] = {-1, -1};
+  // Close-on-exec so that children spawned concurrently by other threads don't keep the pipe open
+  if (!options.discard_output && pipe2(fd, O_CLOEXEC) != 0) {
+    spdlog::error("Unable to pipe fd");
+    return {-1, ""};
+  }
+  const pid_t pid = spawn(cmd, options.output_name, fd[1]);
+  if (fd[1] >= 0) {
+    ::close(fd[1]);
+  }
+  if (pid < 0) {
+    spdlog::error("Unable to exec cmd {}, error {}", cmd, strerror(errno));
+    if (fd[0] >= 0) {
+      ::close(fd[0]);
+    }
+    return {kExecFailureExitCode, ""};
+  }
+
+  const bool bounded = options.timeout.count() > 0;
+  const bool interruptible = bounded || options.stop.stop_possible();
+  const auto deadline = clock::now() + options.timeout;
+  auto expired = [&] {
+    return options.stop.stop_requested() || (bounded && clock::now() >= deadline);
+  };
+  // Poll timeout in ms, waking up regularly to notice stop requests
+  auto poll_timeout = [&] {
+    if (!interruptible) {
+      return -1;
+    }
+    auto wait = std::chrono::milliseconds(100);
+    if (bounded) {
+      wait = std::min(wait, std::chrono::ceil<std::chrono::milliseconds>(deadline - clock::now()));
+    }
+    return std::max(0, static_cast<int>(wait.count()));
+  };
+
+  thread_local std::vector<char> buffer(64 * 1024);
+  std::string output;
+  bool timed_out = false;
+  while (fd[0] >= 0) {
+    pollfd pfd{.fd = fd[0], .events = POLLIN, .revents = 0};
+    const int ready = poll(&pfd, 1, poll_timeout());
+    if (ready < 0 && errno != EINTR) {
+      break;
+    }
+    if (ready > 0) {
+      const auto n = ::read(fd[0], buffer.data(), buffer.size());
+      if (n > 0) {
+        output.append(buffer.data(), n);
+        continue;
+      }
+      if (n == 0 || errno != EINTR) {
+        break;
+      }
+    }
+    if (expired()) {
+      timed_out = true;
+      break;
+    }
+  }
+  if (fd[0] >= 0) {
+    ::close(fd[0]);
+  }
+
+  // stdout is closed, but the command may still be running
+  int stat = 0;
+  if (!timed_out && !interruptible) {
+    while (waitpid(pid, &stat, 0) < 0 && errno == EINTR) {
+    }
+  } else if (!timed_out) {
+    const int pidfd = openPidfd(pid);
+    while (!waitExit(pid, pidfd, stat, std::chrono::milliseconds(poll_timeout()))) {
+      if (expired()) {
+        timed_out = true;
+        break;
+      }
+    }
+    if (pidfd >= 0) {
+      ::close(pidfd);
+    }
+  }
+  if (timed_out) {
+    terminate(pid);
+    if (!options.stop.stop_requested()) {
+      spdlog::warn("Cmd {} timed out after {}ms", cmd, options.timeout.count());
+    }
+    return {kTimeoutExitCode, ""};
+  }
+
+  trimTrailingNewline(output);
+  // Report deaths by signal the way the shell does
+  return {WIFSIGNALED(stat) ? 128 + WTERMSIG(stat) : WEXITSTATUS(stat), std::move(output)};
+}
+
 inline struct res exec(const std::string& cmd, const std::string& output_name) {
-  int pid;
-  auto fp = command::open(cmd, pid, output_name);
-  if (!fp) return {-1, ""};
-  auto output = command::read(fp);
-  auto stat = command::close(fp, pid);
-  return {WEXITSTATUS(stat), output};
+  return run(cmd, {.output_name = output_name});
 }
 
 inline struct res execNoRead(const std::string& cmd) {
-  int pid;
-  auto fp = command::open(cmd, pid, "");
-  if (!fp) return {-1, ""};
-  auto stat = command::close(fp, pid);
-  return {WEXITSTATUS(stat), ""};
+  return run(cmd, {.discard_output = true});
 }
 
 inline int32_t forkExec(const std::string& cmd, const std::string& output_name) {
   if (cmd == "") return -1;
 
-  pid_t pid = fork();
-
+  const pid_t pid = spawn(cmd, output_name, STDOUT_FILENO);
   if (pid < 0) {
     spdlog::error("Unable to exec cmd {}, error {}", cmd.c_str(), strerror(errno));
     return pid;
   }
 
-  // Child executes the command
-  if (!pid) {
-    int err;
-    sigset_t mask;
-    sigfillset(&mask);
-    // Reset sigmask
-    err = pthread_sigmask(SIG_UNBLOCK, &mask, nullptr);
-    if (err != 0) spdlog::error("pthread_sigmask in forkExec failed: {}", strerror(err));
-    setpgid(pid, pid);
-    if (!output_name.empty()) {
-      setenv("WAYBAR_OUTPUT_NAME", output_name.c_str(), 1);
-    }
-    execl("/bin/sh", "sh", "-c", cmd.c_str(), (char*)0);
-    const int saved_errno = errno;
-    spdlog::error("execl(/bin/sh) failed in forkExec: {}", strerror(saved_errno));
-    _exit(kExecFailureExitCode);
-  } else {
-    reap_mtx.lock();
-    reap.push_back(pid);
-    reap_mtx.unlock();
-    spdlog::debug("Added child to reap list: {}", pid);
-  }
+  reap_mtx.lock();
+  reap.push_back(pid);
+  reap_mtx.unlock();
+  spdlog::debug("Added child to reap list: {}", pid);
 
   return pid;
 }
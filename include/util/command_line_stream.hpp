@@ -5,6 +5,7 @@
 
 #include <functional>
 #include <string>
+#include <string_view>
 
 namespace waybar::util::command {
 
@@ -16,14 +17,19 @@ class LineStream {
   LineStream(std::string output_name, OutputCallback on_output, ExitCallback on_exit);
   ~LineStream();
 
-  void start(const std::string& cmd);
+  // With `with_stdin`, the child reads from a pipe fed by send() instead of inheriting stdin
+  void start(const std::string& cmd, bool with_stdin = false);
   void stop();
   bool running() const;
+  // Write `line` and a newline to the child's stdin. Lines must be shorter than PIPE_BUF, so that
+  // they are written whole or not at all. Returns false when the child isn't reading.
+  bool send(std::string_view line);
 
  private:
   bool handleStdout(Glib::IOCondition condition);
   void handleExit(Glib::Pid pid, int status);
   void closeStdout();
+  void closeStdin();
   void drainStdout(bool flush_trailing_line);
   static int statusToExitCode(int status);
 
@@ -33,6 +39,7 @@ class LineStream {
   std::string buffer_;
   Glib::Pid pid_;
   int stdout_fd_;
+  int stdin_fd_;
   sigc::connection stdout_connection_;
   sigc::connection child_connection_;
 };
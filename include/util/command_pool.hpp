@@ -0,0 +1,89 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace waybar::util::command {
+
+/**
+ * Small shared pool of threads running the scripts of polling modules.
+ *
+ * Tasks are keyed by their owner (usually the module) and tasks sharing a key never overlap: a
+ * task submitted while another one for the same key is pending replaces it and keeps the earlier
+ * of the two deadlines, and one submitted while a task for the key runs starts after it returns.
+ * Waking up a module repeatedly thus runs its script once more, not once per wake-up.
+ *
+ * Threads are started on demand when every thread is busy with a due task, up to `max_workers`.
+ * Tasks that run commands without a timeout are submitted as unbounded: a hung script must not
+ * take a thread from the others, so each running unbounded task raises the limit by one. Threads
+ * that stay idle for `idle_timeout` exit again, so the pool shrinks back once they are done.
+ * Tasks get a stop token that is triggered by cancel() and should be passed to command::run().
+ */
+class Pool {
+ public:
+  using Task = std::function<void(std::stop_token)>;
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr std::size_t DEFAULT_MAX_WORKERS = 8;
+  static constexpr std::chrono::seconds DEFAULT_IDLE_TIMEOUT{30};
+
+  static Pool& instance();
+
+  explicit Pool(std::size_t max_workers = DEFAULT_MAX_WORKERS,
+                Clock::duration idle_timeout = DEFAULT_IDLE_TIMEOUT);
+  Pool(const Pool&) = delete;
+  Pool& operator=(const Pool&) = delete;
+  ~Pool();
+
+  /// Run `task` on a worker after `delay`. `bounded` is false if the task may run indefinitely.
+  void submit(const void* key, Task task,
+              std::chrono::milliseconds delay = std::chrono::milliseconds::zero(),
+              bool bounded = true);
+  /// Drop the pending task of `key`, stop its running task and wait for it to return.
+  /// Must not be called from a task of the same key.
+  void cancel(const void* key);
+
+  /// Number of running threads
+  std::size_t workers();
+
+ private:
+  struct Slot {
+    Task pending;
+    Clock::time_point due;
+    bool bounded = true;
+    bool running = false;
+    // Set by cancel() while the task runs, so that it can't schedule itself again
+    bool cancelled = false;
+    std::stop_source stop;
+  };
+  using Slots = std::unordered_map<const void*, Slot>;
+
+  void work();
+  // Pending task that is not running and has the earliest deadline
+  Slots::iterator next();
+  void startWorker();
+  // Called with mutex_ held by a worker that is about to exit
+  void retire();
+
+  const std::size_t max_workers_;
+  const Clock::duration idle_timeout_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::condition_variable done_cv_;
+  Slots slots_;
+  std::vector<std::thread> workers_;
+  // Workers that exited and still have to be joined
+  std::vector<std::thread> retired_;
+  std::size_t idle_ = 0;
+  std::size_t unbounded_running_ = 0;
+  bool stopping_ = false;
+};
+
+}  // namespace waybar::util::command
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <glibmm/dispatcher.h>
+#include <sigc++/signal.h>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "util/scoped_fd.hpp"
+#include "util/sleeper_thread.hpp"
+
+namespace waybar::util {
+
+/**
+ * Process-wide index of the desktop entries in the `applications` directories of the XDG data
+ * dirs (user dir first).
+ *
+ * The directories are scanned and every entry is parsed once, on a background thread started by
+ * the first call to instance(). Lookups are then answered from memory instead of walking and
+ * probing the file system for every window. The directories are watched with inotify and the index
+ * is rebuilt in the background when they change; lookups keep using the previous index until the
+ * new one is ready. Lookups never wait for a scan: until the first one completes they find
+ * nothing, and signal_changed tells callers when to look up again.
+ */
+class DesktopEntryIndex {
+ public:
+  struct Entry {
+    /// Absolute path of the desktop file
+    std::string path;
+    /// Path relative to the `applications` directory, e.g. "kde/org.kde.dolphin.desktop"
+    std::string name;
+    std::string icon;
+    std::string startup_wm_class;
+  };
+
+  /// Must first be called on the main thread
+  static DesktopEntryIndex& instance();
+
+  /// Index of the entries under `dirs`, in precedence order. Must be built on the main thread.
+  explicit DesktopEntryIndex(std::vector<std::string> dirs);
+  DesktopEntryIndex(const DesktopEntryIndex&) = delete;
+  DesktopEntryIndex& operator=(const DesktopEntryIndex&) = delete;
+  ~DesktopEntryIndex();
+
+  /// Emitted on the main thread each time a scan completes, including the first one
+  sigc::signal<void()> signal_changed;
+
+  /// First entry stored under one of `names`. Data dirs take precedence over the order of `names`.
+  std::optional<Entry> byName(const std::vector<std::string>& names) const;
+  /// First entry whose StartupWMClass is `wm_class`
+  std::optional<Entry> byStartupWMClass(const std::string& wm_class) const;
+  /// First entry whose file name ends with one of `suffixes`, or with its lowercase form.
+  /// Data dirs take precedence over the order of `suffixes`.
+  std::optional<Entry> bySuffix(const std::vector<std::string>& suffixes) const;
+
+ private:
+  struct Index {
+    std::vector<Entry> entries;
+    // [begin, end) of each data dir's entries, in precedence order
+    std::vector<std::pair<std::size_t, std::size_t>> dirs;
+    std::unordered_map<std::string, std::size_t> by_name;
+    std::unordered_map<std::string, std::size_t> by_wm_class;
+
+    // Suffix lookups need a scan, so their results are remembered for the life of the index
+    mutable std::mutex suffix_mutex;
+    mutable std::unordered_map<std::string, std::optional<std::size_t>> by_suffix;
+  };
+
+  std::shared_ptr<const Index> index() const;
+  std::shared_ptr<Index> build();
+  void watch(const std::string& dir);
+  void waitForChanges();
+
+  const std::vector<std::string> dirs_;
+  ScopedFd inotify_fd_;
+  std::vector<int> watches_;
+
+  mutable std::mutex mutex_;
+  std::shared_ptr<const Index> index_;
+  Glib::Dispatcher dp_;
+  // Declared last so the scan is stopped before the members it uses are destroyed
+  util::SleeperThread thread_;
+};
+
+}  // namespace waybar::util
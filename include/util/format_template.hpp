@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace waybar::util {
+
+/**
+ * A format string together with the set of named arguments it references.
+ *
+ * Modules that can provide many arguments (e.g. one per CPU core) use it to compute and push only
+ * the arguments the configured format actually uses, and to tell whether a change in their inputs
+ * can change the output at all. The string is scanned once, when the template is built.
+ */
+class FormatTemplate {
+ public:
+  FormatTemplate() = default;
+  explicit FormatTemplate(std::string format);
+
+  /// Rebuild the template for `format`, unless it is the current one. Returns whether it changed.
+  bool reset(const std::string& format);
+
+  const std::string& str() const { return format_; }
+  bool empty() const { return format_.empty(); }
+
+  /// Whether `{name}` (with any format spec) appears in the template
+  bool references(std::string_view name) const;
+  /// Whether `{<prefix><N>}` appears for any number N, e.g. "usage" for {usage0}
+  bool referencesIndexed(std::string_view prefix) const;
+  /// Whether the template has fields that may refer to any argument, such as `{}`, `{0}` or
+  /// nested fields in a format spec. All the queries above return true for such templates.
+  bool referencesAll() const { return references_all_; }
+
+ private:
+  std::string format_;
+  std::vector<std::string> names_;
+  bool references_all_ = false;
+};
+
+}  // namespace waybar::util
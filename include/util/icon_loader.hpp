@@ -16,7 +16,6 @@ class IconLoader {
  private:
   std::vector<Glib::RefPtr<Gtk::IconTheme>> custom_icon_themes_;
   Glib::RefPtr<Gtk::IconTheme> default_icon_theme_ = Gtk::IconTheme::get_default();
-  static std::vector<std::string> search_prefix();
   static Glib::RefPtr<Gio::DesktopAppInfo> get_app_info_by_name(const std::string& app_id);
   static Glib::RefPtr<Gio::DesktopAppInfo> get_desktop_app_info(const std::string& app_id);
   static Glib::RefPtr<Gdk::Pixbuf> load_icon_from_file(std::string const& icon_path, int size);
@@ -26,6 +25,7 @@ class IconLoader {
                               Glib::RefPtr<Gio::DesktopAppInfo> app_info, int size);
 
  public:
+  IconLoader();
   void add_custom_icon_theme(const std::string& theme_name);
   bool image_load_icon(Gtk::Image& image, Glib::RefPtr<Gio::DesktopAppInfo> app_info,
                        int size) const;
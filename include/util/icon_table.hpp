@@ -0,0 +1,56 @@
+#pragma once
+
+#include <json/json.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace waybar::util {
+
+/**
+ * Compiled form of a module's `format-icons` option.
+ *
+ * The JSON is walked once, when the table is built. Each icon set is stored as flat vectors so
+ * that looking up an icon for a value is a short scan (thresholds) or an index computation (plain
+ * icon arrays) with no JSON access or copying.
+ */
+class IconTable {
+ public:
+  class Set {
+   public:
+    /// Icon for `value`, out of `max` (100 if 0). Returns an empty string if there is none.
+    const std::string& get(uint16_t value, uint16_t max = 0) const;
+
+   private:
+    friend class IconTable;
+    enum class Kind : uint8_t { NONE, SINGLE, ARRAY, THRESHOLDS };
+
+    explicit Set(const Json::Value& icons);
+
+    Kind kind_ = Kind::NONE;
+    // SINGLE: one icon. ARRAY: evenly spread icons, non-string entries left empty.
+    // THRESHOLDS: icons paired with maxes_, in configuration order.
+    std::vector<std::string> icons_;
+    std::vector<unsigned> maxes_;
+  };
+
+  IconTable() : IconTable(Json::Value()) {}
+  explicit IconTable(const Json::Value& format_icons);
+
+  /// Icon set for `alt` when `format-icons` is an object, falling back to "default"
+  const Set& select(const std::string& alt) const;
+  /// Icon set for the first of `alts` that has one, falling back to "default"
+  const Set& select(const std::vector<std::string>& alts) const;
+
+ private:
+  const Set* find(const std::string& alt) const;
+
+  bool keyed_ = false;
+  Set default_;
+  // Only the entries that can be selected by an alt, i.e. strings and arrays
+  std::map<std::string, Set, std::less<>> sets_;
+};
+
+}  // namespace waybar::util
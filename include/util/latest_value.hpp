@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace waybar::util {
+
+/**
+ * Hands the latest value produced by worker threads over to the GTK thread.
+ *
+ * Workers publish() complete values; the consumer calls acquire() when it is about to draw and
+ * then reads current(). A value published while the previous one has not been acquired yet
+ * replaces it, and skipped() counts how often that happened. Values are handed over as whole
+ * immutable objects by swapping pointers, so the consumer never sees one half-written, nobody
+ * copies a value under a lock, and current() stays valid and unchanged until the next acquire().
+ *
+ * publish() may be called from any number of threads; acquire() and current() must only be
+ * called by one thread at a time.
+ */
+template <typename T>
+class LatestValue {
+ public:
+  LatestValue() : current_(std::make_shared<const T>()) {}
+  explicit LatestValue(T initial) : current_(std::make_shared<const T>(std::move(initial))) {}
+  LatestValue(const LatestValue&) = delete;
+  LatestValue& operator=(const LatestValue&) = delete;
+
+  /// Hand a value over to the consumer, replacing one it has not acquired yet
+  void publish(T value) {
+    std::shared_ptr<const T> fresh = std::make_shared<const T>(std::move(value));
+    {
+      std::lock_guard lock(mutex_);
+      fresh.swap(pending_);
+    }
+    // The replaced value, if any, is freed outside of the lock
+    if (fresh != nullptr) {
+      skipped_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  /// Make the latest published value current. Returns false if nothing new was published.
+  bool acquire() {
+    std::shared_ptr<const T> fresh;
+    {
+      std::lock_guard lock(mutex_);
+      fresh.swap(pending_);
+    }
+    if (fresh == nullptr) {
+      return false;
+    }
+    current_.swap(fresh);
+    return true;
+  }
+
+  /// Value made current by the last acquire(), or the initial value before the first one
+  const T& current() const { return *current_; }
+
+  /// Published values that were replaced before the consumer acquired them
+  uint64_t skipped() const { return skipped_.load(std::memory_order_relaxed); }
+
+ private:
+  // Only guards the pointer swaps, never a copy of a value
+  std::mutex mutex_;
+  std::shared_ptr<const T> pending_;
+  std::shared_ptr<const T> current_;
+  std::atomic<uint64_t> skipped_ = 0;
+};
+
+}  // namespace waybar::util
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <netlink/netlink.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "util/backend_common.hpp"
+#include "util/scoped_fd.hpp"
+#include "util/sleeper_thread.hpp"
+
+namespace waybar::util {
+
+/**
+ * Network interfaces, addresses and default routes of the system, shared by every network module.
+ *
+ * A single rtnetlink socket follows link, address and route changes, and the tables are kept
+ * up to date from these events after one dump at start-up. Modules select the interface they
+ * show from snapshots of the tables and are notified once per burst of changes. Statistics and
+ * nl80211 (wireless) information of an interface are requested on demand over shared sockets.
+ */
+class NetworkMonitor {
+ private:
+  /* Hack to keep constructor inaccessible but still public.
+   * This is required to be able to use std::make_shared.
+   */
+  struct PrivateConstructorTag {};
+
+ public:
+  struct Address {
+    int family;
+    std::string address;
+    uint8_t prefixlen;
+  };
+
+  struct Interface {
+    int index{-1};
+    std::string name;
+    std::vector<std::string> altnames;
+    bool up{false};
+    bool carrier{false};
+    // Addresses of a global scope, in the order they were added
+    std::vector<Address> addresses;
+  };
+
+  struct DefaultRoute {
+    int family;
+    int index;
+    uint32_t priority;
+    std::string gateway;
+  };
+
+  struct LinkStats {
+    uint64_t rx_bytes;
+    uint64_t tx_bytes;
+  };
+
+  struct WirelessInfo {
+    // As broadcast by the access point, not escaped
+    std::string essid;
+    std::string bssid;
+    int32_t signal_strength_dbm{0};
+    uint8_t signal_strength{0};
+    std::string signal_strength_app;
+    float frequency{0};
+    uint32_t tx_bitrate{0};
+    uint32_t rx_bitrate{0};
+  };
+
+  /// The monitor shared by every module. `on_changed` is called from the monitor's thread after
+  /// the tables changed, for as long as the returned handle is kept.
+  static std::shared_ptr<NetworkMonitor> getInstance(std::function<void()> on_changed);
+
+  /// Snapshot of every known interface, ordered by index
+  std::vector<Interface> interfaces() const;
+  std::optional<Interface> interface(int index) const;
+  /// Default route of the main table with the lowest metric, through `index` if it's not -1
+  std::optional<DefaultRoute> defaultRoute(int index = -1) const;
+
+  /// Byte counters of an interface, requested from the kernel. Blocks the caller.
+  std::optional<LinkStats> linkStats(int index);
+  /// Access point an interface is associated with, requested from nl80211. Blocks the caller.
+  std::optional<WirelessInfo> wirelessInfo(int index);
+
+  NetworkMonitor(PrivateConstructorTag tag);
+
+ protected:
+  /// Empty tables without sockets or an event thread, for tests that feed them messages
+  NetworkMonitor() = default;
+
+  static int handleEvents(struct nl_msg*, void*);
+  static int handleEventsDone(struct nl_msg*, void*);
+  /// Dump everything again to resynchronise the tables, as after an overrun
+  void resync();
+
+ private:
+  static const uint8_t EPOLL_MAX{200};
+
+  struct SocketDeleter {
+    void operator()(struct nl_sock* sock) const {
+      nl_close(sock);
+      nl_socket_free(sock);
+    }
+  };
+  using Socket = std::unique_ptr<struct nl_sock, SocketDeleter>;
+
+  enum class Dump : uint8_t { NONE, LINK, ADDR, ROUTE };
+
+  // Table entries remember the dump generation they were last seen in, so that a dump which
+  // resynchronises the tables can drop the entries it didn't report anymore
+  struct LinkEntry {
+    Interface interface;
+    uint64_t generation;
+  };
+  struct AddressEntry {
+    int index;
+    Address address;
+    uint64_t generation;
+  };
+  struct RouteEntry {
+    DefaultRoute route;
+    uint64_t generation;
+  };
+
+  // Result of a scan request, the BSSID is needed again for the station request
+  struct ScanResult {
+    WirelessInfo info;
+    uint8_t bssid[6];
+    bool associated{false};
+  };
+
+  static int handleLinkStats(struct nl_msg*, void*);
+  static int handleScan(struct nl_msg*, void*);
+  static int handleStationGet(struct nl_msg*, void*);
+
+  void createEventSocket();
+  void createRequestSockets();
+  void worker();
+  void askForStateDump();
+
+  // Called with state_mutex_ held
+  void handleLink(struct nlmsghdr*);
+  void handleAddress(struct nlmsghdr*);
+  void handleRoute(struct nlmsghdr*);
+  Interface snapshot(const LinkEntry&) const;
+
+  // Declared before thread_, which is stopped first
+  Socket ev_sock_;
+  ScopedFd efd_;
+
+  // Guards the tables, and the dump state which is only used by the event thread
+  mutable std::mutex state_mutex_;
+  std::map<int, LinkEntry> links_;
+  std::vector<AddressEntry> addresses_;
+  std::vector<RouteEntry> routes_;
+  uint64_t generation_{0};
+  bool want_route_dump_{true};
+  bool want_link_dump_{true};
+  bool want_addr_dump_{true};
+  Dump dump_in_progress_{Dump::NONE};
+  bool changed_{false};
+
+  // Guards the request sockets, shared by the timer loops of the modules
+  std::mutex request_mutex_;
+  Socket rtnl_sock_;
+  Socket genl_sock_;
+  int nl80211_id_{-1};
+
+  BackendSubscribers subscribers_;
+  util::SleeperThread thread_;
+};
+
+}  // namespace waybar::util
@@ -2,6 +2,9 @@
 
 #include <pipewire/pipewire.h>
 
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 
 #include "util/backend_common.hpp"
@@ -18,6 +21,12 @@ class PipewireBackend {
   pw_registry* registry_;
   spa_hook registryListener_;
 
+  // Signalled for every change; subscribers are notified once per burst of them
+  spa_source* notify_event_;
+  BackendSubscribers subscribers_;
+
+  static void notifyCb(void* data, uint64_t count);
+
   /* Hack to keep constructor inaccessible but still public.
    * This is required to be able to use std::make_shared.
    * It is important to keep this class only accessible via a reference-counted
@@ -27,12 +36,16 @@ class PipewireBackend {
   struct PrivateConstructorTag {};
 
  public:
-  sigc::signal<void> privacy_nodes_changed_signal_event;
-
+  // Guarded by mutex_
   std::unordered_map<uint32_t, PWPrivacyNodeInfo*> privacy_nodes;
   std::mutex mutex_;
 
-  static std::shared_ptr<PipewireBackend> getInstance();
+  /// The backend shared by every module, with a single connection to PipeWire.
+  /// `on_changed` is called from the PipeWire thread after privacy_nodes changed, for as long
+  /// as the returned handle is kept.
+  static std::shared_ptr<PipewireBackend> getInstance(std::function<void()> on_changed);
+
+  void notifyChanged();
 
   // Handlers for PipeWire events
   void handleRegistryEventGlobal(uint32_t id, uint32_t permissions, const char* type,
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <gdkmm/pixbuf.h>
+#include <gtkmm/icontheme.h>
+#include <gtkmm/stylecontext.h>
+#include <sys/stat.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace waybar::util {
+
+/**
+ * Process-wide cache of decoded icons and images, shared by every bar and module.
+ *
+ * Pixbufs are kept in a LRU bounded by their total size in bytes, keyed by what determines their
+ * pixels: the file path (plus its mtime and size) or the icon theme, icon name and size. Scaled
+ * variants are separate entries, so callers should pass the size multiplied by the scale factor.
+ * Entries of a theme are dropped when it emits `changed`, and a file is decoded again when its
+ * mtime or size changes.
+ *
+ * Returned pixbufs are shared and must not be modified in place. Failed loads are not cached.
+ * The shared instance logs its stats at debug level, at most once per STATS_LOG_INTERVAL.
+ * Thread-safe.
+ */
+class PixbufCache {
+ public:
+  static constexpr std::size_t DEFAULT_BUDGET_BYTES = 16 * 1024 * 1024;
+  // In seconds
+  static constexpr unsigned STATS_LOG_INTERVAL = 60;
+
+  struct Stats {
+    std::size_t entries = 0;
+    std::size_t bytes = 0;
+    std::size_t budget = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+  };
+
+  static PixbufCache& instance();
+
+  explicit PixbufCache(std::size_t budget = DEFAULT_BUDGET_BYTES);
+  PixbufCache(const PixbufCache&) = delete;
+  PixbufCache& operator=(const PixbufCache&) = delete;
+  ~PixbufCache();
+
+  /// Same as Gdk::Pixbuf::create_from_file(path, width, height), including the exceptions
+  Glib::RefPtr<Gdk::Pixbuf> fromFile(const std::string& path, int width = -1, int height = -1);
+  /// Result of `load`, which must render `name` from `theme` at `size` with `flags`. Symbolic
+  /// icons recolored for a `style` are cached per foreground color. Exceptions from `load`
+  /// propagate.
+  Glib::RefPtr<Gdk::Pixbuf> fromTheme(const Glib::RefPtr<Gtk::IconTheme>& theme,
+                                      const std::string& name, int size,
+                                      Gtk::IconLookupFlags flags,
+                                      const Glib::RefPtr<Gtk::StyleContext>& style,
+                                      const std::function<Glib::RefPtr<Gdk::Pixbuf>()>& load);
+
+  Stats stats() const;
+  void clear();
+
+ private:
+  struct Entry {
+    std::string key;
+    Glib::RefPtr<Gdk::Pixbuf> pixbuf;
+    std::size_t bytes;
+    // Identifies the source: the theme for icons, and the file's mtime and size for files
+    const GtkIconTheme* theme = nullptr;
+    Glib::RefPtr<Gtk::IconTheme> theme_ref;
+    struct timespec mtime{};
+    off_t size = 0;
+  };
+  using Iterator = std::list<Entry>::iterator;
+
+  // Logs the stats if they changed since `logged`, which is then updated
+  void logStats(Stats& logged) const;
+  Glib::RefPtr<Gdk::Pixbuf> lookup(const std::string& key, const struct stat* st);
+  void insert(Entry entry);
+  void erase(Iterator it);
+  void dropTheme(const GtkIconTheme* theme);
+
+  mutable std::mutex mutex_;
+  std::size_t budget_;
+  Stats stats_;
+  // Most recently used first
+  std::list<Entry> entries_;
+  std::unordered_map<std::string, Iterator> index_;
+  // Themes with cached entries, watched for `changed` until their last entry goes away
+  struct WatchedTheme {
+    sigc::connection changed;
+    std::size_t entries = 0;
+  };
+  std::map<const GtkIconTheme*, WatchedTheme> themes_;
+};
+
+}  // namespace waybar::util
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <giomm.h>
+#include <json/value.h>
+
+struct ext_idle_notification_v1;
+
+namespace waybar::util {
+
+/**
+ * Decides how much polling modules may slow down to save power.
+ *
+ * While the session is idle (ext-idle-notifier) or the system runs on a battery below a
+ * threshold (UPower display device), the sleeps of polling loops that allow it are stretched by
+ * a factor, through TimerScheduler::setStretch(). Pausing modules of a hidden bar is up to the
+ * bar itself.
+ *
+ * Configured once for the whole process by the Client, from the `power-saving` object of the first
+ * bar config that has one; must be used from the main thread.
+ */
+class PowerPolicy {
+ public:
+  static constexpr unsigned DEFAULT_FACTOR = 4;
+  static constexpr double DEFAULT_BATTERY_THRESHOLD = 20;
+  static constexpr unsigned DEFAULT_IDLE_TIMEOUT_S = 300;
+
+  static PowerPolicy& instance();
+
+  PowerPolicy(const PowerPolicy&) = delete;
+  PowerPolicy& operator=(const PowerPolicy&) = delete;
+
+  /// Apply the `power-saving` config: false to disable, or an object with `factor`,
+  /// `battery-threshold` (percent) and `idle-timeout` (seconds), where 0 disables a trigger.
+  void configure(const Json::Value& config);
+
+  /// Current stretch factor, 1 when not saving power
+  unsigned factor() const;
+
+ private:
+  PowerPolicy() = default;
+
+  void apply();
+  void watchBattery();
+  void onBatteryProxy(Glib::RefPtr<Gio::AsyncResult>& result);
+  void readBattery();
+  void watchIdle(unsigned timeout_s);
+  void unwatchIdle();
+
+  static void handleIdled(void* data, ext_idle_notification_v1* notification);
+  static void handleResumed(void* data, ext_idle_notification_v1* notification);
+
+  unsigned factor_ = DEFAULT_FACTOR;
+  double battery_threshold_ = DEFAULT_BATTERY_THRESHOLD;
+  unsigned idle_timeout_s_ = 0;
+
+  bool idle_ = false;
+  bool low_battery_ = false;
+
+  Glib::RefPtr<Gio::DBus::Proxy> battery_proxy_;
+  bool watching_battery_ = false;
+  ext_idle_notification_v1* idle_notification_ = nullptr;
+};
+
+}  // namespace waybar::util
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace waybar::util::procfs {
+
+/**
+ * A procfs/sysfs file that stays open and is re-read with pread(2) into a reusable buffer.
+ * Once the buffer has grown to the file size, polling it costs no open(2) and no allocation,
+ * only pread(2) calls: at least two, as the last one is needed to see the end of the file.
+ * Not thread-safe: each sampler owns its instances.
+ */
+class File {
+ public:
+  explicit File(std::string path);
+  File(const File&) = delete;
+  File& operator=(const File&) = delete;
+  ~File();
+
+  /// Read the whole file. The returned view is valid until the next read.
+  /// Returns std::nullopt if the file does not exist or can't be read.
+  std::optional<std::string_view> tryRead();
+
+  /// Same as tryRead(), but throws std::runtime_error on failure.
+  std::string_view read();
+
+  const std::string& path() const { return path_; }
+
+ private:
+  void close();
+
+  const std::string path_;
+  int fd_{-1};
+  std::vector<char> buffer_;
+};
+
+/// Call `fn(line)` for each line of `text`, without the newline.
+/// Iteration stops early when `fn` returns false.
+template <typename F>
+void forEachLine(std::string_view text, F&& fn) {
+  while (!text.empty()) {
+    auto end = text.find('\n');
+    auto line = text.substr(0, end);
+    if (!fn(line) || end == std::string_view::npos) {
+      return;
+    }
+    text.remove_prefix(end + 1);
+  }
+}
+
+/// Skip leading blanks and parse a number, advancing `text` past it.
+/// Returns false, leaving `value` untouched, if `text` does not start with a number.
+template <typename T>
+bool consumeNumber(std::string_view& text, T& value) {
+  auto start = text.find_first_not_of(" \t");
+  if (start == std::string_view::npos) {
+    text = {};
+    return false;
+  }
+  T parsed{};
+  auto [ptr, ec] = std::from_chars(text.data() + start, text.data() + text.size(), parsed);
+  if (ec != std::errc()) {
+    return false;
+  }
+  value = parsed;
+  text.remove_prefix(ptr - text.data());
+  return true;
+}
+
+/// Maps a "Key:" in a key/value file to the struct member it is stored in.
+template <typename T>
+struct Field {
+  std::string_view key;
+  uint64_t T::* member;
+};
+
+/**
+ * Parse "Key:   value ..." lines (the /proc/meminfo layout) straight into the members of `out`
+ * listed in `fields`. Unknown keys are skipped without allocating.
+ * Returns a bitmask with bit N set when `fields[N]` was found.
+ */
+template <typename T, std::size_t N>
+uint64_t parseKeyValues(std::string_view text, const std::array<Field<T>, N>& fields, T& out) {
+  static_assert(N <= 64, "found-field mask is 64 bits wide");
+  uint64_t found = 0;
+  forEachLine(text, [&](std::string_view line) {
+    auto colon = line.find(':');
+    if (colon == std::string_view::npos) {
+      return true;
+    }
+    auto key = line.substr(0, colon);
+    for (std::size_t i = 0; i < N; ++i) {
+      if (fields[i].key != key) {
+        continue;
+      }
+      auto rest = line.substr(colon + 1);
+      if (consumeNumber(rest, out.*(fields[i].member))) {
+        found |= uint64_t{1} << i;
+      }
+      break;
+    }
+    return true;
+  });
+  return found;
+}
+
+}  // namespace waybar::util::procfs
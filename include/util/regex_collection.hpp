@@ -2,10 +2,18 @@
 
 #include <json/json.h>
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <regex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace waybar::util {
 
@@ -25,16 +33,40 @@ int default_priority_function(std::string& key);
 
 /* A collection of regexes and strings, with a default string to return if no regexes.
  * When a regex is matched, the corresponding string is returned.
- * All regexes that are matched are cached, so that the regexes are only
- * evaluated once against a given string.
+ * Results are kept in a bounded LRU cache, so that the regexes are only evaluated once
+ * against recently seen strings, without growing forever on ever-changing window titles.
+ * Its size is set by modules through their "window-rewrite-cache-size" option, and it counts
+ * its hits, misses and evictions. The cache is locked, as lookups may come from IPC threads as
+ * well as the main thread.
  * Regexes may be given a higher priority than others, so that they are matched
  * first. The priority function is given the regex string, and should return a
  * higher number for higher priority regexes.
  */
 class RegexCollection {
+ public:
+  static constexpr std::size_t DEFAULT_CACHE_SIZE = 256;
+
+  struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+  };
+
+  /// The "window-rewrite-cache-size" of a module config, or DEFAULT_CACHE_SIZE if it is unset
+  /// or invalid
+  static std::size_t cacheSizeFromConfig(const Json::Value& config);
+
  private:
+  using CacheEntry = std::pair<std::string, std::string>;
+
   std::vector<Rule> rules;
-  std::map<std::string, std::string> regex_cache;
+  // Most recently used first; regex_cache keys point into the entries' first member
+  std::list<CacheEntry> cache_order;
+  std::unordered_map<std::string_view, std::list<CacheEntry>::iterator> regex_cache;
+  std::size_t cache_size = DEFAULT_CACHE_SIZE;
+  CacheStats stats;
+  // Behind a pointer to keep the collection movable
+  std::unique_ptr<std::mutex> cache_mutex = std::make_unique<std::mutex>();
   std::string default_repr;
 
   std::string find_match(std::string& value, bool& matched_any);
@@ -43,11 +75,19 @@ class RegexCollection {
   RegexCollection() = default;
   RegexCollection(
       const Json::Value& map, std::string default_repr = "",
-      const std::function<int(std::string&)>& priority_function = default_priority_function);
+      const std::function<int(std::string&)>& priority_function = default_priority_function,
+      std::size_t cache_size = DEFAULT_CACHE_SIZE);
+  RegexCollection(const RegexCollection&) = delete;
+  RegexCollection& operator=(const RegexCollection&) = delete;
+  RegexCollection(RegexCollection&&) = default;
+  RegexCollection& operator=(RegexCollection&&) = default;
   ~RegexCollection() = default;
 
-  std::string& get(std::string& value, bool& matched_any);
-  std::string& get(std::string& value);
+  // Returns a copy, as another thread may evict the cached entry right after the lookup
+  std::string get(std::string& value, bool& matched_any);
+  std::string get(std::string& value);
+
+  CacheStats cache_stats() const;
 };
 
 }  // namespace waybar::util
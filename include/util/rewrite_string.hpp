@@ -1,10 +1,36 @@
 #pragma once
 #include <json/json.h>
 
+#include <regex>
 #include <string>
+#include <vector>
 
 namespace waybar::util {
 std::string rewriteString(const std::string&, const Json::Value&);
 std::string rewriteStringOnce(const std::string& value, const Json::Value& rules,
                               bool& matched_any);
+
+/* A "rewrite" config object compiled once, for modules that rewrite on every update.
+ * apply() behaves like rewriteString(): every rule whose regex matches the whole (already
+ * rewritten) string, case-insensitively, replaces it in turn. Rules whose pattern starts with
+ * literal text are skipped without running the regex when the string doesn't start with it.
+ */
+class RewriteRuleSet {
+ public:
+  struct Rule {
+    std::regex regex;
+    // Lowercase literal text every full match must start with, possibly empty
+    std::string prefix;
+    std::string replacement;
+  };
+
+  RewriteRuleSet() = default;
+  explicit RewriteRuleSet(const Json::Value& rules);
+
+  std::string apply(const std::string& value) const;
+  bool empty() const { return rules_.empty(); }
+
+ private:
+  std::vector<Rule> rules_;
+};
 }  // namespace waybar::util
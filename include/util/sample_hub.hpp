@@ -0,0 +1,205 @@
+#pragma once
+
+#include <glibmm/dispatcher.h>
+#include <sigc++/signal.h>
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "util/sleeper_thread.hpp"
+
+namespace waybar::util {
+
+/**
+ * Periodically sampled data source shared by all modules that subscribe to it.
+ *
+ * The sampler runs as one loop of the shared TimerScheduler, or on a thread of its own when it is
+ * `blocking`, i.e. may hang in a system call (statvfs() on an unresponsive network mount). Each
+ * result is published as an immutable snapshot and announced on the main loop through one
+ * Glib::Dispatcher, which then fans out to every subscriber, regardless of how many bars or
+ * module instances are attached.
+ */
+template <typename T>
+class SampleSource {
+ public:
+  using sample_t = std::shared_ptr<const T>;
+  using sampler_t = std::function<T()>;
+
+  SampleSource(std::string name, std::chrono::milliseconds interval, sampler_t sampler,
+               bool blocking = false)
+      : name_(std::move(name)), interval_(interval), sampler_(std::move(sampler)) {
+    dp_.connect(sigc::mem_fun(*this, &SampleSource::handleSample));
+    // Shared by every bar, so never paused, but it may be slowed down
+    thread_.set_power_saving(true);
+    auto loop = [this] {
+      try {
+        auto sample = std::make_shared<const T>(sampler_());
+        {
+          std::lock_guard lock(mutex_);
+          latest_ = std::move(sample);
+        }
+        dp_.emit();
+      } catch (const std::exception& e) {
+        spdlog::error("{}: {}", name_, e.what());
+      }
+      thread_.sleep_for(interval_);
+    };
+    if (blocking) {
+      thread_ = SleeperThread::Blocking{std::move(loop)};
+    } else {
+      thread_ = std::move(loop);
+    }
+  }
+
+  SampleSource(const SampleSource&) = delete;
+  SampleSource& operator=(const SampleSource&) = delete;
+
+  /// Most recent sample, or nullptr if the first one is still being taken. Thread-safe.
+  sample_t latest() const {
+    std::lock_guard lock(mutex_);
+    return latest_;
+  }
+
+  sigc::connection connect(const sigc::slot<void()>& slot) { return signal_sample_.connect(slot); }
+
+  /// Request an immediate out-of-schedule sample (e.g. on click or resume).
+  void wake_up() { thread_.wake_up(); }
+
+  const std::string& name() const { return name_; }
+
+ private:
+  void handleSample() {
+    try {
+      signal_sample_.emit();
+    } catch (const std::exception& e) {
+      spdlog::error("{}: {}", name_, e.what());
+    }
+  }
+
+  const std::string name_;
+  const std::chrono::milliseconds interval_;
+  const sampler_t sampler_;
+  Glib::Dispatcher dp_;
+  sigc::signal<void()> signal_sample_;
+  mutable std::mutex mutex_;
+  sample_t latest_;
+  // Declared last so the worker is stopped before the members it uses are destroyed
+  SleeperThread thread_;
+};
+
+/**
+ * RAII handle for a SampleSource subscription.
+ * Keeps the source alive and disconnects the subscriber slot on destruction.
+ */
+template <typename T>
+class SampleSubscription {
+ public:
+  SampleSubscription() = default;
+  SampleSubscription(std::shared_ptr<SampleSource<T>> source, const sigc::slot<void()>& slot)
+      : source_(std::move(source)), conn_(source_->connect(slot)) {}
+
+  SampleSubscription(const SampleSubscription&) = delete;
+  SampleSubscription& operator=(const SampleSubscription&) = delete;
+
+  SampleSubscription(SampleSubscription&& other) noexcept
+      : source_(std::move(other.source_)), conn_(other.conn_) {
+    other.conn_ = sigc::connection();
+  }
+
+  SampleSubscription& operator=(SampleSubscription&& other) noexcept {
+    if (this != &other) {
+      conn_.disconnect();
+      source_ = std::move(other.source_);
+      conn_ = other.conn_;
+      other.conn_ = sigc::connection();
+    }
+    return *this;
+  }
+
+  ~SampleSubscription() { conn_.disconnect(); }
+
+  typename SampleSource<T>::sample_t latest() const {
+    return source_ ? source_->latest() : nullptr;
+  }
+
+  void wake_up() {
+    if (source_) {
+      source_->wake_up();
+    }
+  }
+
+ private:
+  std::shared_ptr<SampleSource<T>> source_;
+  sigc::connection conn_;
+};
+
+/**
+ * Process-wide registry of SampleSources keyed by (source name, interval).
+ *
+ * Modules with the same source and interval share one sampler thread, so N bars no longer mean
+ * N pollers. Sources are reference counted and stop once the last subscription is dropped.
+ * Must be used from the main thread, as sources own a Glib::Dispatcher.
+ */
+template <typename T>
+class SampleHub {
+ public:
+  using sampler_t = typename SampleSource<T>::sampler_t;
+
+  // `make_sampler` is only invoked when no live source matches the key. The sampler it returns
+  // may keep its own state (e.g. previous counters), but must not capture any module instance.
+  // If the source already has a sample, `slot` is also called right away, so a module joining a
+  // running source doesn't wait a whole interval for its first sample. Modules pass a slot that
+  // emits their dispatcher rather than one calling update() directly. Samplers that may block
+  // pass `blocking` (see SampleSource).
+  static SampleSubscription<T> subscribe(const std::string& name,
+                                         std::chrono::milliseconds interval,
+                                         const std::function<sampler_t()>& make_sampler,
+                                         const sigc::slot<void()>& slot, bool blocking = false) {
+    SampleSubscription<T> subscription(acquire(name, interval, make_sampler, blocking), slot);
+    if (subscription.latest() != nullptr) {
+      slot();
+    }
+    return subscription;
+  }
+
+  static std::shared_ptr<SampleSource<T>> acquire(const std::string& name,
+                                                  std::chrono::milliseconds interval,
+                                                  const std::function<sampler_t()>& make_sampler,
+                                                  bool blocking = false) {
+    std::lock_guard lock(mutex());
+    auto& sources = registry();
+    std::erase_if(sources, [](const auto& entry) { return entry.second.expired(); });
+
+    auto key = std::make_pair(name, interval);
+    if (auto it = sources.find(key); it != sources.end()) {
+      if (auto source = it->second.lock()) {
+        return source;
+      }
+    }
+    auto source = std::make_shared<SampleSource<T>>(name, interval, make_sampler(), blocking);
+    sources[key] = source;
+    spdlog::debug("Started shared sampler '{}' ({}ms)", name, interval.count());
+    return source;
+  }
+
+ private:
+  using key_t = std::pair<std::string, std::chrono::milliseconds>;
+
+  static std::map<key_t, std::weak_ptr<SampleSource<T>>>& registry() {
+    static std::map<key_t, std::weak_ptr<SampleSource<T>>> sources;
+    return sources;
+  }
+
+  static std::mutex& mutex() {
+    static std::mutex mutex;
+    return mutex;
+  }
+};
+
+}  // namespace waybar::util
@@ -1,13 +1,18 @@
 #pragma once
 
+#include <spdlog/spdlog.h>
+
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <ctime>
+#include <exception>
 #include <functional>
 #include <thread>
+#include <utility>
 
 #include "prepare_for_sleep.h"
+#include "util/timer_scheduler.hpp"
 
 namespace waybar::util {
 
@@ -26,33 +31,54 @@ class CancellationGuard {
   ~CancellationGuard() { pthread_setcancelstate(oldstate, &oldstate); }
 };
 
+/**
+ * Runs a function in a loop, with sleeps in between.
+ *
+ * By default each iteration of the loop is a task of the shared TimerScheduler: sleep_for(),
+ * sleep_until() and sleep() called from the loop don't block but set when the next iteration
+ * starts, so they have to be the last thing an iteration does. Between iterations the loop holds
+ * no thread, and stop() lets a running iteration finish instead of cancelling it.
+ *
+ * Loops that block in system calls (reading a socket, polling a fd) must be assigned as Blocking
+ * instead. These get a thread of their own where the sleeps block, and stop() cancels the thread.
+ *
+ * Loops that poll for data nobody has to see right away can allow their sleeps to be stretched
+ * while saving power, with set_power_saving().
+ */
 class SleeperThread {
  public:
+  /// Loop function that needs a dedicated thread
+  struct Blocking {
+    std::function<void()> func;
+  };
+
   SleeperThread() = default;
 
-  SleeperThread(std::function<void()> func)
-      : thread_{[this, func] {
-          while (do_run_.load(std::memory_order_relaxed)) {
-            signal_.store(false, std::memory_order_relaxed);
-            func();
-          }
-        }} {
-    connection_ = prepare_for_sleep().connect([this](bool sleep) {
-      if (not sleep) wake_up();
-    });
-  }
+  SleeperThread(std::function<void()> func) { *this = std::move(func); }
 
   SleeperThread& operator=(std::function<void()> func) {
-    if (thread_.joinable()) {
-      stop();
-      thread_.join();
+    halt();
+    {
+      std::lock_guard<std::mutex> lck(mutex_);
+      do_run_.store(true, std::memory_order_relaxed);
+      signal_.store(false, std::memory_order_relaxed);
+      parked_ = false;
     }
+    func_ = std::move(func);
+    auto& scheduler = TimerScheduler::instance();
+    timer_ = scheduler.add([this] { iterate(); });
+    scheduler.schedule(timer_, TimerScheduler::Clock::now());
+    return *this;
+  }
+
+  SleeperThread& operator=(Blocking loop) {
+    halt();
     {
       std::lock_guard<std::mutex> lck(mutex_);
       do_run_.store(true, std::memory_order_relaxed);
       signal_.store(false, std::memory_order_relaxed);
     }
-    thread_ = std::thread([this, func] {
+    thread_ = std::thread([this, func = std::move(loop.func)] {
       while (do_run_.load(std::memory_order_relaxed)) {
         signal_.store(false, std::memory_order_relaxed);
         func();
@@ -68,8 +94,22 @@ class SleeperThread {
 
   bool isRunning() const { return do_run_.load(std::memory_order_relaxed); }
 
+  /// Lengthen the sleep_for() of the loop by TimerScheduler::stretch(). Unlike scheduled loops,
+  /// blocking ones only pick up a lower factor with their next sleep.
+  void set_power_saving(bool power_saving) {
+    // Blocking loops read the factor from their own thread, but the scheduler has to be set up
+    // from the main thread
+    TimerScheduler::instance();
+    std::lock_guard<std::mutex> lck(mutex_);
+    power_saving_ = power_saving;
+  }
+
   auto sleep() {
     std::unique_lock lk(mutex_);
+    if (inIteration()) {
+      next_ = Next::WOKEN;
+      return;
+    }
     CancellationGuard cancel_lock;
     return condvar_.wait(lk, [this] {
       return signal_.load(std::memory_order_relaxed) || !do_run_.load(std::memory_order_relaxed);
@@ -78,6 +118,13 @@ class SleeperThread {
 
   auto sleep_for(std::chrono::system_clock::duration dur) {
     std::unique_lock lk(mutex_);
+    if (inIteration()) {
+      const auto stretch = power_saving_ ? TimerScheduler::instance().stretch() : 1U;
+      setNext(TimerScheduler::alignedDeadline(
+          dur < std::chrono::hours(24) ? dur * stretch : dur));
+      next_stretched_ = stretch > 1;
+      return signal_.load(std::memory_order_relaxed) || !do_run_.load(std::memory_order_relaxed);
+    }
     CancellationGuard cancel_lock;
 
     condvar_.wait(lk, [this] {
@@ -85,6 +132,9 @@ class SleeperThread {
              !do_run_.load(std::memory_order_relaxed);
     });
 
+    if (power_saving_ && dur < std::chrono::hours(24)) {
+      dur *= TimerScheduler::instance().stretch();
+    }
     constexpr auto max_time_point = std::chrono::steady_clock::time_point::max();
     auto wait_end = max_time_point;
     auto now = std::chrono::steady_clock::now();
@@ -100,6 +150,10 @@ class SleeperThread {
       std::chrono::time_point<std::chrono::system_clock, std::chrono::system_clock::duration>
           time_point) {
     std::unique_lock lk(mutex_);
+    if (inIteration()) {
+      setNext(TimerScheduler::Clock::now() + (time_point - std::chrono::system_clock::now()));
+      return signal_.load(std::memory_order_relaxed) || !do_run_.load(std::memory_order_relaxed);
+    }
     CancellationGuard cancel_lock;
 
     condvar_.wait(lk, [this] {
@@ -116,6 +170,12 @@ class SleeperThread {
     {
       std::lock_guard<std::mutex> lck(mutex_);
       signal_.store(true, std::memory_order_relaxed);
+      // A running iteration picks the signal up when it returns
+      if (timer_ != 0 && iteration_tid_ == std::thread::id{} &&
+          do_run_.load(std::memory_order_relaxed)) {
+        parked_ = false;
+        TimerScheduler::instance().schedule(timer_, TimerScheduler::Clock::now());
+      }
     }
     condvar_.notify_all();
   }
@@ -127,9 +187,13 @@ class SleeperThread {
       do_run_.store(false, std::memory_order_relaxed);
     }
     condvar_.notify_all();
+    if (timer_ != 0) {
+      // A running iteration is left to finish; it won't be followed by another one
+      TimerScheduler::instance().unschedule(timer_);
+    }
     auto handle = thread_.native_handle();
     if (handle != 0) {
-      // TODO: find a proper way to terminate thread...
+      // Blocking loops may be stuck in a system call that nothing else would interrupt
       pthread_cancel(handle);
     }
   }
@@ -140,20 +204,83 @@ class SleeperThread {
   }
 
   void resume() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    is_paused_ = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      is_paused_ = false;
+      if (std::exchange(parked_, false) && do_run_.load(std::memory_order_relaxed)) {
+        TimerScheduler::instance().schedule(timer_, TimerScheduler::Clock::now());
+      }
+    }
     condvar_.notify_all();
   }
 
-  ~SleeperThread() {
+  ~SleeperThread() { halt(); }
+
+ private:
+  enum class Next { NOW, AT, WOKEN };
+
+  // Called with mutex_ held
+  bool inIteration() const { return iteration_tid_ == std::this_thread::get_id(); }
+
+  // Called with mutex_ held
+  void setNext(TimerScheduler::Clock::time_point deadline) {
+    next_stretched_ = false;
+    if (deadline == TimerScheduler::Clock::time_point::max()) {
+      next_ = Next::WOKEN;
+    } else {
+      next_ = Next::AT;
+      next_deadline_ = deadline;
+    }
+  }
+
+  void iterate() {
+    {
+      std::lock_guard<std::mutex> lck(mutex_);
+      if (!do_run_.load(std::memory_order_relaxed)) {
+        return;
+      }
+      signal_.store(false, std::memory_order_relaxed);
+      next_ = Next::NOW;
+      iteration_tid_ = std::this_thread::get_id();
+    }
+    try {
+      func_();
+    } catch (const std::exception& e) {
+      spdlog::error("Stopping a loop after an error: {}", e.what());
+      do_run_.store(false, std::memory_order_relaxed);
+    }
+
+    std::lock_guard<std::mutex> lck(mutex_);
+    iteration_tid_ = {};
+    if (!do_run_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    auto& scheduler = TimerScheduler::instance();
+    if (signal_.load(std::memory_order_relaxed) || next_ == Next::NOW) {
+      // Woken up during the iteration, or the loop doesn't sleep at all
+      scheduler.schedule(timer_, TimerScheduler::Clock::now());
+    } else if (next_ == Next::AT) {
+      if (is_paused_) {
+        // Runs again on resume() or wake_up()
+        parked_ = true;
+      } else {
+        scheduler.schedule(timer_, next_deadline_, next_stretched_);
+      }
+    }
+  }
+
+  // Stop the loop and wait until it's done
+  void halt() {
     connection_.disconnect();
     stop();
     if (thread_.joinable()) {
       thread_.join();
     }
+    if (timer_ != 0) {
+      TimerScheduler::instance().remove(std::exchange(timer_, 0));
+    }
   }
 
- private:
   std::thread thread_;
   std::condition_variable condvar_;
   std::mutex mutex_;
@@ -161,6 +288,17 @@ class SleeperThread {
   std::atomic<bool> signal_ = false;
   sigc::connection connection_;
   bool is_paused_{false};
+
+  // State of a scheduled loop
+  std::function<void()> func_;
+  TimerScheduler::Id timer_ = 0;
+  std::thread::id iteration_tid_;
+  Next next_ = Next::NOW;
+  TimerScheduler::Clock::time_point next_deadline_;
+  bool next_stretched_ = false;
+  bool power_saving_ = false;
+  // Due while paused
+  bool parked_ = false;
 };
 
 }  // namespace waybar::util
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace waybar::util {
+
+/**
+ * Process-wide timer queue running the loops of every SleeperThread.
+ *
+ * Tasks are run at their deadline on a small pool of workers, and every task due at the same
+ * time is run after a single wakeup. Deadlines of whole-second sleeps are aligned to the seconds
+ * of the wall clock (see alignedDeadline()), so modules polling at the same period are woken
+ * together instead of each at its own phase.
+ *
+ * One of the idle workers waits for the earliest deadline; there is no dedicated timer thread.
+ * Workers are started on demand when every one of them is busy, up to `max_workers`, so the pool
+ * only grows when tasks actually overlap, and workers that stay idle for `idle_timeout` exit
+ * again. Tasks must not block for long, as they hold one of these few workers while they run;
+ * loops that do should be SleeperThread::Blocking. As a safety net, while the pool is full a
+ * watchdog starts one more worker whenever every worker stayed busy for `stall_timeout` past a
+ * deadline, so that a few stuck tasks don't stop all the others. A task never runs on two
+ * workers at once: a task due while it runs starts again after it returns.
+ *
+ * Tasks scheduled as `stretched` had their sleep lengthened by stretch() to save power (see
+ * PowerPolicy). They are run right away when the factor goes down again.
+ */
+class TimerScheduler {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using Id = uint64_t;
+
+  struct Stats {
+    // Times a worker woke up for expired deadlines
+    uint64_t wakeups = 0;
+    uint64_t runs = 0;
+    std::size_t workers = 0;
+    // Workers started past max_workers because every worker was busy for too long
+    uint64_t stalls = 0;
+  };
+
+  static constexpr std::size_t DEFAULT_MAX_WORKERS = 4;
+  static constexpr std::chrono::seconds DEFAULT_IDLE_TIMEOUT{30};
+  static constexpr std::chrono::seconds DEFAULT_STALL_TIMEOUT{1};
+
+  static TimerScheduler& instance();
+
+  explicit TimerScheduler(std::size_t max_workers = DEFAULT_MAX_WORKERS,
+                          Clock::duration idle_timeout = DEFAULT_IDLE_TIMEOUT,
+                          Clock::duration stall_timeout = DEFAULT_STALL_TIMEOUT);
+  TimerScheduler(const TimerScheduler&) = delete;
+  TimerScheduler& operator=(const TimerScheduler&) = delete;
+  ~TimerScheduler();
+
+  /// Register a task. It doesn't run until it is scheduled.
+  Id add(std::function<void()> task);
+  /// Unregister a task and wait for a run in progress, unless called from that run
+  void remove(Id id);
+  /// Run a task at `deadline`, or at its current deadline if that is earlier
+  void schedule(Id id, Clock::time_point deadline, bool stretched = false);
+  /// Drop the deadline of a task. A run in progress is not affected.
+  void unschedule(Id id);
+  /// Run every task now, including the ones waiting without a deadline to be woken up, e.g.
+  /// after the system resumed from sleep
+  void expireAll();
+
+  Stats stats();
+
+  /// Factor by which loops that allow it lengthen their sleeps
+  unsigned stretch() const { return stretch_.load(std::memory_order_relaxed); }
+  void setStretch(unsigned factor);
+
+  /// Deadline of a sleep of `duration` starting now. Sleeps of a second or more end on a second
+  /// of the wall clock (the nearest one, but never before now), shorter ones are not aligned.
+  static Clock::time_point alignedDeadline(std::chrono::system_clock::duration duration);
+
+ private:
+  using Timers = std::multimap<Clock::time_point, Id>;
+
+  struct Task {
+    std::function<void()> run;
+    Timers::iterator timer;
+    bool scheduled = false;
+    bool stretched = false;
+    bool queued = false;
+    bool running = false;
+    // Became due while running
+    bool rerun = false;
+    bool removed = false;
+    std::thread::id runner;
+  };
+
+  void work();
+  void enqueue(Id id, Task& task);
+  void startWorkers();
+  // Called with mutex_ held by a worker that is about to exit
+  void retire();
+  // Runs on watchdog_ while the pool is full
+  void watch();
+
+  const std::size_t max_workers_;
+  const Clock::duration idle_timeout_;
+  const Clock::duration stall_timeout_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::condition_variable done_cv_;
+  std::condition_variable watchdog_cv_;
+  std::unordered_map<Id, Task> tasks_;
+  Timers timers_;
+  std::deque<Id> ready_;
+  // When the first task of ready_ was queued, or taken over by a worker at the latest
+  Clock::time_point ready_since_;
+  std::vector<std::thread> workers_;
+  std::thread watchdog_;
+  // Workers and watchdogs that exited and still have to be joined
+  std::vector<std::thread> retired_;
+  std::size_t idle_ = 0;
+  Id next_id_ = 1;
+  uint64_t wakeups_ = 0;
+  uint64_t runs_ = 0;
+  uint64_t stalls_ = 0;
+  bool stopping_ = false;
+  std::atomic<unsigned> stretch_ = 1;
+};
+
+}  // namespace waybar::util
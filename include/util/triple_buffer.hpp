@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace waybar::util {
+
+/**
+ * Lock-free single producer, single consumer triple buffer.
+ *
+ * The producer fills back() and publishes it; the consumer calls acquire() to pick up the most
+ * recently published value and reads it through front(). Values published while the consumer is
+ * busy replace each other instead of queueing up, so the consumer only ever sees the latest one.
+ * Slots are reused in place: a T that keeps its capacity (e.g. std::vector) stops allocating once
+ * it reaches its working size.
+ *
+ * back() and publish() must only be called by one thread at a time, and so must acquire() and
+ * front().
+ */
+template <typename T>
+class TripleBuffer {
+ public:
+  TripleBuffer() = default;
+  TripleBuffer(const TripleBuffer&) = delete;
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+  /// Slot owned by the producer. Its contents are unspecified until written.
+  T& back() { return slots_[back_]; }
+
+  /// Hand the back slot over to the consumer, dropping any value it has not acquired yet
+  void publish() { back_ = middle_.exchange(back_ | FRESH, std::memory_order_acq_rel) & INDEX; }
+
+  /// Make the latest published value current. Returns false if nothing new was published.
+  bool acquire() {
+    if ((middle_.load(std::memory_order_relaxed) & FRESH) == 0) {
+      return false;
+    }
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX;
+    return true;
+  }
+
+  /// Slot owned by the consumer, holding the value made current by the last acquire()
+  const T& front() const { return slots_[front_]; }
+
+ private:
+  static constexpr uint8_t INDEX = 0x3;
+  static constexpr uint8_t FRESH = 0x4;
+
+  std::array<T, 3> slots_{};
+  uint8_t back_ = 0;
+  uint8_t front_ = 1;
+  std::atomic<uint8_t> middle_{2};
+};
+
+}  // namespace waybar::util
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <glibmm/main.h>
+#include <gtkmm/widget.h>
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace waybar::util {
+
+/**
+ * Runs module updates in step with the frame clock of a widget.
+ *
+ * schedule() only marks an update as pending. Pending updates are run together on the next
+ * frame clock tick of the widget, i.e. at most once per refresh of the output it is shown on, so
+ * a burst of events costs one update per module instead of one per event. Each update can also
+ * have a minimum period: an update scheduled sooner than that after its previous run is postponed
+ * rather than dropped.
+ *
+ * When the widget is not mapped, or the compositor stops sending frames for it, pending updates
+ * are run from the main loop instead so they are never held back indefinitely.
+ */
+class UpdateScheduler {
+ public:
+  using Handle = std::size_t;
+
+  explicit UpdateScheduler(Gtk::Widget& widget);
+  ~UpdateScheduler();
+  UpdateScheduler(const UpdateScheduler&) = delete;
+  UpdateScheduler& operator=(const UpdateScheduler&) = delete;
+
+  Handle add(std::function<void()> update,
+             std::chrono::milliseconds min_period = std::chrono::milliseconds::zero());
+  void schedule(Handle handle);
+
+ private:
+  // Upper bound on how long a pending update waits for a frame clock tick
+  static constexpr unsigned FALLBACK_INTERVAL_MS = 100;
+
+  struct Entry {
+    std::function<void()> update;
+    gint64 min_period_us;
+    gint64 last_run_us = 0;
+    bool pending = false;
+  };
+
+  static gboolean onTick(GtkWidget* widget, GdkFrameClock* clock, gpointer data);
+  void arm();
+  void disarm();
+  void flush(gint64 now_us);
+
+  Gtk::Widget& widget_;
+  std::vector<Entry> entries_;
+  std::vector<Handle> pending_;
+  std::vector<Handle> running_;
+  guint tick_id_ = 0;
+  sigc::connection fallback_;
+  sigc::connection deferred_;
+};
+
+}  // namespace waybar::util
@@ -2,14 +2,15 @@
 
 #include <gdkmm/pixbuf.h>
 #include <glibmm/fileutils.h>
-#include <glibmm/keyfile.h>
-#include <glibmm/miscutils.h>
 #include <spdlog/spdlog.h>
 
-#include <filesystem>
+#include <algorithm>
 #include <optional>
+#include <vector>
 
+#include "util/desktop_entry_index.hpp"
 #include "util/gtk_icon.hpp"
+#include "util/pixbuf_cache.hpp"
 
 namespace waybar {
 
@@ -22,6 +23,16 @@ AAppIconLabel::AAppIconLabel(const Json::Value& config, const std::string& name,
     app_icon_size_ = config["icon-size"].asUInt();
   }
   image_.set_pixel_size(app_icon_size_);
+  if (iconEnabled()) {
+    // Start indexing desktop entries before the first window needs them
+    desktop_entries_changed_ =
+        util::DesktopEntryIndex::instance().signal_changed.connect([this] {
+          if (!app_identifier_.empty()) {
+            updateAppIconName(app_identifier_, alternative_app_identifier_);
+            updateAppIcon();
+          }
+        });
+  }
 }
 
 std::string toLowerCase(const std::string& input) {
@@ -31,66 +42,27 @@ std::string toLowerCase(const std::string& input) {
   return result;
 }
 
-std::optional<std::string> getFileBySuffix(const std::string& dir, const std::string& suffix,
-                                           bool check_lower_case) {
-  try {
-    for (const auto& entry : std::filesystem::recursive_directory_iterator(dir)) {
-      if (entry.is_regular_file()) {
-        std::string filename = entry.path().filename().string();
-        if (filename.size() < suffix.size()) {
-          continue;
-        }
-        if ((filename.compare(filename.size() - suffix.size(), suffix.size(), suffix) == 0) ||
-            (check_lower_case && filename.compare(filename.size() - suffix.size(), suffix.size(),
-                                                  toLowerCase(suffix)) == 0)) {
-          return entry.path().string();
-        }
-      }
-    }
-  } catch (const std::filesystem::filesystem_error&) {
-  }
-
-  return {};
-}
-
-std::optional<std::string> getFileBySuffix(const std::string& dir, const std::string& suffix) {
-  return getFileBySuffix(dir, suffix, false);
-}
-
-std::optional<std::string> getDesktopFilePath(const std::string& app_identifier,
-                                              const std::string& alternative_app_identifier) {
+std::optional<util::DesktopEntryIndex::Entry> getDesktopEntry(
+    const std::string& app_identifier, const std::string& alternative_app_identifier) {
   if (app_identifier.empty()) {
     return {};
   }
 
-  auto data_dirs = Glib::get_system_data_dirs();
-  data_dirs.insert(data_dirs.begin(), Glib::get_user_data_dir());
-  for (const auto& data_dir : data_dirs) {
-    const auto data_app_dir = data_dir + "/applications/";
-    auto desktop_file_suffix = app_identifier + ".desktop";
-    // searching for file by suffix catches cases like terminal emulator "foot" where class is
-    // "footclient" and desktop file is named "org.codeberg.dnkl.footclient.desktop"
-    auto desktop_file_path = getFileBySuffix(data_app_dir, desktop_file_suffix, true);
-    // "true" argument allows checking for lowercase - this catches cases where class name is
-    // "LibreWolf" and desktop file is named "librewolf.desktop"
-    if (desktop_file_path.has_value()) {
-      return desktop_file_path;
-    }
-    if (!alternative_app_identifier.empty()) {
-      desktop_file_suffix = alternative_app_identifier + ".desktop";
-      desktop_file_path = getFileBySuffix(data_app_dir, desktop_file_suffix, true);
-      if (desktop_file_path.has_value()) {
-        return desktop_file_path;
-      }
-    }
+  // Matching the file name by suffix catches cases like terminal emulator "foot" where class is
+  // "footclient" and desktop file is named "org.codeberg.dnkl.footclient.desktop". The suffix is
+  // also matched in lowercase, which catches cases where class name is "LibreWolf" and desktop
+  // file is named "librewolf.desktop".
+  std::vector<std::string> suffixes{app_identifier + ".desktop"};
+  if (!alternative_app_identifier.empty()) {
+    suffixes.push_back(alternative_app_identifier + ".desktop");
   }
-  return {};
+  return util::DesktopEntryIndex::instance().bySuffix(suffixes);
 }
 
 std::optional<Glib::ustring> getIconName(const std::string& app_identifier,
                                          const std::string& alternative_app_identifier) {
-  const auto desktop_file_path = getDesktopFilePath(app_identifier, alternative_app_identifier);
-  if (!desktop_file_path.has_value()) {
+  const auto desktop_entry = getDesktopEntry(app_identifier, alternative_app_identifier);
+  if (!desktop_entry.has_value()) {
     // Try some heuristics to find a matching icon
 
     if (DefaultGtkIconThemeWrapper::has_icon(app_identifier)) {
@@ -121,18 +93,11 @@ std::optional<Glib::ustring> getIconName(const std::string& app_identifier,
     return {};
   }
 
-  try {
-    Glib::KeyFile desktop_file;
-    desktop_file.load_from_file(desktop_file_path.value());
-    return desktop_file.get_string("Desktop Entry", "Icon");
-  } catch (Glib::FileError& error) {
-    spdlog::warn("Error while loading desktop file {}: {}", desktop_file_path.value(),
-                 error.what().c_str());
-  } catch (Glib::KeyFileError& error) {
-    spdlog::warn("Error while loading desktop file {}: {}", desktop_file_path.value(),
-                 error.what().c_str());
+  if (desktop_entry->icon.empty()) {
+    spdlog::debug("Desktop file {} has no icon", desktop_entry->path);
+    return {};
   }
-  return {};
+  return desktop_entry->icon;
 }
 
 void AAppIconLabel::updateAppIconName(const std::string& app_identifier,
@@ -140,6 +105,8 @@ void AAppIconLabel::updateAppIconName(const std::string& app_identifier,
   if (!iconEnabled()) {
     return;
   }
+  app_identifier_ = app_identifier;
+  alternative_app_identifier_ = alternative_app_identifier;
 
   const auto icon_name = getIconName(app_identifier, alternative_app_identifier);
   if (icon_name.has_value()) {
@@ -158,8 +125,8 @@ void AAppIconLabel::updateAppIcon() {
     } else if (app_icon_name_.front() == '/') {
       try {
         int scaled_icon_size = app_icon_size_ * image_.get_scale_factor();
-        auto pixbuf =
-            Gdk::Pixbuf::create_from_file(app_icon_name_, scaled_icon_size, scaled_icon_size);
+        auto pixbuf = util::PixbufCache::instance().fromFile(app_icon_name_, scaled_icon_size,
+                                                             scaled_icon_size);
 
         auto surface = Gdk::Cairo::create_surface_from_pixbuf(pixbuf, image_.get_scale_factor(),
                                                               image_.get_window());
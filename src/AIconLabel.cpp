@@ -5,6 +5,8 @@
 #include <regex>
 #include <string>
 
+#include "util/pixbuf_cache.hpp"
+
 namespace waybar {
 
 AIconLabel::AIconLabel(const Json::Value& config, const std::string& name, const std::string& id,
@@ -92,7 +94,8 @@ auto AIconLabel::update() -> void {
     if (iconLabel.front() == '/') {
       try {
         int scaled_icon_size = app_icon_size_ * image_.get_scale_factor();
-        auto pixbuf = Gdk::Pixbuf::create_from_file(iconLabel, scaled_icon_size, scaled_icon_size);
+        auto pixbuf =
+            util::PixbufCache::instance().fromFile(iconLabel, scaled_icon_size, scaled_icon_size);
 
         auto surface = Gdk::Cairo::create_surface_from_pixbuf(pixbuf, image_.get_scale_factor(),
                                                               image_.get_window());
@@ -35,7 +35,22 @@ ALabel::ALabel(const Json::Value& config, const std::string& name, const std::st
                                       // modulo-by-zero clock code.
                                       : (interval == 0 ? 0L : 1000L * static_cast<long>(interval)))
                                : 1000 * (long)interval))),
-      default_format_(format_) {
+      default_format_(format_),
+      icons_(config_["format-icons"]) {
+  for (auto it = config_.begin(); it != config_.end(); ++it) {
+    if (!it->isString()) {
+      continue;
+    }
+    const auto key = it.name();
+    if (key.starts_with("format-")) {
+      state_formats_.emplace(key.substr(7), it->asString());
+    } else if (key.starts_with("tooltip-format-")) {
+      state_tooltip_formats_.emplace(key.substr(15), it->asString());
+    } else if (key == "tooltip-format") {
+      tooltip_format_ = it->asString();
+    }
+  }
+
   label_.set_name(name);
   if (!id.empty()) {
     label_.get_style_context()->add_class(id);
@@ -49,6 +64,16 @@ ALabel::ALabel(const Json::Value& config, const std::string& name, const std::st
     label_.set_has_tooltip(true);
     label_.signal_query_tooltip().connect(
         [this](int, int, bool, const Glib::RefPtr<Gtk::Tooltip>& tooltip) {
+          if (tooltip_producer_) {
+            auto producer = std::move(tooltip_producer_);
+            tooltip_producer_ = nullptr;
+            try {
+              last_tooltip_markup_ = producer();
+            } catch (const std::exception& e) {
+              spdlog::error("{}: failed to format the tooltip: {}", name_, e.what());
+              last_tooltip_markup_.reset();
+            }
+          }
           if (!last_tooltip_markup_.has_value() || last_tooltip_markup_->empty()) {
             active_tooltip_.reset();
             return false;
@@ -178,6 +203,7 @@ bool ALabel::setLabelMarkup(const Glib::ustring& markup) {
 }
 
 bool ALabel::setTooltipMarkup(const Glib::ustring& markup) {
+  tooltip_producer_ = nullptr;
   if (last_tooltip_markup_ == markup.raw()) {
     return false;
   }
@@ -189,96 +215,45 @@ bool ALabel::setTooltipMarkup(const Glib::ustring& markup) {
   return true;
 }
 
-std::string ALabel::getIcon(uint16_t percentage, const std::string& alt, uint16_t max) {
-  auto format_icons = config_["format-icons"];
-  if (format_icons.isObject()) {
-    if (!alt.empty() && (format_icons[alt].isString() || format_icons[alt].isArray())) {
-      format_icons = format_icons[alt];
-    } else {
-      format_icons = format_icons["default"];
-    }
-  }
-  if (format_icons.isArray()) {
-    auto size = format_icons.size();
-    if (size != 0U && format_icons[0].isObject()) {
-      std::string last_icon;
-      for (const auto& threshold : format_icons) {
-        if (!threshold.isObject() || !threshold["icon"].isString() || !threshold["max"].isUInt()) {
-          static bool warned = false;
-          if (!warned) {
-            spdlog::warn(
-                "format-icons: skipping invalid threshold object, expected {\"icon\": \"...\", "
-                "\"max\": N}");
-            warned = true;
-          }
-          continue;
-        }
-        last_icon = threshold["icon"].asString();
-        if (percentage <= threshold["max"].asUInt()) {
-          return last_icon;
-        }
-      }
-      if (!last_icon.empty()) {
-        return last_icon;
-      }
-    } else if (size != 0U) {
-      auto divisor = std::max(1U, (max == 0 ? 100U : static_cast<unsigned>(max)) / size);
-      auto idx = std::clamp(percentage / divisor, 0U, size - 1);
-      format_icons = format_icons[idx];
-    }
-  }
-  if (format_icons.isString()) {
-    return format_icons.asString();
+void ALabel::setTooltipProducer(std::function<std::string()> producer) {
+  if (active_tooltip_) {
+    setTooltipMarkup(producer());
+    return;
   }
-  return "";
+  tooltip_producer_ = std::move(producer);
+}
+
+void ALabel::setTooltipFormat(std::string format, std::shared_ptr<const FormatArgs> args) {
+  setTooltipProducer([format = std::move(format), args = std::move(args)] {
+    return fmt::vformat(format, *args);
+  });
+}
+
+std::string ALabel::getIcon(uint16_t percentage, const std::string& alt, uint16_t max) {
+  return icons_.select(alt).get(percentage, max);
 }
 
 std::string ALabel::getIcon(uint16_t percentage, const std::vector<std::string>& alts,
                             uint16_t max) {
-  auto format_icons = config_["format-icons"];
-  if (format_icons.isObject()) {
-    std::string _alt = "default";
-    for (const auto& alt : alts) {
-      if (!alt.empty() && (format_icons[alt].isString() || format_icons[alt].isArray())) {
-        _alt = alt;
-        break;
-      }
-    }
-    format_icons = format_icons[_alt];
+  return icons_.select(alts).get(percentage, max);
+}
+
+const std::string* ALabel::stateFormat(std::string_view state) const {
+  if (state.empty()) {
+    return nullptr;
   }
-  if (format_icons.isArray()) {
-    auto size = format_icons.size();
-    if (size != 0U && format_icons[0].isObject()) {
-      std::string last_icon;
-      for (const auto& threshold : format_icons) {
-        if (!threshold.isObject() || !threshold["icon"].isString() || !threshold["max"].isUInt()) {
-          static bool warned = false;
-          if (!warned) {
-            spdlog::warn(
-                "format-icons: skipping invalid threshold object, expected {\"icon\": \"...\", "
-                "\"max\": N}");
-            warned = true;
-          }
-          continue;
-        }
-        last_icon = threshold["icon"].asString();
-        if (percentage <= threshold["max"].asUInt()) {
-          return last_icon;
-        }
-      }
-      if (!last_icon.empty()) {
-        return last_icon;
-      }
-    } else if (size != 0U) {
-      auto divisor = std::max(1U, (max == 0 ? 100U : static_cast<unsigned>(max)) / size);
-      auto idx = std::clamp(percentage / divisor, 0U, size - 1);
-      format_icons = format_icons[idx];
+  auto it = state_formats_.find(state);
+  return it != state_formats_.end() ? &it->second : nullptr;
+}
+
+const std::string& ALabel::tooltipFormat(std::string_view state,
+                                         const std::string& defaultFormat) const {
+  if (!state.empty()) {
+    if (auto it = state_tooltip_formats_.find(state); it != state_tooltip_formats_.end()) {
+      return it->second;
     }
   }
-  if (format_icons.isString()) {
-    return format_icons.asString();
-  }
-  return "";
+  return tooltip_format_ ? *tooltip_format_ : defaultFormat;
 }
 
 void ALabel::copyToClipboard(const std::string& literal) {
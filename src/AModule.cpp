@@ -113,6 +113,23 @@ AModule::~AModule() {
   }
 }
 
+void AModule::suspend() {
+  for (auto* thread : polling_threads_) {
+    thread->pause();
+  }
+}
+
+void AModule::resume() {
+  for (auto* thread : polling_threads_) {
+    thread->resume();
+  }
+}
+
+void AModule::adaptPolling(util::SleeperThread& thread) {
+  thread.set_power_saving(true);
+  polling_threads_.push_back(&thread);
+}
+
 auto AModule::update() -> void {
   // Run user-provided update handler if configured
   if (config_["on-update"].isString()) {
@@ -323,8 +340,9 @@ AModule::SCROLL_DIR AModule::getScrollDir(GdkEventScroll* e) {
   }
 }
 
-bool AModule::handleScroll(GdkEventScroll* e) {
-  auto dir = getScrollDir(e);
+bool AModule::handleScroll(GdkEventScroll* e) { return handleScrollDir(getScrollDir(e)); }
+
+bool AModule::handleScrollDir(SCROLL_DIR dir) {
   std::string eventName{};
 
   if (dir == SCROLL_DIR::UP)
@@ -3,7 +3,10 @@
 #include <gtk-layer-shell.h>
 #include <spdlog/spdlog.h>
 
+#include <chrono>
+#include <future>
 #include <ostream>
+#include <set>
 #include <type_traits>
 
 #include "client.hpp"
@@ -62,6 +65,12 @@ const std::string Bar::MODE_DEFAULT = "default";
 const std::string Bar::MODE_INVISIBLE = "invisible";
 const std::string_view DEFAULT_BAR_ID = "bar-0";
 
+/* Milliseconds since `start`, for startup timings */
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
 /* Deserializer for enum bar_layer */
 void from_json(const Json::Value& j, bar_layer& l) {
   if (j == "bottom") {
@@ -271,12 +280,14 @@ waybar::Bar::Bar(struct waybar_output* w_output, const Json::Value& w_config)
 
   unmap_conn_ = window.signal_unmap().connect([this]() {
     spdlog::debug("Output {} unmapped (DPMS off), suspending modules", output->name);
-    toggleSuspend(true);
+    mapped_ = false;
+    updateSuspended();
   });
 
   map_conn_ = window.signal_map().connect([this]() {
     spdlog::debug("Output {} mapped (DPMS on), resuming modules", output->name);
-    toggleSuspend(false);
+    mapped_ = true;
+    updateSuspended();
   });
 
 #if HAVE_SWAY
@@ -323,6 +334,10 @@ waybar::Bar::Bar(struct waybar_output* w_output, const Json::Value& w_config)
   }
 
   setupWidgets();
+  if (suspended_) {
+    // Started hidden
+    toggleSuspend(true);
+  }
   window.show_all();
 
   /*
@@ -405,6 +420,8 @@ void waybar::Bar::setMode(const struct bar_mode& mode) {
     window.get_style_context()->add_class("hidden");
     window.set_opacity(0);
   }
+  hidden_ = !mode.visible;
+  updateSuspended();
   /*
    * All the changes above require `wl_surface_commit`.
    * gtk-layer-shell schedules a commit on the next frame event in GTK, but this could fail in
@@ -599,7 +616,9 @@ void waybar::Bar::getModules(const Factory& factory, const std::string& pos,
           getModules(factory, ref, group_module.get());
           module = group_module.release();
         } else {
+          const auto start = std::chrono::steady_clock::now();
           module = factory.makeModule(ref, pos);
+          spdlog::debug("Bar {}: made {} in {:.1f} ms", output->name, ref, elapsedMs(start));
         }
 
         std::shared_ptr<AModule> module_sp(module);
@@ -617,13 +636,21 @@ void waybar::Bar::getModules(const Factory& factory, const std::string& pos,
             modules_right_.emplace_back(module_sp);
           }
         }
-        module->dp.connect([module, ref] {
+        auto update = [module, ref] {
           try {
             module->update();
           } catch (const std::exception& e) {
             spdlog::error("{}: {}", ref, e.what());
           }
-        });
+        };
+        if (update_scheduler_) {
+          const auto& interval = config[ref]["min-update-interval"];
+          auto min_period = std::chrono::milliseconds(interval.isUInt() ? interval.asUInt() : 0);
+          auto handle = update_scheduler_->add(update, min_period);
+          module->dp.connect([this, handle] { update_scheduler_->schedule(handle); });
+        } else {
+          module->dp.connect(update);
+        }
         module->dp.emit();
       } catch (const std::exception& e) {
         spdlog::warn("module {}: {}", name.asString(), e.what());
@@ -632,6 +659,57 @@ void waybar::Bar::getModules(const Factory& factory, const std::string& pos,
   }
 }
 
+void waybar::Bar::collectModules(const std::string& pos, std::vector<std::string>& names) {
+  const auto& module_list = pos.starts_with("group/") ? config[pos]["modules"] : config[pos];
+  if (!module_list.isArray()) {
+    return;
+  }
+  for (const auto& name : module_list) {
+    auto ref = name.asString();
+    if (config[ref].isMember("hosts") && !waybar::util::valid_host(config[ref])) {
+      continue;
+    }
+    if (ref.starts_with("group/") && ref.size() > 6 && ref != pos) {
+      collectModules(ref, names);
+    } else {
+      names.push_back(std::move(ref));
+    }
+  }
+}
+
+void waybar::Bar::prepareModules(bool no_center) {
+  std::vector<std::string> names;
+  collectModules("modules-left", names);
+  if (!no_center) {
+    collectModules("modules-center", names);
+  }
+  collectModules("modules-right", names);
+
+  // Only once per module type: the other bars reuse what the first one prepared
+  static std::set<std::string> prepared;
+  std::vector<std::future<void>> pending;
+  for (const auto& name : names) {
+    const auto ref = name.substr(0, name.find('#'));
+    if (prepared.contains(ref)) {
+      continue;
+    }
+    prepared.insert(ref);
+    auto prepare = Factory::prepareModule(name);
+    if (!prepare) {
+      continue;
+    }
+    pending.push_back(std::async(std::launch::async, [prepare = std::move(prepare), ref] {
+      const auto start = std::chrono::steady_clock::now();
+      prepare();
+      spdlog::debug("Prepared {} in {:.1f} ms", ref, elapsedMs(start));
+    }));
+  }
+  // Makes the modules on this thread afterwards, with their services already up
+  for (auto& done : pending) {
+    done.wait();
+  }
+}
+
 auto waybar::Bar::setupWidgets() -> void {
   window.add(box_);
 
@@ -655,12 +733,19 @@ auto waybar::Bar::setupWidgets() -> void {
   setupAltFormatKeyForModuleList("modules-right");
   setupAltFormatKeyForModuleList("modules-center");
 
+  if (config["coalesce-updates"].isBool() && config["coalesce-updates"].asBool()) {
+    update_scheduler_ = std::make_unique<util::UpdateScheduler>(window);
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  prepareModules(no_center);
   Factory factory(*this, config);
   getModules(factory, "modules-left");
   if (!no_center) {
     getModules(factory, "modules-center");
   }
   getModules(factory, "modules-right");
+  spdlog::debug("Bar {}: modules ready in {:.1f} ms", output->name, elapsedMs(start));
 
   for (auto const& module : modules_left_) {
     left_.pack_start(*module, module->expandEnabled(), module->expandEnabled());
@@ -757,6 +842,15 @@ void waybar::Bar::onOutputGeometryChanged() {
   configureGlobalOffset(window.get_width(), window.get_height());
 }
 
+void waybar::Bar::updateSuspended() {
+  // Nobody sees the modules of a hidden bar or one on an output that is off
+  const bool suspend = hidden_ || !mapped_;
+  if (suspend != suspended_) {
+    suspended_ = suspend;
+    toggleSuspend(suspend);
+  }
+}
+
 void waybar::Bar::toggleSuspend(bool suspend) {
   // Iterate the actual module objects. Modules are packed into the Gtk::Box via
   // AModule::operator Gtk::Widget&(), which returns the member event_box_, so the
@@ -13,6 +13,7 @@
 #include "util/clara.hpp"
 #include "util/format.hpp"
 #include "util/hex_checker.hpp"
+#include "util/power_policy.hpp"
 
 waybar::Client* waybar::Client::inst() {
   static auto* c = new Client();
@@ -306,6 +307,33 @@ void waybar::Client::bindInterfaces() {
       sigc::mem_fun(*this, &Client::handleMonitorRemoved));
 }
 
+void waybar::Client::setupPowerSaving(const Json::Value& config) {
+  // Power saving applies to the whole process, so the first bar that configures it decides
+  Json::Value power_saving;
+  bool conflicting = false;
+  auto apply = [&](const Json::Value& bar_config) {
+    if (!bar_config.isObject() || !bar_config.isMember("power-saving")) {
+      return;
+    }
+    if (power_saving.isNull()) {
+      power_saving = bar_config["power-saving"];
+    } else if (bar_config["power-saving"] != power_saving) {
+      conflicting = true;
+    }
+  };
+  if (config.isArray()) {
+    for (const auto& bar_config : config) {
+      apply(bar_config);
+    }
+  } else {
+    apply(config);
+  }
+  if (conflicting) {
+    spdlog::warn("Bars set different power-saving options, using the ones of the first bar");
+  }
+  util::PowerPolicy::instance().configure(power_saving);
+}
+
 int waybar::Client::main(int argc, char* argv[]) {
   bool show_help = false;
   bool show_version = false;
@@ -387,6 +415,7 @@ int waybar::Client::main(int argc, char* argv[]) {
   }
 
   bindInterfaces();
+  setupPowerSaving(m_config);
   gtk_app->hold();
   gtk_app->run();
   m_cssReloadHelper.reset();  // stop watching css file
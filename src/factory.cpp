@@ -1,5 +1,14 @@
 #include "factory.hpp"
 
+#include <giomm/dbusconnection.h>
+#include <glibmm/variant.h>
+#include <spdlog/spdlog.h>
+
+#include <exception>
+#include <map>
+#include <string_view>
+#include <vector>
+
 #include "bar.hpp"
 
 #if defined(HAVE_CHRONO_TIMEZONES) || defined(HAVE_LIBDATE)
@@ -31,6 +40,7 @@
 #include "modules/dwl/window.hpp"
 #endif
 #ifdef HAVE_HYPRLAND
+#include "modules/hyprland/backend.hpp"
 #include "modules/hyprland/language.hpp"
 #include "modules/hyprland/submap.hpp"
 #include "modules/hyprland/window.hpp"
@@ -133,8 +143,90 @@
 #include "modules/temperature.hpp"
 #include "modules/user.hpp"
 
+namespace {
+
+// A D-Bus service that a module's constructor talks to synchronously
+struct DBusService {
+  Gio::DBus::BusType bus;
+  // A session service that the module's own proxy would start anyway, so it is started ahead of
+  // it. Only the connection to the bus is made when null.
+  const char* activate = nullptr;
+};
+
+const std::map<std::string_view, std::vector<DBusService>>& moduleServices() {
+  using Gio::DBus::BusType;
+  static const std::map<std::string_view, std::vector<DBusService>> services = {
+      {"backlight", {{BusType::BUS_TYPE_SYSTEM}}},
+      {"bluetooth", {{BusType::BUS_TYPE_SYSTEM}}},
+      {"gamemode", {{BusType::BUS_TYPE_SESSION, "com.feralinteractive.GameMode"}}},
+      {"inhibitor", {{BusType::BUS_TYPE_SYSTEM}}},
+      {"mpris", {{BusType::BUS_TYPE_SESSION}}},
+      {"power-profiles-daemon", {{BusType::BUS_TYPE_SYSTEM}}},
+      {"systemd-failed-units", {{BusType::BUS_TYPE_SYSTEM}, {BusType::BUS_TYPE_SESSION}}},
+      {"tray", {{BusType::BUS_TYPE_SESSION}}},
+      {"upower", {{BusType::BUS_TYPE_SYSTEM}}},
+      {"wwan", {{BusType::BUS_TYPE_SYSTEM}}},
+  };
+  return services;
+}
+
+// Connect to the bus, so that the module's synchronous proxy calls don't wait for the handshake.
+// System services are never activated from here: configuring a module mustn't start a daemon
+// that the module itself leaves alone (e.g. bluetooth doesn't auto-start bluez).
+void startService(const DBusService& service) {
+  auto connection = Gio::DBus::Connection::get_sync(service.bus);
+  if (service.activate == nullptr) {
+    return;
+  }
+  auto args = Glib::VariantContainerBase::create_tuple(
+      {Glib::Variant<Glib::ustring>::create(service.activate),
+       Glib::Variant<guint32>::create(0)});
+  connection->call_sync("/org/freedesktop/DBus", "org.freedesktop.DBus", "StartServiceByName",
+                        args, "org.freedesktop.DBus");
+}
+
+}  // namespace
+
 waybar::Factory::Factory(const Bar& bar, const Json::Value& config) : bar_(bar), config_(config) {}
 
+std::function<void()> waybar::Factory::prepareModule(const std::string& name) {
+  const auto ref = std::string_view(name).substr(0, name.find('#'));
+#ifdef HAVE_HYPRLAND
+  if (ref.starts_with("hyprland/")) {
+    // Connects to the event socket and fetches the state that the modules read when made
+    return [] {
+      auto& state = waybar::modules::hyprland::IPC::inst().state();
+      try {
+        state.monitors();
+        state.workspaces();
+        state.clients();
+        state.activeWorkspace();
+      } catch (const std::exception& e) {
+        // The modules report it when they query Hyprland themselves
+        spdlog::debug("Couldn't fetch the Hyprland state: {}", e.what());
+      }
+    };
+  }
+#endif
+  const auto& services = moduleServices();
+  auto it = services.find(ref);
+  if (it == services.end()) {
+    return {};
+  }
+  return [&needed = it->second] {
+    for (const auto& service : needed) {
+      try {
+        startService(service);
+      } catch (const Glib::Error& e) {
+        // The module reports it when it fails to connect
+        spdlog::debug("Couldn't prepare {}: {}",
+                      service.activate != nullptr ? service.activate : "D-Bus",
+                      std::string(e.what()));
+      }
+    }
+  };
+}
+
 waybar::AModule* waybar::Factory::makeModule(const std::string& name,
                                              const std::string& pos) const {
   try {
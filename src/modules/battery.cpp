@@ -77,7 +77,7 @@ void waybar::modules::Battery::worker() {
     dp.emit();
     thread_timer_.sleep_for(interval_);
   };
-  thread_ = [this] {
+  thread_ = util::SleeperThread::Blocking{[this] {
     struct inotify_event event = {0};
     int nbytes = read(battery_watch_fd_, &event, sizeof(event));
     if (nbytes != sizeof(event) || event.mask & IN_IGNORED) {
@@ -85,8 +85,8 @@ void waybar::modules::Battery::worker() {
       return;
     }
     dp.emit();
-  };
-  thread_battery_update_ = [this] {
+  }};
+  thread_battery_update_ = util::SleeperThread::Blocking{[this] {
     poll_fds_[0].revents = 0;
     poll_fds_[0].events = POLLIN;
     poll_fds_[0].fd = udev_monitor_get_fd(mon_.get());
@@ -101,8 +101,9 @@ void waybar::modules::Battery::worker() {
     }
     refreshBatteries();
     dp.emit();
-  };
+  }};
 #endif
+  adaptPolling(thread_timer_);
 }
 
 void waybar::modules::Battery::refreshBatteries() {
@@ -767,11 +768,15 @@ auto waybar::modules::Battery::update() -> void {
     } else if (config_["tooltip-format"].isString()) {
       tooltip_format = config_["tooltip-format"].asString();
     }
-    setTooltipMarkup(
-        fmt::format(fmt::runtime(tooltip_format), fmt::arg("timeTo", tooltip_text_default),
-                    fmt::arg("power", power), fmt::arg("capacity", capacity),
-                    fmt::arg("time", time_remaining_formatted), fmt::arg("cycles", cycles),
-                    fmt::arg("health", fmt::format("{:.3}", health))));
+    setTooltipProducer([tooltip_format = std::move(tooltip_format),
+                        time_to = std::move(tooltip_text_default), power = power,
+                        capacity = capacity, time_remaining = time_remaining_formatted,
+                        cycles = cycles, health = health] {
+      return fmt::format(fmt::runtime(tooltip_format), fmt::arg("timeTo", time_to),
+                         fmt::arg("power", power), fmt::arg("capacity", capacity),
+                         fmt::arg("time", time_remaining), fmt::arg("cycles", cycles),
+                         fmt::arg("health", fmt::format("{:.3}", health)));
+    });
   }
   if (!old_status_.empty()) {
     label_.get_style_context()->remove_class(old_status_);
@@ -97,8 +97,7 @@ auto waybar::modules::cava::CavaGLSL::doAction(const std::string& name) -> void
 
 void waybar::modules::cava::CavaGLSL::pauseResume() { backend_->doPauseResume(); }
 
-auto waybar::modules::cava::CavaGLSL::onUpdate(const CavaBackend::AudioRaw& input) -> void {
-  m_data_ = input;
+auto waybar::modules::cava::CavaGLSL::onUpdate() -> void {
   if (silence_) {
     gl_area_.get_style_context()->remove_class("silent");
     if (!gl_area_.get_style_context()->has_class("updated"))
@@ -193,7 +192,9 @@ auto waybar::modules::cava::CavaGLSL::onBackendConfigChanged() -> void {
 }
 
 bool waybar::modules::cava::CavaGLSL::onRender(const Glib::RefPtr<Gdk::GLContext>& context) {
-  if (m_data_.bars_raw.empty() || shaderProgram_ == 0) return true;
+  // Borrow the backend's latest frame rather than keeping a copy of it
+  const auto& data = backend_->audioRaw();
+  if (data.bars_raw.empty() || shaderProgram_ == 0) return true;
 
   glUseProgram(shaderProgram_);
   glBindVertexArray(vao_);
@@ -203,9 +204,9 @@ bool waybar::modules::cava::CavaGLSL::onRender(const Glib::RefPtr<Gdk::GLContext
   glBindTexture(GL_TEXTURE_2D, texture_);
   glUniform1i(uniform_input_texture_, 0);
 
-  glUniform1fv(uniform_bars_, m_data_.number_of_bars, m_data_.bars_raw.data());
-  glUniform1fv(uniform_previous_bars_, m_data_.number_of_bars, m_data_.previous_bars_raw.data());
-  glUniform1i(uniform_bars_count_, m_data_.number_of_bars);
+  glUniform1fv(uniform_bars_, data.number_of_bars, data.bars_raw.data());
+  glUniform1fv(uniform_previous_bars_, data.number_of_bars, data.previous_bars_raw.data());
+  glUniform1i(uniform_bars_count_, data.number_of_bars);
   ++frame_counter_;
   glUniform1f(uniform_time_,
               static_cast<float>(frame_counter_) * backend_->getFrameTimeMilsec().count() / 1000.0f);
@@ -27,8 +27,11 @@ std::shared_ptr<waybar::modules::cava::CavaBackend> waybar::modules::cava::CavaB
 }
 
 waybar::modules::cava::CavaBackend::CavaBackend(const Json::Value& config) : config_(config) {
+  audio_raw_dp_.connect(sigc::mem_fun(*this, &CavaBackend::onAudioRaw));
+  // Frames that arrive faster than the main loop renders them are stale; only draw the latest
+  m_signal_update_.set_coalescing(true);
   loadConfig();
-  read_thread_ = [this] {
+  read_thread_ = util::SleeperThread::Blocking{[this] {
     while (read_thread_.isRunning()) {
       try {
         if (input_source_) {
@@ -51,7 +54,7 @@ waybar::modules::cava::CavaBackend::CavaBackend(const Json::Value& config) : con
       read_thread_exited_ = true;
     }
     read_thread_exit_cv_.notify_one();
-  };
+  }};
   out_thread_ = [this] {
     try {
       doUpdate(false);
@@ -186,7 +189,7 @@ void waybar::modules::cava::CavaBackend::doUpdate(bool force) {
     execute();
     if (re_paint_ == 1 || force || prm_.continuous_rendering) {
       m_signal_update_.emit(output_);
-      m_signal_audio_raw_.emit(AudioRaw{audio_raw_});
+      publishAudioRaw();
     }
   } else {
     while (adaptive_delay_.increase()) {}
@@ -195,6 +198,26 @@ void waybar::modules::cava::CavaBackend::doUpdate(bool force) {
   silence_prev_ = silence_;
 }
 
+// Called with state_mutex_ held, which serializes the producer side of the triple buffer
+void waybar::modules::cava::CavaBackend::publishAudioRaw() {
+  audio_raw_frames_.back().assign(audio_raw_);
+  audio_raw_frames_.publish();
+  // One wakeup per main loop iteration is enough, whatever was published in between is dropped
+  if (!audio_raw_pending_.exchange(true)) audio_raw_dp_.emit();
+}
+
+void waybar::modules::cava::CavaBackend::onAudioRaw() {
+  audio_raw_pending_ = false;
+  audio_raw_frames_.acquire();
+  m_signal_audio_raw_.emit();
+}
+
+const waybar::modules::cava::CavaBackend::AudioRaw&
+waybar::modules::cava::CavaBackend::audioRaw() {
+  audio_raw_frames_.acquire();
+  return audio_raw_frames_.front();
+}
+
 void waybar::modules::cava::CavaBackend::freeBackend() {
   input_source_ = nullptr;
 
@@ -21,14 +21,31 @@
 using namespace date;
 namespace fmt_lib = waybar::util::date::format;
 
+// Rendered calendars kept by a clock, see Clock::cldCache_
+constexpr std::size_t kCldCacheSize{12};
+
+// Whether a date format shows the seconds, so that text rendered from it changes every second
+static bool showsSeconds(std::string_view format) {
+  for (auto pos = format.find('%'); pos != std::string_view::npos && pos + 1 < format.size();
+       pos = format.find('%', pos + 1)) {
+    ++pos;
+    if (format[pos] == 'E' || format[pos] == 'O') {
+      if (++pos == format.size()) break;
+    }
+    if (format[pos] == 'S' || format[pos] == 'T' || format[pos] == 'r' || format[pos] == 'X' ||
+        format[pos] == 'c' || format[pos] == 's') {
+      return true;
+    }
+  }
+  return false;
+}
+
 waybar::modules::Clock::Clock(const std::string& id, const Json::Value& config)
     : ALabel(config, "clock", id, "{:%H:%M}", 60, false, false, true),
       m_locale_{std::locale(config_["locale"].isString() ? config_["locale"].asString() : "")},
       m_tlpFmt_{(config_["tooltip-format"].isString()) ? config_["tooltip-format"].asString() : ""},
       m_tooltip_{new Gtk::Label()},
       cldInTooltip_{m_tlpFmt_.find("{" + kCldPlaceholder + "}") != std::string::npos},
-      cldYearShift_{January / 1 / 1900},
-      cldMonShift_{year(1900) / January},
       tzInTooltip_{m_tlpFmt_.find("{" + kTZPlaceholder + "}") != std::string::npos},
       tzCurrIdx_{0},
       tzTooltipFormat_{config_["timezone-tooltip-format"].isString()
@@ -81,6 +98,7 @@ waybar::modules::Clock::Clock(const std::string& id, const Json::Value& config)
     if (config_[kCldPlaceholder]["iso8601"].isBool()) {
       iso8601Calendar_ = config_[kCldPlaceholder]["iso8601"].asBool();
     }
+    cldFirstDow_ = first_day_of_week();
 
     if (config_[kCldPlaceholder]["weeks-numbering"].isString()) {
       const std::string wn{config_[kCldPlaceholder]["weeks-numbering"].asString()};
@@ -113,11 +131,9 @@ waybar::modules::Clock::Clock(const std::string& id, const Json::Value& config)
       fmtMap_.insert({2, config_[kCldPlaceholder]["format"]["days"].asString()});
     else
       fmtMap_.insert({2, "{}"});
-    if (config_[kCldPlaceholder]["format"]["today"].isString()) {
+    if (config_[kCldPlaceholder]["format"]["today"].isString())
       fmtMap_.insert({3, config_[kCldPlaceholder]["format"]["today"].asString()});
-      auto local_time = zoned_time{local_zone(), system_clock::now()}.get_local_time();
-      cldBaseDay_ = year_month_day{floor<days>(local_time)}.day();
-    } else
+    else
       fmtMap_.insert({3, "{}"});
     const auto weekFmt = [this]() -> std::string {
       switch (weekNumbering_) {
@@ -128,7 +144,7 @@ waybar::modules::Clock::Clock(const std::string& id, const Json::Value& config)
         case WeekNumbering::SUNDAY:
           return "{:%U}";
         default:
-          return iso8601Calendar_ ? "{:%V}" : ((first_day_of_week() == Monday) ? "{:%W}" : "{:%U}");
+          return iso8601Calendar_ ? "{:%V}" : ((cldFirstDow_ == Monday) ? "{:%W}" : "{:%U}");
       }
     }();
     if (config_[kCldPlaceholder]["format"]["weeks"].isString() && cldWPos_ != WS::HIDDEN) {
@@ -167,16 +183,24 @@ waybar::modules::Clock::Clock(const std::string& id, const Json::Value& config)
   if (tooltipEnabled()) {
     label_.set_has_tooltip(true);
     label_.signal_query_tooltip().connect(sigc::mem_fun(*this, &Clock::query_tlp_cb));
+    event_box_.add_events(Gdk::LEAVE_NOTIFY_MASK);
+    event_box_.signal_leave_notify_event().connect([this](GdkEventCrossing*) {
+      tlpVisible_ = false;
+      return false;
+    });
   }
 
-  thread_ = [this] {
-    dp.emit();
-    thread_.sleep_for(interval_ - system_clock::now().time_since_epoch() % interval_);
-  };
+  tick_ = util::ClockTick::subscribe(interval_, [this] { dp.emit(); });
+  // The tick may be shared with clocks that already started
+  dp.emit();
 }
 
 bool waybar::modules::Clock::query_tlp_cb(int, int, bool,
                                           const Glib::RefPtr<Gtk::Tooltip>& tooltip) {
+  if (tlpStale_) {
+    renderTooltip(zoned_seconds{tlpZone_, tlpTime_});
+  }
+  tlpVisible_ = true;
   tooltip->set_custom(*m_tooltip_.get());
   return true;
 }
@@ -207,92 +231,118 @@ auto waybar::modules::Clock::update() -> void {
   }
 
   if (tooltipEnabled()) {
-    const year_month_day today{floor<days>(now.get_local_time())};
-    const auto shiftedDay{today + cldCurrShift_};
-    // choose::earliest disambiguates the DST fall-back hour (ambiguous local
-    // time) and skips forward over the spring-forward gap (nonexistent local
-    // time); without it this constructor throws and aborts Waybar every minute
-    // during a DST transition. Fixes #2615 (and its many duplicates).
-    const zoned_time shiftedNow{
-        tz, local_days(shiftedDay) + (now.get_local_time() - floor<days>(now.get_local_time())),
-        choose::earliest};
-
-    if (tzInTooltip_) tzText_ = getTZtext(now.get_sys_time());
-    if (cldInTooltip_) cldText_ = get_calendar(today, shiftedDay, tz);
-    if (ordInTooltip_) ordText_ = get_ordinal_date(shiftedDay);
-    try {
-      if (tzInTooltip_ || cldInTooltip_ || ordInTooltip_) {
-        // std::vformat doesn't support named arguments.
-        m_tlpText_ =
-            std::regex_replace(m_tlpFmt_, std::regex("\\{" + kTZPlaceholder + "\\}"), tzText_);
-        m_tlpText_ = std::regex_replace(
-            m_tlpText_, std::regex("\\{" + kCldPlaceholder + "\\}"),
-            fmt_lib::vformat(m_locale_, cldText_, fmt_lib::make_format_args(shiftedNow)));
-        m_tlpText_ =
-            std::regex_replace(m_tlpText_, std::regex("\\{" + kOrdPlaceholder + "\\}"), ordText_);
-      } else {
-        m_tlpText_ = m_tlpFmt_;
-      }
+    if (tlpVisible_) {
+      renderTooltip(now);
+      label_.trigger_tooltip_query();
+    } else {
+      tlpStale_ = true;
+      tlpZone_ = tz;
+      tlpTime_ = now.get_sys_time();
+    }
+  }
 
-      m_tlpText_ = fmt_lib::vformat(m_locale_, m_tlpText_, fmt_lib::make_format_args(now));
-    } catch (const std::exception& e) {
-      // An unsupported/invalid specifier (e.g. %-I / %OI) in the tooltip-format or the
-      // calendar format must not take the whole module down every tick. Warn once and skip
-      // the tooltip for this update so the bar keeps working.
-      static bool tlpWarned = false;
-      if (!tlpWarned) {
-        spdlog::warn(
-            "Clock: could not format tooltip \"{}\": {}. Skipping tooltip; check your "
-            "tooltip-format/calendar format specifiers.",
-            m_tlpFmt_, e.what());
-        tlpWarned = true;
-      }
-      m_tlpText_.clear();
+  ALabel::update();
+}
+
+auto waybar::modules::Clock::renderTooltip(const zoned_seconds& now) -> void {
+  const auto* tz = now.get_time_zone();
+  const year_month_day today{floor<days>(now.get_local_time())};
+  const auto shiftedDay{today + cldCurrShift_};
+  // choose::earliest disambiguates the DST fall-back hour (ambiguous local
+  // time) and skips forward over the spring-forward gap (nonexistent local
+  // time); without it this constructor throws and aborts Waybar every minute
+  // during a DST transition. Fixes #2615 (and its many duplicates).
+  const zoned_time shiftedNow{
+      tz, local_days(shiftedDay) + (now.get_local_time() - floor<days>(now.get_local_time())),
+      choose::earliest};
+
+  if (tzInTooltip_) {
+    // Only rebuilt when the time it shows changes, or its format (format-alt toggles format_)
+    const auto& tzFormat = tzTooltipFormat_.empty() ? format_ : tzTooltipFormat_;
+    auto shown = now.get_sys_time();
+    if (!showsSeconds(tzFormat)) {
+      shown = floor<minutes>(shown);
+    }
+    if (shown != tzTextTime_ || tzCurrIdx_ != tzTextIdx_ || tzFormat != tzTextFormat_) {
+      tzText_ = getTZtext(shown);
+      tzTextTime_ = shown;
+      tzTextIdx_ = tzCurrIdx_;
+      tzTextFormat_ = tzFormat;
+    }
+  }
+  if (cldInTooltip_) cldText_ = get_calendar(today, shiftedDay, tz);
+  if (ordInTooltip_) ordText_ = get_ordinal_date(shiftedDay);
+  try {
+    if (tzInTooltip_ || cldInTooltip_ || ordInTooltip_) {
+      // std::vformat doesn't support named arguments.
+      static const std::regex tzRegex{"\\{" + kTZPlaceholder + "\\}"};
+      static const std::regex cldRegex{"\\{" + kCldPlaceholder + "\\}"};
+      static const std::regex ordRegex{"\\{" + kOrdPlaceholder + "\\}"};
+      m_tlpText_ = std::regex_replace(m_tlpFmt_, tzRegex, tzText_);
+      m_tlpText_ = std::regex_replace(
+          m_tlpText_, cldRegex,
+          fmt_lib::vformat(m_locale_, cldText_, fmt_lib::make_format_args(shiftedNow)));
+      m_tlpText_ = std::regex_replace(m_tlpText_, ordRegex, ordText_);
+    } else {
+      m_tlpText_ = m_tlpFmt_;
     }
 
-    // Pango doesn't support CSS classes but to continue using it while staying
-    // backwards compatible this approach uses post-posting to replace fake
-    // classes with attributes Pango does understand.
-    //
-    // The benefit of this approach is anyone using the original styling choices
-    // can continue doing that and folks can optionally opt into using classes.
-    //
-    // It's also forwards compatible to where if this implemention ever changes
-    // to support proper classes anyone using them will continue to work.
-    auto context = label_.get_style_context();
-
-    static const std::vector<std::pair<std::string, std::string>> calendar_class_map = {
-        {"calendar-today", "class='today'"},
-        {"calendar-days", "class='days'"},
-        {"calendar-weeks", "class='weeks'"},
-        {"calendar-weekdays", "class='weekdays'"},
-        {"calendar-months", "class='months'"}};
-
-    for (const auto& [css_class, search_str] : calendar_class_map) {
-      try {
-        context->add_class(css_class);
-        const Gdk::RGBA color = context->get_color();
-        context->remove_class(css_class);
-
-        const std::string replace_str = fmt::format(
-            "color='#{:02x}{:02x}{:02x}'", static_cast<int>(color.get_red() * 255),
-            static_cast<int>(color.get_green() * 255), static_cast<int>(color.get_blue() * 255));
-
-        m_tlpText_ = std::regex_replace(m_tlpText_, std::regex(search_str), replace_str);
-      } catch (const Glib::Error& e) {
-        spdlog::warn("Clock: Failed to fetch CSS color for {}: {}", css_class, e.what().raw());
-        continue;
-      } catch (...) {
-        // Catch-all for any other weirdness.
-        continue;
-      }
+    m_tlpText_ = fmt_lib::vformat(m_locale_, m_tlpText_, fmt_lib::make_format_args(now));
+  } catch (const std::exception& e) {
+    // An unsupported/invalid specifier (e.g. %-I / %OI) in the tooltip-format or the
+    // calendar format must not take the whole module down every tick. Warn once and skip
+    // the tooltip for this update so the bar keeps working.
+    static bool tlpWarned = false;
+    if (!tlpWarned) {
+      spdlog::warn(
+          "Clock: could not format tooltip \"{}\": {}. Skipping tooltip; check your "
+          "tooltip-format/calendar format specifiers.",
+          m_tlpFmt_, e.what());
+      tlpWarned = true;
     }
+    m_tlpText_.clear();
+  }
 
-    m_tooltip_->set_markup(m_tlpText_);
-    label_.trigger_tooltip_query();
+  // Pango doesn't support CSS classes but to continue using it while staying
+  // backwards compatible this approach uses post-posting to replace fake
+  // classes with attributes Pango does understand.
+  //
+  // The benefit of this approach is anyone using the original styling choices
+  // can continue doing that and folks can optionally opt into using classes.
+  //
+  // It's also forwards compatible to where if this implemention ever changes
+  // to support proper classes anyone using them will continue to work.
+  auto context = label_.get_style_context();
+
+  static const std::vector<std::pair<std::string, std::regex>> calendar_class_map = {
+      {"calendar-today", std::regex("class='today'")},
+      {"calendar-days", std::regex("class='days'")},
+      {"calendar-weeks", std::regex("class='weeks'")},
+      {"calendar-weekdays", std::regex("class='weekdays'")},
+      {"calendar-months", std::regex("class='months'")}};
+
+  for (const auto& [css_class, search] : calendar_class_map) {
+    try {
+      context->add_class(css_class);
+      const Gdk::RGBA color = context->get_color();
+      context->remove_class(css_class);
+
+      const std::string replace_str = fmt::format(
+          "color='#{:02x}{:02x}{:02x}'", static_cast<int>(color.get_red() * 255),
+          static_cast<int>(color.get_green() * 255), static_cast<int>(color.get_blue() * 255));
+
+      m_tlpText_ = std::regex_replace(m_tlpText_, search, replace_str);
+    } catch (const Glib::Error& e) {
+      spdlog::warn("Clock: Failed to fetch CSS color for {}: {}", css_class, e.what().raw());
+      continue;
+    } catch (...) {
+      // Catch-all for any other weirdness.
+      continue;
+    }
   }
 
-  ALabel::update();
+  m_tooltip_->set_markup(m_tlpText_);
+  tlpStale_ = false;
 }
 
 auto waybar::modules::Clock::getTZtext(sys_seconds now) -> std::string {
@@ -422,33 +472,23 @@ auto getCalendarLine(const year_month_day& currDate, const year_month ym, const
 
 auto waybar::modules::Clock::get_calendar(const year_month_day& today, const year_month_day& ymd,
                                           const time_zone* tz) -> const std::string {
-  const auto firstdow{first_day_of_week()};
+  const auto firstdow{cldFirstDow_};
   const auto maxRows{12 / cldMonCols_};
   const auto ym{ymd.year() / ymd.month()};
   const auto y{ymd.year()};
   const auto d{ymd.day()};
 
+  if (today != cldCacheDay_) {
+    cldCache_.clear();
+    cldCacheDay_ = today;
+  }
+  const CldKey key{static_cast<int>(y),
+                   cldMode_ == CldMode::YEAR ? 0u : static_cast<unsigned>(ymd.month()), cldMode_,
+                   tz};
+  if (const auto it = cldCache_.find(key); it != cldCache_.end()) return it->second;
+
   std::ostringstream os;
   std::ostringstream tmp;
-
-  if (cldMode_ == CldMode::YEAR) {
-    if (y / month{1} / 1 == cldYearShift_)
-      if (d == cldBaseDay_ || (uint)cldBaseDay_ == 0u)
-        return cldYearCached_;
-      else
-        cldBaseDay_ = d;
-    else
-      cldYearShift_ = y / month{1} / 1;
-  }
-  if (cldMode_ == CldMode::MONTH) {
-    if (ym == cldMonShift_)
-      if (d == cldBaseDay_ || (uint)cldBaseDay_ == 0u)
-        return cldMonCached_;
-      else
-        cldBaseDay_ = d;
-    else
-      cldMonShift_ = ym;
-  }
   // Pad object
   const std::string pads(cldWnLen_, ' ');
   // Compute number of lines needed for each calendar month
@@ -556,12 +596,9 @@ auto waybar::modules::Clock::get_calendar(const year_month_day& today, const yea
                        fmt_lib::make_format_args(
                            static_cast<const std::string_view&&>(date::format("{:L%e}", d)))));
 
-  if (cldMode_ == CldMode::YEAR)
-    cldYearCached_ = os.str();
-  else
-    cldMonCached_ = os.str();
-
-  return os.str();
+  // Scrolling far through the calendar mustn't grow the cache without bound
+  if (cldCache_.size() >= kCldCacheSize) cldCache_.clear();
+  return cldCache_.emplace(key, os.str()).first->second;
 }
 
 auto waybar::modules::Clock::local_zone() -> const time_zone* {
@@ -14,55 +14,77 @@
 #endif
 
 waybar::modules::Cpu::Cpu(const std::string& id, const Json::Value& config)
-    : ALabel(config, "cpu", id, "{usage}%", 10) {
-  thread_ = [this] {
+    : ALabel(config, "cpu", id, "{usage}%", 10),
+      usage_(CpuUsage::subscribe(interval_, [this] { dp.emit(); })),
+      load_(Load::subscribe(interval_, [this] { firstSample(); })),
+      frequency_(CpuFrequency::subscribe(interval_, [this] { firstSample(); })) {}
+
+void waybar::modules::Cpu::firstSample() {
+  if (!ready_) {
     dp.emit();
-    thread_.sleep_for(interval_);
-  };
+  }
 }
 
 auto waybar::modules::Cpu::update() -> void {
-  // TODO: as creating dynamic fmt::arg arrays is buggy we have to calc both
-  auto [load1, load5, load15] = Load::getLoad();
-  auto [cpu_usage, tooltip] = CpuUsage::getCpuUsage(prev_times_);
-  auto [max_frequency, min_frequency, avg_frequency] = CpuFrequency::getCpuFrequency();
+  auto usage = usage_.latest();
+  auto load = load_.latest();
+  auto frequency = frequency_.latest();
+  // Each source announces its first sample, the last one to arrive updates the module
+  if (!usage || !load || !frequency) {
+    return;
+  }
+  ready_ = true;
+  const auto& [load1, load5, load15] = *load;
+  const auto& [cpu_usage, tooltip] = *usage;
+  const auto& [max_frequency, min_frequency, avg_frequency] = *frequency;
 
-  auto format = format_;
   auto total_usage = cpu_usage.empty() ? 0 : cpu_usage[0];
   auto state = getState(total_usage);
-  if (!state.empty() && config_["format-" + state].isString()) {
-    format = config_["format-" + state].asString();
-  }
+  const auto* state_format = stateFormat(state);
+  const auto& format = state_format != nullptr ? *state_format : format_;
 
   if (format.empty()) {
     event_box_.hide();
   } else {
     event_box_.show();
-    auto icons = std::vector<std::string>{state};
-    fmt::dynamic_format_arg_store<fmt::format_context> store;
-    store.push_back(fmt::arg("load", load1));
-    store.push_back(fmt::arg("load1", load1));
-    store.push_back(fmt::arg("load5", load5));
-    store.push_back(fmt::arg("load15", load15));
-    store.push_back(fmt::arg("usage", total_usage));
-    store.push_back(fmt::arg("icon", getIcon(total_usage, icons)));
-    store.push_back(fmt::arg("max_frequency", max_frequency));
-    store.push_back(fmt::arg("min_frequency", min_frequency));
-    store.push_back(fmt::arg("avg_frequency", avg_frequency));
-    std::vector<std::string> arg_names;
-    arg_names.reserve(cpu_usage.size() * 2);
-    std::string all_icons;
-    for (size_t i = 1; i < cpu_usage.size(); ++i) {
-      auto core_i = i - 1;
-      arg_names.push_back(fmt::format("usage{}", core_i));
-      store.push_back(fmt::arg(arg_names.back().c_str(), cpu_usage[i]));
-      auto core_icon = getIcon(cpu_usage[i], icons);
-      all_icons += core_icon;
-      arg_names.push_back(fmt::format("icon{}", core_i));
-      store.push_back(fmt::arg(arg_names.back().c_str(), core_icon));
+    const bool with_tooltip = tooltipEnabled();
+    const auto& tooltip_format = with_tooltip ? tooltipFormat(state, tooltip) : tooltip;
+    CpuUsage::Changes changes(rendered_usage_.get(), *usage, state != rendered_state_);
+    changes.add({"load", "load1", "load5", "load15"},
+                rendered_load_ != nullptr && *rendered_load_ != *load);
+    changes.add({"max_frequency", "min_frequency", "avg_frequency"},
+                rendered_frequency_ != nullptr && *rendered_frequency_ != *frequency);
+    const bool label_changed = label_template_.reset(format) || changes.affect(label_template_);
+    const bool tooltip_changed =
+        with_tooltip &&
+        (tooltip_template_.reset(tooltip_format) || changes.affect(tooltip_template_));
+
+    if (label_changed || tooltip_changed) {
+      const auto& icons = icons_.select(state);
+      auto store = std::make_shared<FormatArgs>();
+      store->push_back(fmt::arg("load", load1));
+      store->push_back(fmt::arg("load1", load1));
+      store->push_back(fmt::arg("load5", load5));
+      store->push_back(fmt::arg("load15", load15));
+      store->push_back(fmt::arg("usage", total_usage));
+      store->push_back(fmt::arg("icon", icons.get(total_usage)));
+      store->push_back(fmt::arg("max_frequency", max_frequency));
+      store->push_back(fmt::arg("min_frequency", min_frequency));
+      store->push_back(fmt::arg("avg_frequency", avg_frequency));
+      core_args_.push(*store,
+                      CpuUsage::CoreArgs::referenced({&label_template_, &tooltip_template_}),
+                      cpu_usage, icons);
+      if (label_changed) {
+        setLabelMarkup(fmt::vformat(format, *store));
+      }
+      if (tooltip_changed) {
+        setTooltipFormat(tooltip_format, std::move(store));
+      }
     }
-    store.push_back(fmt::arg("icons", all_icons));
-    updateLabelAndTooltipForState(state, format, tooltip, store);
+    rendered_usage_ = usage;
+    rendered_load_ = load;
+    rendered_frequency_ = frequency;
+    rendered_state_ = state;
   }
 
   // Call parent update
@@ -3,8 +3,9 @@
 
 #include "modules/cpu_frequency.hpp"
 
-std::vector<float> waybar::modules::CpuFrequency::parseCpuFrequencies() {
-  std::vector<float> frequencies;
+void waybar::modules::CpuFrequency::parseCpuFrequencies(SamplerState& state) {
+  auto& frequencies = state.frequencies;
+  frequencies.clear();
   size_t len;
   int32_t freq;
 
@@ -29,6 +30,4 @@ std::vector<float> waybar::modules::CpuFrequency::parseCpuFrequencies() {
     spdlog::warn("cpu/bsd: parseCpuFrequencies failed, not found in sysctl");
     frequencies.push_back(NAN);
   }
-
-  return frequencies;
 }
@@ -10,21 +10,30 @@
 #endif
 
 waybar::modules::CpuFrequency::CpuFrequency(const std::string& id, const Json::Value& config)
-    : ALabel(config, "cpu_frequency", id, "{avg_frequency}", 10) {
-  thread_ = [this] {
-    dp.emit();
-    thread_.sleep_for(interval_);
-  };
+    : ALabel(config, "cpu_frequency", id, "{avg_frequency}", 10),
+      frequency_(subscribe(interval_, [this] { dp.emit(); })) {}
+
+auto waybar::modules::CpuFrequency::subscribe(std::chrono::milliseconds interval,
+                                              const sigc::slot<void()>& slot)
+    -> util::SampleSubscription<Sample> {
+  return util::SampleHub<Sample>::subscribe(
+      "cpu_frequency", interval,
+      [] { return [state = std::make_shared<SamplerState>()] { return getCpuFrequency(*state); }; },
+      slot);
 }
 
 auto waybar::modules::CpuFrequency::update() -> void {
+  auto sample = frequency_.latest();
+  if (!sample) {
+    return;
+  }
   // TODO: as creating dynamic fmt::arg arrays is buggy we have to calc both
-  auto [max_frequency, min_frequency, avg_frequency] = CpuFrequency::getCpuFrequency();
+  const auto& [max_frequency, min_frequency, avg_frequency] = *sample;
 
   auto format = format_;
   auto state = getState(avg_frequency);
-  if (!state.empty() && config_["format-" + state].isString()) {
-    format = config_["format-" + state].asString();
+  if (const auto* state_format = stateFormat(state)) {
+    format = *state_format;
   }
 
   if (format.empty()) {
@@ -44,8 +53,10 @@ auto waybar::modules::CpuFrequency::update() -> void {
   ALabel::update();
 }
 
-std::tuple<float, float, float> waybar::modules::CpuFrequency::getCpuFrequency() {
-  std::vector<float> frequencies = CpuFrequency::parseCpuFrequencies();
+std::tuple<float, float, float> waybar::modules::CpuFrequency::getCpuFrequency(
+    SamplerState& state) {
+  CpuFrequency::parseCpuFrequencies(state);
+  const auto& frequencies = state.frequencies;
   if (frequencies.empty()) {
     return {0.f, 0.f, 0.f};
   }
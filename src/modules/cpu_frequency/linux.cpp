@@ -1,25 +1,29 @@
 #include <filesystem>
 
 #include "modules/cpu_frequency.hpp"
+#include "util/procfs.hpp"
 
-std::vector<float> waybar::modules::CpuFrequency::parseCpuFrequencies() {
-  const std::string file_path_ = "/proc/cpuinfo";
-  std::ifstream info(file_path_);
-  if (!info.is_open()) {
-    throw std::runtime_error("Can't open " + file_path_);
-  }
-  std::vector<float> frequencies;
-  std::string line;
-  while (getline(info, line)) {
-    if (line.substr(0, 7).compare("cpu MHz") != 0) {
-      continue;
+void waybar::modules::CpuFrequency::parseCpuFrequencies(SamplerState& state) {
+  auto& frequencies = state.frequencies;
+  // Kept open as long as the shared source and re-read with pread()
+  auto text = state.cpuinfo_file.read();
+  frequencies.clear();
+  util::procfs::forEachLine(text, [&frequencies](std::string_view line) {
+    if (!line.starts_with("cpu MHz")) {
+      return true;
     }
-
-    std::string frequency_str = line.substr(line.find(":") + 2);
-    float frequency = std::strtol(frequency_str.c_str(), nullptr, 10);
-    frequencies.push_back(frequency);
-  }
-  info.close();
+    auto colon = line.find(':');
+    if (colon == std::string_view::npos) {
+      return true;
+    }
+    // Whole MHz are enough, the value is rounded to tens of MHz later on
+    auto frequency_str = line.substr(colon + 1);
+    long frequency = 0;
+    if (util::procfs::consumeNumber(frequency_str, frequency)) {
+      frequencies.push_back(frequency);
+    }
+    return true;
+  });
 
   if (frequencies.size() <= 0) {
     std::string cpufreq_dir = "/sys/devices/system/cpu/cpufreq";
@@ -40,6 +44,4 @@ std::vector<float> waybar::modules::CpuFrequency::parseCpuFrequencies() {
     } catch (const std::filesystem::filesystem_error&) {
     }
   }
-
-  return frequencies;
 }
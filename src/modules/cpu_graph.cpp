@@ -14,16 +14,15 @@
 #endif
 
 waybar::modules::CpuGraph::CpuGraph(const std::string& id, const Json::Value& config)
-    : AGraph(config, "cpu_graph", id, 5) {
-  thread_ = [this] {
-    dp.emit();
-    thread_.sleep_for(interval_);
-  };
-}
+    : AGraph(config, "cpu_graph", id, 5),
+      usage_(CpuUsage::subscribe(interval_, [this] { dp.emit(); })) {}
 
 auto waybar::modules::CpuGraph::update() -> void {
-  // TODO: as creating dynamic fmt::arg arrays is buggy we have to calc both
-  auto [cpu_usage, tooltip] = CpuUsage::getCpuUsage(prev_times_);
+  auto sample = usage_.latest();
+  if (!sample) {
+    return;
+  }
+  const auto& [cpu_usage, tooltip] = *sample;
   if (tooltipEnabled()) {
     graph_.set_tooltip_text(tooltip);
   }
@@ -9,62 +9,154 @@
 #include <fmt/core.h>
 #endif
 
+#include <algorithm>
+#include <iterator>
+
+namespace {
+uint16_t totalUsage(const std::vector<uint16_t>& usage) { return usage.empty() ? 0 : usage[0]; }
+}  // namespace
+
 waybar::modules::CpuUsage::CpuUsage(const std::string& id, const Json::Value& config)
-    : ALabel(config, "cpu_usage", id, "{usage}%", 10) {
-  thread_ = [this] {
-    dp.emit();
-    thread_.sleep_for(interval_);
-  };
-}
+    : ALabel(config, "cpu_usage", id, "{usage}%", 10),
+      usage_(subscribe(interval_, [this] { dp.emit(); })) {}
 
 auto waybar::modules::CpuUsage::update() -> void {
-  // TODO: as creating dynamic fmt::arg arrays is buggy we have to calc both
-  auto [cpu_usage, tooltip] = CpuUsage::getCpuUsage(prev_times_);
+  auto sample = usage_.latest();
+  if (!sample) {
+    return;
+  }
+  const auto& [cpu_usage, tooltip] = *sample;
 
-  auto format = format_;
-  auto total_usage = cpu_usage.empty() ? 0 : cpu_usage[0];
+  auto total_usage = totalUsage(cpu_usage);
   auto state = getState(total_usage);
-  if (!state.empty() && config_["format-" + state].isString()) {
-    format = config_["format-" + state].asString();
-  }
+  const auto* state_format = stateFormat(state);
+  const auto& format = state_format != nullptr ? *state_format : format_;
 
   if (format.empty()) {
     event_box_.hide();
   } else {
     event_box_.show();
-    auto icons = std::vector<std::string>{state};
-    fmt::dynamic_format_arg_store<fmt::format_context> store;
-    store.push_back(fmt::arg("usage", total_usage));
-    store.push_back(fmt::arg("icon", getIcon(total_usage, icons)));
-    std::vector<std::string> arg_names;
-    arg_names.reserve(cpu_usage.size() * 2);
-    std::string all_icons;
-    for (size_t i = 1; i < cpu_usage.size(); ++i) {
-      auto core_i = i - 1;
-      arg_names.push_back(fmt::format("usage{}", core_i));
-      store.push_back(fmt::arg(arg_names.back().c_str(), cpu_usage[i]));
-      auto core_icon = getIcon(cpu_usage[i], icons);
-      all_icons += core_icon;
-      arg_names.push_back(fmt::format("icon{}", core_i));
-      store.push_back(fmt::arg(arg_names.back().c_str(), core_icon));
+    const bool with_tooltip = tooltipEnabled();
+    const auto& tooltip_format = with_tooltip ? tooltipFormat({}, tooltip) : tooltip;
+    const Changes changes(rendered_.get(), *sample, state != rendered_state_);
+    const bool label_changed = label_template_.reset(format) || changes.affect(label_template_);
+    const bool tooltip_changed =
+        with_tooltip &&
+        (tooltip_template_.reset(tooltip_format) || changes.affect(tooltip_template_));
+
+    if (label_changed || tooltip_changed) {
+      const auto& icons = icons_.select(state);
+      auto store = std::make_shared<FormatArgs>();
+      store->push_back(fmt::arg("usage", total_usage));
+      store->push_back(fmt::arg("icon", icons.get(total_usage)));
+      core_args_.push(*store, CoreArgs::referenced({&label_template_, &tooltip_template_}),
+                      cpu_usage, icons);
+      if (label_changed) {
+        setLabelMarkup(fmt::vformat(format, *store));
+      }
+      if (tooltip_changed) {
+        setTooltipFormat(tooltip_format, std::move(store));
+      }
     }
-    store.push_back(fmt::arg("icons", all_icons));
-    updateLabelAndTooltip(format, tooltip, store);
+    rendered_ = sample;
+    rendered_state_ = state;
   }
 
   // Call parent update
   ALabel::update();
 }
 
+auto waybar::modules::CpuUsage::CoreArgs::referenced(
+    std::initializer_list<const util::FormatTemplate*> templates) -> Refs {
+  Refs refs;
+  for (const auto* tpl : templates) {
+    refs.usage = refs.usage || tpl->referencesIndexed("usage");
+    refs.icon = refs.icon || tpl->referencesIndexed("icon");
+    refs.icons = refs.icons || tpl->references("icons");
+  }
+  return refs;
+}
+
+void waybar::modules::CpuUsage::CoreArgs::push(
+    fmt::dynamic_format_arg_store<fmt::format_context>& store, Refs refs,
+    const std::vector<uint16_t>& usage, const util::IconTable::Set& icons) {
+  if (!refs.any()) {
+    return;
+  }
+  const auto cores = usage.empty() ? 0 : usage.size() - 1;
+  for (auto core = usage_names_.size(); core < cores; ++core) {
+    usage_names_.push_back(fmt::format("usage{}", core));
+    icon_names_.push_back(fmt::format("icon{}", core));
+  }
+
+  std::string all_icons;
+  for (std::size_t core = 0; core < cores; ++core) {
+    const auto value = usage[core + 1];
+    if (refs.usage) {
+      store.push_back(fmt::arg(usage_names_[core].c_str(), value));
+    }
+    if (refs.icon || refs.icons) {
+      const auto& icon = icons.get(value);
+      if (refs.icon) {
+        store.push_back(fmt::arg(icon_names_[core].c_str(), std::cref(icon)));
+      }
+      if (refs.icons) {
+        all_icons += icon;
+      }
+    }
+  }
+  if (refs.icons) {
+    store.push_back(fmt::arg("icons", all_icons));
+  }
+}
+
+waybar::modules::CpuUsage::Changes::Changes(const Sample* rendered, const Sample& sample,
+                                             bool state_changed)
+    : all_(rendered == nullptr || state_changed),
+      total_(all_ || totalUsage(std::get<0>(*rendered)) != totalUsage(std::get<0>(sample))),
+      cores_(all_ || std::get<0>(*rendered) != std::get<0>(sample)) {}
+
+void waybar::modules::CpuUsage::Changes::add(std::initializer_list<std::string_view> names,
+                                             bool changed) {
+  if (changed) {
+    names_.insert(names_.end(), names.begin(), names.end());
+  }
+}
+
+bool waybar::modules::CpuUsage::Changes::affect(const util::FormatTemplate& tpl) const {
+  if (all_ || (total_ && (tpl.references("usage") || tpl.references("icon")))) {
+    return true;
+  }
+  if (cores_ && (tpl.referencesIndexed("usage") || tpl.referencesIndexed("icon") ||
+                 tpl.references("icons"))) {
+    return true;
+  }
+  return std::any_of(names_.begin(), names_.end(),
+                     [&](auto name) { return tpl.references(name); });
+}
+
+auto waybar::modules::CpuUsage::subscribe(std::chrono::milliseconds interval,
+                                          const sigc::slot<void()>& slot)
+    -> util::SampleSubscription<Sample> {
+  return util::SampleHub<Sample>::subscribe(
+      "cpu_usage", interval,
+      [] { return [state = std::make_shared<SamplerState>()] { return getCpuUsage(*state); }; },
+      slot);
+}
+
 std::tuple<std::vector<uint16_t>, std::string> waybar::modules::CpuUsage::getCpuUsage(
-    std::vector<std::tuple<size_t, size_t>>& prev_times) {
+    SamplerState& state) {
+  auto& prev_times = state.prev_times;
+  auto& curr_times = state.curr_times;
   if (prev_times.empty()) {
-    prev_times = CpuUsage::parseCpuinfo();
+    // Only ever reached on a SampleHub worker thread, never on the GTK main loop
+    CpuUsage::parseCpuinfo(state, prev_times);
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
   }
-  std::vector<std::tuple<size_t, size_t>> curr_times = CpuUsage::parseCpuinfo();
+  CpuUsage::parseCpuinfo(state, curr_times);
   std::string tooltip;
   std::vector<uint16_t> usage;
+  usage.reserve(curr_times.size());
 
   if (curr_times.size() != prev_times.size()) {
     // The number of CPUs has changed, eg. due to CPU hotplug
@@ -83,7 +175,7 @@ std::tuple<std::vector<uint16_t>, std::string> waybar::modules::CpuUsage::getCpu
       tooltip = "(pending)";
       usage.push_back(0);
     }
-    prev_times = curr_times;
+    std::swap(prev_times, curr_times);
     return {usage, tooltip};
   }
 
@@ -92,7 +184,7 @@ std::tuple<std::vector<uint16_t>, std::string> waybar::modules::CpuUsage::getCpu
     auto [prev_idle, prev_total] = prev_times[i];
     if (i > 0 && (curr_total == 0 || prev_total == 0)) {
       // This CPU is offline
-      tooltip = tooltip + fmt::format("\nCore{}: offline", i - 1);
+      fmt::format_to(std::back_inserter(tooltip), "\nCore{}: offline", i - 1);
       usage.push_back(0);
       continue;
     }
@@ -101,12 +193,12 @@ std::tuple<std::vector<uint16_t>, std::string> waybar::modules::CpuUsage::getCpu
     uint16_t tmp =
         (delta_total > 0) ? static_cast<uint16_t>(100 * (1 - delta_idle / delta_total)) : 0;
     if (i == 0) {
-      tooltip = fmt::format("Total: {}%", tmp);
+      fmt::format_to(std::back_inserter(tooltip), "Total: {}%", tmp);
     } else {
-      tooltip = tooltip + fmt::format("\nCore{}: {}%", i - 1, tmp);
+      fmt::format_to(std::back_inserter(tooltip), "\nCore{}: {}%", i - 1, tmp);
     }
     usage.push_back(tmp);
   }
-  prev_times = curr_times;
+  std::swap(prev_times, curr_times);
   return {usage, tooltip};
 }
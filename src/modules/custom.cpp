@@ -3,28 +3,37 @@
 #include <spdlog/spdlog.h>
 
 #include <cerrno>
+#include <map>
 #include <stdexcept>
 #include <utility>
 
+#include "util/pixbuf_cache.hpp"
+
+namespace {
+bool isDaemon(const Json::Value& config) {
+  return config["daemon"].isBool() && config["daemon"].asBool() && config["exec"].isString();
+}
+}  // namespace
+
 waybar::modules::Custom::Custom(const std::string& name, const std::string& id,
                                 const Json::Value& config, const std::string& output_name)
-    : AIconLabel(config, "custom-" + name, id, "{}"),
+    : AIconLabel(config, "custom-" + name, id, "{}", 0, false,
+                 // Every click and scroll is forwarded to a daemon
+                 isDaemon(config), isDaemon(config)),
       name_(name),
       output_name_(output_name),
       id_(id),
       tooltip_format_enabled_{config_["tooltip-format"].isString()},
-      percentage_(0) {
+      percentage_(0),
+      daemon_(isDaemon(config)) {
   if (config.isNull()) {
     spdlog::warn("There is no configuration for 'custom/{}', element will be hidden", name);
   }
 
-  if (!config_["signal"].empty() && config_["interval"].empty() &&
-      config_["restart-interval"].empty()) {
-    waitingWorker();
-  } else if (interval_.count() > 0) {
-    delayWorker();
-  } else if (config_["exec"].isString()) {
-    continuousWorker();
+  script_ = CustomScript::get(config_, name_, output_name_, interval_);
+  script_->subscribe(this, [this](const util::command::res& output) { handleOutput(output); });
+  if (script_->mode() == CustomScript::Mode::NONE && interval_.count() > 0) {
+    dp.emit();
   }
   if (config_["image-path"].isString()) {
     image_path_ = config_["image-path"].asString();
@@ -38,148 +47,73 @@ waybar::modules::Custom::Custom(const std::string& name, const std::string& id,
 }
 
 waybar::modules::Custom::~Custom() {
-  restart_connection_.disconnect();
-  if (continuous_stream_) {
-    continuous_stream_->stop();
+  script_->unsubscribe(this);
+  if (output_.skipped() > 0) {
+    spdlog::debug("custom/{}: {} outputs were replaced before being shown", name_,
+                  output_.skipped());
   }
 }
 
-void waybar::modules::Custom::delayWorker() {
-  if (!config_["exec"].isString() && !config_["exec-if"].isString()) {
-    dp.emit();
-    return;
-  }
-
-  thread_ = [this] {
-    for (auto it = this->pid_children_.begin(); it != this->pid_children_.end();) {
-      int status = 0;
-      const auto pid = static_cast<pid_t>(*it);
-      const auto waited = waitpid(pid, &status, WNOHANG);
-      if (waited == 0) {
-        ++it;
-        continue;
-      }
-      if (waited == -1 && errno != ECHILD) {
-        ++it;
-        continue;
-      }
-      it = this->pid_children_.erase(it);
-    }
-
-    bool can_update = true;
-    if (config_["exec-if"].isString()) {
-      output_ = util::command::execNoRead(config_["exec-if"].asString());
-      if (output_.exit_code != 0) {
-        can_update = false;
-        dp.emit();
-      }
-    }
-    if (can_update) {
-      if (config_["exec"].isString()) {
-        output_ = util::command::exec(config_["exec"].asString(), output_name_);
-      }
-      dp.emit();
-    }
-    thread_.sleep_for(interval_);
-  };
-}
-
-void waybar::modules::Custom::continuousWorker() {
-  continuous_stream_ = std::make_unique<util::command::LineStream>(
-      output_name_,
-      [this](const std::string& output) {
-        output_ = {.exit_code = 0, .out = output};
-        dp.emit();
-      },
-      [this](int exit_code) { handleContinuousProcessExit(exit_code); });
-  startContinuousProcess(true);
+void waybar::modules::Custom::handleOutput(const util::command::res& output) {
+  // May run on a pool worker; update() picks the output up on the GTK thread
+  output_.publish(output);
+  dp.emit();
 }
 
-void waybar::modules::Custom::startContinuousProcess(bool throw_on_failure) {
-  const auto cmd = config_["exec"].asString();
-
-  try {
-    continuous_stream_->start(cmd);
-  } catch (const Glib::SpawnError& e) {
-    if (throw_on_failure) {
-      throw std::runtime_error("Unable to open " + cmd + ": " + e.what().raw());
+void waybar::modules::Custom::reapChildren() {
+  for (auto it = this->pid_children_.begin(); it != this->pid_children_.end();) {
+    int status = 0;
+    const auto pid = static_cast<pid_t>(*it);
+    const auto waited = waitpid(pid, &status, WNOHANG);
+    if (waited == 0) {
+      ++it;
+      continue;
     }
-    output_ = {.exit_code = 1, .out = ""};
-    dp.emit();
-    spdlog::error("Unable to restart {}: {}", name_, e.what().raw());
-    scheduleContinuousRestart();
-  } catch (const std::exception& e) {
-    if (throw_on_failure) {
-      throw;
+    if (waited == -1 && errno != ECHILD) {
+      ++it;
+      continue;
     }
-    output_ = {.exit_code = 1, .out = ""};
-    dp.emit();
-    spdlog::error("Unable to restart {}: {}", name_, e.what());
-    scheduleContinuousRestart();
-  }
-}
-
-void waybar::modules::Custom::handleContinuousProcessExit(int exit_code) {
-  if (exit_code != 0) {
-    output_ = {.exit_code = exit_code, .out = ""};
-    dp.emit();
-    spdlog::error("{} stopped unexpectedly, is it endless?", name_);
-  }
-
-  scheduleContinuousRestart();
-}
-
-void waybar::modules::Custom::scheduleContinuousRestart() {
-  restart_connection_.disconnect();
-  if (!config_["restart-interval"].isNumeric() || config_["restart-interval"].asDouble() <= 0) {
-    // A non-positive restart-interval must not busy-respawn the script
-    // (that starves the GTK main loop); treat it as "do not restart".
-    return;
+    it = this->pid_children_.erase(it);
   }
-
-  restart_connection_ = Glib::signal_timeout().connect(
-      [this] {
-        startContinuousProcess(false);
-        return false;
-      },
-      std::max(1U, static_cast<unsigned>(config_["restart-interval"].asDouble() * 1000)));
-}
-
-void waybar::modules::Custom::waitingWorker() {
-  thread_ = [this] {
-    bool can_update = true;
-    if (config_["exec-if"].isString()) {
-      output_ = util::command::execNoRead(config_["exec-if"].asString());
-      if (output_.exit_code != 0) {
-        can_update = false;
-        dp.emit();
-      }
-    }
-    if (can_update) {
-      if (config_["exec"].isString()) {
-        output_ = util::command::exec(config_["exec"].asString(), output_name_);
-      }
-      dp.emit();
-    }
-    thread_.sleep();
-  };
 }
 
 void waybar::modules::Custom::refresh(int sig) {
 #ifdef SIGRTMIN
   if (config_["signal"].isInt() && sig == SIGRTMIN + config_["signal"].asInt()) {
-    thread_.wake_up();
+    script_->refresh();
   }
 #endif
 }
 
+void waybar::modules::Custom::suspend() { script_->pause(this); }
+
+void waybar::modules::Custom::resume() { script_->resume(this); }
+
+bool waybar::modules::Custom::execOnEvent() const {
+  return !config_["exec-on-event"].isBool() || config_["exec-on-event"].asBool();
+}
+
 void waybar::modules::Custom::handleEvent() {
-  if (!config_["exec-on-event"].isBool() || config_["exec-on-event"].asBool()) {
-    thread_.wake_up();
+  if (execOnEvent()) {
+    script_->event("update");
   }
 }
 
 bool waybar::modules::Custom::handleScroll(GdkEventScroll* e) {
+  if (daemon_) {
+    static const std::map<SCROLL_DIR, std::string_view> directions = {
+        {SCROLL_DIR::UP, "up"},
+        {SCROLL_DIR::DOWN, "down"},
+        {SCROLL_DIR::LEFT, "left"},
+        {SCROLL_DIR::RIGHT, "right"}};
+    // Smooth scrolling accumulates deltas, so the direction must be read only once
+    const auto dir = getScrollDir(e);
+    auto name = directions.find(dir);
+    if (name != directions.end() && execOnEvent()) {
+      script_->event(fmt::format("scroll {}", name->second));
+    }
+    return handleScrollDir(dir);
+  }
   auto ret = ALabel::handleScroll(e);
   handleEvent();
   return ret;
@@ -187,14 +121,28 @@ bool waybar::modules::Custom::handleScroll(GdkEventScroll* e) {
 
 bool waybar::modules::Custom::handleToggle(GdkEventButton* const& e) {
   auto ret = ALabel::handleToggle(e);
+  if (daemon_) {
+    static const std::map<guint, std::string_view> buttons = {
+        {1, "left"}, {2, "middle"}, {3, "right"}, {8, "backward"}, {9, "forward"}};
+    if (e->type == GDK_BUTTON_PRESS && execOnEvent()) {
+      auto button = buttons.find(e->button);
+      script_->event(button != buttons.end() ? fmt::format("click {}", button->second)
+                                             : fmt::format("click {}", e->button));
+    }
+    return ret;
+  }
   handleEvent();
   return ret;
 }
 
 auto waybar::modules::Custom::update() -> void {
+  reapChildren();
+  output_.acquire();
+  const auto& output = output_.current();
+
   // Hide label if output is empty
   if ((config_["exec"].isString() || config_["exec-if"].isString()) &&
-      (output_.out.empty() || output_.exit_code != 0)) {
+      (output.out.empty() || output.exit_code != 0)) {
     event_box_.hide();
   } else {
     if (config_["return-type"].asString() == "json") {
@@ -256,8 +204,8 @@ auto waybar::modules::Custom::update() -> void {
         event_box_.show();
         if (!image_path_.empty()) {
           try {
-            auto pixbuf =
-                Gdk::Pixbuf::create_from_file(image_path_, app_icon_size_, app_icon_size_);
+            auto pixbuf = util::PixbufCache::instance().fromFile(image_path_, app_icon_size_,
+                                                                 app_icon_size_);
             image_.set(pixbuf);
           } catch (const Glib::Error& e) {
             spdlog::warn("custom {}: failed to load image-path '{}': {}", name_, image_path_,
@@ -292,7 +240,7 @@ auto waybar::modules::Custom::update() -> void {
 }
 
 void waybar::modules::Custom::parseOutputRaw() {
-  std::istringstream output(output_.out);
+  std::istringstream output(output_.current().out);
   std::string line;
   int i = 0;
   while (getline(output, line)) {
@@ -327,7 +275,7 @@ void waybar::modules::Custom::parseOutputRaw() {
 }
 
 void waybar::modules::Custom::parseOutputJson() {
-  std::istringstream output(output_.out);
+  std::istringstream output(output_.current().out);
   std::string line;
   class_.clear();
   // A script can emit invalid UTF-8; passing it unchecked to Pango/GTK aborts
@@ -3,11 +3,15 @@
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <cerrno>
 #include <cmath>
 #include <stdexcept>
 #include <string>
+#include <utility>
 
+#include "util/command_pool.hpp"
 #include "util/scope_guard.hpp"
+#include "util/timer_scheduler.hpp"
 
 waybar::modules::CustomGraph::CustomGraph(const std::string& name, const std::string& id,
                                           const Json::Value& config, const std::string& output_name)
@@ -25,57 +29,66 @@ waybar::modules::CustomGraph::CustomGraph(const std::string& name, const std::st
 
   if (!config_["signal"].empty() && config_["interval"].empty() &&
       config_["restart-interval"].empty()) {
-    waitingWorker();
+    mode_ = Mode::WAIT;
+    schedule(std::chrono::milliseconds::zero());
   } else if (interval_.count() > 0) {
-    delayWorker();
+    mode_ = Mode::POLL;
+    schedule(std::chrono::milliseconds::zero());
   } else if (config_["exec"].isString()) {
+    mode_ = Mode::CONTINUOUS;
     continuousWorker();
   }
 }
 
 waybar::modules::CustomGraph::~CustomGraph() {
-  if (pid_ != -1) {
-    killpg(pid_, SIGTERM);
-    waitpid(pid_, NULL, 0);
-    pid_ = -1;
+  util::command::Pool::instance().cancel(this);
+  // The continuous worker replaces the script when it restarts it
+  const int pid = pid_.exchange(-1);
+  if (pid != -1) {
+    killpg(pid, SIGTERM);
+    waitpid(pid, NULL, 0);
+  }
+  if (output_.skipped() > 0) {
+    spdlog::debug("custom-graph/{}: {} outputs were superseded before the graph took them",
+                  name_, output_.skipped());
   }
 }
 
-void waybar::modules::CustomGraph::delayWorker() {
-  thread_ = [this] {
-    for (int i : this->pid_children_) {
-      int status;
-      waitpid(i, &status, 0);
-    }
-
-    this->pid_children_.clear();
-
-    bool can_update = true;
-    if (config_["exec-if"].isString()) {
-      output_ = util::command::execNoRead(config_["exec-if"].asString());
-      if (output_.exit_code != 0) {
-        can_update = false;
-        dp.emit();
-      }
-    }
-    if (can_update) {
-      if (config_["exec"].isString()) {
-        output_ = util::command::exec(config_["exec"].asString(), output_name_);
-      }
-      dp.emit();
-    }
-    thread_.sleep_for(interval_);
-  };
+void waybar::modules::CustomGraph::schedule(std::chrono::milliseconds delay) {
+  util::command::Pool::instance().submit(
+      this,
+      [this](std::stop_token stop) {
+        runScript(stop);
+        if (stop.stop_requested()) {
+          return;
+        }
+        // "once" runs again only when woken up
+        if (mode_ != Mode::POLL || interval_ == std::chrono::milliseconds::max()) {
+          return;
+        }
+        {
+          std::lock_guard lock(pause_mutex_);
+          if (paused_) {
+            // Runs again on resume()
+            parked_ = true;
+            return;
+          }
+        }
+        schedule(interval_ * util::TimerScheduler::instance().stretch());
+      },
+      // The script has no timeout
+      delay, false);
 }
 
 void waybar::modules::CustomGraph::continuousWorker() {
   auto cmd = config_["exec"].asString();
-  pid_ = -1;
-  fp_ = util::command::open(cmd, pid_, output_name_);
+  int pid = -1;
+  fp_ = util::command::open(cmd, pid, output_name_);
+  pid_ = pid;
   if (!fp_) {
     throw std::runtime_error("Unable to open " + cmd);
   }
-  thread_ = [this, cmd] {
+  thread_ = util::SleeperThread::Blocking{[this, cmd] {
     char* buff = nullptr;
     waybar::util::ScopeGuard buff_deleter([&buff]() {
       if (buff) {
@@ -90,18 +103,20 @@ void waybar::modules::CustomGraph::continuousWorker() {
         fp_ = nullptr;
       }
       if (exit_code != 0) {
-        output_ = {exit_code, ""};
+        output_.publish({exit_code, ""});
         dp.emit();
         spdlog::error("{} stopped unexpectedly, is it endless?", name_);
       }
       if (config_["restart-interval"].isUInt()) {
         pid_ = -1;
         thread_.sleep_for(std::chrono::seconds(config_["restart-interval"].asUInt()));
-        fp_ = util::command::open(cmd, pid_, output_name_);
+        int pid = -1;
+        fp_ = util::command::open(cmd, pid, output_name_);
+        pid_ = pid;
         if (!fp_) {
           // Letting this exception escape the SleeperThread would call
           // std::terminate and kill all of Waybar. Degrade gracefully instead.
-          output_ = {1, ""};
+          output_.publish({1, ""});
           dp.emit();
           spdlog::error("Unable to restart {}: unable to open {}", name_, cmd);
           thread_.stop();
@@ -118,43 +133,75 @@ void waybar::modules::CustomGraph::continuousWorker() {
       if (!output.empty() && output[output.length() - 1] == '\n') {
         output.erase(output.length() - 1);
       }
-      output_ = {0, output};
+      output_.publish({0, output});
       dp.emit();
     }
-  };
+  }};
 }
 
-void waybar::modules::CustomGraph::waitingWorker() {
-  thread_ = [this] {
-    bool can_update = true;
-    if (config_["exec-if"].isString()) {
-      output_ = util::command::execNoRead(config_["exec-if"].asString());
-      if (output_.exit_code != 0) {
-        can_update = false;
-        dp.emit();
-      }
-    }
-    if (can_update) {
-      if (config_["exec"].isString()) {
-        output_ = util::command::exec(config_["exec"].asString(), output_name_);
-      }
-      dp.emit();
-    }
-    thread_.sleep();
-  };
+void waybar::modules::CustomGraph::runScript(std::stop_token stop) {
+  util::command::res output{};
+  if (config_["exec-if"].isString()) {
+    output = util::command::run(config_["exec-if"].asString(),
+                                {.stop = stop, .discard_output = true});
+  }
+  if (output.exit_code == 0 && config_["exec"].isString() && !stop.stop_requested()) {
+    output = util::command::run(config_["exec"].asString(),
+                                {.output_name = output_name_, .stop = stop});
+  }
+  if (stop.stop_requested()) {
+    // The module is going away
+    return;
+  }
+  output_.publish(std::move(output));
+  dp.emit();
+}
+
+void waybar::modules::CustomGraph::reapChildren() {
+  // Clicks spawn on-click commands on the GTK thread; collect the ones that exited
+  std::erase_if(this->pid_children_, [](int pid) {
+    const auto waited = waitpid(pid, nullptr, WNOHANG);
+    return waited != 0 && (waited != -1 || errno == ECHILD);
+  });
 }
 
 void waybar::modules::CustomGraph::refresh(int sig) {
 #ifdef SIGRTMIN
   if (config_["signal"].isInt() && sig == SIGRTMIN + config_["signal"].asInt()) {
-    thread_.wake_up();
+    wakeUp();
   }
 #endif
 }
 
+void waybar::modules::CustomGraph::suspend() {
+  std::lock_guard lock(pause_mutex_);
+  paused_ = true;
+}
+
+void waybar::modules::CustomGraph::resume() {
+  bool run_now = false;
+  {
+    std::lock_guard lock(pause_mutex_);
+    paused_ = false;
+    run_now = std::exchange(parked_, false);
+  }
+  if (run_now) {
+    schedule(std::chrono::milliseconds::zero());
+  }
+}
+
+void waybar::modules::CustomGraph::wakeUp() {
+  if (mode_ == Mode::CONTINUOUS) {
+    // Cuts the wait before a restart short
+    thread_.wake_up();
+  } else if (mode_ != Mode::NONE) {
+    schedule(std::chrono::milliseconds::zero());
+  }
+}
+
 void waybar::modules::CustomGraph::handleEvent() {
   if (!config_["exec-on-event"].isBool() || config_["exec-on-event"].asBool()) {
-    thread_.wake_up();
+    wakeUp();
   }
 }
 
@@ -171,9 +218,14 @@ bool waybar::modules::CustomGraph::handleToggle(GdkEventButton* const& e) {
 }
 
 auto waybar::modules::CustomGraph::update() -> void {
+  reapChildren();
+  // Only a new output is a new sample for the graph
+  const bool fresh = output_.acquire();
+  const auto& output = output_.current();
+
   // Hide label if output is empty
   if ((config_["exec"].isString() || config_["exec-if"].isString()) &&
-      (output_.out.empty() || output_.exit_code != 0)) {
+      (output.out.empty() || output.exit_code != 0)) {
     event_box_.hide();
   } else {
     if (config_["return-type"].asString() == "json") {
@@ -183,7 +235,9 @@ auto waybar::modules::CustomGraph::update() -> void {
     }
 
     try {
-      addValue(percentage_);
+      if (fresh) {
+        addValue(percentage_);
+      }
 
       if (tooltipEnabled()) {
         if (tooltip_format_enabled_) {
@@ -223,7 +277,7 @@ auto waybar::modules::CustomGraph::update() -> void {
 }
 
 void waybar::modules::CustomGraph::parseOutputRaw() {
-  std::istringstream output(output_.out);
+  std::istringstream output(output_.current().out);
   std::string line;
   int i = 0;
   while (getline(output, line)) {
@@ -273,7 +327,7 @@ void waybar::modules::CustomGraph::parseOutputRaw() {
 }
 
 void waybar::modules::CustomGraph::parseOutputJson() {
-  std::istringstream output(output_.out);
+  std::istringstream output(output_.current().out);
   std::string line;
   class_.clear();
   // A script can emit invalid UTF-8; passing it unchecked to Pango/GTK aborts
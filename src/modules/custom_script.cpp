@@ -0,0 +1,328 @@
+#include "modules/custom_script.hpp"
+
+#include <glibmm/main.h>
+#include <json/writer.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "util/command_pool.hpp"
+#include "util/timer_scheduler.hpp"
+
+namespace waybar::modules {
+
+namespace {
+
+// Settings that determine what the script outputs and when
+constexpr const char* kScriptKeys[] = {"exec",     "exec-if",          "exec-timeout", "interval",
+                                       "daemon",   "restart-interval", "signal"};
+
+bool isShared(const Json::Value& config) {
+  const auto& shared = config["shared"];
+  if (shared.isBool()) {
+    return shared.asBool();
+  }
+  if (shared.isString() && shared.asString() == "auto") {
+    // Only the command line can be checked; scripts reading the variable need "shared": false
+    return config["exec"].asString().find("WAYBAR_OUTPUT_NAME") == std::string::npos &&
+           config["exec-if"].asString().find("WAYBAR_OUTPUT_NAME") == std::string::npos;
+  }
+  return false;
+}
+
+std::string sharingKey(const Json::Value& config) {
+  Json::Value settings(Json::objectValue);
+  for (const auto* key : kScriptKeys) {
+    settings[key] = config[key];
+  }
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "";
+  return Json::writeString(builder, settings);
+}
+
+}  // namespace
+
+std::shared_ptr<CustomScript> CustomScript::get(const Json::Value& config,
+                                                const std::string& name,
+                                                const std::string& output_name,
+                                                std::chrono::milliseconds interval) {
+  if (!isShared(config)) {
+    auto script = std::make_shared<CustomScript>(config, name, output_name, interval);
+    script->start();
+    return script;
+  }
+
+  static std::mutex registry_mutex;
+  static std::map<std::string, std::weak_ptr<CustomScript>> registry;
+
+  const auto key = sharingKey(config);
+  std::lock_guard lock(registry_mutex);
+  if (auto it = registry.find(key); it != registry.end()) {
+    if (auto script = it->second.lock()) {
+      spdlog::debug("custom/{}: sharing the script started for another output", name);
+      return script;
+    }
+  }
+  std::erase_if(registry, [](const auto& entry) { return entry.second.expired(); });
+
+  // The first output to start the script is the one it sees in WAYBAR_OUTPUT_NAME
+  auto script = std::make_shared<CustomScript>(config, name, output_name, interval);
+  script->start();
+  registry[key] = script;
+  return script;
+}
+
+CustomScript::CustomScript(const Json::Value& config, std::string name, std::string output_name,
+                           std::chrono::milliseconds interval)
+    : config_(config),
+      name_(std::move(name)),
+      output_name_(std::move(output_name)),
+      interval_(interval) {
+  if (config_["exec-timeout"].isNumeric() && config_["exec-timeout"].asDouble() > 0) {
+    exec_timeout_ = std::chrono::milliseconds(
+        std::max(1L, static_cast<long>(config_["exec-timeout"].asDouble() * 1000)));
+  }
+
+  const bool has_exec = config_["exec"].isString();
+  if (has_exec && config_["daemon"].isBool() && config_["daemon"].asBool()) {
+    mode_ = Mode::DAEMON;
+  } else if (!config_["signal"].empty() && config_["interval"].empty() &&
+             config_["restart-interval"].empty()) {
+    // Runs once, then on every signal
+    mode_ = Mode::POLL;
+  } else if (interval_.count() > 0) {
+    mode_ = has_exec || config_["exec-if"].isString() ? Mode::POLL : Mode::NONE;
+  } else if (has_exec) {
+    mode_ = Mode::CONTINUOUS;
+  }
+}
+
+CustomScript::~CustomScript() {
+  util::command::Pool::instance().cancel(this);
+  tick_connection_.disconnect();
+  restart_connection_.disconnect();
+  if (stream_) {
+    stream_->stop();
+  }
+}
+
+void CustomScript::subscribe(const void* owner, Output on_output) {
+  std::lock_guard lock(mutex_);
+  if (last_) {
+    on_output(*last_);
+  }
+  subscribers_[owner] = std::move(on_output);
+}
+
+void CustomScript::unsubscribe(const void* owner) {
+  std::lock_guard lock(mutex_);
+  subscribers_.erase(owner);
+  paused_.erase(owner);
+}
+
+void CustomScript::pause(const void* owner) {
+  std::lock_guard lock(mutex_);
+  if (subscribers_.contains(owner)) {
+    paused_.insert(owner);
+  }
+}
+
+void CustomScript::resume(const void* owner) {
+  bool run_now = false;
+  {
+    std::lock_guard lock(mutex_);
+    paused_.erase(owner);
+    run_now = std::exchange(parked_, false);
+  }
+  if (run_now) {
+    schedule(std::chrono::milliseconds::zero());
+  }
+}
+
+bool CustomScript::allPaused() const {
+  return !subscribers_.empty() && paused_.size() == subscribers_.size();
+}
+
+void CustomScript::publish(util::command::res output) {
+  std::lock_guard lock(mutex_);
+  last_ = std::move(output);
+  for (const auto& [owner, on_output] : subscribers_) {
+    on_output(*last_);
+  }
+}
+
+void CustomScript::start() {
+  switch (mode_) {
+    case Mode::POLL:
+      schedule(std::chrono::milliseconds::zero());
+      break;
+    case Mode::CONTINUOUS:
+    case Mode::DAEMON:
+      stream_ = std::make_unique<util::command::LineStream>(
+          output_name_,
+          [this](const std::string& output) {
+            // Take each line as the reply to the oldest request that may still be answered
+            if (event_pending_) {
+              event_pending_ = false;
+            } else {
+              awaiting_reply_ = false;
+            }
+            publish({.exit_code = 0, .out = output});
+          },
+          [this](int exit_code) { handleExit(exit_code); });
+      startStream(true);
+      if (mode_ == Mode::DAEMON && interval_.count() > 0 &&
+          interval_ != std::chrono::milliseconds::max()) {
+        tick_connection_ = Glib::signal_timeout().connect(
+            [this] {
+              if (awaiting_reply_) {
+                // Skip one tick for a busy daemon, but don't wait forever for a lost reply
+                spdlog::debug("{}: no reply to the last update, asking again next time", name_);
+                awaiting_reply_ = false;
+              } else {
+                request("update");
+              }
+              return true;
+            },
+            std::max(1L, static_cast<long>(interval_.count())));
+      }
+      break;
+    case Mode::NONE:
+      break;
+  }
+}
+
+void CustomScript::refresh() {
+  if (mode_ == Mode::POLL) {
+    schedule(std::chrono::milliseconds::zero());
+  } else if (mode_ == Mode::DAEMON) {
+    request("update");
+  }
+}
+
+void CustomScript::event(std::string_view line) {
+  if (mode_ == Mode::POLL) {
+    schedule(std::chrono::milliseconds::zero());
+  } else if (mode_ == Mode::DAEMON) {
+    request(line);
+  }
+}
+
+void CustomScript::schedule(std::chrono::milliseconds delay) {
+  util::command::Pool::instance().submit(
+      this,
+      [this](std::stop_token stop) {
+        run(stop);
+        // "once" runs again only when woken up
+        if (interval_.count() == 0 || interval_ == std::chrono::milliseconds::max()) {
+          return;
+        }
+        {
+          std::lock_guard lock(mutex_);
+          if (allPaused()) {
+            // Runs again on resume()
+            parked_ = true;
+            return;
+          }
+        }
+        schedule(interval_ * util::TimerScheduler::instance().stretch());
+      },
+      delay, exec_timeout_.count() > 0);
+}
+
+void CustomScript::run(std::stop_token stop) {
+  util::command::res output{};
+  if (config_["exec-if"].isString()) {
+    output = util::command::run(config_["exec-if"].asString(),
+                                {.timeout = exec_timeout_, .stop = stop, .discard_output = true});
+    if (stop.stop_requested()) {
+      // The script is going away
+      return;
+    }
+    if (output.exit_code != 0) {
+      publish(std::move(output));
+      return;
+    }
+  }
+  if (config_["exec"].isString()) {
+    output = util::command::run(
+        config_["exec"].asString(),
+        {.output_name = output_name_, .timeout = exec_timeout_, .stop = stop});
+  }
+  if (!stop.stop_requested()) {
+    publish(std::move(output));
+  }
+}
+
+void CustomScript::request(std::string_view line) {
+  // Don't let updates pile up behind a daemon that is still busy answering the last one
+  if (line == "update" && awaiting_reply_) {
+    return;
+  }
+  if (stream_->send(line)) {
+    // Replies to events are optional
+    if (line == "update") {
+      awaiting_reply_ = true;
+    } else {
+      event_pending_ = true;
+    }
+  } else {
+    spdlog::debug("{}: daemon isn't reading requests, dropped '{}'", name_, line);
+  }
+}
+
+void CustomScript::startStream(bool throw_on_failure) {
+  const auto cmd = config_["exec"].asString();
+
+  try {
+    stream_->start(cmd, mode_ == Mode::DAEMON);
+    if (mode_ == Mode::DAEMON) {
+      awaiting_reply_ = false;
+      event_pending_ = false;
+      request("update");
+    }
+  } catch (const Glib::SpawnError& e) {
+    if (throw_on_failure) {
+      throw std::runtime_error("Unable to open " + cmd + ": " + e.what().raw());
+    }
+    publish({.exit_code = 1, .out = ""});
+    spdlog::error("Unable to restart {}: {}", name_, e.what().raw());
+    scheduleRestart();
+  } catch (const std::exception& e) {
+    if (throw_on_failure) {
+      throw;
+    }
+    publish({.exit_code = 1, .out = ""});
+    spdlog::error("Unable to restart {}: {}", name_, e.what());
+    scheduleRestart();
+  }
+}
+
+void CustomScript::handleExit(int exit_code) {
+  if (exit_code != 0) {
+    publish({.exit_code = exit_code, .out = ""});
+    spdlog::error("{} stopped unexpectedly, is it endless?", name_);
+  }
+
+  scheduleRestart();
+}
+
+void CustomScript::scheduleRestart() {
+  restart_connection_.disconnect();
+  if (!config_["restart-interval"].isNumeric() || config_["restart-interval"].asDouble() <= 0) {
+    // A non-positive restart-interval must not busy-respawn the script
+    // (that starves the GTK main loop); treat it as "do not restart".
+    return;
+  }
+
+  restart_connection_ = Glib::signal_timeout().connect(
+      [this] {
+        startStream(false);
+        return false;
+      },
+      std::max(1U, static_cast<unsigned>(config_["restart-interval"].asDouble() * 1000)));
+}
+
+}  // namespace waybar::modules
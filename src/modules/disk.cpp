@@ -4,12 +4,13 @@
 
 using namespace waybar::util;
 
+namespace {
+const std::string DEFAULT_TOOLTIP_FORMAT{
+    "{used} used out of {total} on {path} ({percentage_used}%)"};
+}  // namespace
+
 waybar::modules::Disk::Disk(const std::string& id, const Json::Value& config)
     : ALabel(config, "disk", id, "{}%", 30), header_(""), paths_(), separator_(" ") {
-  thread_ = [this] {
-    dp.emit();
-    thread_.sleep_for(interval_);
-  };
   if (config["header"].isString()) {
     header_ = config["header"].asString();
   }
@@ -31,17 +32,21 @@ waybar::modules::Disk::Disk(const std::string& id, const Json::Value& config)
   if (config["unit"].isString()) {
     unit_ = config["unit"].asString();
   }
-}
-
-auto waybar::modules::Disk::update() -> void {
-  std::string tooltip_label;
-  std::string label = header_;
-
-  bool had_valid_disk = false;
 
-  for (size_t i = 0; i < paths_.size(); ++i) {
-    const auto& path = paths_[i];
+  std::string source = "disk";
+  for (const auto& path : paths_) {
+    source += ":" + path;
+  }
+  // statvfs() hangs as long as a network file system doesn't answer
+  stats_ = util::SampleHub<Sample>::subscribe(
+      source, interval_, [paths = paths_] { return [paths] { return statPaths(paths); }; },
+      [this] { dp.emit(); }, true);
+}
 
+auto waybar::modules::Disk::statPaths(const std::vector<std::string>& paths) -> Sample {
+  Sample sample;
+  sample.reserve(paths.size());
+  for (const auto& path : paths) {
     struct statvfs /* {
         unsigned long  f_bsize;    // filesystem block size
         unsigned long  f_frsize;   // fragment size
@@ -58,70 +63,43 @@ auto waybar::modules::Disk::update() -> void {
         stats;
 
     int err = statvfs(path.c_str(), &stats);
-
-    /* Conky options
-      fs_bar - Bar that shows how much space is used
-      fs_free - Free space on a file system
-      fs_free_perc - Free percentage of space
-      fs_size - File system size
-      fs_used - File system used space
-    */
-
     if (err != 0 || stats.f_blocks == 0) {
       spdlog::warn("Disk: statvfs failed for path '{}' (errno={})", path, errno);
+      sample.emplace_back(std::nullopt);
       continue;
     }
+    sample.emplace_back(stats);
+  }
+  return sample;
+}
 
-    float specific_free, specific_used, specific_total, divisor;
+auto waybar::modules::Disk::update() -> void {
+  auto sample = stats_.latest();
+  if (!sample) {
+    return;
+  }
+  std::string label = header_;
 
-    divisor = calc_specific_divisor(unit_);
-    specific_free = (stats.f_bavail * stats.f_frsize) / divisor;
-    specific_used = ((stats.f_blocks - stats.f_bfree) * stats.f_frsize) / divisor;
-    specific_total = (stats.f_blocks * stats.f_frsize) / divisor;
+  bool had_valid_disk = false;
 
-    auto free = pow_format(stats.f_bavail * stats.f_frsize, "B", true);
-    auto used = pow_format((stats.f_blocks - stats.f_bfree) * stats.f_frsize, "B", true);
-    auto total = pow_format(stats.f_blocks * stats.f_frsize, "B", true);
+  for (size_t i = 0; i < paths_.size() && i < sample->size(); ++i) {
+    if (!(*sample)[i].has_value()) {
+      continue;
+    }
+    const auto& stats = *(*sample)[i];
     auto percentage_used = (stats.f_blocks - stats.f_bfree) * 100 / stats.f_blocks;
 
     std::string disk_format = format_;
     auto state = getState(percentage_used);
-    if (!state.empty() && config_["format-" + state].isString()) {
-      disk_format = config_["format-" + state].asString();
+    if (const auto* state_format = stateFormat(state)) {
+      disk_format = *state_format;
     }
 
     if (!disk_format.empty()) {
       if (had_valid_disk) {
         label += separator_;
       }
-
-      label += fmt::format(
-          fmt::runtime(disk_format), stats.f_bavail * 100 / stats.f_blocks, fmt::arg("free", free),
-          fmt::arg("percentage_free", stats.f_bavail * 100 / stats.f_blocks),
-          fmt::arg("used", used), fmt::arg("percentage_used", percentage_used),
-          fmt::arg("total", total), fmt::arg("path", path),
-          fmt::arg("specific_free", specific_free), fmt::arg("specific_used", specific_used),
-          fmt::arg("specific_total", specific_total));
-    }
-
-    std::string tooltip_format = "{used} used out of {total} on {path} ({percentage_used}%)";
-    if (config_["tooltip-format"].isString()) {
-      tooltip_format = config_["tooltip-format"].asString();
-    }
-
-    if (!tooltip_format.empty()) {
-      if (had_valid_disk) {
-        tooltip_label += "\n";
-      }
-
-      tooltip_label += fmt::format(
-          fmt::runtime(tooltip_format), stats.f_bavail * 100 / stats.f_blocks,
-          fmt::arg("free", free),
-          fmt::arg("percentage_free", stats.f_bavail * 100 / stats.f_blocks),
-          fmt::arg("used", used), fmt::arg("percentage_used", percentage_used),
-          fmt::arg("total", total), fmt::arg("path", path),
-          fmt::arg("specific_free", specific_free), fmt::arg("specific_used", specific_used),
-          fmt::arg("specific_total", specific_total));
+      label += formatDisk(disk_format, stats, paths_[i]);
     }
 
     had_valid_disk = true;
@@ -134,13 +112,63 @@ auto waybar::modules::Disk::update() -> void {
 
   setLabelMarkup(label);
 
-  if (tooltipEnabled() && !tooltip_label.empty()) {
-    setTooltipMarkup(tooltip_label);
+  if (tooltipEnabled()) {
+    setTooltipProducer([this, sample = std::move(sample)] {
+      std::string tooltip;
+      const auto& tooltip_format = tooltipFormat({}, DEFAULT_TOOLTIP_FORMAT);
+      if (tooltip_format.empty()) {
+        return tooltip;
+      }
+      bool first = true;
+      for (size_t i = 0; i < paths_.size() && i < sample->size(); ++i) {
+        if (!(*sample)[i].has_value()) {
+          continue;
+        }
+        if (!first) {
+          tooltip += "\n";
+        }
+        first = false;
+        tooltip += formatDisk(tooltip_format, *(*sample)[i], paths_[i]);
+      }
+      return tooltip;
+    });
   }
   // Call parent update
   ALabel::update();
 }
 
+std::string waybar::modules::Disk::formatDisk(const std::string& format,
+                                              const struct statvfs& stats,
+                                              const std::string& path) {
+  /* Conky options
+    fs_bar - Bar that shows how much space is used
+    fs_free - Free space on a file system
+    fs_free_perc - Free percentage of space
+    fs_size - File system size
+    fs_used - File system used space
+  */
+  float specific_free, specific_used, specific_total, divisor;
+
+  divisor = calc_specific_divisor(unit_);
+  specific_free = (stats.f_bavail * stats.f_frsize) / divisor;
+  specific_used = ((stats.f_blocks - stats.f_bfree) * stats.f_frsize) / divisor;
+  specific_total = (stats.f_blocks * stats.f_frsize) / divisor;
+
+  auto free = pow_format(stats.f_bavail * stats.f_frsize, "B", true);
+  auto used = pow_format((stats.f_blocks - stats.f_bfree) * stats.f_frsize, "B", true);
+  auto total = pow_format(stats.f_blocks * stats.f_frsize, "B", true);
+  auto percentage_used = (stats.f_blocks - stats.f_bfree) * 100 / stats.f_blocks;
+
+  return fmt::format(fmt::runtime(format), stats.f_bavail * 100 / stats.f_blocks,
+                     fmt::arg("free", free),
+                     fmt::arg("percentage_free", stats.f_bavail * 100 / stats.f_blocks),
+                     fmt::arg("used", used), fmt::arg("percentage_used", percentage_used),
+                     fmt::arg("total", total), fmt::arg("path", path),
+                     fmt::arg("specific_free", specific_free),
+                     fmt::arg("specific_used", specific_used),
+                     fmt::arg("specific_total", specific_total));
+}
+
 float waybar::modules::Disk::calc_specific_divisor(const std::string& divisor) {
   if (divisor == "kB") {
     return 1000.0;
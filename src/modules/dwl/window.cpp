@@ -76,6 +76,7 @@ static const wl_registry_listener registry_listener_impl = {.global = handle_glo
 Window::Window(const std::string& id, const Bar& bar, const Json::Value& config)
     : AAppIconLabel(config, "window", id, "{}", 0, true),
       bar_(bar),
+      rewrite_(config_["rewrite"]),
       active_(false),
       hide_inactive_(false),
       hide_empty_(false) {
@@ -121,10 +122,9 @@ void Window::handle_layout_symbol(const char* layout_symbol) {
 void Window::handle_layout(const uint32_t layout) { layout_ = layout; }
 
 void Window::handle_frame() {
-  label_.set_markup(waybar::util::rewriteString(
-      fmt::format(fmt::runtime(format_), fmt::arg("title", title_),
-                  fmt::arg("layout", layout_symbol_), fmt::arg("app_id", appid_)),
-      config_["rewrite"]));
+  label_.set_markup(rewrite_.apply(fmt::format(fmt::runtime(format_), fmt::arg("title", title_),
+                                               fmt::arg("layout", layout_symbol_),
+                                               fmt::arg("app_id", appid_))));
   updateAppIconName(appid_, "");
   updateAppIcon();
   if (tooltipEnabled()) {
@@ -31,6 +31,7 @@ waybar::modules::Gps::Gps(const std::string& id, const Json::Value& config)
     dp.emit();
     thread_.sleep_for(interval_);
   };
+  adaptPolling(thread_);
 
   if (0 != gps_open("localhost", "2947", &gps_data_)) {
     throw std::runtime_error("Can't open gpsd socket");
@@ -44,7 +45,7 @@ waybar::modules::Gps::Gps(const std::string& id, const Json::Value& config)
     hideNoFix = config_["hide-no-fix"].asBool();
   }
 
-  gps_thread_ = [this] {
+  gps_thread_ = util::SleeperThread::Blocking{[this] {
     dp.emit();
     gps_stream(&gps_data_, WATCH_ENABLE, NULL);
     int last_gps_mode = 0;
@@ -65,7 +66,7 @@ waybar::modules::Gps::Gps(const std::string& id, const Json::Value& config)
       }
       last_gps_mode = gps_data_.fix.mode;
     }
-  };
+  }};
 
 #ifdef WANT_RFKILL
   rfkill_.on_update.connect(sigc::hide(sigc::mem_fun(*this, &Gps::update)));
@@ -15,6 +15,7 @@
 #include <filesystem>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "util/scoped_fd.hpp"
 
@@ -46,10 +47,21 @@ std::filesystem::path IPC::getSocketFolder(const char* instanceSig) {
   return socketFolder_ / instanceSig;
 }
 
-IPC::IPC() {
-  // will start IPC and relay events to parseIPC
+IPC::IPC() : state_([](const std::string& rq) { return getSocket1Reply(rq); }) {
   socketOwnerPid_ = getpid();
-  ipcThread_ = std::thread([this]() { socketListener(); });
+  // Connected here rather than on the IPC thread, so that the state mirror is live, and caches
+  // what is read from it, as soon as inst() returns
+  const int socketfd = connectSocket2();
+  if (socketfd == -1) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(socketMutex_);
+    socketfd_ = socketfd;
+  }
+  state_.setLive(true);
+  // will relay events to parseIPC
+  ipcThread_ = std::thread([this, socketfd]() { socketListener(socketfd); });
 }
 
 IPC::~IPC() {
@@ -78,13 +90,13 @@ IPC& IPC::inst() {
   return ipc;
 }
 
-void IPC::socketListener() {
+int IPC::connectSocket2() {
   // check for hyprland
   const char* his = getenv("HYPRLAND_INSTANCE_SIGNATURE");
 
   if (his == nullptr) {
     spdlog::warn("Hyprland is not running, Hyprland IPC will not be available.");
-    return;
+    return -1;
   }
 
   spdlog::info("Hyprland IPC starting");
@@ -94,7 +106,7 @@ void IPC::socketListener() {
 
   if (socketfd == -1) {
     spdlog::error("Hyprland IPC: socketfd failed");
-    return;
+    return -1;
   }
 
   addr.sun_family = AF_UNIX;
@@ -103,7 +115,7 @@ void IPC::socketListener() {
   if (socketPath.native().size() >= sizeof(addr.sun_path)) {
     spdlog::error("Hyprland IPC: Socket path is too long: {}", socketPath.string());
     close(socketfd);
-    return;
+    return -1;
   }
   strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
 
@@ -112,15 +124,15 @@ void IPC::socketListener() {
   if (connect(socketfd, (struct sockaddr*)&addr, l) == -1) {
     spdlog::error("Hyprland IPC: Unable to connect? {}", std::strerror(errno));
     close(socketfd);
-    return;
+    return -1;
   }
 
-  {
-    std::lock_guard<std::mutex> lock(socketMutex_);
-    socketfd_ = socketfd;
-  }
+  return socketfd;
+}
 
+void IPC::socketListener(int socketfd) {
   std::string pending;
+  std::vector<std::string> messages;
   while (running_.load(std::memory_order_relaxed)) {
     std::array<char, 1024> buffer;  // Hyprland socket2 events are max 1024 bytes
     const ssize_t bytes_read = read(socketfd, buffer.data(), buffer.size());
@@ -152,16 +164,26 @@ void IPC::socketListener() {
         continue;
       }
       spdlog::debug("hyprland IPC received {}", messageReceived);
+      messages.push_back(std::move(messageReceived));
+    }
 
+    // Bring the state mirror up to date with the whole burst before any handler reads it, so
+    // handlers for the same burst share at most one re-query per section.
+    for (const auto& message : messages) {
+      state_.apply(message);
+    }
+    for (const auto& message : messages) {
       try {
-        parseIPC(messageReceived);
+        parseIPC(message);
       } catch (std::exception& e) {
-        spdlog::warn("Failed to parse IPC message: {}, reason: {}", messageReceived, e.what());
+        spdlog::warn("Failed to parse IPC message: {}, reason: {}", message, e.what());
       } catch (...) {
         throw;
       }
     }
+    messages.clear();
   }
+  state_.setLive(false);
   {
     std::lock_guard<std::mutex> lock(socketMutex_);
     if (socketfd_ != -1) {
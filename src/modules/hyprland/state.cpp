@@ -0,0 +1,332 @@
+#include "modules/hyprland/state.hpp"
+
+#include <bit>
+#include <charconv>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+namespace waybar::modules::hyprland {
+
+namespace {
+
+constexpr std::array<const char*, 4> kQueries = {"j/monitors", "j/workspaces", "j/clients",
+                                                 "j/activeworkspace"};
+
+// Events that may change the layout in ways we don't patch, and the sections they invalidate
+struct Invalidation {
+  std::string_view event;
+  uint8_t sections;
+};
+
+constexpr uint8_t kWindows = State::CLIENTS | State::WORKSPACES | State::ACTIVE_WORKSPACE;
+constexpr uint8_t kWorkspaces = State::MONITORS | State::WORKSPACES | State::ACTIVE_WORKSPACE;
+
+constexpr std::array<Invalidation, 22> kInvalidations = {{
+    {"openwindow", kWindows},
+    {"closewindow", kWindows},
+    {"movewindow", kWindows},
+    {"movewindowv2", kWindows},
+    {"changefloatingmode", kWindows},
+    {"fullscreen", kWindows},
+    {"pin", State::CLIENTS},
+    {"minimized", State::CLIENTS},
+    {"togglegroup", State::CLIENTS},
+    {"moveintogroup", State::CLIENTS},
+    {"moveoutofgroup", State::CLIENTS},
+    {"createworkspace", kWorkspaces},
+    {"createworkspacev2", kWorkspaces},
+    {"destroyworkspace", kWorkspaces},
+    {"destroyworkspacev2", kWorkspaces},
+    {"moveworkspace", State::ALL},
+    {"moveworkspacev2", State::ALL},
+    {"activespecial", State::MONITORS},
+    {"activespecialv2", State::MONITORS},
+    {"monitoradded", State::ALL},
+    {"monitorremoved", State::ALL},
+    {"configreloaded", State::ALL},
+}};
+
+std::size_t indexOf(State::Section section) { return std::countr_zero(unsigned{section}); }
+
+std::optional<int> parseInt(std::string_view text) {
+  int value = 0;
+  auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+  if (ec != std::errc() || ptr != text.data() + text.size()) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+std::pair<std::string, std::string> splitPayload(const std::string& payload) {
+  const auto comma = payload.find(',');
+  if (comma == std::string::npos) {
+    return {payload, ""};
+  }
+  return {payload.substr(0, comma), payload.substr(comma + 1)};
+}
+
+std::string normalizeAddress(const std::string& address) {
+  return address.starts_with("0x") ? address : "0x" + address;
+}
+
+const Json::Value* findById(const Json::Value& array, int id) {
+  for (const auto& item : array) {
+    if (item["id"].asInt() == id) {
+      return &item;
+    }
+  }
+  return nullptr;
+}
+
+Json::Value* findById(Json::Value& array, int id) {
+  return const_cast<Json::Value*>(findById(std::as_const(array), id));
+}
+
+}  // namespace
+
+State::State(Query query) : query_(std::move(query)) {}
+
+auto State::get(Section section) -> Snapshot {
+  const auto index = indexOf(section);
+  uint64_t generation = 0;
+  {
+    std::lock_guard lock(mutex_);
+    if (live_ && (stale_ & section) == 0 && sections_[index]) {
+      return sections_[index];
+    }
+    generation = generations_[index];
+  }
+
+  // Query without the lock, so events keep being applied while socket1 answers
+  const auto reply = query_(kQueries[index]);
+  if (reply.empty()) {
+    // Keep the section stale so the next read retries
+    return std::make_shared<const Json::Value>();
+  }
+  auto fresh = std::make_shared<Json::Value>(parser_.parse(reply));
+
+  std::lock_guard lock(mutex_);
+  // An event for this section during the query may not be reflected in the reply, so only cache
+  // it if there was none; the section then stays stale and the next read queries again
+  if (generations_[index] == generation) {
+    sections_[index] = fresh;
+    stale_ &= ~section;
+  }
+  return fresh;
+}
+
+const Json::Value* State::cached(Section section) const {
+  const auto& slot = sections_[indexOf(section)];
+  return slot && (stale_ & section) == 0 ? slot.get() : nullptr;
+}
+
+Json::Value* State::mutableSection(Section section) {
+  auto& slot = sections_[indexOf(section)];
+  if (!slot || (stale_ & section) != 0) {
+    // The event is lost on the stale copy, and may be missing from a reply in flight
+    ++generations_[indexOf(section)];
+    return nullptr;
+  }
+  if (slot.use_count() > 1) {
+    slot = std::make_shared<Json::Value>(*slot);
+  }
+  return slot.get();
+}
+
+void State::invalidate(uint8_t sections) {
+  std::lock_guard lock(mutex_);
+  markStale(sections);
+}
+
+void State::markStale(uint8_t sections) {
+  stale_ |= sections;
+  for (std::size_t index = 0; index < kSections; ++index) {
+    if ((sections & (1U << index)) != 0) {
+      ++generations_[index];
+    }
+  }
+}
+
+void State::setLive(bool live) {
+  std::lock_guard lock(mutex_);
+  live_ = live;
+  // Whatever was cached may have missed events while the stream was down
+  markStale(ALL);
+}
+
+void State::apply(const std::string& ev) {
+  const auto separator = ev.find(">>");
+  const auto name = std::string_view(ev).substr(0, separator);
+  const auto payload = separator == std::string::npos ? std::string() : ev.substr(separator + 2);
+
+  std::lock_guard lock(mutex_);
+  for (const auto& [event, sections] : kInvalidations) {
+    if (event == name) {
+      markStale(sections);
+      return;
+    }
+  }
+
+  if (name == "activewindowv2") {
+    onActiveWindow(payload);
+  } else if (name == "windowtitlev2") {
+    const auto [address, title] = splitPayload(payload);
+    onWindowTitle(address, title);
+  } else if (name == "workspacev2") {
+    if (auto id = parseInt(splitPayload(payload).first)) {
+      onWorkspace(*id);
+    } else {
+      markStale(MONITORS | ACTIVE_WORKSPACE);
+    }
+  } else if (name == "focusedmonv2") {
+    const auto [monitor, workspace] = splitPayload(payload);
+    if (auto id = parseInt(workspace)) {
+      onFocusedMonitor(monitor, *id);
+    } else {
+      markStale(MONITORS | ACTIVE_WORKSPACE);
+    }
+  } else if (name == "renameworkspace") {
+    const auto [workspace, newName] = splitPayload(payload);
+    if (auto id = parseInt(workspace)) {
+      onWorkspaceRenamed(*id, newName);
+    } else {
+      markStale(ALL);
+    }
+  }
+}
+
+void State::onActiveWindow(const std::string& address) {
+  const auto* clients = cached(CLIENTS);
+  auto* workspaces = mutableSection(WORKSPACES);
+  if (address.empty() || address == "," || clients == nullptr || workspaces == nullptr) {
+    markStale(WORKSPACES | ACTIVE_WORKSPACE);
+    return;
+  }
+
+  const auto normalized = normalizeAddress(address);
+  for (const auto& client : *clients) {
+    if (client["address"].asString() != normalized) {
+      continue;
+    }
+    // The focused window becomes the "lastwindow" of the workspace it lives on
+    const int id = client["workspace"]["id"].asInt();
+    if (auto* workspace = findById(*workspaces, id)) {
+      (*workspace)["lastwindow"] = normalized;
+      (*workspace)["lastwindowtitle"] = client["title"];
+    }
+    if (auto* active = mutableSection(ACTIVE_WORKSPACE); active && (*active)["id"].asInt() == id) {
+      (*active)["lastwindow"] = normalized;
+      (*active)["lastwindowtitle"] = client["title"];
+    }
+    return;
+  }
+  // A window we haven't seen yet
+  markStale(CLIENTS | WORKSPACES | ACTIVE_WORKSPACE);
+}
+
+void State::onWindowTitle(const std::string& address, const std::string& title) {
+  const auto normalized = normalizeAddress(address);
+
+  bool found = false;
+  if (auto* clients = mutableSection(CLIENTS)) {
+    for (auto& client : *clients) {
+      if (client["address"].asString() == normalized) {
+        client["title"] = title;
+        found = true;
+        break;
+      }
+    }
+  }
+  if (!found) {
+    markStale(CLIENTS);
+  }
+
+  if (auto* workspaces = mutableSection(WORKSPACES)) {
+    for (auto& workspace : *workspaces) {
+      if (workspace["lastwindow"].asString() == normalized) {
+        workspace["lastwindowtitle"] = title;
+      }
+    }
+  }
+  if (auto* active = mutableSection(ACTIVE_WORKSPACE)) {
+    if ((*active)["lastwindow"].asString() == normalized) {
+      (*active)["lastwindowtitle"] = title;
+    }
+  }
+}
+
+void State::onWorkspace(int id) {
+  // The focused monitor switched to another (existing) workspace
+  auto* monitors = mutableSection(MONITORS);
+  const auto* workspaces = cached(WORKSPACES);
+  const Json::Value* workspace = workspaces != nullptr ? findById(*workspaces, id) : nullptr;
+  if (monitors == nullptr || workspace == nullptr) {
+    markStale(MONITORS | ACTIVE_WORKSPACE);
+    return;
+  }
+
+  bool found = false;
+  for (auto& monitor : *monitors) {
+    if (monitor["focused"].asBool()) {
+      monitor["activeWorkspace"]["id"] = id;
+      monitor["activeWorkspace"]["name"] = (*workspace)["name"];
+      found = true;
+    }
+  }
+  if (!found) {
+    markStale(MONITORS);
+  }
+  setActiveWorkspace(id);
+}
+
+void State::onFocusedMonitor(const std::string& monitor, int workspaceId) {
+  if (auto* monitors = mutableSection(MONITORS)) {
+    for (auto& item : *monitors) {
+      item["focused"] = item["name"].asString() == monitor;
+    }
+  }
+  setActiveWorkspace(workspaceId);
+}
+
+void State::onWorkspaceRenamed(int id, const std::string& name) {
+  if (auto* workspaces = mutableSection(WORKSPACES)) {
+    if (auto* workspace = findById(*workspaces, id)) {
+      (*workspace)["name"] = name;
+    }
+  }
+  if (auto* monitors = mutableSection(MONITORS)) {
+    for (auto& monitor : *monitors) {
+      for (const char* key : {"activeWorkspace", "specialWorkspace"}) {
+        if (monitor[key]["id"].asInt() == id) {
+          monitor[key]["name"] = name;
+        }
+      }
+    }
+  }
+  if (auto* clients = mutableSection(CLIENTS)) {
+    for (auto& client : *clients) {
+      if (client["workspace"]["id"].asInt() == id) {
+        client["workspace"]["name"] = name;
+      }
+    }
+  }
+  if (auto* active = mutableSection(ACTIVE_WORKSPACE); active && (*active)["id"].asInt() == id) {
+    (*active)["name"] = name;
+  }
+}
+
+void State::setActiveWorkspace(int id) {
+  const auto* workspaces = cached(WORKSPACES);
+  const Json::Value* workspace = workspaces != nullptr ? findById(*workspaces, id) : nullptr;
+  if (workspace == nullptr) {
+    markStale(ACTIVE_WORKSPACE);
+    return;
+  }
+  sections_[indexOf(ACTIVE_WORKSPACE)] = std::make_shared<Json::Value>(*workspace);
+  stale_ &= ~ACTIVE_WORKSPACE;
+  // Newer than any reply in flight
+  ++generations_[indexOf(ACTIVE_WORKSPACE)];
+}
+
+}  // namespace waybar::modules::hyprland
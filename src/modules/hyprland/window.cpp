@@ -19,7 +19,10 @@ namespace waybar::modules::hyprland {
 std::shared_mutex windowIpcSmtx;
 
 Window::Window(const std::string& id, const Bar& bar, const Json::Value& config)
-    : AAppIconLabel(config, "window", id, "{title}", 0, true), bar_(bar), m_ipc(IPC::inst()) {
+    : AAppIconLabel(config, "window", id, "{title}", 0, true),
+      bar_(bar),
+      rewrite_(config_["rewrite"]),
+      m_ipc(IPC::inst()) {
   separateOutputs_ = config["separate-outputs"].asBool();
 
   update();
@@ -59,12 +62,11 @@ auto Window::update() -> void {
       displayTitle = config_["fallback"].asString();
     }
 
-    label_text = waybar::util::rewriteString(
+    label_text = rewrite_.apply(
         fmt::format(fmt::runtime(format_), fmt::arg("title", displayTitle),
                     fmt::arg("initialTitle", windowData_.initial_title),
                     fmt::arg("class", windowData_.class_name),
-                    fmt::arg("initialClass", windowData_.initial_class_name)),
-        config_["rewrite"]);
+                    fmt::arg("initialClass", windowData_.initial_class_name)));
     setLabelMarkup(label_text);
   } else {
     label_.hide();
@@ -116,7 +118,8 @@ auto Window::update() -> void {
 auto Window::getActiveWorkspace() -> Workspace { return getActiveWorkspace(""); }
 
 auto Window::getActiveWorkspace(const std::string& monitorName) -> Workspace {
-  const auto monitors = IPC::inst().getSocket1JsonReply("monitors");
+  const auto monitorsSnapshot = IPC::inst().state().monitors();
+  const auto& monitors = *monitorsSnapshot;
   if (monitors.isArray()) {
     auto monitor = std::ranges::find_if(monitors, [&](const Json::Value& monitor) {
       return monitorName.empty() ? monitor["focused"].asBool() : monitor["name"] == monitorName;
@@ -133,7 +136,8 @@ auto Window::getActiveWorkspace(const std::string& monitorName) -> Workspace {
     const int special_id = (*monitor)["specialWorkspace"]["id"].asInt();
     const int id = special_id != 0 ? special_id : (*monitor)["activeWorkspace"]["id"].asInt();
 
-    const auto workspaces = IPC::inst().getSocket1JsonReply("workspaces");
+    const auto workspacesSnapshot = IPC::inst().state().workspaces();
+    const auto& workspaces = *workspacesSnapshot;
     if (workspaces.isArray()) {
       auto workspace = std::ranges::find_if(
           workspaces, [&](const Json::Value& workspace) { return workspace["id"] == id; });
@@ -192,7 +196,8 @@ void Window::queryActiveWorkspace() {
     return;
   }
 
-  const auto clients = m_ipc.getSocket1JsonReply("clients");
+  const auto clientsSnapshot = m_ipc.state().clients();
+  const auto& clients = *clientsSnapshot;
   if (!clients.isArray()) {
     return;
   }
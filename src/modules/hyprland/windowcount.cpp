@@ -65,7 +65,8 @@ auto WindowCount::update() -> void {
 }
 
 auto WindowCount::getActiveWorkspace() -> Workspace {
-  const auto workspace = m_ipc.getSocket1JsonReply("activeworkspace");
+  const auto workspaceSnapshot = m_ipc.state().activeWorkspace();
+  const auto& workspace = *workspaceSnapshot;
 
   if (workspace.isObject()) {
     return Workspace::parse(workspace);
@@ -75,7 +76,8 @@ auto WindowCount::getActiveWorkspace() -> Workspace {
 }
 
 auto WindowCount::getActiveWorkspace(const std::string& monitorName) -> Workspace {
-  const auto monitors = m_ipc.getSocket1JsonReply("monitors");
+  const auto monitorsSnapshot = m_ipc.state().monitors();
+  const auto& monitors = *monitorsSnapshot;
   if (monitors.isArray()) {
     auto monitor = std::ranges::find_if(
         monitors, [&](const Json::Value& monitor) { return monitor["name"] == monitorName; });
@@ -89,7 +91,8 @@ auto WindowCount::getActiveWorkspace(const std::string& monitorName) -> Workspac
     }
     const int id = (*monitor)["activeWorkspace"]["id"].asInt();
 
-    const auto workspaces = m_ipc.getSocket1JsonReply("workspaces");
+    const auto workspacesSnapshot = m_ipc.state().workspaces();
+    const auto& workspaces = *workspacesSnapshot;
     if (workspaces.isArray()) {
       auto workspace = std::ranges::find_if(
           workspaces, [&](const Json::Value& workspace) { return workspace["id"] == id; });
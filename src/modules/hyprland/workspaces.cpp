@@ -48,7 +48,7 @@ Workspaces::~Workspaces() {
 }
 
 void Workspaces::init() {
-  m_activeWorkspaceId = m_ipc.getSocket1JsonReply("activeworkspace")["id"].asInt();
+  m_activeWorkspaceId = (*m_ipc.state().activeWorkspace())["id"].asInt();
 
   initializeWorkspaces();
 
@@ -123,7 +123,7 @@ void Workspaces::createWorkspace(Json::Value const& workspace_data,
 
 void Workspaces::createWorkspacesToCreate() {
   for (const auto& [workspaceData, clientsData] : m_workspacesToCreate) {
-    createWorkspace(workspaceData, clientsData);
+    createWorkspace(workspaceData, clientsData ? *clientsData : Json::Value::nullRef);
   }
   if (!m_workspacesToCreate.empty()) {
     updateWindowCount();
@@ -178,13 +178,13 @@ std::string Workspaces::getRewrite(const std::string& window_class,
 
 std::vector<int> Workspaces::getVisibleWorkspaces() {
   std::vector<int> visibleWorkspaces;
-  auto monitors = IPC::inst().getSocket1JsonReply("monitors");
-  for (const auto& monitor : monitors) {
-    auto ws = monitor["activeWorkspace"];
+  const auto monitors = m_ipc.state().monitors();
+  for (const auto& monitor : *monitors) {
+    const auto& ws = monitor["activeWorkspace"];
     if (ws.isObject() && ws["id"].isInt()) {
       visibleWorkspaces.push_back(ws["id"].asInt());
     }
-    auto sws = monitor["specialWorkspace"];
+    const auto& sws = monitor["specialWorkspace"];
     auto name = sws["name"].asString();
     if (sws.isObject() && sws["id"].isInt() && !name.empty()) {
       visibleWorkspaces.push_back(sws["id"].asInt());
@@ -202,17 +202,17 @@ void Workspaces::initializeWorkspaces() {
   }
 
   // get all current workspaces
-  auto const workspacesJson = m_ipc.getSocket1JsonReply("workspaces");
-  auto const clientsJson = m_ipc.getSocket1JsonReply("clients");
+  auto const workspacesJson = m_ipc.state().workspaces();
+  auto const clientsJson = m_ipc.state().clients();
 
-  for (const auto& workspaceJson : workspacesJson) {
+  for (const auto& workspaceJson : *workspacesJson) {
     std::string workspaceName = workspaceJson["name"].asString();
     if ((allOutputs() || m_bar.output->name == workspaceJson["monitor"].asString()) &&
         (!workspaceName.starts_with("special") || showSpecial()) &&
         !isWorkspaceIgnored(workspaceName)) {
       m_workspacesToCreate.emplace_back(workspaceJson, clientsJson);
     } else {
-      extendOrphans(workspaceJson["id"].asInt(), clientsJson);
+      extendOrphans(workspaceJson["id"].asInt(), *clientsJson);
     }
   }
 
@@ -242,7 +242,7 @@ bool Workspaces::isWorkspaceIgnored(std::string const& name) {
   return false;
 }
 
-void Workspaces::loadPersistentWorkspacesFromConfig(Json::Value const& clientsJson) {
+void Workspaces::loadPersistentWorkspacesFromConfig(State::Snapshot const& clientsJson) {
   spdlog::info("Loading persistent workspaces from Waybar config");
   const std::vector<std::string> keys = m_persistentWorkspaceConfig.getMemberNames();
   std::vector<std::string> persistentWorkspacesToCreate;
@@ -364,7 +364,8 @@ void Workspaces::onWorkspaceDestroyed(std::string const& payload) {
   }
 }
 
-void Workspaces::onWorkspaceCreated(std::string const& payload, Json::Value const& clientsData) {
+void Workspaces::onWorkspaceCreated(std::string const& payload,
+                                    State::Snapshot const& clientsData) {
   spdlog::debug("Workspace created: {}", payload);
 
   const auto [workspaceIdStr, _] = splitDoublePayload(payload);
@@ -375,9 +376,9 @@ void Workspaces::onWorkspaceCreated(std::string const& payload, Json::Value cons
   }
 
   auto const workspaceRules = m_ipc.getSocket1JsonReply("workspacerules");
-  auto const workspacesJson = m_ipc.getSocket1JsonReply("workspaces");
+  auto const workspacesJson = m_ipc.state().workspaces();
 
-  for (auto workspaceJson : workspacesJson) {
+  for (auto workspaceJson : *workspacesJson) {
     const auto currentId = workspaceJson["id"].asInt();
     if (currentId == *workspaceId) {
       std::string workspaceName = workspaceJson["name"].asString();
@@ -405,7 +406,7 @@ void Workspaces::onWorkspaceCreated(std::string const& payload, Json::Value cons
         break;
       }
     } else {
-      extendOrphans(*workspaceId, clientsData);
+      extendOrphans(*workspaceId, clientsData ? *clientsData : Json::Value::nullRef);
     }
   }
 }
@@ -414,7 +415,7 @@ void Workspaces::onWorkspaceMoved(std::string const& payload) {
   spdlog::debug("Workspace moved: {}", payload);
 
   // Update active workspace
-  m_activeWorkspaceId = (m_ipc.getSocket1JsonReply("activeworkspace"))["id"].asInt();
+  m_activeWorkspaceId = (*m_ipc.state().activeWorkspace())["id"].asInt();
 
   if (allOutputs()) return;
 
@@ -423,8 +424,7 @@ void Workspaces::onWorkspaceMoved(std::string const& payload) {
   const auto subPayload = makePayload(workspaceIdStr, workspaceName);
 
   if (m_bar.output->name == monitorName) {
-    Json::Value clientsData = m_ipc.getSocket1JsonReply("clients");
-    onWorkspaceCreated(subPayload, clientsData);
+    onWorkspaceCreated(subPayload, m_ipc.state().clients());
   } else {
     spdlog::debug("Removing workspace because it was moved to another monitor: {}", subPayload);
     onWorkspaceDestroyed(subPayload);
@@ -461,7 +461,8 @@ void Workspaces::onMonitorFocused(std::string const& payload) {
 
   m_activeWorkspaceId = *workspaceId;
 
-  for (Json::Value& monitor : m_ipc.getSocket1JsonReply("monitors")) {
+  const auto monitors = m_ipc.state().monitors();
+  for (const Json::Value& monitor : *monitors) {
     if (monitor["name"].asString() == monitorName) {
       const auto name = monitor["specialWorkspace"]["name"].asString();
       m_activeSpecialWorkspaceName = !name.starts_with("special:") ? name : name.substr(8);
@@ -573,14 +574,14 @@ void Workspaces::onWindowTitleEvent(std::string const& payload) {
   }
 
   if (inserter.has_value()) {
-    Json::Value clientsData = m_ipc.getSocket1JsonReply("clients");
+    const auto clientsData = m_ipc.state().clients();
     std::string jsonWindowAddress = fmt::format("0x{}", windowAddress);
 
-    auto client = std::ranges::find_if(clientsData, [jsonWindowAddress](auto& client) {
+    auto client = std::ranges::find_if(*clientsData, [jsonWindowAddress](auto& client) {
       return client["address"].asString() == jsonWindowAddress;
     });
 
-    if (client != clientsData.end() && !client->empty()) {
+    if (client != clientsData->end() && !client->empty()) {
       (*inserter)({*client});
     }
   }
@@ -729,7 +730,8 @@ auto Workspaces::populateWindowRewriteConfig(const Json::Value& config) -> void
 
   m_windowRewriteRules = util::RegexCollection(
       windowRewrite, windowRewriteDefault,
-      [this](std::string& window_rule) { return windowRewritePriorityFunction(window_rule); });
+      [this](std::string& window_rule) { return windowRewritePriorityFunction(window_rule); },
+      util::RegexCollection::cacheSizeFromConfig(config));
 }
 
 auto Workspaces::populateMaxWindowsConfig(const Json::Value& config) -> void {
@@ -899,11 +901,11 @@ void Workspaces::removeWorkspace(std::string const& workspaceString) {
 void Workspaces::setCurrentMonitorId() {
   // get monitor ID from name (used by persistent workspaces)
   m_monitorId = 0;
-  auto monitors = m_ipc.getSocket1JsonReply("monitors");
-  auto currentMonitor = std::ranges::find_if(monitors, [this](const Json::Value& m) {
+  const auto monitors = m_ipc.state().monitors();
+  auto currentMonitor = std::ranges::find_if(*monitors, [this](const Json::Value& m) {
     return m["name"].asString() == m_bar.output->name;
   });
-  if (currentMonitor == monitors.end()) {
+  if (currentMonitor == monitors->end()) {
     spdlog::error("Monitor '{}' does not have an ID? Using 0", m_bar.output->name);
   } else {
     m_monitorId = (*currentMonitor)["id"].asInt();
@@ -1013,12 +1015,12 @@ void Workspaces::sortWorkspaces() {
 }
 
 void Workspaces::setUrgentWorkspace(std::string const& windowaddress) {
-  const Json::Value clientsJson = m_ipc.getSocket1JsonReply("clients");
+  const auto clientsJson = m_ipc.state().clients();
   const std::string normalizedAddress =
       windowaddress.starts_with("0x") ? windowaddress : fmt::format("0x{}", windowaddress);
   int workspaceId = -1;
 
-  for (const auto& clientJson : clientsJson) {
+  for (const auto& clientJson : *clientsJson) {
     if (clientJson["address"].asString() == normalizedAddress) {
       workspaceId = clientJson["workspace"]["id"].asInt();
       break;
@@ -1051,12 +1053,12 @@ auto Workspaces::update() -> void {
 }
 
 void Workspaces::updateWindowCount() {
-  const Json::Value workspacesJson = m_ipc.getSocket1JsonReply("workspaces");
+  const auto workspacesJson = m_ipc.state().workspaces();
   for (auto const& workspace : m_workspaces) {
     auto workspaceJson = std::ranges::find_if(
-        workspacesJson, [&](Json::Value const& x) { return x["id"].asInt() == workspace->id(); });
+        *workspacesJson, [&](Json::Value const& x) { return x["id"].asInt() == workspace->id(); });
     uint32_t count = 0;
-    if (workspaceJson != workspacesJson.end()) {
+    if (workspaceJson != workspacesJson->end()) {
       try {
         count = (*workspaceJson)["windows"].asUInt();
       } catch (const std::exception& e) {
@@ -1095,11 +1097,11 @@ bool Workspaces::updateWindowsToCreate() {
 
 void Workspaces::updateWorkspaceStates() {
   const std::vector<int> visibleWorkspaces = getVisibleWorkspaces();
-  auto updatedWorkspaces = m_ipc.getSocket1JsonReply("workspaces");
+  const auto updatedWorkspaces = m_ipc.state().workspaces();
 
-  auto currentWorkspace = m_ipc.getSocket1JsonReply("activeworkspace");
+  const auto currentWorkspace = m_ipc.state().activeWorkspace();
   std::string currentWorkspaceName =
-      currentWorkspace.isMember("name") ? currentWorkspace["name"].asString() : "";
+      currentWorkspace->isMember("name") ? (*currentWorkspace)["name"].asString() : "";
 
   for (auto& workspace : m_workspaces) {
     bool isActiveByName =
@@ -1121,10 +1123,10 @@ void Workspaces::updateWorkspaceStates() {
     if (m_withTooltip) {
       workspaceTooltip = workspace->selectString(m_tooltipMap);
     }
-    auto updatedWorkspace = std::ranges::find_if(updatedWorkspaces, [&workspace](const auto& w) {
+    auto updatedWorkspace = std::ranges::find_if(*updatedWorkspaces, [&workspace](const auto& w) {
       return w["id"].asInt() == workspace->id();
     });
-    if (updatedWorkspace != updatedWorkspaces.end()) {
+    if (updatedWorkspace != updatedWorkspaces->end()) {
       workspace->setOutput((*updatedWorkspace)["monitor"].asString());
     }
     workspace->update(workspaceIcon, workspaceTooltip);
@@ -4,6 +4,8 @@
 
 #include <config.hpp>
 
+#include "util/pixbuf_cache.hpp"
+
 waybar::modules::Image::Image(const std::string& id, const Json::Value& config)
     : AModule(config, "image", id) {
   strategy_ = getStrategy(id, config, MODULE_CLASS, event_box_, tooltipEnabled());
@@ -25,9 +27,11 @@ waybar::modules::Image::Image(const std::string& id, const Json::Value& config)
     interval_ = once;
   }
 
-  delayWorker();
+  schedule(std::chrono::milliseconds::zero());
 }
 
+waybar::modules::Image::~Image() { util::command::Pool::instance().cancel(this); }
+
 auto waybar::modules::Image::getStrategy(const std::string& id, const Json::Value& cfg,
                                          const std::string& module, Gtk::EventBox& evbox,
                                          bool hasTooltip)
@@ -43,20 +47,29 @@ auto waybar::modules::Image::getStrategy(const std::string& id, const Json::Valu
   return strat;
 }
 
-void waybar::modules::Image::delayWorker() {
-  thread_ = [this] {
-    // Do the blocking work (e.g. running a user script) here on the worker
-    // thread; update() then only parses the result and draws on the main thread.
-    strategy_->fetch();
-    dp.emit();
-    thread_.sleep_for(interval_);
-  };
+void waybar::modules::Image::schedule(std::chrono::milliseconds delay) {
+  util::command::Pool::instance().submit(
+      this,
+      [this](std::stop_token stop) {
+        // Do the blocking work (e.g. running a user script) here on the worker
+        // thread; update() then only parses the result and draws on the main thread.
+        strategy_->fetch(stop);
+        if (stop.stop_requested()) {
+          return;
+        }
+        dp.emit();
+        if (interval_ != std::chrono::milliseconds::max()) {
+          schedule(interval_);
+        }
+      },
+      // The script has no timeout
+      delay, false);
 }
 
 void waybar::modules::Image::refresh(int sig) {
 #ifdef SIGRTMIN
   if (config_["signal"].isInt() && sig == SIGRTMIN + config_["signal"].asInt()) {
-    thread_.wake_up();
+    schedule(std::chrono::milliseconds::zero());
   }
 #endif
 }
@@ -85,12 +98,15 @@ MultipleImageStrategy::MultipleImageStrategy(const std::string& id, const Json::
   }
 }
 
-void MultipleImageStrategy::fetch() {
+void MultipleImageStrategy::fetch(std::stop_token stop) {
   // Run the (blocking) user script off the GTK main thread so the bar doesn't
   // freeze for the script's duration on every interval. update() consumes the
   // captured output. The static "entries" path takes priority and needs no exec.
   if (config_["entries"].empty() && !config_["exec"].empty()) {
-    exec_output_ = util::command::exec(config_["exec"].asString(), "").out;
+    auto output = util::command::run(config_["exec"].asString(), {.stop = stop});
+    if (!stop.stop_requested()) {
+      exec_output_.publish(std::move(output.out));
+    }
   }
 }
 
@@ -107,11 +123,13 @@ void MultipleImageStrategy::update() {
     setImagesData(config_["entries"]);
   } else if (!config_["exec"].empty()) {
     // exec output was captured by fetch() on the worker thread
+    exec_output_.acquire();
+    const auto& exec_output = exec_output_.current();
     Json::Value as_json;
     Json::Reader reader;
 
-    if (!reader.parse(exec_output_, as_json)) {
-      spdlog::error("invalid json from exec {}", exec_output_);
+    if (!reader.parse(exec_output, as_json)) {
+      spdlog::error("invalid json from exec {}", exec_output);
       return;
     }
 
@@ -139,7 +157,7 @@ void MultipleImageStrategy::setupAndDraw() {
 
     Glib::RefPtr<Gdk::Pixbuf> pixbuf;
     try {
-      pixbuf = Gdk::Pixbuf::create_from_file(path, size_, size_);
+      pixbuf = util::PixbufCache::instance().fromFile(path, size_, size_);
     } catch (const Glib::Error& e) {
       spdlog::error("failed to load image '{}': {}", path, std::string(e.what()));
       pixbuf.reset();  // fall through to the .empty branch
@@ -248,6 +266,16 @@ SingleImageStrategy::SingleImageStrategy(const std::string& id, const Json::Valu
   }
 }
 
+void SingleImageStrategy::fetch(std::stop_token stop) {
+  // A static "path" takes priority and needs no exec
+  if (!config_["path"].isString() && config_["exec"].isString()) {
+    auto output = util::command::run(config_["exec"].asString(), {.stop = stop});
+    if (!stop.stop_requested()) {
+      output_.publish(std::move(output));
+    }
+  }
+}
+
 void SingleImageStrategy::update() {
   if (config_["path"].isString()) {
     auto p = config_["path"].asString();
@@ -256,7 +284,8 @@ void SingleImageStrategy::update() {
     // otherwise keep the literal path so paths with spaces/metacharacters still work.
     path_ = (result.size() == 1) ? result.front() : p;
   } else if (config_["exec"].isString()) {
-    output_ = util::command::exec(config_["exec"].asString(), "");
+    // exec output was captured by fetch() on the worker thread
+    output_.acquire();
     parseOutputRaw();
     // expand path if "~" or "$HOME" is present in original path
     auto result = Config::tryExpandPath(path_, "");
@@ -267,7 +296,7 @@ void SingleImageStrategy::update() {
   if (Glib::file_test(path_, Glib::FILE_TEST_EXISTS)) {
     int scaled_icon_size = size_ * image_.get_scale_factor();
     try {
-      pixbuf = Gdk::Pixbuf::create_from_file(path_, scaled_icon_size, scaled_icon_size);
+      pixbuf = util::PixbufCache::instance().fromFile(path_, scaled_icon_size, scaled_icon_size);
     } catch (const Glib::Exception& e) {
       // Existing but corrupt/non-image file: degrade to the empty state instead of crashing.
       spdlog::warn("Failed to load image {}: {}", path_, std::string(e.what()));
@@ -306,7 +335,7 @@ void SingleImageStrategy::update() {
 }
 
 void SingleImageStrategy::parseOutputRaw() {
-  std::istringstream output(output_.out);
+  std::istringstream output(output_.current().out);
   std::string line;
   int i = 0;
   while (getline(output, line)) {
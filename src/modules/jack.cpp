@@ -11,6 +11,7 @@ JACK::JACK(const std::string& id, const Json::Value& config)
     dp.emit();
     thread_.sleep_for(interval_);
   };
+  adaptPolling(thread_);
 }
 
 std::string JACK::JACKState() {
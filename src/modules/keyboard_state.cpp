@@ -206,7 +206,7 @@ waybar::modules::KeyboardState::KeyboardState(const std::string& id, const Bar&
     throw errno_error(errno, "Failed to find keyboard device");
   }
 
-  libinput_thread_ = [this] {
+  libinput_thread_ = util::SleeperThread::Blocking{[this] {
     dp.emit();
     while (1) {
       struct pollfd fd = {libinput_get_fd(libinput_), POLLIN, 0};
@@ -228,9 +228,9 @@ waybar::modules::KeyboardState::KeyboardState(const std::string& id, const Bar&
         libinput_event_destroy(event);
       }
     }
-  };
+  }};
 
-  hotplug_thread_ = [this] {
+  hotplug_thread_ = util::SleeperThread::Blocking{[this] {
     int fd;
     fd = inotify_init();
     if (fd < 0) {
@@ -283,7 +283,7 @@ waybar::modules::KeyboardState::KeyboardState(const std::string& id, const Bar&
         i += sizeof(struct inotify_event) + event->len;
       }
     }
-  };
+  }};
 }
 
 waybar::modules::KeyboardState::~KeyboardState() {
@@ -10,24 +10,31 @@
 #endif
 
 waybar::modules::Load::Load(const std::string& id, const Json::Value& config)
-    : ALabel(config, "load", id, "{load1}", 10) {
-  thread_ = [this] {
-    dp.emit();
-    thread_.sleep_for(interval_);
-  };
+    : ALabel(config, "load", id, "{load1}", 10),
+      load_(subscribe(interval_, [this] { dp.emit(); })) {}
+
+auto waybar::modules::Load::subscribe(std::chrono::milliseconds interval,
+                                      const sigc::slot<void()>& slot)
+    -> util::SampleSubscription<Sample> {
+  return util::SampleHub<Sample>::subscribe(
+      "load", interval, [] { return &Load::getLoad; }, slot);
 }
 
 auto waybar::modules::Load::update() -> void {
+  auto sample = load_.latest();
+  if (!sample) {
+    return;
+  }
   // TODO: as creating dynamic fmt::arg arrays is buggy we have to calc both
-  auto [load1, load5, load15] = Load::getLoad();
+  const auto& [load1, load5, load15] = *sample;
   if (tooltipEnabled()) {
     auto tooltip = fmt::format("Load 1: {}\nLoad 5: {}\nLoad 15: {}", load1, load5, load15);
     label_.set_tooltip_markup(tooltip);
   }
   auto format = format_;
   auto state = getState(load1);
-  if (!state.empty() && config_["format-" + state].isString()) {
-    format = config_["format-" + state].asString();
+  if (const auto* state_format = stateFormat(state)) {
+    format = *state_format;
   }
 
   if (format.empty()) {
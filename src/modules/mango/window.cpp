@@ -8,7 +8,9 @@
 namespace waybar::modules::mango {
 
 Window::Window(const std::string& id, const Bar& bar, const Json::Value& config)
-    : AAppIconLabel(config, "window", id, "{title}", 0, true), bar_(bar) {
+    : AAppIconLabel(config, "window", id, "{title}", 0, true),
+      bar_(bar),
+      rewrite_(config_["rewrite"]) {
   IPC::getInstance().registerForIPC("monitor", this);
 }
 
@@ -42,10 +44,9 @@ void Window::doUpdate() {
   std::string sanitized_title = waybar::util::sanitize_string(title);
   std::string sanitized_appid = waybar::util::sanitize_string(appid);
 
-  label_.set_markup(waybar::util::rewriteString(
-      fmt::format(fmt::runtime(format_), fmt::arg("title", sanitized_title),
-                  fmt::arg("app_id", sanitized_appid)),
-      config_["rewrite"]));
+  label_.set_markup(rewrite_.apply(fmt::format(fmt::runtime(format_),
+                                               fmt::arg("title", sanitized_title),
+                                               fmt::arg("app_id", sanitized_appid))));
 
   updateAppIconName(appid, "");
   if (tooltipEnabled()) label_.set_tooltip_markup(title);
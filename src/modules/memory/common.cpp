@@ -12,11 +12,13 @@ const std::unordered_map<std::string, float> kUnits = {
 }
 
 waybar::modules::Memory::Memory(const std::string& id, const Json::Value& config)
-    : ALabel(config, "memory", id, "{}%", 30) {
-  thread_ = [this] {
-    dp.emit();
-    thread_.sleep_for(interval_);
-  };
+    : ALabel(config, "memory", id, "{}%", 30),
+      meminfo_(util::SampleHub<Meminfo>::subscribe(
+          "memory", interval_,
+          [] {
+            return [state = std::make_shared<SamplerState>()] { return parseMeminfo(*state); };
+          },
+          [this] { dp.emit(); })) {
   if (config["unit"].isString()) {
     unit_ = config["unit"].asString();
     if (!kUnits.contains(unit_)) {
@@ -28,25 +30,22 @@ waybar::modules::Memory::Memory(const std::string& id, const Json::Value& config
 }
 
 auto waybar::modules::Memory::update() -> void {
-  parseMeminfo();
-
-  unsigned long memtotal = meminfo_["MemTotal"];
-  unsigned long swaptotal = 0;
-  if (meminfo_.contains("SwapTotal")) {
-    swaptotal = meminfo_["SwapTotal"];
+  auto meminfo = meminfo_.latest();
+  if (!meminfo) {
+    return;
   }
+
+  unsigned long memtotal = meminfo->mem_total;
+  unsigned long swaptotal = meminfo->swap_total;
   unsigned long memfree;
-  unsigned long swapfree = 0;
-  if (meminfo_.contains("SwapFree")) {
-    swapfree = meminfo_["SwapFree"];
-  }
-  if (meminfo_.contains("MemAvailable")) {
+  unsigned long swapfree = meminfo->swap_free;
+  if (meminfo->has_mem_available) {
     // New kernels (3.4+) have an accurate available memory field.
-    memfree = meminfo_["MemAvailable"] + meminfo_["zfs_size"];
+    memfree = meminfo->mem_available + meminfo->zfs_size;
   } else {
     // Old kernel; give a best-effort approximation of available memory.
-    memfree = meminfo_["MemFree"] + meminfo_["Buffers"] + meminfo_["Cached"] +
-              meminfo_["SReclaimable"] - meminfo_["Shmem"] + meminfo_["zfs_size"];
+    memfree = meminfo->mem_free + meminfo->buffers + meminfo->cached + meminfo->s_reclaimable -
+              meminfo->shmem + meminfo->zfs_size;
   }
 
   if (memtotal > 0 && memfree >= 0) {
@@ -69,8 +68,8 @@ auto waybar::modules::Memory::update() -> void {
 
     auto format = format_;
     auto state = getState(used_ram_percentage);
-    if (!state.empty() && config_["format-" + state].isString()) {
-      format = config_["format-" + state].asString();
+    if (const auto* state_format = stateFormat(state)) {
+      format = *state_format;
     }
 
     if (format.empty()) {
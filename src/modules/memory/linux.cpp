@@ -1,43 +1,44 @@
 #include "modules/memory.hpp"
-
-static unsigned zfsArcSize() {
-  std::ifstream zfs_arc_stats{"/proc/spl/kstat/zfs/arcstats"};
-
-  if (zfs_arc_stats.is_open()) {
-    std::string name;
-    std::string type;
-    unsigned long data{0};
-
-    std::string line;
-    while (std::getline(zfs_arc_stats, line)) {
-      std::stringstream(line) >> name >> type >> data;
-
-      if (name == "size") {
-        return data / 1024;  // convert to kB
+#include "util/procfs.hpp"
+
+static unsigned zfsArcSize(waybar::util::procfs::File& zfs_arc_stats) {
+  unsigned long data{0};
+  if (auto text = zfs_arc_stats.tryRead()) {
+    // "name type data" columns, e.g. "size    4    123456789"
+    waybar::util::procfs::forEachLine(*text, [&data](std::string_view line) {
+      if (!line.starts_with("size ")) {
+        return true;
       }
-    }
+      line.remove_prefix(4);
+      unsigned type;
+      waybar::util::procfs::consumeNumber(line, type);
+      waybar::util::procfs::consumeNumber(line, data);
+      return false;
+    });
   }
 
-  return 0;
+  return data / 1024;  // convert to kB
 }
 
-void waybar::modules::Memory::parseMeminfo() {
-  const std::string data_dir_ = "/proc/meminfo";
-  std::ifstream info(data_dir_);
-  if (!info.is_open()) {
-    throw std::runtime_error("Can't open " + data_dir_);
-  }
-  std::string line;
-  while (getline(info, line)) {
-    auto posDelim = line.find(':');
-    if (posDelim == std::string::npos) {
-      continue;
-    }
-
-    std::string name = line.substr(0, posDelim);
-    int64_t value = std::stol(line.substr(posDelim + 1));
-    meminfo_[name] = value;
-  }
-
-  meminfo_["zfs_size"] = zfsArcSize();
+auto waybar::modules::Memory::parseMeminfo(SamplerState& state) -> Meminfo {
+  using util::procfs::Field;
+  static constexpr std::array<Field<Meminfo>, 9> fields{{
+      {"MemTotal", &Meminfo::mem_total},
+      {"MemFree", &Meminfo::mem_free},
+      {"MemAvailable", &Meminfo::mem_available},
+      {"Buffers", &Meminfo::buffers},
+      {"Cached", &Meminfo::cached},
+      {"SReclaimable", &Meminfo::s_reclaimable},
+      {"Shmem", &Meminfo::shmem},
+      {"SwapTotal", &Meminfo::swap_total},
+      {"SwapFree", &Meminfo::swap_free},
+  }};
+  constexpr uint64_t mem_available_bit = uint64_t{1} << 2;
+
+  // Both files stay open as long as the shared source and are re-read with pread()
+  Meminfo meminfo;
+  auto found = util::procfs::parseKeyValues(state.meminfo_file.read(), fields, meminfo);
+  meminfo.has_mem_available = (found & mem_available_bit) != 0;
+  meminfo.zfs_size = zfsArcSize(state.zfs_arc_stats_file);
+  return meminfo;
 }
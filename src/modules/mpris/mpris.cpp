@@ -170,16 +170,25 @@ Mpris::Mpris(const std::string& id, const Json::Value& config)
                      this, "signal::metadata", G_CALLBACK(onPlayerMetadata), this, NULL);
   }
 
-  // allow setting an interval count that triggers periodic refreshes
+  // Player info is read on the main context when a player signal arrives and, when an interval
+  // is set, periodically to refresh the position. The worker only keeps the time.
+  scheduleFetch();
   if (interval_.count() > 0) {
+    fetch_dp_.connect(sigc::mem_fun(*this, &Mpris::fetch));
     thread_ = [this] {
-      dp.emit();
       thread_.sleep_for(interval_);
+      fetch_dp_.emit();
     };
+    adaptPolling(thread_);
   }
 }
 
 Mpris::~Mpris() {
+  thread_.stop();
+  fetch_idle_.disconnect();
+  if (info_.skipped() > 0) {
+    spdlog::debug("mpris: {} player updates were dropped for newer ones", info_.skipped());
+  }
   if (manager != nullptr) {
     g_signal_handlers_disconnect_by_data(manager, this);
   }
@@ -390,7 +399,7 @@ auto Mpris::onPlayerNameAppeared(PlayerctlPlayerManager* manager, PlayerctlPlaye
                    G_CALLBACK(onPlayerPause), mpris, "signal::stop", G_CALLBACK(onPlayerStop),
                    mpris, "signal::metadata", G_CALLBACK(onPlayerMetadata), mpris, NULL);
 
-  mpris->dp.emit();
+  mpris->scheduleFetch();
 }
 
 auto Mpris::onPlayerNameVanished(PlayerctlPlayerManager* manager, PlayerctlPlayerName* player_name,
@@ -401,14 +410,14 @@ auto Mpris::onPlayerNameVanished(PlayerctlPlayerManager* manager, PlayerctlPlaye
   spdlog::debug("mpris: name-vanished callback: {}", player_name->name);
 
   if (mpris->player_ == "playerctld") {
-    mpris->dp.emit();
+    mpris->scheduleFetch();
   } else if (mpris->player_ == player_name->name) {
     // Don't touch GTK widgets directly from the playerctl callback: on resume
     // from suspend this can run in a re-entrant / torn-down state and crash in
     // Gtk::Widget::set_visible. Only update state + emit; update() (on the main
     // thread) hides the module when there is no player. See #5124.
     mpris->player = nullptr;
-    mpris->dp.emit();
+    mpris->scheduleFetch();
   }
 }
 
@@ -418,7 +427,7 @@ auto Mpris::onPlayerPlay(PlayerctlPlayer* player, gpointer data) -> void {
 
   spdlog::debug("mpris: player-play callback");
   // update widget
-  mpris->dp.emit();
+  mpris->scheduleFetch();
 }
 
 auto Mpris::onPlayerPause(PlayerctlPlayer* player, gpointer data) -> void {
@@ -427,7 +436,7 @@ auto Mpris::onPlayerPause(PlayerctlPlayer* player, gpointer data) -> void {
 
   spdlog::debug("mpris: player-pause callback");
   // update widget
-  mpris->dp.emit();
+  mpris->scheduleFetch();
 }
 
 auto Mpris::onPlayerStop(PlayerctlPlayer* player, gpointer data) -> void {
@@ -436,7 +445,7 @@ auto Mpris::onPlayerStop(PlayerctlPlayer* player, gpointer data) -> void {
 
   spdlog::debug("mpris: player-stop callback");
   // update widget (update() handles visibility)
-  mpris->dp.emit();
+  mpris->scheduleFetch();
 }
 
 auto Mpris::onPlayerMetadata(PlayerctlPlayer* player, GVariant* metadata, gpointer data) -> void {
@@ -445,7 +454,28 @@ auto Mpris::onPlayerMetadata(PlayerctlPlayer* player, GVariant* metadata, gpoint
 
   spdlog::debug("mpris: player-metadata callback");
   // update widget
-  mpris->dp.emit();
+  mpris->scheduleFetch();
+}
+
+auto Mpris::fetch() -> void {
+  fetch_idle_.disconnect();
+  // Not called by the bar, which would catch it
+  try {
+    info_.publish(getPlayerInfo());
+  } catch (const std::exception& e) {
+    spdlog::error("mpris: {}", e.what());
+    info_.publish(std::nullopt);
+  }
+  dp.emit();
+}
+
+auto Mpris::scheduleFetch() -> void {
+  if (!fetch_idle_.connected()) {
+    fetch_idle_ = Glib::signal_idle().connect([this] {
+      fetch();
+      return false;
+    });
+  }
 }
 
 auto Mpris::getPlayerInfo() -> std::optional<PlayerInfo> {
@@ -620,7 +650,8 @@ bool Mpris::handleToggle(GdkEventButton* const& e) {
     return false;
   }
 
-  auto info = getPlayerInfo();
+  // Act on the player that is shown instead of asking D-Bus again
+  const auto& info = info_.current();
   if (!info) return false;
 
   struct ButtonAction {
@@ -638,6 +669,7 @@ bool Mpris::handleToggle(GdkEventButton* const& e) {
 
   // Command pattern: encapsulate each button's action
   auto* target = last_active_player_ ? last_active_player_ : player;
+  if (target == nullptr) return false;
   const ButtonAction actions[] = {
       {1, "on-click", [&]() { playerctl_player_play_pause(target, &error); }},
       {2, "on-click-middle", [&]() { playerctl_player_previous(target, &error); }},
@@ -669,7 +701,8 @@ auto Mpris::update() -> void {
   if (now - last_update_ < interval_) return;
   last_update_ = now;
 
-  auto opt = getPlayerInfo();
+  info_.acquire();
+  const auto& opt = info_.current();
   if (!opt) {
     event_box_.set_visible(false);
     ALabel::update();
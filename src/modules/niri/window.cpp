@@ -10,7 +10,9 @@
 namespace waybar::modules::niri {
 
 Window::Window(const std::string& id, const Bar& bar, const Json::Value& config)
-    : AAppIconLabel(config, "window", id, "{title}", 0, true), bar_(bar) {
+    : AAppIconLabel(config, "window", id, "{title}", 0, true),
+      bar_(bar),
+      rewrite_(config_["rewrite"]) {
   if (!gIPC) gIPC = std::make_unique<IPC>();
 
   gIPC->registerForIPC("WindowsChanged", this);
@@ -68,11 +70,10 @@ void Window::doUpdate() {
     const auto sanitizedAppId = waybar::util::sanitize_string(appId);
 
     label_.show();
-    label_.set_markup(waybar::util::rewriteString(
+    label_.set_markup(rewrite_.apply(
         fmt::format(fmt::runtime(format_), fmt::arg("title", sanitizedTitle),
                     fmt::arg("app_id", sanitizedAppId), fmt::arg("col", col),
-                    fmt::arg("max_col", max_col)),
-        config_["rewrite"]));
+                    fmt::arg("max_col", max_col))));
 
     updateAppIconName(appId, "");
 
@@ -93,10 +94,9 @@ void Window::doUpdate() {
   } else {
     if (config_["show-empty"].asBool()) {
       label_.show();
-      label_.set_markup(waybar::util::rewriteString(
+      label_.set_markup(rewrite_.apply(
           fmt::format(fmt::runtime(format_), fmt::arg("title", ""), fmt::arg("app_id", ""),
-                      fmt::arg("col", -1), fmt::arg("max_col", -1)),
-          config_["rewrite"]));
+                      fmt::arg("col", -1), fmt::arg("max_col", -1))));
     } else {
       label_.hide();
     }
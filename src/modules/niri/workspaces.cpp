@@ -5,11 +5,20 @@
 
 #include <algorithm>
 #include <cctype>
-
-#include "util/rewrite_string.hpp"  // Needed for rewrite logic
+#include <string_view>
 
 namespace waybar::modules::niri {
 
+namespace {
+
+bool equalsIgnoreCase(std::string_view value, std::string_view lowercase) {
+  return std::ranges::equal(value, lowercase, [](char a, char b) {
+    return std::tolower(static_cast<unsigned char>(a)) == b;
+  });
+}
+
+}  // namespace
+
 Workspaces::Workspaces(const std::string& id, const Bar& bar, const Json::Value& config)
     : AModule(config, "workspaces", id, false, false), bar_(bar), box_(bar.orientation, 0) {
   const auto config_sort_by_number = config_["sort-by-number"];
@@ -192,7 +201,9 @@ void Workspaces::populateWindowRewriteConfig() {
     // If Niri needs rule prioritization like Hyprland, a priority function
     // would be needed as a second argument here.
     try {
-      m_windowRewriteRules = util::RegexCollection(rewrite_rules_config);
+      m_windowRewriteRules = util::RegexCollection(
+          rewrite_rules_config, "", util::default_priority_function,
+          util::RegexCollection::cacheSizeFromConfig(config_));
     } catch (const std::exception& e) {
       spdlog::error("Error initializing RegexCollection: {}", e.what());
       // Initialize with an empty collection if error occurs
@@ -224,40 +235,31 @@ std::string Workspaces::getRewrite(const std::string& app_id, const std::string&
   // Niri uses app_id, Hyprland uses class. Adapt the key format.
   std::string lookup_key = "app_id<" + app_id + "> title<" + title + ">";
   std::string res = m_windowRewriteRules.get(lookup_key);
-  if (!res.empty()) {
-    // Create Json::Value for substitutions
-    Json::Value substitutions(Json::objectValue);
-    substitutions["app_id"] = app_id;
-    substitutions["title"] = title;
-    return util::rewriteString(res, substitutions);
+  if (res.empty()) {
+    // Fallback to app_id only
+    lookup_key = "app_id<" + app_id + ">";
+    res = m_windowRewriteRules.get(lookup_key);
   }
-  // Fallback to app_id only
-  lookup_key = "app_id<" + app_id + ">";
-  res = m_windowRewriteRules.get(lookup_key);
-  if (!res.empty()) {
-    // Create Json::Value for substitutions
-    Json::Value substitutions(Json::objectValue);
-    substitutions["app_id"] = app_id;
-    substitutions["title"] = title;
-    return util::rewriteString(res, substitutions);
+  if (res.empty()) {
+    // Fallback to title only
+    lookup_key = "title<" + title + ">";
+    res = m_windowRewriteRules.get(lookup_key);
   }
-  // Fallback to title only
-  lookup_key = "title<" + title + ">";
-  res = m_windowRewriteRules.get(lookup_key);
-  if (!res.empty()) {
-    // Create Json::Value for substitutions
-    Json::Value substitutions(Json::objectValue);
-    substitutions["app_id"] = app_id;
-    substitutions["title"] = title;
-    return util::rewriteString(res, substitutions);
+  if (res.empty()) {
+    // No rule matched, use the default, which may be a placeholder as well
+    res = m_windowRewriteDefault;
   }
 
-  // No rule matched, return default
-  // Apply substitutions to default as well, in case it uses placeholders
-  Json::Value substitutions(Json::objectValue);
-  substitutions["app_id"] = app_id;
-  substitutions["title"] = title;
-  return util::rewriteString(m_windowRewriteDefault, substitutions);
+  // A representation that is "app_id" or "title", in any case, is replaced by that value, in
+  // that order. rewriteString() with these two constant rules did the same, but compiled both
+  // regexes for every window.
+  if (equalsIgnoreCase(res, "app_id")) {
+    res = app_id;
+  }
+  if (equalsIgnoreCase(res, "title")) {
+    res = title;
+  }
+  return res;
 }
 
 // Build the "{windows}" replacement string for a workspace using window-rewrite rules.
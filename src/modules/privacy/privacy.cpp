@@ -110,9 +110,10 @@ Privacy::Privacy(const std::string& id, const Json::Value& config, Gtk::Orientat
     ignore_monitor = config_["ignore-monitor"].asBool();
   }
 
-  pw_backend = util::PipewireBackend::PipewireBackend::getInstance();
-  pw_backend->privacy_nodes_changed_signal_event.connect(
-      sigc::mem_fun(*this, &Privacy::onPWPrivacyNodesChanged));
+  pw_backend = util::PipewireBackend::PipewireBackend::getInstance(
+      [this] { onPWPrivacyNodesChanged(); });
+  // The backend may have been started by another bar already
+  onPWPrivacyNodesChanged();
 
   geoclue_backend = util::GeoClueBackend::GeoClueBackend::getInstance();
   geoclue_backend->in_use_changed_signal_event.connect(
@@ -125,6 +126,8 @@ void Privacy::onPWPrivacyNodesChanged() {
   nodes_audio_in.clear();
   nodes_screenshare.clear();
 
+  // Shared with the privacy modules of other bars
+  std::unique_lock nodes_lock(pw_backend->mutex_);
   for (auto& node : pw_backend->privacy_nodes) {
     if (ignore_monitor && node.second->is_monitor) continue;
 
@@ -151,6 +154,7 @@ void Privacy::onPWPrivacyNodesChanged() {
         break;
     }
   }
+  nodes_lock.unlock();
 
   mutex_.unlock();
   dp.emit();
@@ -5,9 +5,7 @@ waybar::modules::Pulseaudio::Pulseaudio(const std::string& id, const Json::Value
   event_box_.add_events(Gdk::SCROLL_MASK | Gdk::SMOOTH_SCROLL_MASK);
   event_box_.signal_scroll_event().connect(sigc::mem_fun(*this, &Pulseaudio::handleScroll));
 
-  backend = util::AudioBackend::getInstance([this] { this->dp.emit(); });
-  backend->setIgnoredSinks(config_["ignored-sinks"]);
-  backend->setSinkMapping(config_["sink-mapping"]);
+  backend = util::AudioBackend::getInstance(config_, [this] { this->dp.emit(); });
 
   if (config_["target"].isString() && config_["target"].asString() == "source") {
     target = util::PulseaudioTarget::Source;
@@ -4,9 +4,7 @@ namespace waybar::modules {
 
 PulseaudioSlider::PulseaudioSlider(const std::string& id, const Json::Value& config)
     : ASlider(config, "pulseaudio-slider", id) {
-  backend = util::AudioBackend::getInstance([this] { this->dp.emit(); });
-  backend->setIgnoredSinks(config_["ignored-sinks"]);
-  backend->setSinkMapping(config_["sink-mapping"]);
+  backend = util::AudioBackend::getInstance(config_, [this] { this->dp.emit(); });
 
   if (config_["target"].isString()) {
     std::string target = config_["target"].asString();
@@ -3,15 +3,10 @@
 #include <time.h>
 
 waybar::modules::Clock::Clock(const std::string& id, const Json::Value& config)
-    : ALabel(config, "clock", id, "{:%H:%M}", 60) {
-  thread_ = [this] {
-    dp.emit();
-    auto now = std::chrono::system_clock::now();
-    /* difference with projected wakeup time */
-    auto diff = now.time_since_epoch() % interval_;
-    /* sleep until the next projected time */
-    thread_.sleep_for(interval_ - diff);
-  };
+    : ALabel(config, "clock", id, "{:%H:%M}", 60),
+      tick_(util::ClockTick::subscribe(interval_, [this] { dp.emit(); })) {
+  // The tick may be shared with clocks that already started
+  dp.emit();
 }
 
 auto waybar::modules::Clock::update() -> void {
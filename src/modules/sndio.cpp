@@ -57,7 +57,7 @@ Sndio::Sndio(const std::string& id, const Json::Value& config)
   event_box_.signal_scroll_event().connect(sigc::mem_fun(*this, &Sndio::handleScroll));
   event_box_.signal_button_press_event().connect(sigc::mem_fun(*this, &Sndio::handleToggle));
 
-  thread_ = [this] {
+  thread_ = util::SleeperThread::Blocking{[this] {
     dp.emit();
 
     int nfds = sioctl_pollfd(hdl_, pfds_.data(), POLLIN);
@@ -95,7 +95,7 @@ Sndio::Sndio(const std::string& id, const Json::Value& config)
         break;
       }
     }
-  };
+  }};
 }
 
 Sndio::~Sndio() { sioctl_close(hdl_); }
@@ -17,6 +17,7 @@
 #include "modules/sni/icon_manager.hpp"
 #include "util/format.hpp"  // IWYU pragma: keep
 #include "util/gtk_icon.hpp"
+#include "util/pixbuf_cache.hpp"
 
 template <>
 struct fmt::formatter<Glib::VariantBase> : formatter<std::string> {
@@ -300,7 +301,8 @@ void Item::setCustomIcon(const std::string& id) {
   if (!custom_icon.empty()) {
     if (std::filesystem::exists(custom_icon)) {
       try {
-        Glib::RefPtr<Gdk::Pixbuf> custom_pixbuf = Gdk::Pixbuf::create_from_file(custom_icon);
+        Glib::RefPtr<Gdk::Pixbuf> custom_pixbuf =
+            util::PixbufCache::instance().fromFile(custom_icon);
         icon_name = "";  // icon_name has priority over pixmap
         icon_pixmap = custom_pixbuf;
         has_custom_icon_ = true;
@@ -499,7 +501,7 @@ Glib::RefPtr<Gdk::Pixbuf> Item::loadIconFromNameOrFile(const std::string& name,
   try {
     std::ifstream temp(name);
     if (temp.is_open()) {
-      return Gdk::Pixbuf::create_from_file(name);
+      return util::PixbufCache::instance().fromFile(name);
     }
   } catch (const Glib::Error& e) {
     if (log_failure) {
@@ -547,11 +549,20 @@ Glib::RefPtr<Gdk::Pixbuf> Item::overlayPixbufs(const Glib::RefPtr<Gdk::Pixbuf>&
 
 Glib::RefPtr<Gdk::Pixbuf> Item::getIconByName(const std::string& name, int request_size) {
   if (!icon_theme_path.empty()) {
-    auto icon_info = icon_theme->lookup_icon(name.c_str(), request_size,
-                                             Gtk::IconLookupFlags::ICON_LOOKUP_FORCE_SIZE);
-    if (icon_info) {
-      bool is_sym = false;
-      return icon_info.load_symbolic(event_box.get_style_context(), is_sym);
+    auto style = event_box.get_style_context();
+    auto pixbuf = util::PixbufCache::instance().fromTheme(
+        icon_theme, name, request_size, Gtk::IconLookupFlags::ICON_LOOKUP_FORCE_SIZE, style,
+        [&]() -> Glib::RefPtr<Gdk::Pixbuf> {
+          auto icon_info = icon_theme->lookup_icon(name.c_str(), request_size,
+                                                   Gtk::IconLookupFlags::ICON_LOOKUP_FORCE_SIZE);
+          if (!icon_info) {
+            return {};
+          }
+          bool is_sym = false;
+          return icon_info.load_symbolic(style, is_sym);
+        });
+    if (pixbuf) {
+      return pixbuf;
     }
   }
   return DefaultGtkIconThemeWrapper::load_icon(name.c_str(), request_size,
@@ -45,7 +45,6 @@ void sendAll(int fd, const char* data, size_t size, const char* what) {
 Ipc::Ipc() {
   socketPath_ = getSocketPath();
   fd_ = util::ScopedFd(open(socketPath_));
-  fd_event_ = util::ScopedFd(open(socketPath_));
 }
 
 Ipc::~Ipc() {
@@ -67,7 +66,9 @@ Ipc::~Ipc() {
   }
 }
 
-void Ipc::setWorker(std::function<void()>&& func) { thread_ = std::move(func); }
+void Ipc::setWorker(std::function<void()>&& func) {
+  thread_ = util::SleeperThread::Blocking{std::move(func)};
+}
 
 std::string Ipc::getSocketPath() {
   const char* env = getenv("SWAYSOCK");
@@ -122,7 +123,7 @@ struct Ipc::ipc_response Ipc::recv(int fd) {
   size_t total = 0;
   while (total < ipc_header_size_) {
     const ssize_t res = ::recv(fd, header.data() + total, ipc_header_size_ - total, 0);
-    if (fd_event_ == -1 || fd_ == -1) {
+    if (fd_ == -1) {
       // IPC is closed so just return an empty response
       return {.size = 0, .type = 0, .payload = ""};
     }
@@ -186,12 +187,20 @@ struct Ipc::ipc_response Ipc::send(int fd, uint32_t type, const std::string& pay
 }
 
 void Ipc::sendCmd(uint32_t type, const std::string& payload) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  const auto res = Ipc::send(fd_, type, payload);
+  const auto res = query(type, payload);
   signal_cmd.emit(res);
 }
 
+struct Ipc::ipc_response Ipc::query(uint32_t type, const std::string& payload) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return Ipc::send(fd_, type, payload);
+}
+
 void Ipc::subscribe(const std::string& payload) {
+  // Only opened on the first subscription, so command-only clients don't hold an event socket
+  if (fd_event_ == -1) {
+    fd_event_.reset(open(socketPath_));
+  }
   auto res = Ipc::send(fd_event_, IPC_SUBSCRIBE, payload);
   if (res.payload != "{\"success\": true}") {
     throw std::runtime_error("Unable to subscribe ipc event");
@@ -227,17 +236,23 @@ void Ipc::reconnectEvent() {
 }
 
 void Ipc::handleEvent() {
+  if (auto res = readEvent()) {
+    signal_event.emit(*res);
+  }
+}
+
+std::optional<struct Ipc::ipc_response> Ipc::readEvent() {
   try {
-    const auto res = Ipc::recv(fd_event_);
-    signal_event.emit(res);
+    return Ipc::recv(fd_event_);
   } catch (const std::exception& e) {
     if (!running_) {
       // The Ipc is being torn down; the socket was closed on purpose.
-      return;
+      return std::nullopt;
     }
     spdlog::warn("Lost sway IPC event connection ({}), reconnecting", e.what());
     reconnectEvent();
   }
+  return std::nullopt;
 }
 
 }  // namespace waybar::modules::sway
@@ -0,0 +1,128 @@
+#include "modules/sway/ipc/tree.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <string>
+#include <utility>
+
+#include "modules/sway/ipc/ipc.hpp"
+#include "modules/sway/ipc/tree_patch.hpp"
+
+namespace waybar::modules::sway {
+
+std::shared_ptr<Tree> Tree::getInstance() {
+  static std::mutex mutex;
+  static std::weak_ptr<Tree> instance;
+
+  std::lock_guard lock(mutex);
+  auto tree = instance.lock();
+  if (!tree) {
+    tree = std::shared_ptr<Tree>(new Tree());
+    instance = tree;
+  }
+  return tree;
+}
+
+Tree::Tree() {
+  dp_.connect([this] {
+    if (auto tree = snapshot()) {
+      signal_tree.emit(*tree);
+    }
+  });
+  ipc_.subscribe(R"(["window","workspace"])");
+  // Waits for sway to answer IPC_GET_TREE
+  fetch_thread_ = util::SleeperThread::Blocking{[this] { fetchWorker(); }};
+  ipc_.setWorker([this] { onEvent(ipc_.readEvent()); });
+}
+
+Tree::~Tree() { fetch_thread_.stop(); }
+
+auto Tree::snapshot() const -> snapshot_t {
+  std::lock_guard lock(mutex_);
+  return snapshot_;
+}
+
+void Tree::onEvent(std::optional<struct Ipc::ipc_response> event) {
+  {
+    std::lock_guard lock(mutex_);
+    if (!event) {
+      // Reconnected after losing the event socket; anything may have changed meanwhile
+      refresh_requested_ = true;
+    } else if (event->type == IPC_EVENT_WINDOW || event->type == IPC_EVENT_WORKSPACE) {
+      pending_.emplace_back(std::move(*event));
+    } else {
+      return;
+    }
+  }
+  fetch_thread_.wake_up();
+}
+
+void Tree::fetchWorker() {
+  std::vector<struct Ipc::ipc_response> events;
+  bool refresh;
+  {
+    std::unique_lock lock(mutex_);
+    if (pending_.empty() && !refresh_requested_) {
+      lock.unlock();
+      fetch_thread_.sleep();
+      return;
+    }
+    events.swap(pending_);
+    refresh = refresh_requested_;
+    refresh_requested_ = false;
+  }
+
+  try {
+    auto current = snapshot();
+    if (!refresh && current) {
+      // Cheap path: every queued event only touches container properties or the focus
+      std::vector<std::pair<uint32_t, Json::Value>> parsed;
+      parsed.reserve(events.size());
+      for (const auto& event : events) {
+        auto payload = parser_.parse(event.payload);
+        if (!isPatchableEvent(event.type, payload)) {
+          refresh = true;
+          break;
+        }
+        parsed.emplace_back(event.type, std::move(payload));
+      }
+      if (!refresh) {
+        auto tree = std::make_shared<Json::Value>(*current);
+        for (const auto& [type, payload] : parsed) {
+          if (!patchTree(*tree, type, payload)) {
+            refresh = true;
+            break;
+          }
+        }
+        if (!refresh) {
+          publish(std::move(tree));
+          return;
+        }
+      }
+    }
+    fetch();
+  } catch (const std::exception& e) {
+    spdlog::error("sway tree: {}", e.what());
+    {
+      std::lock_guard lock(mutex_);
+      refresh_requested_ = true;
+    }
+    fetch_thread_.sleep_for(std::chrono::seconds(1));
+  }
+}
+
+void Tree::fetch() {
+  const auto res = ipc_.query(IPC_GET_TREE);
+  publish(std::make_shared<const Json::Value>(parser_.parse(res.payload)));
+}
+
+void Tree::publish(snapshot_t tree) {
+  {
+    std::lock_guard lock(mutex_);
+    snapshot_ = std::move(tree);
+  }
+  dp_.emit();
+}
+
+}  // namespace waybar::modules::sway
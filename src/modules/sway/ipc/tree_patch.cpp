@@ -0,0 +1,130 @@
+#include "modules/sway/ipc/tree_patch.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "modules/sway/ipc/ipc.hpp"
+
+namespace waybar::modules::sway {
+namespace {
+
+// Appends the nodes from `node` down to the first one matching `pred` to `path`
+template <typename Pred>
+bool findPath(Json::Value& node, const Pred& pred, std::vector<Json::Value*>& path) {
+  path.push_back(&node);
+  if (pred(node)) {
+    return true;
+  }
+  for (const char* children : {"nodes", "floating_nodes"}) {
+    if (!node.isMember(children)) {
+      continue;
+    }
+    for (auto& child : node[children]) {
+      if (findPath(child, pred, path)) {
+        return true;
+      }
+    }
+  }
+  path.pop_back();
+  return false;
+}
+
+bool findPath(Json::Value& tree, const Json::Value& container, std::vector<Json::Value*>& path) {
+  if (!container.isMember("id")) {
+    return false;
+  }
+  const auto id = container["id"].asInt64();
+  return findPath(
+      tree,
+      [id](const Json::Value& node) { return node.isMember("id") && node["id"].asInt64() == id; },
+      path);
+}
+
+const Json::Value* workspaceOf(const std::vector<Json::Value*>& path) {
+  auto it = std::find_if(path.begin(), path.end(), [](const Json::Value* node) {
+    return (*node)["type"].asString() == "workspace";
+  });
+  return it == path.end() ? nullptr : *it;
+}
+
+// Copy the container's own properties, leaving its children (and their focus order) alone
+void copyProperties(Json::Value& node, const Json::Value& container) {
+  for (const auto& name : container.getMemberNames()) {
+    if (name != "nodes" && name != "floating_nodes") {
+      node[name] = container[name];
+    }
+  }
+}
+
+// Move the `focused` flag to the container and the container to the front of the focus order of
+// each of its ancestors, as sway does when the focus moves within a workspace
+bool patchFocus(Json::Value& tree, const Json::Value& container) {
+  std::vector<Json::Value*> path;
+  if (!findPath(tree, container, path)) {
+    return false;
+  }
+  std::vector<Json::Value*> previous;
+  if (!findPath(
+          tree, [](const Json::Value& node) { return node["focused"].asBool(); }, previous)) {
+    return false;
+  }
+  const auto* workspace = workspaceOf(path);
+  if (workspace == nullptr || workspace != workspaceOf(previous)) {
+    return false;
+  }
+
+  (*previous.back())["focused"] = false;
+  copyProperties(*path.back(), container);
+  for (size_t i = 0; i + 1 < path.size(); ++i) {
+    auto& focus = (*path[i])["focus"];
+    if (!focus.isArray()) {
+      continue;
+    }
+    const auto& id = (*path[i + 1])["id"];
+    Json::Value reordered(Json::arrayValue);
+    reordered.append(id);
+    for (const auto& entry : focus) {
+      if (entry != id) {
+        reordered.append(entry);
+      }
+    }
+    focus.swap(reordered);
+  }
+  return true;
+}
+
+}  // namespace
+
+bool isPatchableEvent(uint32_t type, const Json::Value& event) {
+  const auto change = event["change"].asString();
+  if (type == IPC_EVENT_WINDOW) {
+    return change == "title" || change == "mark" || change == "urgent" || change == "focus";
+  }
+  return type == IPC_EVENT_WORKSPACE && change == "urgent";
+}
+
+bool patchTree(Json::Value& tree, uint32_t type, const Json::Value& event) {
+  if (!isPatchableEvent(type, event)) {
+    return false;
+  }
+  if (type == IPC_EVENT_WORKSPACE) {
+    std::vector<Json::Value*> path;
+    if (!findPath(tree, event["current"], path)) {
+      return false;
+    }
+    copyProperties(*path.back(), event["current"]);
+    return true;
+  }
+  if (event["change"].asString() == "focus") {
+    return patchFocus(tree, event["container"]);
+  }
+  std::vector<Json::Value*> path;
+  if (!findPath(tree, event["container"], path)) {
+    return false;
+  }
+  copyProperties(*path.back(), event["container"]);
+  return true;
+}
+
+}  // namespace waybar::modules::sway
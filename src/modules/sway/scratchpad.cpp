@@ -13,20 +13,12 @@ Scratchpad::Scratchpad(const std::string& id, const Json::Value& config)
       show_empty_(config_["show-empty"].isBool() ? config_["show-empty"].asBool() : false),
       tooltip_enabled_(config_["tooltip"].isBool() ? config_["tooltip"].asBool() : true),
       tooltip_text_(""),
-      count_(0) {
-  ipc_.subscribe(R"(["window"])");
-  ipc_.signal_event.connect(sigc::mem_fun(*this, &Scratchpad::onEvent));
-  ipc_.signal_cmd.connect(sigc::mem_fun(*this, &Scratchpad::onCmd));
-
-  getTree();
-
-  ipc_.setWorker([this] {
-    try {
-      ipc_.handleEvent();
-    } catch (const std::exception& e) {
-      spdlog::error("Scratchpad: {}", e.what());
-    }
-  });
+      count_(0),
+      tree_(Tree::getInstance()) {
+  tree_->signal_tree.connect(sigc::mem_fun(*this, &Scratchpad::onTree));
+  if (auto tree = tree_->snapshot()) {
+    onTree(*tree);
+  }
 }
 auto Scratchpad::update() -> void {
   if (count_ || show_empty_) {
@@ -49,18 +41,8 @@ auto Scratchpad::update() -> void {
   ALabel::update();
 }
 
-auto Scratchpad::getTree() -> void {
+auto Scratchpad::onTree(const Json::Value& tree) -> void {
   try {
-    ipc_.sendCmd(IPC_GET_TREE);
-  } catch (const std::exception& e) {
-    spdlog::error("Scratchpad: {}", e.what());
-  }
-}
-
-auto Scratchpad::onCmd(const struct Ipc::ipc_response& res) -> void {
-  try {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto tree = parser_.parse(res.payload);
     count_ = tree["nodes"][0]["nodes"][0]["floating_nodes"].size();
     if (tooltip_enabled_) {
       tooltip_text_.clear();
@@ -78,6 +60,4 @@ auto Scratchpad::onCmd(const struct Ipc::ipc_response& res) -> void {
     spdlog::error("Scratchpad: {}", e.what());
   }
 }
-
-auto Scratchpad::onEvent(const struct Ipc::ipc_response& res) -> void { getTree(); }
 }  // namespace waybar::modules::sway
\ No newline at end of file
@@ -17,39 +17,27 @@
 namespace waybar::modules::sway {
 
 Window::Window(const std::string& id, const Bar& bar, const Json::Value& config)
-    : AAppIconLabel(config, "window", id, "{}", 0, true), bar_(bar), windowId_(-1) {
-  ipc_.subscribe(R"(["window","workspace"])");
-  ipc_.signal_event.connect(sigc::mem_fun(*this, &Window::onEvent));
-  ipc_.signal_cmd.connect(sigc::mem_fun(*this, &Window::onCmd));
+    : AAppIconLabel(config, "window", id, "{}", 0, true),
+      bar_(bar),
+      rewrite_(config_["rewrite"]),
+      windowId_(-1),
+      tree_(Tree::getInstance()) {
+  tree_->signal_tree.connect(sigc::mem_fun(*this, &Window::onTree));
   // Get Initial focused window
-  getTree();
-  // Launch worker
-  ipc_.setWorker([this] {
-    try {
-      ipc_.handleEvent();
-    } catch (const std::exception& e) {
-      spdlog::error("Window: {}", e.what());
-      spdlog::trace("Window::Window exception");
-    }
-  });
+  if (auto tree = tree_->snapshot()) {
+    onTree(*tree);
+  }
 }
 
-void Window::onEvent(const struct Ipc::ipc_response& res) { getTree(); }
-
-void Window::onCmd(const struct Ipc::ipc_response& res) {
+void Window::onTree(const Json::Value& tree) {
   try {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto payload = parser_.parse(res.payload);
-    auto output = payload["output"].isString() ? payload["output"].asString() : "";
+    auto output = tree["output"].isString() ? tree["output"].asString() : "";
     std::tie(app_nb_, floating_count_, windowId_, window_, app_id_, app_class_, shell_, layout_,
-             marks_) = getFocusedNode(payload["nodes"], output);
-    // Do not resolve the app icon here: onCmd runs on the sway IPC worker thread and
-    // updateAppIconName() touches the global Gtk::IconTheme cache, which is not thread-safe.
-    // The icon is resolved in update() on the main thread instead (triggered by dp.emit()).
+             marks_) = getFocusedNode(tree["nodes"], output);
     dp.emit();
   } catch (const std::exception& e) {
     spdlog::error("Window: {}", e.what());
-    spdlog::trace("Window::onCmd exception");
+    spdlog::trace("Window::onTree exception");
   }
 }
 
@@ -96,16 +84,15 @@ auto Window::update() -> void {
     old_app_id_ = app_id_;
   }
 
-  setLabelMarkup(waybar::util::rewriteString(
+  setLabelMarkup(rewrite_.apply(
       fmt::format(fmt::runtime(format_), fmt::arg("title", window_), fmt::arg("app_id", app_id_),
-                  fmt::arg("shell", shell_), fmt::arg("marks", marks_)),
-      config_["rewrite"]));
+                  fmt::arg("shell", shell_), fmt::arg("marks", marks_))));
   if (tooltipEnabled()) {
     setTooltipMarkup(Glib::Markup::escape_text(window_));
   }
 
   // Resolve the app icon on the main thread to avoid racing with GTK draw on the
-  // global Gtk::IconTheme cache (see onCmd).
+  // global Gtk::IconTheme cache.
   updateAppIconName(app_id_, app_class_);
   updateAppIcon();
 
@@ -311,13 +298,4 @@ Window::getFocusedNode(const Json::Value& nodes, std::string& output) {
   return gfnWithWorkspace(nodes, output, config_, bar_, placeholder, placeholder);
 }
 
-void Window::getTree() {
-  try {
-    ipc_.sendCmd(IPC_GET_TREE);
-  } catch (const std::exception& e) {
-    spdlog::error("Window: {}", e.what());
-    spdlog::trace("Window::getTree exception");
-  }
-}
-
 }  // namespace waybar::modules::sway
@@ -44,7 +44,8 @@ int Workspaces::windowRewritePriorityFunction(std::string const& window_rule) {
 Workspaces::Workspaces(const std::string& id, const Bar& bar, const Json::Value& config)
     : AModule(config, "workspaces", id, false, !config["disable-scroll"].asBool()),
       bar_(bar),
-      box_(bar.orientation, 0) {
+      box_(bar.orientation, 0),
+      tree_(Tree::getInstance()) {
   if (config["format-icons"]["high-priority-named"].isArray()) {
     for (const auto& it : config["format-icons"]["high-priority-named"]) {
       high_priority_named_.push_back(it.asString());
@@ -82,35 +83,19 @@ Workspaces::Workspaces(const std::string& id, const Bar& bar, const Json::Value&
     std::string windowRewriteDefault =
         windowRewriteDefaultConfig.isString() ? windowRewriteDefaultConfig.asString() : "?";
     m_windowRewriteRules = waybar::util::RegexCollection(
-        windowRewrite, std::move(windowRewriteDefault), windowRewritePriorityFunction);
+        windowRewrite, std::move(windowRewriteDefault), windowRewritePriorityFunction,
+        waybar::util::RegexCollection::cacheSizeFromConfig(config));
   }
   populateIgnoreWorkspacesConfig(config);
-  ipc_.subscribe(R"(["workspace"])");
-  ipc_.subscribe(R"(["window"])");
-  ipc_.signal_event.connect(sigc::mem_fun(*this, &Workspaces::onEvent));
-  ipc_.signal_cmd.connect(sigc::mem_fun(*this, &Workspaces::onCmd));
-  ipc_.sendCmd(IPC_GET_TREE);
+  tree_->signal_tree.connect(sigc::mem_fun(*this, &Workspaces::onTree));
+  if (auto tree = tree_->snapshot()) {
+    onTree(*tree);
+  }
   if (config["enable-bar-scroll"].asBool()) {
     auto& window = const_cast<Bar&>(bar_).window;
     window.add_events(Gdk::SCROLL_MASK | Gdk::SMOOTH_SCROLL_MASK);
     window.signal_scroll_event().connect(sigc::mem_fun(*this, &Workspaces::handleScroll));
   }
-  // Launch worker
-  ipc_.setWorker([this] {
-    try {
-      ipc_.handleEvent();
-    } catch (const std::exception& e) {
-      spdlog::error("Workspaces: {}", e.what());
-    }
-  });
-}
-
-void Workspaces::onEvent(const struct Ipc::ipc_response& res) {
-  try {
-    ipc_.sendCmd(IPC_GET_TREE);
-  } catch (const std::exception& e) {
-    spdlog::error("Workspaces: {}", e.what());
-  }
 }
 
 auto Workspaces::populateIgnoreWorkspacesConfig(const Json::Value& config) -> void {
@@ -143,145 +128,134 @@ bool Workspaces::isWorkspaceIgnored(std::string const& name) {
   return false;
 }
 
-void Workspaces::onCmd(const struct Ipc::ipc_response& res) {
-  if (res.type == IPC_GET_TREE) {
-    try {
-      {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto payload = parser_.parse(res.payload);
-        workspaces_.clear();
-        std::vector<Json::Value> outputs;
-        bool alloutputs = config_["all-outputs"].asBool();
-        std::copy_if(payload["nodes"].begin(), payload["nodes"].end(), std::back_inserter(outputs),
-                     [&](const auto& output) {
-                       if (alloutputs && output["name"].asString() != "__i3") {
-                         return true;
-                       }
-                       if (output["name"].asString() == bar_.output->name) {
-                         return true;
-                       }
-                       return false;
-                     });
-
-        for (auto& output : outputs) {
-          std::copy_if(
-              output["nodes"].begin(), output["nodes"].end(), std::back_inserter(workspaces_),
-              [&](const auto& node) { return !(isWorkspaceIgnored(node["name"].asString())); });
-          std::copy(output["floating_nodes"].begin(), output["floating_nodes"].end(),
-                    std::back_inserter(workspaces_));
+void Workspaces::onTree(const Json::Value& tree) {
+  try {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      workspaces_.clear();
+      bool alloutputs = config_["all-outputs"].asBool();
+      for (const auto& output : tree["nodes"]) {
+        const auto name = output["name"].asString();
+        if (!(alloutputs && name != "__i3") && name != bar_.output->name) {
+          continue;
         }
+        std::copy_if(
+            output["nodes"].begin(), output["nodes"].end(), std::back_inserter(workspaces_),
+            [&](const auto& node) { return !(isWorkspaceIgnored(node["name"].asString())); });
+        std::copy(output["floating_nodes"].begin(), output["floating_nodes"].end(),
+                  std::back_inserter(workspaces_));
+      }
 
-        // adding persistent workspaces (as per the config file)
-        if (config_["persistent-workspaces"].isObject()) {
-          const Json::Value& p_workspaces = config_["persistent-workspaces"];
-          const std::vector<std::string> p_workspaces_names = p_workspaces.getMemberNames();
+      // adding persistent workspaces (as per the config file)
+      if (config_["persistent-workspaces"].isObject()) {
+        const Json::Value& p_workspaces = config_["persistent-workspaces"];
+        const std::vector<std::string> p_workspaces_names = p_workspaces.getMemberNames();
 
-          for (const std::string& p_w_name : p_workspaces_names) {
-            const Json::Value& p_w = p_workspaces[p_w_name];
-            auto it = std::find_if(workspaces_.begin(), workspaces_.end(),
-                                   [&p_w_name](const Json::Value& node) {
-                                     return node["name"].asString() == p_w_name;
-                                   });
+        for (const std::string& p_w_name : p_workspaces_names) {
+          const Json::Value& p_w = p_workspaces[p_w_name];
+          auto it = std::find_if(workspaces_.begin(), workspaces_.end(),
+                                 [&p_w_name](const Json::Value& node) {
+                                   return node["name"].asString() == p_w_name;
+                                 });
 
-            if (it != workspaces_.end()) {
-              continue;  // already displayed by some bar
-            }
+          if (it != workspaces_.end()) {
+            continue;  // already displayed by some bar
+          }
 
-            if (p_w.isArray() && !p_w.empty()) {
-              // Adding to target outputs
-              for (const Json::Value& output : p_w) {
-                auto output_name = output.asString();
-                if (output_name == bar_.output->name || output_name == bar_.output->identifier) {
-                  Json::Value v;
-                  v["name"] = p_w_name;
-                  v["target_output"] = bar_.output->name;
-                  v["num"] = convertWorkspaceNameToNum(p_w_name);
-                  workspaces_.emplace_back(std::move(v));
-                  break;
-                }
+          if (p_w.isArray() && !p_w.empty()) {
+            // Adding to target outputs
+            for (const Json::Value& output : p_w) {
+              auto output_name = output.asString();
+              if (output_name == bar_.output->name || output_name == bar_.output->identifier) {
+                Json::Value v;
+                v["name"] = p_w_name;
+                v["target_output"] = bar_.output->name;
+                v["num"] = convertWorkspaceNameToNum(p_w_name);
+                workspaces_.emplace_back(std::move(v));
+                break;
               }
-            } else {
-              // Adding to all outputs
-              Json::Value v;
-              v["name"] = p_w_name;
-              v["target_output"] = "";
-              v["num"] = convertWorkspaceNameToNum(p_w_name);
-              workspaces_.emplace_back(std::move(v));
             }
+          } else {
+            // Adding to all outputs
+            Json::Value v;
+            v["name"] = p_w_name;
+            v["target_output"] = "";
+            v["num"] = convertWorkspaceNameToNum(p_w_name);
+            workspaces_.emplace_back(std::move(v));
           }
         }
+      }
 
-        // sway has a defined ordering of workspaces that should be preserved in
-        // the representation displayed by waybar to ensure that commands such
-        // as "workspace prev" or "workspace next" make sense when looking at
-        // the workspace representation in the bar.
-        // Due to waybar's own feature of persistent workspaces unknown to sway,
-        // custom sorting logic is necessary to make these workspaces appear
-        // naturally in the list of workspaces without messing up sway's
-        // sorting. For this purpose, a custom numbering property is created
-        // that preserves the order provided by sway while inserting numbered
-        // persistent workspaces at their natural positions.
-        //
-        // All of this code assumes that sway provides numbered workspaces first
-        // and other workspaces are sorted by their creation time.
-        //
-        // In a first pass, the maximum "num" value is computed to enqueue
-        // unnumbered workspaces behind numbered ones when computing the sort
-        // attribute.
-        //
-        // Note: if the 'alphabetical_sort' option is true, the user is in
-        // agreement that the "workspace prev/next" commands may not follow
-        // the order displayed in Waybar.
-        int max_num = -1;
-        for (auto& workspace : workspaces_) {
-          max_num = std::max(workspace["num"].asInt(), max_num);
-        }
-        for (auto& workspace : workspaces_) {
-          auto workspace_num = workspace["num"].asInt();
-          if (workspace_num > -1) {
-            workspace["sort"] = workspace_num;
-          } else {
-            workspace["sort"] = ++max_num;
-          }
+      // sway has a defined ordering of workspaces that should be preserved in
+      // the representation displayed by waybar to ensure that commands such
+      // as "workspace prev" or "workspace next" make sense when looking at
+      // the workspace representation in the bar.
+      // Due to waybar's own feature of persistent workspaces unknown to sway,
+      // custom sorting logic is necessary to make these workspaces appear
+      // naturally in the list of workspaces without messing up sway's
+      // sorting. For this purpose, a custom numbering property is created
+      // that preserves the order provided by sway while inserting numbered
+      // persistent workspaces at their natural positions.
+      //
+      // All of this code assumes that sway provides numbered workspaces first
+      // and other workspaces are sorted by their creation time.
+      //
+      // In a first pass, the maximum "num" value is computed to enqueue
+      // unnumbered workspaces behind numbered ones when computing the sort
+      // attribute.
+      //
+      // Note: if the 'alphabetical_sort' option is true, the user is in
+      // agreement that the "workspace prev/next" commands may not follow
+      // the order displayed in Waybar.
+      int max_num = -1;
+      for (auto& workspace : workspaces_) {
+        max_num = std::max(workspace["num"].asInt(), max_num);
+      }
+      for (auto& workspace : workspaces_) {
+        auto workspace_num = workspace["num"].asInt();
+        if (workspace_num > -1) {
+          workspace["sort"] = workspace_num;
+        } else {
+          workspace["sort"] = ++max_num;
         }
-        std::sort(workspaces_.begin(), workspaces_.end(),
-                  [this](const Json::Value& lhs, const Json::Value& rhs) {
-                    auto lname = lhs["name"].asString();
-                    auto rname = rhs["name"].asString();
-                    int l = lhs["sort"].asInt();
-                    int r = rhs["sort"].asInt();
-
-                    if (!custom_sort_priorities_.empty()) {
-                      auto const lcustom = getCustomSortIndex(lname);
-                      auto const rcustom = getCustomSortIndex(rname);
-                      if (lcustom && rcustom) {
-                        if (*lcustom != *rcustom) {
-                          return *lcustom < *rcustom;
-                        }
-                      } else if (lcustom) {
-                        return true;
-                      } else if (rcustom) {
-                        return false;
+      }
+      std::sort(workspaces_.begin(), workspaces_.end(),
+                [this](const Json::Value& lhs, const Json::Value& rhs) {
+                  auto lname = lhs["name"].asString();
+                  auto rname = rhs["name"].asString();
+                  int l = lhs["sort"].asInt();
+                  int r = rhs["sort"].asInt();
+
+                  if (!custom_sort_priorities_.empty()) {
+                    auto const lcustom = getCustomSortIndex(lname);
+                    auto const rcustom = getCustomSortIndex(rname);
+                    if (lcustom && rcustom) {
+                      if (*lcustom != *rcustom) {
+                        return *lcustom < *rcustom;
                       }
+                    } else if (lcustom) {
+                      return true;
+                    } else if (rcustom) {
+                      return false;
                     }
-
-                    if (l == r || config_["alphabetical_sort"].asBool()) {
-                      // In case both integers are the same, lexicographical
-                      // sort. The code above already ensure that this will only
-                      // happened in case of explicitly numbered workspaces.
-                      //
-                      // Additionally, if the config specifies to sort workspaces
-                      // alphabetically do this here.
-                      return lname < rname;
-                    }
-
-                    return l < r;
-                  });
-      }
-      dp.emit();
-    } catch (const std::exception& e) {
-      spdlog::error("Workspaces: {}", e.what());
+                  }
+
+                  if (l == r || config_["alphabetical_sort"].asBool()) {
+                    // In case both integers are the same, lexicographical
+                    // sort. The code above already ensure that this will only
+                    // happened in case of explicitly numbered workspaces.
+                    //
+                    // Additionally, if the config specifies to sort workspaces
+                    // alphabetically do this here.
+                    return lname < rname;
+                  }
+
+                  return l < r;
+                });
     }
+    dp.emit();
+  } catch (const std::exception& e) {
+    spdlog::error("Workspaces: {}", e.what());
   }
 }
 
@@ -124,6 +124,7 @@ waybar::modules::Temperature::Temperature(const std::string& id, const Json::Val
     dp.emit();
     thread_.sleep_for(interval_);
   };
+  adaptPolling(thread_);
 }
 
 auto waybar::modules::Temperature::update() -> void {
@@ -209,7 +210,3 @@ bool waybar::modules::Temperature::isCritical(uint16_t temperature_c) {
   return config_["critical-threshold"].isInt() &&
          temperature_c >= config_["critical-threshold"].asInt();
 }
-
-void waybar::modules::Temperature::suspend() { thread_.pause(); }
-
-void waybar::modules::Temperature::resume() { thread_.resume(); }
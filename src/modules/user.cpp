@@ -12,6 +12,7 @@
 #include "glibmm/fileutils.h"
 #include "sigc++/functors/mem_fun.h"
 #include "sigc++/functors/ptr_fun.h"
+#include "util/pixbuf_cache.hpp"
 
 #if HAVE_CPU_LINUX
 #include <sys/sysinfo.h>
@@ -114,7 +115,7 @@ void User::init_default_user_avatar(int width, int height) {
 
 void User::init_user_avatar(const std::string& path, int width, int height) {
   if (Glib::file_test(path, Glib::FILE_TEST_EXISTS)) {
-    Glib::RefPtr<Gdk::Pixbuf> pixbuf_ = Gdk::Pixbuf::create_from_file(path, width, height);
+    Glib::RefPtr<Gdk::Pixbuf> pixbuf_ = util::PixbufCache::instance().fromFile(path, width, height);
     AIconLabel::image_.set(pixbuf_);
   } else {
     AIconLabel::box_.remove(AIconLabel::image_);
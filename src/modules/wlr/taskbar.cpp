@@ -611,7 +611,7 @@ void Task::update() {
                     fmt::arg("app_id", app_id), fmt::arg("state", state_string()),
                     fmt::arg("short_state", state_string(true)));
 
-    txt = waybar::util::rewriteString(txt, config_["rewrite"]);
+    txt = tbar_->rewrite_rules().apply(txt);
 
     if (markup)
       text_before_.set_markup(txt);
@@ -625,7 +625,7 @@ void Task::update() {
                     fmt::arg("app_id", app_id), fmt::arg("state", state_string()),
                     fmt::arg("short_state", state_string(true)));
 
-    txt = waybar::util::rewriteString(txt, config_["rewrite"]);
+    txt = tbar_->rewrite_rules().apply(txt);
 
     if (markup)
       text_after_.set_markup(txt);
@@ -640,7 +640,7 @@ void Task::update() {
                     fmt::arg("app_id", app_id), fmt::arg("state", state_string()),
                     fmt::arg("short_state", state_string(true)));
 
-    txt = waybar::util::rewriteString(txt, config_["rewrite"]);
+    txt = tbar_->rewrite_rules().apply(txt);
 
     if (markup)
       button.set_tooltip_markup(txt);
@@ -703,6 +703,7 @@ Taskbar::Taskbar(const std::string& id, const waybar::Bar& bar, const Json::Valu
     : waybar::AModule(config, "taskbar", id, false, false),
       bar_(bar),
       box_{bar.orientation, 0},
+      rewrite_rules_{config_["rewrite"]},
       manager_{nullptr},
       workspace_manager_{nullptr},
       seat_{nullptr} {
@@ -1163,6 +1164,8 @@ const std::map<std::string, std::string>& Taskbar::app_ids_replace_map() const {
   return app_ids_replace_map_;
 }
 
+const util::RewriteRuleSet& Taskbar::rewrite_rules() const { return rewrite_rules_; }
+
 std::size_t Taskbar::task_id_count(std::string_view id) const {
   return std::ranges::count_if(tasks_, [=](auto&& task) { return id == task->app_id(); });
 }
@@ -24,10 +24,13 @@ constexpr const char* DEFAULT_FORMAT = "{state}";
 
 waybar::modules::Wwan::Wwan(const std::string& id, const Json::Value& config)
     : ALabel(config, "wwan", id, "{}", 5) {
+  // Only wakes the main loop up: ModemManager is asked from update(), on the main context that
+  // also keeps its proxies up to date
   thread_ = [this] {
     dp.emit();
     thread_.sleep_for(interval_);
   };
+  adaptPolling(thread_);
 
   GError* error = nullptr;
   connection = g_bus_get_sync(G_BUS_TYPE_SYSTEM, nullptr, &error);
@@ -1,6 +1,7 @@
 #include "util/audio_backend.hpp"
 
 #include <fmt/core.h>
+#include <json/writer.h>
 #include <pulse/def.h>
 #include <pulse/error.h>
 #include <pulse/introspect.h>
@@ -11,20 +12,24 @@
 
 #include <algorithm>
 #include <cmath>
+#include <map>
+#include <mutex>
 #include <stdexcept>
 #include <utility>
 
 namespace waybar::util {
 
-AudioBackend::AudioBackend(std::function<void()> on_updated_cb, private_constructor_tag tag)
+AudioBackend::AudioBackend(const Json::Value& config, private_constructor_tag tag)
     : mainloop_(nullptr),
       mainloop_api_(nullptr),
       context_(nullptr),
       volume_(0),
       muted_(false),
       source_volume_(0),
-      source_muted_(false),
-      on_updated_cb_(std::move(on_updated_cb)) {
+      source_muted_(false) {
+  // Fixed for the lifetime of the backend: the mainloop thread reads them without locking
+  setIgnoredSinks(config["ignored-sinks"]);
+  setSinkMapping(config["sink-mapping"]);
   // Initialize pa_volume_ and pa_source_volume_ with safe defaults
   pa_cvolume_init(&pa_volume_);
   pa_cvolume_init(&pa_source_volume_);
@@ -34,6 +39,8 @@ AudioBackend::AudioBackend(std::function<void()> on_updated_cb, private_construc
   }
   pa_threaded_mainloop_lock(mainloop_);
   mainloop_api_ = pa_threaded_mainloop_get_api(mainloop_);
+  notify_event_ = mainloop_api_->defer_new(mainloop_api_, notifyCb, this);
+  mainloop_api_->defer_enable(notify_event_, 0);
   connectContext();
   if (pa_threaded_mainloop_start(mainloop_) < 0) {
     throw std::runtime_error("pa_mainloop_run() failed.");
@@ -51,15 +58,46 @@ AudioBackend::~AudioBackend() {
       pa_context_unref(context_);
       context_ = nullptr;
     }
+    if (notify_event_ != nullptr) {
+      mainloop_api_->defer_free(notify_event_);
+      notify_event_ = nullptr;
+    }
     pa_threaded_mainloop_unlock(mainloop_);
     pa_threaded_mainloop_stop(mainloop_);
     pa_threaded_mainloop_free(mainloop_);
   }
 }
 
-std::shared_ptr<AudioBackend> AudioBackend::getInstance(std::function<void()> on_updated_cb) {
-  private_constructor_tag tag;
-  return std::make_shared<AudioBackend>(on_updated_cb, tag);
+std::shared_ptr<AudioBackend> AudioBackend::getInstance(const Json::Value& config,
+                                                       std::function<void()> on_updated_cb) {
+  static std::mutex registry_mutex;
+  static std::map<std::string, std::weak_ptr<AudioBackend>> registry;
+
+  // Modules that pick the sink differently can't share a backend
+  Json::Value settings(Json::objectValue);
+  settings["ignored-sinks"] = config["ignored-sinks"];
+  settings["sink-mapping"] = config["sink-mapping"];
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "";
+  const auto key = Json::writeString(builder, settings);
+
+  std::lock_guard lock(registry_mutex);
+  auto backend = registry[key].lock();
+  if (!backend) {
+    std::erase_if(registry, [](const auto& entry) { return entry.second.expired(); });
+    private_constructor_tag tag;
+    backend = std::make_shared<AudioBackend>(config, tag);
+    registry[key] = backend;
+  }
+  auto& subscribers = backend->subscribers_;
+  return subscribeBackend(std::move(backend), subscribers, std::move(on_updated_cb));
+}
+
+void AudioBackend::notifyChanged() { mainloop_api_->defer_enable(notify_event_, 1); }
+
+void AudioBackend::notifyCb(pa_mainloop_api* api, pa_defer_event* event, void* data) {
+  api->defer_enable(event, 0);
+  static_cast<AudioBackend*>(data)->subscribers_.notify();
 }
 
 void AudioBackend::connectContext() {
@@ -304,7 +342,7 @@ void AudioBackend::sinkInfoCb(pa_context* /*context*/, const pa_sink_info* i, in
     } else {
       backend->form_factor_ = "";
     }
-    backend->on_updated_cb_();
+    backend->notifyChanged();
   }
 }
 
@@ -326,7 +364,7 @@ void AudioBackend::sourceInfoCb(pa_context* /*context*/, const pa_source_info* i
     backend->source_muted_ = i->mute != 0;
     backend->source_desc_ = i->description;
     backend->source_port_name_ = i->active_port != nullptr ? i->active_port->name : "Unknown";
-    backend->on_updated_cb_();
+    backend->notifyChanged();
   }
 }
 
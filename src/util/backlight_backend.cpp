@@ -182,7 +182,7 @@ BacklightBackend::BacklightBackend(std::chrono::milliseconds interval,
   }
 #endif
 
-  udev_thread_ = [this] {
+  udev_thread_ = SleeperThread::Blocking{[this] {
     std::unique_ptr<udev, UdevDeleter> udev{udev_new()};
     check_nn(udev.get(), "Udev new failed");
 
@@ -252,7 +252,7 @@ BacklightBackend::BacklightBackend(std::chrono::milliseconds interval,
       }
       this->on_updated_cb_();
     }
-  };
+  }};
 }
 
 const BacklightDevice* BacklightBackend::best_device(const std::vector<BacklightDevice>& devices,
@@ -0,0 +1,75 @@
+#include "util/clock_tick.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <exception>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace waybar::util {
+
+ClockTick::Subscription::Subscription(std::shared_ptr<ClockTick> tick,
+                                      const sigc::slot<void()>& slot)
+    : tick_(std::move(tick)), conn_(tick_->connect(slot)) {}
+
+ClockTick::Subscription::Subscription(Subscription&& other) noexcept
+    : tick_(std::move(other.tick_)), conn_(other.conn_) {
+  other.conn_ = sigc::connection();
+}
+
+ClockTick::Subscription& ClockTick::Subscription::operator=(Subscription&& other) noexcept {
+  if (this != &other) {
+    conn_.disconnect();
+    tick_ = std::move(other.tick_);
+    conn_ = other.conn_;
+    other.conn_ = sigc::connection();
+  }
+  return *this;
+}
+
+ClockTick::Subscription ClockTick::subscribe(std::chrono::milliseconds period,
+                                             const sigc::slot<void()>& slot) {
+  return Subscription(acquire(period), slot);
+}
+
+std::shared_ptr<ClockTick> ClockTick::acquire(std::chrono::milliseconds period) {
+  static std::mutex mutex;
+  static std::map<std::chrono::milliseconds, std::weak_ptr<ClockTick>> ticks;
+
+  std::lock_guard lock(mutex);
+  std::erase_if(ticks, [](const auto& entry) { return entry.second.expired(); });
+  if (auto it = ticks.find(period); it != ticks.end()) {
+    if (auto tick = it->second.lock()) {
+      return tick;
+    }
+  }
+  auto tick = std::make_shared<ClockTick>(period);
+  ticks[period] = tick;
+  spdlog::debug("Started shared clock tick ({}ms)", period.count());
+  return tick;
+}
+
+ClockTick::ClockTick(std::chrono::milliseconds period) : period_(period) {
+  dp_.connect(sigc::mem_fun(*this, &ClockTick::handleTick));
+  thread_ = [this] {
+    dp_.emit();
+    // An `interval` of "once" only ticks when the tick starts
+    if (period_ == std::chrono::milliseconds::max()) {
+      thread_.sleep();
+      return;
+    }
+    const auto now = std::chrono::system_clock::now();
+    thread_.sleep_until(now - now.time_since_epoch() % period_ + period_);
+  };
+}
+
+void ClockTick::handleTick() {
+  try {
+    signal_tick_.emit();
+  } catch (const std::exception& e) {
+    spdlog::error("clock tick: {}", e.what());
+  }
+}
+
+}  // namespace waybar::util
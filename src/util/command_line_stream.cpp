@@ -92,25 +92,32 @@ waybar::util::command::LineStream::LineStream(std::string output_name, OutputCal
       on_output_(std::move(on_output)),
       on_exit_(std::move(on_exit)),
       pid_(0),
-      stdout_fd_(-1) {}
+      stdout_fd_(-1),
+      stdin_fd_(-1) {}
 
 waybar::util::command::LineStream::~LineStream() { stop(); }
 
-void waybar::util::command::LineStream::start(const std::string& cmd) {
+void waybar::util::command::LineStream::start(const std::string& cmd, bool with_stdin) {
   stop();
 
   std::vector<std::string> argv{"/bin/sh", "-c", cmd};
   auto envp = buildChildEnvironment(output_name_);
   Glib::spawn_async_with_pipes("", argv, envp,
                                Glib::SPAWN_DO_NOT_REAP_CHILD | Glib::SPAWN_CLOEXEC_PIPES,
-                               sigc::ptr_fun(&prepareChild), &pid_, nullptr, &stdout_fd_, nullptr);
+                               sigc::ptr_fun(&prepareChild), &pid_,
+                               with_stdin ? &stdin_fd_ : nullptr, &stdout_fd_, nullptr);
 
-  const auto flags = fcntl(stdout_fd_, F_GETFL, 0);
-  if (flags == -1 || fcntl(stdout_fd_, F_SETFL, flags | O_NONBLOCK) == -1) {
-    const auto saved_errno = errno;
-    stop();
-    throw std::runtime_error("Unable to configure child stdout: " +
-                             std::string(std::strerror(saved_errno)));
+  for (const auto fd : {stdout_fd_, stdin_fd_}) {
+    if (fd == -1) {
+      continue;
+    }
+    const auto flags = fcntl(fd, F_GETFL, 0);
+    if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+      const auto saved_errno = errno;
+      stop();
+      throw std::runtime_error("Unable to configure child pipes: " +
+                               std::string(std::strerror(saved_errno)));
+    }
   }
 
   stdout_connection_ =
@@ -132,11 +139,50 @@ void waybar::util::command::LineStream::stop() {
   }
 
   closeStdout();
+  closeStdin();
   buffer_.clear();
 }
 
 bool waybar::util::command::LineStream::running() const { return pid_ != 0; }
 
+bool waybar::util::command::LineStream::send(std::string_view line) {
+  if (stdin_fd_ == -1) {
+    return false;
+  }
+
+  std::string message(line);
+  message += '\n';
+
+  // A child that closed its stdin must not take the bar down with SIGPIPE: block it while
+  // writing and discard it if it was raised
+  sigset_t sigpipe;
+  sigset_t old_mask;
+  sigemptyset(&sigpipe);
+  sigaddset(&sigpipe, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &sigpipe, &old_mask);
+  ssize_t written;
+  do {
+    written = ::write(stdin_fd_, message.data(), message.size());
+  } while (written == -1 && errno == EINTR);
+  const auto saved_errno = errno;
+  if (written == -1 && saved_errno == EPIPE) {
+    const timespec no_wait = {0, 0};
+    while (sigtimedwait(&sigpipe, nullptr, &no_wait) == -1 && errno == EINTR) {
+    }
+  }
+  pthread_sigmask(SIG_SETMASK, &old_mask, nullptr);
+
+  if (written == static_cast<ssize_t>(message.size())) {
+    return true;
+  }
+  if (written == -1 && saved_errno == EPIPE) {
+    closeStdin();
+  } else if (written == -1 && saved_errno != EAGAIN) {
+    spdlog::error("Writing command stdin failed: {}", std::strerror(saved_errno));
+  }
+  return false;
+}
+
 bool waybar::util::command::LineStream::handleStdout(Glib::IOCondition condition) {
   const auto should_flush =
       static_cast<bool>(condition & (Glib::IO_HUP | Glib::IO_ERR | Glib::IO_NVAL));
@@ -158,6 +204,7 @@ void waybar::util::command::LineStream::handleExit(Glib::Pid pid, int status) {
     stdout_connection_.disconnect();
     closeStdout();
   }
+  closeStdin();
 
   if (pid_ == pid) {
     Glib::spawn_close_pid(pid_);
@@ -169,6 +216,13 @@ void waybar::util::command::LineStream::handleExit(Glib::Pid pid, int status) {
   on_exit_(statusToExitCode(status));
 }
 
+void waybar::util::command::LineStream::closeStdin() {
+  if (stdin_fd_ != -1) {
+    ::close(stdin_fd_);
+    stdin_fd_ = -1;
+  }
+}
+
 void waybar::util::command::LineStream::closeStdout() {
   if (stdout_fd_ != -1) {
     ::close(stdout_fd_);
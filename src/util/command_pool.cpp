@@ -0,0 +1,175 @@
+#include "util/command_pool.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <exception>
+#include <iterator>
+#include <utility>
+
+namespace waybar::util::command {
+
+Pool& Pool::instance() {
+  // Leaked on purpose: modules may still cancel their tasks during static destruction
+  static auto* pool = new Pool();
+  return *pool;
+}
+
+Pool::Pool(std::size_t max_workers, Clock::duration idle_timeout)
+    : max_workers_(std::max<std::size_t>(1, max_workers)), idle_timeout_(idle_timeout) {}
+
+Pool::~Pool() {
+  std::vector<std::thread> workers;
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+    for (auto& [key, slot] : slots_) {
+      slot.stop.request_stop();
+    }
+    workers = std::move(workers_);
+    std::ranges::move(retired_, std::back_inserter(workers));
+    retired_.clear();
+  }
+  cv_.notify_all();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+void Pool::submit(const void* key, Task task, std::chrono::milliseconds delay, bool bounded) {
+  std::lock_guard lock(mutex_);
+  if (stopping_) {
+    return;
+  }
+  const auto due = Clock::now() + delay;
+  auto [it, inserted] = slots_.try_emplace(key);
+  auto& slot = it->second;
+  if (slot.cancelled) {
+    return;
+  }
+  slot.due = inserted || !slot.pending ? due : std::min(slot.due, due);
+  slot.pending = std::move(task);
+  slot.bounded = bounded;
+  if (idle_ == 0) {
+    startWorker();
+  }
+  cv_.notify_one();
+}
+
+void Pool::cancel(const void* key) {
+  std::unique_lock lock(mutex_);
+  auto it = slots_.find(key);
+  if (it == slots_.end()) {
+    return;
+  }
+  if (!it->second.running) {
+    slots_.erase(it);
+    return;
+  }
+  it->second.pending = nullptr;
+  it->second.cancelled = true;
+  it->second.stop.request_stop();
+  done_cv_.wait(lock, [this, key] { return !slots_.contains(key); });
+}
+
+std::size_t Pool::workers() {
+  std::lock_guard lock(mutex_);
+  return workers_.size();
+}
+
+auto Pool::next() -> Slots::iterator {
+  auto best = slots_.end();
+  for (auto it = slots_.begin(); it != slots_.end(); ++it) {
+    if (it->second.pending && !it->second.running &&
+        (best == slots_.end() || it->second.due < best->second.due)) {
+      best = it;
+    }
+  }
+  return best;
+}
+
+void Pool::startWorker() {
+  // Retired workers released the lock for good before they were handed over
+  for (auto& worker : retired_) {
+    worker.join();
+  }
+  retired_.clear();
+  if (workers_.size() < max_workers_ + unbounded_running_) {
+    workers_.emplace_back([this] { work(); });
+  }
+}
+
+void Pool::retire() {
+  auto self = std::ranges::find(workers_, std::this_thread::get_id(), &std::thread::get_id);
+  retired_.push_back(std::move(*self));
+  workers_.erase(self);
+}
+
+void Pool::work() {
+  std::unique_lock lock(mutex_);
+  while (!stopping_) {
+    auto it = next();
+    if (it == slots_.end() || it->second.due > Clock::now()) {
+      ++idle_;
+      const auto idle_until = Clock::now() + idle_timeout_;
+      // By value: the slot may be erased while we wait
+      const auto wake_at = it == slots_.end() ? idle_until : std::min(idle_until, it->second.due);
+      cv_.wait_until(lock, wake_at);
+      --idle_;
+
+      const auto now = Clock::now();
+      if (stopping_ || now < idle_until) {
+        continue;
+      }
+      // Another idle worker is left to wait for the next pending task, if there is one
+      it = next();
+      if (it == slots_.end() || (it->second.due > now && idle_ > 0)) {
+        retire();
+        // That worker may wait for a later deadline
+        cv_.notify_one();
+        return;
+      }
+      continue;
+    }
+
+    const auto* key = it->first;
+    auto& slot = it->second;
+    auto task = std::move(slot.pending);
+    slot.pending = nullptr;
+    slot.running = true;
+    slot.stop = std::stop_source();
+    auto token = slot.stop.get_token();
+    const bool bounded = slot.bounded;
+    if (!bounded) {
+      ++unbounded_running_;
+    }
+    // Keep a thread around for the other modules while this one is busy
+    if (idle_ == 0 && slots_.size() > 1) {
+      startWorker();
+    }
+
+    lock.unlock();
+    try {
+      task(token);
+    } catch (const std::exception& e) {
+      spdlog::error("Command task failed: {}", e.what());
+    }
+    task = nullptr;
+    lock.lock();
+    if (!bounded) {
+      --unbounded_running_;
+    }
+
+    // The slot may have been rehashed while the task ran
+    auto done = slots_.find(key);
+    done->second.running = false;
+    if (!done->second.pending) {
+      slots_.erase(done);
+      done_cv_.notify_all();
+    } else {
+      cv_.notify_one();
+    }
+  }
+}
+
+}  // namespace waybar::util::command
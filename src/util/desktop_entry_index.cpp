@@ -0,0 +1,236 @@
+#include "util/desktop_entry_index.hpp"
+
+#include <glibmm/keyfile.h>
+#include <glibmm/miscutils.h>
+#include <poll.h>
+#include <spdlog/spdlog.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <filesystem>
+#include <string_view>
+#include <system_error>
+#include <unordered_set>
+#include <utility>
+
+namespace waybar::util {
+
+namespace {
+
+constexpr uint32_t WATCH_MASK = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+// Package managers touch many files at once; rebuild once they are done
+constexpr auto REBUILD_DELAY = std::chrono::milliseconds(500);
+
+std::string toLower(std::string text) {
+  std::transform(text.begin(), text.end(), text.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return text;
+}
+
+std::vector<std::string> applicationDirs() {
+  std::vector<std::string> dirs{Glib::get_user_data_dir() + "/applications"};
+  for (const auto& data_dir : Glib::get_system_data_dirs()) {
+    dirs.push_back(data_dir + "/applications");
+  }
+  // The same directory may be listed twice, e.g. /usr/share and /usr/share/
+  std::unordered_set<std::string> seen;
+  std::erase_if(dirs, [&seen](const auto& dir) {
+    std::error_code ec;
+    auto canonical = std::filesystem::weakly_canonical(dir, ec);
+    return !seen.insert(ec ? dir : canonical.string()).second;
+  });
+  return dirs;
+}
+
+}  // namespace
+
+DesktopEntryIndex& DesktopEntryIndex::instance() {
+  // Never destroyed: modules may still look up entries while the bar shuts down
+  static auto* index = new DesktopEntryIndex(applicationDirs());
+  return *index;
+}
+
+DesktopEntryIndex::DesktopEntryIndex(std::vector<std::string> dirs)
+    : dirs_(std::move(dirs)), inotify_fd_(inotify_init1(IN_CLOEXEC | IN_NONBLOCK)) {
+  if (inotify_fd_ == -1) {
+    spdlog::warn("Desktop entries will not be reloaded on changes: inotify_init1 failed");
+  }
+  dp_.connect([this] { signal_changed.emit(); });
+  thread_ = SleeperThread::Blocking{[this] {
+    auto index = build();
+    {
+      std::lock_guard lock(mutex_);
+      index_ = std::move(index);
+    }
+    dp_.emit();
+    waitForChanges();
+  }};
+}
+
+DesktopEntryIndex::~DesktopEntryIndex() { thread_.stop(); }
+
+auto DesktopEntryIndex::build() -> std::shared_ptr<Index> {
+  for (auto wd : watches_) {
+    inotify_rm_watch(inotify_fd_, wd);
+  }
+  watches_.clear();
+
+  auto index = std::make_shared<Index>();
+  for (const auto& dir : dirs_) {
+    const auto begin = index->entries.size();
+    std::error_code ec;
+    if (!std::filesystem::is_directory(dir, ec)) {
+      index->dirs.emplace_back(begin, begin);
+      continue;
+    }
+    watch(dir);
+
+    std::filesystem::recursive_directory_iterator it(dir, ec);
+    for (; !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+      if (it->is_directory(ec)) {
+        watch(it->path().string());
+        continue;
+      }
+      const auto& path = it->path();
+      if (path.extension() != ".desktop" || !it->is_regular_file(ec)) {
+        continue;
+      }
+
+      Entry entry{.path = path.string(),
+                  .name = path.lexically_relative(dir).string(),
+                  .icon = {},
+                  .startup_wm_class = {}};
+      try {
+        Glib::KeyFile desktop_file;
+        desktop_file.load_from_file(entry.path);
+        if (desktop_file.has_key("Desktop Entry", "Icon")) {
+          entry.icon = desktop_file.get_string("Desktop Entry", "Icon");
+        }
+        if (desktop_file.has_key("Desktop Entry", "StartupWMClass")) {
+          entry.startup_wm_class = desktop_file.get_string("Desktop Entry", "StartupWMClass");
+        }
+      } catch (const Glib::Error& error) {
+        spdlog::debug("Error while loading desktop file {}: {}", entry.path,
+                      error.what().c_str());
+      }
+
+      const auto pos = index->entries.size();
+      // Entries in earlier data dirs shadow later ones with the same name
+      index->by_name.emplace(entry.name, pos);
+      if (!entry.startup_wm_class.empty()) {
+        index->by_wm_class.emplace(entry.startup_wm_class, pos);
+      }
+      index->entries.push_back(std::move(entry));
+    }
+    index->dirs.emplace_back(begin, index->entries.size());
+  }
+
+  spdlog::debug("Indexed {} desktop entries", index->entries.size());
+  return index;
+}
+
+void DesktopEntryIndex::watch(const std::string& dir) {
+  if (inotify_fd_ == -1) {
+    return;
+  }
+  auto wd = inotify_add_watch(inotify_fd_, dir.c_str(), WATCH_MASK);
+  if (wd >= 0) {
+    watches_.push_back(wd);
+  }
+}
+
+void DesktopEntryIndex::waitForChanges() {
+  if (inotify_fd_ == -1 || watches_.empty()) {
+    // Nothing to wait for; stay idle instead of rebuilding in a loop
+    thread_.sleep();
+    return;
+  }
+
+  pollfd pfd{.fd = inotify_fd_, .events = POLLIN, .revents = 0};
+  while (thread_.isRunning() && poll(&pfd, 1, -1) < 0 && errno == EINTR) {
+  }
+  thread_.sleep_for(REBUILD_DELAY);
+
+  // Drain everything queued up so far, the next scan picks up all of it
+  alignas(inotify_event) std::array<char, 4096> buffer;
+  while (read(inotify_fd_, buffer.data(), buffer.size()) > 0) {
+  }
+}
+
+auto DesktopEntryIndex::index() const -> std::shared_ptr<const Index> {
+  static const auto empty = std::make_shared<const Index>();
+  std::lock_guard lock(mutex_);
+  return index_ != nullptr ? index_ : empty;
+}
+
+auto DesktopEntryIndex::byName(const std::vector<std::string>& names) const
+    -> std::optional<Entry> {
+  const auto index = this->index();
+  // by_name only keeps the entry from the earliest data dir for each name
+  std::optional<std::pair<std::size_t, std::size_t>> best;  // (data dir, position)
+  for (const auto& name : names) {
+    auto it = index->by_name.find(name);
+    if (it == index->by_name.end()) {
+      continue;
+    }
+    const auto dir = std::find_if(index->dirs.begin(), index->dirs.end(),
+                                  [pos = it->second](const auto& range) {
+                                    return pos >= range.first && pos < range.second;
+                                  }) -
+                     index->dirs.begin();
+    if (!best || static_cast<std::size_t>(dir) < best->first) {
+      best.emplace(dir, it->second);
+    }
+  }
+  return best ? std::optional(index->entries[best->second]) : std::nullopt;
+}
+
+auto DesktopEntryIndex::byStartupWMClass(const std::string& wm_class) const
+    -> std::optional<Entry> {
+  const auto index = this->index();
+  auto it = index->by_wm_class.find(wm_class);
+  return it != index->by_wm_class.end() ? std::optional(index->entries[it->second])
+                                        : std::nullopt;
+}
+
+auto DesktopEntryIndex::bySuffix(const std::vector<std::string>& suffixes) const
+    -> std::optional<Entry> {
+  const auto index = this->index();
+
+  std::string key;
+  for (const auto& suffix : suffixes) {
+    key += suffix;
+    key += '\n';
+  }
+  std::lock_guard lock(index->suffix_mutex);
+  auto [cached, inserted] = index->by_suffix.try_emplace(key);
+  if (inserted) {
+    for (const auto& [begin, end] : index->dirs) {
+      for (const auto& suffix : suffixes) {
+        const auto lower = toLower(suffix);
+        auto it = std::find_if(index->entries.begin() + begin, index->entries.begin() + end,
+                               [&](const Entry& entry) {
+                                 std::string_view file(entry.name);
+                                 file.remove_prefix(file.rfind('/') + 1);
+                                 return file.ends_with(suffix) || file.ends_with(lower);
+                               });
+        if (it != index->entries.begin() + end) {
+          cached->second = it - index->entries.begin();
+          break;
+        }
+      }
+      if (cached->second) {
+        break;
+      }
+    }
+  }
+  return cached->second ? std::optional(index->entries[*cached->second]) : std::nullopt;
+}
+
+}  // namespace waybar::util
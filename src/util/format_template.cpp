@@ -0,0 +1,75 @@
+#include "util/format_template.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <utility>
+
+namespace waybar::util {
+
+namespace {
+bool isDigits(std::string_view text) {
+  return !text.empty() &&
+         std::all_of(text.begin(), text.end(), [](unsigned char c) { return std::isdigit(c); });
+}
+}  // namespace
+
+FormatTemplate::FormatTemplate(std::string format) : format_(std::move(format)) {
+  const std::string_view text(format_);
+  std::size_t pos = 0;
+  while ((pos = text.find_first_of("{}", pos)) != std::string_view::npos) {
+    if (pos + 1 < text.size() && text[pos + 1] == text[pos]) {
+      // Escaped "{{" or "}}"
+      pos += 2;
+      continue;
+    }
+    if (text[pos] == '}') {
+      ++pos;
+      continue;
+    }
+
+    const auto start = pos + 1;
+    const auto end = text.find_first_of(":!}", start);
+    if (end == std::string_view::npos) {
+      break;
+    }
+    const auto name = text.substr(start, end - start);
+    if (name.empty() || isDigits(name)) {
+      references_all_ = true;
+    } else if (std::find(names_.begin(), names_.end(), name) == names_.end()) {
+      names_.emplace_back(name);
+    }
+
+    // Skip the format spec. Nested replacement fields like {:>{width}} are not tracked, so a
+    // template that has them is treated as referencing everything.
+    int depth = 1;
+    for (pos = end; pos < text.size() && depth > 0; ++pos) {
+      if (text[pos] == '{') {
+        references_all_ = true;
+        ++depth;
+      } else if (text[pos] == '}') {
+        --depth;
+      }
+    }
+  }
+}
+
+bool FormatTemplate::reset(const std::string& format) {
+  if (format == format_) {
+    return false;
+  }
+  *this = FormatTemplate(format);
+  return true;
+}
+
+bool FormatTemplate::references(std::string_view name) const {
+  return references_all_ || std::find(names_.begin(), names_.end(), name) != names_.end();
+}
+
+bool FormatTemplate::referencesIndexed(std::string_view prefix) const {
+  return references_all_ || std::any_of(names_.begin(), names_.end(), [prefix](const auto& name) {
+           return name.starts_with(prefix) &&
+                  isDigits(std::string_view(name).substr(prefix.size()));
+         });
+}
+
+}  // namespace waybar::util
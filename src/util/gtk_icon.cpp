@@ -1,5 +1,7 @@
 #include "util/gtk_icon.hpp"
 
+#include "util/pixbuf_cache.hpp"
+
 /* We need a global mutex for accessing the object returned by Gtk::IconTheme::get_default()
  * because it always returns the same object across different threads, and concurrent
  * access can cause data corruption and lead to invalid memory access and crashes.
@@ -18,20 +20,24 @@ bool DefaultGtkIconThemeWrapper::has_icon(const std::string& value) {
 Glib::RefPtr<Gdk::Pixbuf> DefaultGtkIconThemeWrapper::load_icon(
     const char* name, int tmp_size, Gtk::IconLookupFlags flags,
     Glib::RefPtr<Gtk::StyleContext> style) {
-  const std::lock_guard<std::mutex> lock(default_theme_mutex);
-
   auto default_theme = Gtk::IconTheme::get_default();
 
-  auto icon_info = default_theme->lookup_icon(name, tmp_size, flags);
+  // Decoded icons are shared through the cache; only a miss needs the theme lock
+  return waybar::util::PixbufCache::instance().fromTheme(
+      default_theme, name, tmp_size, flags, style, [&]() -> Glib::RefPtr<Gdk::Pixbuf> {
+        const std::lock_guard<std::mutex> lock(default_theme_mutex);
+
+        auto icon_info = default_theme->lookup_icon(name, tmp_size, flags);
 
-  if (icon_info == nullptr) {
-    return default_theme->load_icon(name, tmp_size, flags);
-  }
+        if (icon_info == nullptr) {
+          return default_theme->load_icon(name, tmp_size, flags);
+        }
 
-  if (style.get() == nullptr) {
-    return icon_info.load_icon();
-  }
+        if (style.get() == nullptr) {
+          return icon_info.load_icon();
+        }
 
-  bool is_sym = false;
-  return icon_info.load_symbolic(style, is_sym);
+        bool is_sym = false;
+        return icon_info.load_symbolic(style, is_sym);
+      });
 }
@@ -1,62 +1,36 @@
 #include "util/icon_loader.hpp"
 
-#include "util/string.hpp"
+#include <algorithm>
+#include <sstream>
 
-std::vector<std::string> IconLoader::search_prefix() {
-  std::vector<std::string> prefixes = {""};
+#include "util/desktop_entry_index.hpp"
+#include "util/pixbuf_cache.hpp"
 
-  const char* home_env = std::getenv("HOME");
-  std::string home_dir = home_env ? home_env : "";
-  if (!home_dir.empty()) {
-    prefixes.push_back(home_dir + "/.local/share/");
-  }
-
-  auto xdg_data_dirs = std::getenv("XDG_DATA_DIRS");
-  if (!xdg_data_dirs) {
-    prefixes.emplace_back("/usr/share/");
-    prefixes.emplace_back("/usr/local/share/");
-  } else {
-    std::string xdg_data_dirs_str(xdg_data_dirs);
-    size_t start = 0;
-    size_t end = 0;
-
-    do {
-      end = xdg_data_dirs_str.find(':', start);
-      auto p = xdg_data_dirs_str.substr(start, end - start);
-      prefixes.push_back(trim(p) + "/");
-
-      start = end == std::string::npos ? end : end + 1;
-    } while (end != std::string::npos);
-  }
-
-  for (auto& p : prefixes) spdlog::debug("Using 'desktop' search path prefix: {}", p);
-
-  return prefixes;
+IconLoader::IconLoader() {
+  // Start indexing desktop entries before the first lookup needs them
+  waybar::util::DesktopEntryIndex::instance();
 }
 
 Glib::RefPtr<Gio::DesktopAppInfo> IconLoader::get_app_info_by_name(const std::string& app_id) {
-  static std::vector<std::string> prefixes = search_prefix();
-
-  std::vector<std::string> app_folders = {"", "applications/", "applications/kde/",
-                                          "applications/org.kde."};
-
-  std::vector<std::string> suffixes = {"", ".desktop"};
-
-  for (auto const& prefix : prefixes) {
-    for (auto const& folder : app_folders) {
-      for (auto const& suffix : suffixes) {
-        auto app_info_ =
-            Gio::DesktopAppInfo::create_from_filename(prefix + folder + app_id + suffix);
-        if (!app_info_) {
-          continue;
-        }
-
-        return app_info_;
-      }
-    }
+  if (app_id.empty()) {
+    return {};
+  }
+  if (app_id.front() == '/') {
+    return Gio::DesktopAppInfo::create_from_filename(app_id);
   }
 
-  return {};
+  auto entry = waybar::util::DesktopEntryIndex::instance().byName({
+      app_id,
+      app_id + ".desktop",
+      "kde/" + app_id,
+      "kde/" + app_id + ".desktop",
+      "org.kde." + app_id,
+      "org.kde." + app_id + ".desktop",
+  });
+  if (!entry) {
+    return {};
+  }
+  return Gio::DesktopAppInfo::create_from_filename(entry->path);
 }
 
 Glib::RefPtr<Gio::DesktopAppInfo> IconLoader::get_desktop_app_info(const std::string& app_id) {
@@ -65,6 +39,13 @@ Glib::RefPtr<Gio::DesktopAppInfo> IconLoader::get_desktop_app_info(const std::st
     return app_info;
   }
 
+  if (auto entry = waybar::util::DesktopEntryIndex::instance().byStartupWMClass(app_id)) {
+    app_info = Gio::DesktopAppInfo::create_from_filename(entry->path);
+    if (app_info) {
+      return app_info;
+    }
+  }
+
   std::string desktop_file = "";
 
   gchar*** desktop_list = g_desktop_app_info_search(app_id.c_str());
@@ -94,8 +75,7 @@ Glib::RefPtr<Gio::DesktopAppInfo> IconLoader::get_desktop_app_info(const std::st
 
 Glib::RefPtr<Gdk::Pixbuf> IconLoader::load_icon_from_file(std::string const& icon_path, int size) {
   try {
-    auto pb = Gdk::Pixbuf::create_from_file(icon_path, size, size);
-    return pb;
+    return waybar::util::PixbufCache::instance().fromFile(icon_path, size, size);
   } catch (...) {
     return {};
   }
@@ -127,7 +107,11 @@ bool IconLoader::image_load_icon(Gtk::Image& image, const Glib::RefPtr<Gtk::Icon
   auto scaled_icon_size = size * image.get_scale_factor();
 
   try {
-    pixbuf = icon_theme->load_icon(ret_icon_name, scaled_icon_size, Gtk::ICON_LOOKUP_FORCE_SIZE);
+    pixbuf = waybar::util::PixbufCache::instance().fromTheme(
+        icon_theme, ret_icon_name, scaled_icon_size, Gtk::ICON_LOOKUP_FORCE_SIZE, {}, [&] {
+          return icon_theme->load_icon(ret_icon_name, scaled_icon_size,
+                                       Gtk::ICON_LOOKUP_FORCE_SIZE);
+        });
   } catch (...) {
     if (Glib::file_test(ret_icon_name, Glib::FILE_TEST_EXISTS)) {
       pixbuf = load_icon_from_file(ret_icon_name, scaled_icon_size);
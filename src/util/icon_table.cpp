@@ -0,0 +1,110 @@
+#include "util/icon_table.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+namespace waybar::util {
+
+namespace {
+const std::string EMPTY;
+
+bool selectable(const Json::Value& icons) { return icons.isString() || icons.isArray(); }
+}  // namespace
+
+IconTable::Set::Set(const Json::Value& icons) {
+  if (icons.isString()) {
+    kind_ = Kind::SINGLE;
+    icons_.push_back(icons.asString());
+    return;
+  }
+  if (!icons.isArray() || icons.empty()) {
+    return;
+  }
+
+  if (!icons[0].isObject()) {
+    kind_ = Kind::ARRAY;
+    icons_.reserve(icons.size());
+    for (const auto& icon : icons) {
+      icons_.push_back(icon.isString() ? icon.asString() : std::string());
+    }
+    return;
+  }
+
+  kind_ = Kind::THRESHOLDS;
+  for (const auto& threshold : icons) {
+    if (!threshold.isObject() || !threshold["icon"].isString() || !threshold["max"].isUInt()) {
+      static bool warned = false;
+      if (!warned) {
+        spdlog::warn(
+            "format-icons: skipping invalid threshold object, expected {\"icon\": \"...\", "
+            "\"max\": N}");
+        warned = true;
+      }
+      continue;
+    }
+    icons_.push_back(threshold["icon"].asString());
+    maxes_.push_back(threshold["max"].asUInt());
+  }
+}
+
+const std::string& IconTable::Set::get(uint16_t value, uint16_t max) const {
+  switch (kind_) {
+    case Kind::SINGLE:
+      return icons_.front();
+    case Kind::ARRAY: {
+      const auto size = static_cast<unsigned>(icons_.size());
+      auto divisor = std::max(1U, (max == 0 ? 100U : static_cast<unsigned>(max)) / size);
+      auto idx = std::clamp(value / divisor, 0U, size - 1);
+      return icons_[idx];
+    }
+    case Kind::THRESHOLDS:
+      for (std::size_t i = 0; i < maxes_.size(); ++i) {
+        if (value <= maxes_[i]) {
+          return icons_[i];
+        }
+      }
+      // Above every threshold: keep the last icon
+      return icons_.empty() ? EMPTY : icons_.back();
+    case Kind::NONE:
+      break;
+  }
+  return EMPTY;
+}
+
+IconTable::IconTable(const Json::Value& format_icons)
+    : keyed_(format_icons.isObject()),
+      default_(keyed_ ? format_icons["default"] : format_icons) {
+  if (!keyed_) {
+    return;
+  }
+  for (auto it = format_icons.begin(); it != format_icons.end(); ++it) {
+    if (selectable(*it)) {
+      sets_.emplace(it.name(), Set(*it));
+    }
+  }
+}
+
+const IconTable::Set* IconTable::find(const std::string& alt) const {
+  if (!keyed_ || alt.empty()) {
+    return nullptr;
+  }
+  auto it = sets_.find(alt);
+  return it != sets_.end() ? &it->second : nullptr;
+}
+
+auto IconTable::select(const std::string& alt) const -> const Set& {
+  const auto* set = find(alt);
+  return set != nullptr ? *set : default_;
+}
+
+auto IconTable::select(const std::vector<std::string>& alts) const -> const Set& {
+  for (const auto& alt : alts) {
+    if (const auto* set = find(alt)) {
+      return *set;
+    }
+  }
+  return default_;
+}
+
+}  // namespace waybar::util
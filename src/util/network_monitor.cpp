@@ -0,0 +1,745 @@
+#include "util/network_monitor.hpp"
+
+#include <arpa/inet.h>
+#include <fmt/format.h>
+#include <linux/if.h>
+#include <linux/if_ether.h>
+#include <linux/if_link.h>
+#include <linux/nl80211.h>
+#include <linux/rtnetlink.h>
+#include <netlink/genl/ctrl.h>
+#include <netlink/genl/genl.h>
+#include <spdlog/spdlog.h>
+#include <sys/epoll.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace waybar::util {
+
+std::shared_ptr<NetworkMonitor> NetworkMonitor::getInstance(std::function<void()> on_changed) {
+  static std::mutex instance_mutex;
+  static std::weak_ptr<NetworkMonitor> instance;
+
+  std::lock_guard lock(instance_mutex);
+  auto monitor = instance.lock();
+  if (!monitor) {
+    PrivateConstructorTag tag;
+    monitor = std::make_shared<NetworkMonitor>(tag);
+    instance = monitor;
+  }
+  auto& subscribers = monitor->subscribers_;
+  return subscribeBackend(std::move(monitor), subscribers, std::move(on_changed));
+}
+
+NetworkMonitor::NetworkMonitor(PrivateConstructorTag /*tag*/) {
+  createEventSocket();
+  createRequestSockets();
+
+  // Ask for a dump of interfaces, then addresses and then routes to populate the tables. The
+  // next dump is requested once the previous one is done, from handleEventsDone().
+  askForStateDump();
+  worker();
+}
+
+void NetworkMonitor::createEventSocket() {
+  ev_sock_.reset(nl_socket_alloc());
+  nl_socket_disable_seq_check(ev_sock_.get());
+  nl_socket_modify_cb(ev_sock_.get(), NL_CB_VALID, NL_CB_CUSTOM, handleEvents, this);
+  nl_socket_modify_cb(ev_sock_.get(), NL_CB_FINISH, NL_CB_CUSTOM, handleEventsDone, this);
+  if (nl_connect(ev_sock_.get(), NETLINK_ROUTE) != 0) {
+    throw std::runtime_error("Can't connect network socket");
+  }
+  if (nl_socket_set_nonblocking(ev_sock_.get())) {
+    throw std::runtime_error("Can't set non-blocking on network socket");
+  }
+  // Enlarge the socket receive buffer so that a burst of link/address/route
+  // change notifications (e.g. a router reboot or a PPPoE redial) is less likely
+  // to overflow it and make the kernel drop messages (ENOBUFS). Overruns are
+  // still handled in worker() by resynchronising the state, but a larger buffer
+  // avoids most of them. The kernel caps the request at net.core.rmem_max.
+  nl_socket_set_buffer_size(ev_sock_.get(), 1024 * 1024, 0);
+  nl_socket_add_memberships(ev_sock_.get(), RTNLGRP_LINK, RTNLGRP_IPV4_IFADDR,
+                            RTNLGRP_IPV6_IFADDR, RTNLGRP_IPV4_ROUTE, RTNLGRP_IPV6_ROUTE, 0);
+
+  efd_.reset(epoll_create1(EPOLL_CLOEXEC));
+  if (efd_ < 0) {
+    throw std::runtime_error("Can't create epoll");
+  }
+  auto fd = nl_socket_get_fd(ev_sock_.get());
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN | EPOLLET | EPOLLRDHUP;
+  event.data.fd = fd;
+  if (epoll_ctl(efd_, EPOLL_CTL_ADD, fd, &event) == -1) {
+    throw std::runtime_error("Can't add epoll event");
+  }
+}
+
+void NetworkMonitor::createRequestSockets() {
+  // Requests block until their reply arrived, so they don't go through the event socket that
+  // the event thread drains.
+  // libnl asks for an ACK by default, which would arrive after a reply and be read as the answer
+  // to the next request. A failed request is answered with an error instead of a reply.
+  rtnl_sock_.reset(nl_socket_alloc());
+  nl_socket_disable_auto_ack(rtnl_sock_.get());
+  if (nl_connect(rtnl_sock_.get(), NETLINK_ROUTE) != 0) {
+    throw std::runtime_error("Can't connect link statistics socket");
+  }
+
+  genl_sock_.reset(nl_socket_alloc());
+  if (genl_connect(genl_sock_.get()) != 0) {
+    throw std::runtime_error("Can't connect to netlink socket");
+  }
+  nl80211_id_ = genl_ctrl_resolve(genl_sock_.get(), "nl80211");
+  if (nl80211_id_ < 0) {
+    spdlog::warn("Can't resolve nl80211 interface");
+  }
+  // Resolving waits for an ACK, the scan and station requests share the socket without them
+  nl_socket_disable_auto_ack(genl_sock_.get());
+}
+
+void NetworkMonitor::worker() {
+  thread_ = util::SleeperThread::Blocking{[this] {
+    std::array<struct epoll_event, EPOLL_MAX> events{};
+
+    int ec = epoll_wait(efd_, events.data(), EPOLL_MAX, -1);
+    if (ec <= 0) {
+      return;
+    }
+    for (auto i = 0; i < ec; i++) {
+      if (events[i].data.fd != nl_socket_get_fd(ev_sock_.get())) {
+        thread_.stop();
+        return;
+      }
+      int rc = 0;
+      // Read as many message as possible, until the socket blocks
+      while (true) {
+        errno = 0;
+        rc = nl_recvmsgs_default(ev_sock_.get());
+        if (rc == -NLE_AGAIN || errno == EAGAIN) {
+          rc = 0;
+          break;
+        }
+        if (rc == -NLE_NOMEM || errno == ENOBUFS) {
+          // The kernel dropped multicast notifications because our receive
+          // buffer overflowed. This happens during a burst of
+          // link/address/route changes such as a router reboot or a PPPoE
+          // redial. We have lost track of the current state -- in
+          // particular the RTM_NEWADDR carrying the interface's new IP
+          // address may have been dropped -- so request a fresh dump to
+          // resynchronise. Without this the address (cleared by the
+          // preceding RTM_DELADDR) would stay blank until Waybar is
+          // restarted, because nothing else re-queries it (#5122).
+          spdlog::warn("network: netlink receive buffer overrun, resyncing state");
+          resync();
+          // Keep draining; the next recv proceeds normally now that the
+          // overrun has been reported.
+          continue;
+        }
+      }
+      if (rc < 0) {
+        spdlog::error("nl_recvmsgs_default error: {}", nl_geterror(-rc));
+        thread_.stop();
+        return;
+      }
+    }
+
+    // Modules hear about a burst of changes once, and not before the dumps are complete
+    bool changed = false;
+    {
+      std::lock_guard lock(state_mutex_);
+      if (dump_in_progress_ == Dump::NONE) {
+        changed = std::exchange(changed_, false);
+      }
+    }
+    if (changed) {
+      subscribers_.notify();
+    }
+  }};
+}
+
+void NetworkMonitor::resync() {
+  std::lock_guard lock(state_mutex_);
+  want_link_dump_ = true;
+  want_addr_dump_ = true;
+  want_route_dump_ = true;
+  askForStateDump();
+}
+
+// Called with state_mutex_ held, or from the constructor
+void NetworkMonitor::askForStateDump() {
+  /* We need to wait until the current dump is done before sending new
+   * messages. handleEventsDone() is called when a dump is done. */
+  if (dump_in_progress_ != Dump::NONE) return;
+
+  struct rtgenmsg rt_hdr = {
+      .rtgen_family = AF_UNSPEC,
+  };
+  int type = 0;
+
+  if (want_link_dump_) {
+    type = RTM_GETLINK;
+    want_link_dump_ = false;
+    dump_in_progress_ = Dump::LINK;
+
+  } else if (want_addr_dump_) {
+    type = RTM_GETADDR;
+    want_addr_dump_ = false;
+    dump_in_progress_ = Dump::ADDR;
+
+  } else if (want_route_dump_) {
+    type = RTM_GETROUTE;
+    want_route_dump_ = false;
+    dump_in_progress_ = Dump::ROUTE;
+
+  } else {
+    return;
+  }
+  // Without a socket, tests feed the dump and report its end themselves
+  if (ev_sock_ != nullptr) {
+    nl_send_simple(ev_sock_.get(), type, NLM_F_DUMP, &rt_hdr, sizeof(rt_hdr));
+  }
+  // Everything the dump reports, or that changes while it runs, is stamped with the new
+  // generation. What is left with an older one once it's done has gone meanwhile.
+  generation_++;
+}
+
+int NetworkMonitor::handleEventsDone(struct nl_msg* /*msg*/, void* data) {
+  auto* monitor = static_cast<NetworkMonitor*>(data);
+  std::lock_guard lock(monitor->state_mutex_);
+  const auto generation = monitor->generation_;
+  switch (monitor->dump_in_progress_) {
+    case Dump::LINK:
+      std::erase_if(monitor->links_,
+                    [generation](const auto& link) { return link.second.generation < generation; });
+      break;
+    case Dump::ADDR:
+      std::erase_if(monitor->addresses_,
+                    [generation](const auto& addr) { return addr.generation < generation; });
+      break;
+    case Dump::ROUTE:
+      std::erase_if(monitor->routes_,
+                    [generation](const auto& route) { return route.generation < generation; });
+      break;
+    case Dump::NONE:
+      break;
+  }
+  monitor->dump_in_progress_ = Dump::NONE;
+  monitor->changed_ = true;
+  monitor->askForStateDump();
+  return NL_OK;
+}
+
+int NetworkMonitor::handleEvents(struct nl_msg* msg, void* data) {
+  auto* monitor = static_cast<NetworkMonitor*>(data);
+  std::lock_guard lock(monitor->state_mutex_);
+  auto nh = nlmsg_hdr(msg);
+
+  switch (nh->nlmsg_type) {
+    case RTM_NEWLINK:
+    case RTM_DELLINK:
+      monitor->handleLink(nh);
+      break;
+    case RTM_NEWADDR:
+    case RTM_DELADDR:
+      monitor->handleAddress(nh);
+      break;
+    case RTM_NEWROUTE:
+    case RTM_DELROUTE:
+      monitor->handleRoute(nh);
+      break;
+  }
+  return NL_OK;
+}
+
+void NetworkMonitor::handleLink(struct nlmsghdr* nh) {
+  struct ifinfomsg* ifi = static_cast<struct ifinfomsg*>(NLMSG_DATA(nh));
+  struct nlattr* attrs[IFLA_MAX + 1];
+  if (nlmsg_parse(nh, sizeof(*ifi), attrs, IFLA_MAX, nullptr) < 0) {
+    spdlog::error("network: failed to parse netlink attributes");
+    return;
+  }
+  const int index = ifi->ifi_index;
+
+  if (nh->nlmsg_type == RTM_DELLINK) {
+    spdlog::debug("network: interface {} deleted", index);
+    links_.erase(index);
+    std::erase_if(addresses_, [index](const auto& addr) { return addr.index == index; });
+    std::erase_if(routes_, [index](const auto& route) { return route.route.index == index; });
+    changed_ = true;
+    return;
+  }
+
+  auto& link = links_[index];
+  link.generation = generation_;
+  link.interface.index = index;
+  if (attrs[IFLA_IFNAME] != nullptr) {
+    const char* ifname_ptr = nla_get_string(attrs[IFLA_IFNAME]);
+    size_t ifname_len = nla_len(attrs[IFLA_IFNAME]) - 1;  // minus \0
+    link.interface.name = std::string(ifname_ptr, ifname_len);
+  }
+  if (attrs[IFLA_CARRIER] != nullptr) {
+    link.interface.carrier = nla_get_u8(attrs[IFLA_CARRIER]) == 1;
+  }
+  if (attrs[IFLA_PROP_LIST] != nullptr) {
+    struct nlattr* prop;
+    int rem;
+
+    link.interface.altnames.clear();
+    nla_for_each_nested(prop, attrs[IFLA_PROP_LIST], rem) {
+      if (nla_type(prop) == IFLA_ALT_IFNAME) {
+        const char* altname_ptr = nla_get_string(prop);
+        size_t altname_len = nla_len(prop) - 1;  // minus \0
+        link.interface.altnames.emplace_back(altname_ptr, altname_len);
+      }
+    }
+  }
+  link.interface.up = (ifi->ifi_flags & IFF_UP) != 0;
+  if (!link.interface.up) {
+    // The routes through an interface that goes down are deleted without a notification, so
+    // start looking for another default route
+    std::erase_if(routes_, [index](const auto& route) { return route.route.index == index; });
+  }
+  changed_ = true;
+}
+
+void NetworkMonitor::handleAddress(struct nlmsghdr* nh) {
+  struct ifaddrmsg* ifa = static_cast<struct ifaddrmsg*>(NLMSG_DATA(nh));
+  struct nlattr* attrs[IFA_MAX + 1];
+
+  // We ignore address mark as scope for the link or host,
+  // which should leave scope global addresses.
+  if (ifa->ifa_scope >= RT_SCOPE_LINK ||
+      (ifa->ifa_family != AF_INET && ifa->ifa_family != AF_INET6)) {
+    return;
+  }
+  if (nlmsg_parse(nh, sizeof(*ifa), attrs, IFA_MAX, nullptr) < 0) {
+    spdlog::error("network: failed to parse netlink attributes");
+    return;
+  }
+  // On point-to-point links IFA_ADDRESS is the address of the peer, the local one is IFA_LOCAL
+  auto* attr = attrs[IFA_LOCAL] != nullptr ? attrs[IFA_LOCAL] : attrs[IFA_ADDRESS];
+  if (attr == nullptr) {
+    return;
+  }
+  char ipaddr[INET6_ADDRSTRLEN];
+  if (inet_ntop(ifa->ifa_family, nla_data(attr), ipaddr, sizeof(ipaddr)) == nullptr) {
+    return;
+  }
+
+  const int index = static_cast<int>(ifa->ifa_index);
+  auto it = std::find_if(addresses_.begin(), addresses_.end(), [&](const auto& addr) {
+    return addr.index == index && addr.address.family == ifa->ifa_family &&
+           addr.address.address == ipaddr && addr.address.prefixlen == ifa->ifa_prefixlen;
+  });
+  if (nh->nlmsg_type == RTM_DELADDR) {
+    if (it != addresses_.end()) {
+      spdlog::debug("network: if{} addr deleted {}/{}", index, ipaddr, ifa->ifa_prefixlen);
+      addresses_.erase(it);
+      changed_ = true;
+    }
+    return;
+  }
+  if (it != addresses_.end()) {
+    it->generation = generation_;
+    return;
+  }
+  spdlog::debug("network: if{}, new addr {}/{}", index, ipaddr, ifa->ifa_prefixlen);
+  addresses_.push_back({index, {ifa->ifa_family, ipaddr, ifa->ifa_prefixlen}, generation_});
+  changed_ = true;
+}
+
+void NetworkMonitor::handleRoute(struct nlmsghdr* nh) {
+  // Based on https://gist.github.com/Yawning/c70d804d4b8ae78cc698
+  // to find the interface used to reach the outside world
+
+  struct rtmsg* rtm = static_cast<struct rtmsg*>(NLMSG_DATA(nh));
+  int family = rtm->rtm_family;
+  ssize_t attrlen = RTM_PAYLOAD(nh);
+  struct rtattr* attr = RTM_RTA(rtm);
+  char gateway_addr[INET6_ADDRSTRLEN];
+  bool has_gateway = false;
+  bool has_destination = false;
+  int temp_idx = -1;
+  uint32_t priority = 0;
+
+  /* Find the message(s) concerting the main routing table, each message
+   * corresponds to a single routing table entry.
+   */
+  if (rtm->rtm_table != RT_TABLE_MAIN) {
+    return;
+  }
+
+  /* Parse all the attributes for a single routing table entry. */
+  for (; RTA_OK(attr, attrlen); attr = RTA_NEXT(attr, attrlen)) {
+    /* Determine if this routing table entry corresponds to the default
+     * route by seeing if it has a gateway, and if a destination addr is
+     * set, that it is all 0s.
+     */
+    switch (attr->rta_type) {
+      case RTA_GATEWAY:
+        /* The gateway of the route. */
+        inet_ntop(family, RTA_DATA(attr), gateway_addr, sizeof(gateway_addr));
+        has_gateway = true;
+        break;
+      case RTA_DST: {
+        /* The destination address.
+         * Should be either missing, or maybe all 0s.  Accept both.
+         */
+        auto* dest = (const unsigned char*)RTA_DATA(attr);
+        size_t dest_size = RTA_PAYLOAD(attr);
+        for (size_t i = 0; i < dest_size; ++i) {
+          if (dest[i] != 0) {
+            has_destination = true;
+            break;
+          }
+        }
+
+        if (rtm->rtm_dst_len != 0) {
+          // We have found a destination like 0.0.0.0/24, this is not a
+          // default gateway route.
+          has_destination = true;
+        }
+        break;
+      }
+      case RTA_OIF:
+        /* The output interface index. */
+        temp_idx = *static_cast<int*>(RTA_DATA(attr));
+        break;
+      case RTA_PRIORITY:
+        priority = *(uint32_t*)RTA_DATA(attr);
+        break;
+      default:
+        break;
+    }
+  }
+
+  // Only default routes are of interest
+  if (!has_gateway || has_destination || temp_idx == -1) {
+    return;
+  }
+  auto it = std::find_if(routes_.begin(), routes_.end(), [&](const auto& route) {
+    return route.route.family == family && route.route.index == temp_idx &&
+           route.route.priority == priority;
+  });
+  if (nh->nlmsg_type == RTM_DELROUTE) {
+    if (it != routes_.end()) {
+      spdlog::debug("network: default route deleted if{} metric {}", temp_idx, priority);
+      routes_.erase(it);
+      changed_ = true;
+    }
+    return;
+  }
+  if (it != routes_.end()) {
+    it->generation = generation_;
+    if (it->route.gateway != gateway_addr) {
+      it->route.gateway = gateway_addr;
+      changed_ = true;
+    }
+    return;
+  }
+  spdlog::debug("network: new default route via {} on if{} metric {}", gateway_addr, temp_idx,
+                priority);
+  routes_.push_back({{family, temp_idx, priority, gateway_addr}, generation_});
+  changed_ = true;
+}
+
+NetworkMonitor::Interface NetworkMonitor::snapshot(const LinkEntry& link) const {
+  auto interface = link.interface;
+  for (const auto& addr : addresses_) {
+    if (addr.index == interface.index) {
+      interface.addresses.push_back(addr.address);
+    }
+  }
+  return interface;
+}
+
+std::vector<NetworkMonitor::Interface> NetworkMonitor::interfaces() const {
+  std::lock_guard lock(state_mutex_);
+  std::vector<Interface> interfaces;
+  interfaces.reserve(links_.size());
+  for (const auto& [index, link] : links_) {
+    interfaces.push_back(snapshot(link));
+  }
+  return interfaces;
+}
+
+std::optional<NetworkMonitor::Interface> NetworkMonitor::interface(int index) const {
+  std::lock_guard lock(state_mutex_);
+  auto it = links_.find(index);
+  if (it == links_.end()) {
+    return std::nullopt;
+  }
+  return snapshot(it->second);
+}
+
+std::optional<NetworkMonitor::DefaultRoute> NetworkMonitor::defaultRoute(int index) const {
+  std::lock_guard lock(state_mutex_);
+  const RouteEntry* best = nullptr;
+  for (const auto& entry : routes_) {
+    if (index != -1 && entry.route.index != index) {
+      continue;
+    }
+    // On a tie, the route seen first stays
+    if (best == nullptr || entry.route.priority < best->route.priority) {
+      best = &entry;
+    }
+  }
+  if (best == nullptr) {
+    return std::nullopt;
+  }
+  return best->route;
+}
+
+std::optional<NetworkMonitor::LinkStats> NetworkMonitor::linkStats(int index) {
+  std::lock_guard lock(request_mutex_);
+  // Ask for this link only; its reply carries the 64 bit counters (IFLA_STATS64)
+  std::optional<LinkStats> stats;
+  struct ifinfomsg ifinfo_hdr = {
+      .ifi_family = AF_UNSPEC,
+      .ifi_index = index,
+  };
+  nl_socket_modify_cb(rtnl_sock_.get(), NL_CB_VALID, NL_CB_CUSTOM, handleLinkStats, &stats);
+  int err = nl_send_simple(rtnl_sock_.get(), RTM_GETLINK, NLM_F_REQUEST, &ifinfo_hdr,
+                           sizeof(ifinfo_hdr));
+  if (err >= 0) {
+    err = nl_recvmsgs_default(rtnl_sock_.get());
+  }
+  if (err < 0) {
+    spdlog::debug("network: failed to get statistics of if{}: {}", index, nl_geterror(err));
+  }
+  return stats;
+}
+
+int NetworkMonitor::handleLinkStats(struct nl_msg* msg, void* data) {
+  auto* stats = static_cast<std::optional<LinkStats>*>(data);
+  auto nh = nlmsg_hdr(msg);
+  struct nlattr* attrs[IFLA_MAX + 1];
+
+  if (nh->nlmsg_type != RTM_NEWLINK ||
+      nlmsg_parse(nh, sizeof(struct ifinfomsg), attrs, IFLA_MAX, nullptr) < 0) {
+    return NL_SKIP;
+  }
+  if (attrs[IFLA_STATS64] == nullptr ||
+      nla_len(attrs[IFLA_STATS64]) < static_cast<int>(sizeof(struct rtnl_link_stats64))) {
+    return NL_SKIP;
+  }
+  // The attribute payload is not guaranteed to be 8 bytes aligned
+  struct rtnl_link_stats64 link_stats;
+  memcpy(&link_stats, nla_data(attrs[IFLA_STATS64]), sizeof(link_stats));
+  *stats = LinkStats{link_stats.rx_bytes, link_stats.tx_bytes};
+  return NL_OK;
+}
+
+std::optional<NetworkMonitor::WirelessInfo> NetworkMonitor::wirelessInfo(int index) {
+  if (nl80211_id_ < 0) {
+    return std::nullopt;
+  }
+  std::lock_guard lock(request_mutex_);
+  ScanResult scan;
+  nl_socket_modify_cb(genl_sock_.get(), NL_CB_VALID, NL_CB_CUSTOM, handleScan, &scan);
+
+  struct nl_msg* nl_msg = nlmsg_alloc();
+  if (nl_msg == nullptr) {
+    return std::nullopt;
+  }
+  if (genlmsg_put(nl_msg, NL_AUTO_PORT, NL_AUTO_SEQ, nl80211_id_, 0, NLM_F_DUMP,
+                  NL80211_CMD_GET_SCAN, 0) == nullptr ||
+      nla_put_u32(nl_msg, NL80211_ATTR_IFINDEX, index) < 0) {
+    nlmsg_free(nl_msg);
+    return std::nullopt;
+  }
+  int err = nl_send_sync(genl_sock_.get(), nl_msg);
+  if (err < 0) {
+    spdlog::warn("nl80211: nl_send_sync get_scan error {}", err);
+  }
+  if (!scan.associated) {
+    return std::nullopt;
+  }
+
+  // Connected to an AP, get the station data for the bitrates
+  nl_socket_modify_cb(genl_sock_.get(), NL_CB_VALID, NL_CB_CUSTOM, handleStationGet, &scan.info);
+  nl_msg = nlmsg_alloc();
+  if (nl_msg == nullptr) {
+    return scan.info;
+  }
+  if (genlmsg_put(nl_msg, NL_AUTO_PORT, NL_AUTO_SEQ, nl80211_id_, 0, 0, /* No DUMP flag */
+                  NL80211_CMD_GET_STATION, 0) == nullptr ||
+      nla_put_u32(nl_msg, NL80211_ATTR_IFINDEX, index) < 0 ||
+      nla_put(nl_msg, NL80211_ATTR_MAC, ETH_ALEN, scan.bssid) < 0) {
+    nlmsg_free(nl_msg);
+    return scan.info;
+  }
+  err = nl_send_sync(genl_sock_.get(), nl_msg);
+  if (err < 0) {
+    spdlog::warn("nl80211: nl_send_sync get_station error {}", err);
+  }
+  return scan.info;
+}
+
+static bool associatedOrJoined(struct nlattr** bss) {
+  if (bss[NL80211_BSS_STATUS] == nullptr) {
+    return false;
+  }
+  auto status = nla_get_u32(bss[NL80211_BSS_STATUS]);
+  switch (status) {
+    case NL80211_BSS_STATUS_ASSOCIATED:
+    case NL80211_BSS_STATUS_IBSS_JOINED:
+    case NL80211_BSS_STATUS_AUTHENTICATED:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static void parseEssid(struct nlattr** bss, NetworkMonitor::WirelessInfo& info) {
+  if (bss[NL80211_BSS_INFORMATION_ELEMENTS] != nullptr) {
+    auto ies = static_cast<char*>(nla_data(bss[NL80211_BSS_INFORMATION_ELEMENTS]));
+    auto ies_len = nla_len(bss[NL80211_BSS_INFORMATION_ELEMENTS]);
+    const auto hdr_len = 2;
+    while (ies_len > hdr_len && ies[0] != 0) {
+      ies_len -= ies[1] + hdr_len;
+      ies += ies[1] + hdr_len;
+    }
+    if (ies_len > hdr_len && ies_len > ies[1] + hdr_len) {
+      auto essid_begin = ies + hdr_len;
+      auto essid_end = essid_begin + ies[1];
+      info.essid.assign(essid_begin, essid_end);
+    }
+  }
+}
+
+static void parseSignal(struct nlattr** bss, NetworkMonitor::WirelessInfo& info) {
+  if (bss[NL80211_BSS_SIGNAL_MBM] != nullptr) {
+    // signalstrength in dBm from mBm
+    info.signal_strength_dbm = nla_get_s32(bss[NL80211_BSS_SIGNAL_MBM]) / 100;
+
+    // uses nmcli implementation for calculating strength
+    // https://github.com/NetworkManager/NetworkManager/blob/23ffa5fc6e7acbd7a96138c6c18f478f5127177d/src/libnm-platform/wifi/nm-wifi-utils-nl80211.c#L411
+
+    const int noise_floor_dbm = -90;
+    const int signal_max_dbm = -20;
+    info.signal_strength_dbm =
+        std::clamp(info.signal_strength_dbm, noise_floor_dbm, signal_max_dbm);
+    info.signal_strength =
+        100 - (70 * (((float)signal_max_dbm - (float)info.signal_strength_dbm) /
+                     ((float)signal_max_dbm - (float)noise_floor_dbm)));
+
+    if (info.signal_strength_dbm >= -50) {
+      info.signal_strength_app = "Great Connectivity";
+    } else if (info.signal_strength_dbm >= -60) {
+      info.signal_strength_app = "Good Connectivity";
+    } else if (info.signal_strength_dbm >= -67) {
+      info.signal_strength_app = "Streaming";
+    } else if (info.signal_strength_dbm >= -70) {
+      info.signal_strength_app = "Web Surfing";
+    } else if (info.signal_strength_dbm >= -80) {
+      info.signal_strength_app = "Basic Connectivity";
+    } else {
+      info.signal_strength_app = "Poor Connectivity";
+    }
+  }
+  if (bss[NL80211_BSS_SIGNAL_UNSPEC] != nullptr) {
+    info.signal_strength = nla_get_u8(bss[NL80211_BSS_SIGNAL_UNSPEC]);
+  }
+}
+
+static void parseFreq(struct nlattr** bss, NetworkMonitor::WirelessInfo& info) {
+  if (bss[NL80211_BSS_FREQUENCY] != nullptr) {
+    // in GHz
+    info.frequency = (double)nla_get_u32(bss[NL80211_BSS_FREQUENCY]) / 1000;
+  }
+}
+
+int NetworkMonitor::handleScan(struct nl_msg* msg, void* data) {
+  auto* scan = static_cast<ScanResult*>(data);
+  auto gnlh = static_cast<genlmsghdr*>(nlmsg_data(nlmsg_hdr(msg)));
+  struct nlattr* tb[NL80211_ATTR_MAX + 1];
+  struct nlattr* bss[NL80211_BSS_MAX + 1];
+  struct nla_policy bss_policy[NL80211_BSS_MAX + 1]{};
+  bss_policy[NL80211_BSS_TSF].type = NLA_U64;
+  bss_policy[NL80211_BSS_FREQUENCY].type = NLA_U32;
+  bss_policy[NL80211_BSS_BSSID].type = NLA_UNSPEC;
+  bss_policy[NL80211_BSS_BEACON_INTERVAL].type = NLA_U16;
+  bss_policy[NL80211_BSS_CAPABILITY].type = NLA_U16;
+  bss_policy[NL80211_BSS_INFORMATION_ELEMENTS].type = NLA_UNSPEC;
+  bss_policy[NL80211_BSS_SIGNAL_MBM].type = NLA_U32;
+  bss_policy[NL80211_BSS_SIGNAL_UNSPEC].type = NLA_U8;
+  bss_policy[NL80211_BSS_STATUS].type = NLA_U32;
+
+  if (nla_parse(tb, NL80211_ATTR_MAX, genlmsg_attrdata(gnlh, 0), genlmsg_attrlen(gnlh, 0),
+                nullptr) < 0) {
+    return NL_SKIP;
+  }
+  if (tb[NL80211_ATTR_BSS] == nullptr) {
+    return NL_SKIP;
+  }
+  if (nla_parse_nested(bss, NL80211_BSS_MAX, tb[NL80211_ATTR_BSS], bss_policy) != 0) {
+    return NL_SKIP;
+  }
+  if (!associatedOrJoined(bss)) {
+    return NL_SKIP;
+  }
+  parseEssid(bss, scan->info);
+  parseSignal(bss, scan->info);
+  parseFreq(bss, scan->info);
+  if (bss[NL80211_BSS_BSSID] != nullptr && nla_len(bss[NL80211_BSS_BSSID]) == ETH_ALEN) {
+    auto bssid = static_cast<uint8_t*>(nla_data(bss[NL80211_BSS_BSSID]));
+    memcpy(scan->bssid, bssid, ETH_ALEN);
+    scan->info.bssid = fmt::format("{:x}:{:x}:{:x}:{:x}:{:x}:{:x}", bssid[0], bssid[1], bssid[2],
+                                   bssid[3], bssid[4], bssid[5]);
+    scan->associated = true;
+  }
+  return NL_OK;
+}
+
+int NetworkMonitor::handleStationGet(struct nl_msg* msg, void* data) {
+  auto* info = static_cast<WirelessInfo*>(data);
+  auto gnlh = static_cast<genlmsghdr*>(nlmsg_data(nlmsg_hdr(msg)));
+  struct nlattr* tb[NL80211_ATTR_MAX + 1];
+
+  if (nla_parse(tb, NL80211_ATTR_MAX, genlmsg_attrdata(gnlh, 0), genlmsg_attrlen(gnlh, 0),
+                nullptr) < 0) {
+    return NL_SKIP;
+  }
+
+  if (tb[NL80211_ATTR_STA_INFO] == nullptr) {
+    return NL_SKIP;
+  }
+
+  struct nlattr* sinfo[NL80211_STA_INFO_MAX + 1];
+  if (nla_parse_nested(sinfo, NL80211_STA_INFO_MAX, tb[NL80211_ATTR_STA_INFO], nullptr) != 0) {
+    return NL_SKIP;
+  }
+
+  if (sinfo[NL80211_STA_INFO_TX_BITRATE] != nullptr) {
+    struct nlattr* tx_br_info[NL80211_RATE_INFO_MAX + 1];
+    if (nla_parse_nested(tx_br_info, NL80211_RATE_INFO_MAX, sinfo[NL80211_STA_INFO_TX_BITRATE],
+                         nullptr) == 0) {
+      if (tx_br_info[NL80211_RATE_INFO_BITRATE32] != nullptr) {
+        info->tx_bitrate = nla_get_u32(tx_br_info[NL80211_RATE_INFO_BITRATE32]) * pow(10, 5);
+      } else if (tx_br_info[NL80211_RATE_INFO_BITRATE] != nullptr) {
+        info->tx_bitrate = nla_get_u16(tx_br_info[NL80211_RATE_INFO_BITRATE]) * pow(10, 5);
+      }
+    }
+  }
+
+  if (sinfo[NL80211_STA_INFO_RX_BITRATE] != nullptr) {
+    struct nlattr* rx_br_info[NL80211_RATE_INFO_MAX + 1];
+    if (nla_parse_nested(rx_br_info, NL80211_RATE_INFO_MAX, sinfo[NL80211_STA_INFO_RX_BITRATE],
+                         nullptr) == 0) {
+      if (rx_br_info[NL80211_RATE_INFO_BITRATE32] != nullptr) {
+        info->rx_bitrate = nla_get_u32(rx_br_info[NL80211_RATE_INFO_BITRATE32]) * pow(10, 5);
+      } else if (rx_br_info[NL80211_RATE_INFO_BITRATE] != nullptr) {
+        info->rx_bitrate = nla_get_u16(rx_br_info[NL80211_RATE_INFO_BITRATE]) * pow(10, 5);
+      }
+    }
+  }
+  return NL_OK;
+}
+
+}  // namespace waybar::util
@@ -8,7 +8,7 @@ static void getNodeInfo(void* data_, const struct pw_node_info* info) {
   auto* pNodeInfo = static_cast<PWPrivacyNodeInfo*>(data_);
   pNodeInfo->handleNodeEventInfo(info);
 
-  static_cast<PipewireBackend*>(pNodeInfo->data)->privacy_nodes_changed_signal_event.emit();
+  static_cast<PipewireBackend*>(pNodeInfo->data)->notifyChanged();
 }
 
 static const struct pw_node_events NODE_EVENTS = {
@@ -42,7 +42,7 @@ static const struct pw_registry_events REGISTRY_EVENTS = {
 };
 
 PipewireBackend::PipewireBackend(PrivateConstructorTag tag)
-    : mainloop_(nullptr), context_(nullptr), core_(nullptr) {
+    : mainloop_(nullptr), context_(nullptr), core_(nullptr), notify_event_(nullptr) {
   pw_init(nullptr, nullptr);
   mainloop_ = pw_thread_loop_new("waybar", nullptr);
   if (mainloop_ == nullptr) {
@@ -68,6 +68,7 @@ PipewireBackend::PipewireBackend(PrivateConstructorTag tag)
     throw std::runtime_error("pw_context_connect() failed");
   }
   registry_ = pw_core_get_registry(core_, PW_VERSION_REGISTRY, 0);
+  notify_event_ = pw_loop_add_event(pw_thread_loop_get_loop(mainloop_), notifyCb, this);
 
   spa_zero(registryListener_);
   pw_registry_add_listener(registry_, &registryListener_, &REGISTRY_EVENTS, this);
@@ -89,6 +90,10 @@ PipewireBackend::~PipewireBackend() {
 
   spa_zero(registryListener_);
 
+  if (notify_event_ != nullptr) {
+    pw_loop_destroy_source(pw_thread_loop_get_loop(mainloop_), notify_event_);
+  }
+
   if (core_ != nullptr) {
     pw_core_disconnect(core_);
   }
@@ -104,9 +109,28 @@ PipewireBackend::~PipewireBackend() {
   }
 }
 
-std::shared_ptr<PipewireBackend> PipewireBackend::getInstance() {
-  PrivateConstructorTag tag;
-  return std::make_shared<PipewireBackend>(tag);
+std::shared_ptr<PipewireBackend> PipewireBackend::getInstance(std::function<void()> on_changed) {
+  static std::mutex instance_mutex;
+  static std::weak_ptr<PipewireBackend> instance;
+
+  std::lock_guard lock(instance_mutex);
+  auto backend = instance.lock();
+  if (!backend) {
+    PrivateConstructorTag tag;
+    backend = std::make_shared<PipewireBackend>(tag);
+    instance = backend;
+  }
+  auto& subscribers = backend->subscribers_;
+  return subscribeBackend(std::move(backend), subscribers, std::move(on_changed));
+}
+
+void PipewireBackend::notifyChanged() {
+  // Signalling again before the loop got to it doesn't queue a second notification
+  pw_loop_signal_event(pw_thread_loop_get_loop(mainloop_), notify_event_);
+}
+
+void PipewireBackend::notifyCb(void* data, uint64_t /*count*/) {
+  static_cast<PipewireBackend*>(data)->subscribers_.notify();
 }
 
 void PipewireBackend::handleRegistryEventGlobal(uint32_t id, uint32_t permissions, const char* type,
@@ -158,7 +182,7 @@ void PipewireBackend::handleRegistryEventGlobalRemove(uint32_t id) {
   }
   mutex_.unlock();
 
-  privacy_nodes_changed_signal_event.emit();
+  notifyChanged();
 }
 
 }  // namespace waybar::util::PipewireBackend
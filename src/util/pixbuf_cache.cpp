@@ -0,0 +1,186 @@
+#include "util/pixbuf_cache.hpp"
+
+#include <fmt/format.h>
+#include <glibmm/main.h>
+#include <spdlog/spdlog.h>
+#include <sys/stat.h>
+
+#include <iterator>
+#include <utility>
+
+namespace waybar::util {
+
+PixbufCache& PixbufCache::instance() {
+  // Leaked on purpose: pixbufs must not be released after GTK is gone
+  static auto* cache = [] {
+    auto* cache = new PixbufCache();
+    Glib::signal_timeout().connect_seconds(
+        [cache, logged = Stats{}]() mutable {
+          cache->logStats(logged);
+          return true;
+        },
+        STATS_LOG_INTERVAL);
+    return cache;
+  }();
+  return *cache;
+}
+
+void PixbufCache::logStats(Stats& logged) const {
+  if (!spdlog::should_log(spdlog::level::debug)) {
+    return;
+  }
+  auto current = stats();
+  if (current.hits == logged.hits && current.misses == logged.misses) {
+    return;
+  }
+  spdlog::debug("Pixbuf cache: {} images, {} of {} bytes, {} hits, {} misses, {} evictions",
+                current.entries, current.bytes, current.budget, current.hits, current.misses,
+                current.evictions);
+  logged = current;
+}
+
+PixbufCache::PixbufCache(std::size_t budget) : budget_(budget) { stats_.budget = budget; }
+
+PixbufCache::~PixbufCache() {
+  for (auto& [theme, watched] : themes_) {
+    watched.changed.disconnect();
+  }
+}
+
+Glib::RefPtr<Gdk::Pixbuf> PixbufCache::fromFile(const std::string& path, int width, int height) {
+  struct stat st {};
+  if (stat(path.c_str(), &st) != 0) {
+    // Let GdkPixbuf report the error
+    return Gdk::Pixbuf::create_from_file(path, width, height);
+  }
+
+  auto key = fmt::format("file:{}:{}x{}", path, width, height);
+  if (auto pixbuf = lookup(key, &st)) {
+    return pixbuf;
+  }
+
+  auto pixbuf = Gdk::Pixbuf::create_from_file(path, width, height);
+  insert({.key = std::move(key),
+          .pixbuf = pixbuf,
+          .bytes = pixbuf->get_byte_length(),
+          .mtime = st.st_mtim,
+          .size = st.st_size});
+  return pixbuf;
+}
+
+Glib::RefPtr<Gdk::Pixbuf> PixbufCache::fromTheme(
+    const Glib::RefPtr<Gtk::IconTheme>& theme, const std::string& name, int size,
+    Gtk::IconLookupFlags flags, const Glib::RefPtr<Gtk::StyleContext>& style,
+    const std::function<Glib::RefPtr<Gdk::Pixbuf>()>& load) {
+  if (!theme) {
+    return load();
+  }
+
+  auto key = fmt::format("icon:{}:{}:{}:{}", static_cast<const void*>(theme->gobj()), name, size,
+                         static_cast<int>(flags));
+  if (style) {
+    key += ':';
+    key += style->get_color(style->get_state()).to_string();
+  }
+  if (auto pixbuf = lookup(key, nullptr)) {
+    return pixbuf;
+  }
+
+  // Loaded without holding the lock; a concurrent miss for the same key just loads it twice
+  auto pixbuf = load();
+  if (pixbuf) {
+    insert({.key = std::move(key),
+            .pixbuf = pixbuf,
+            .bytes = pixbuf->get_byte_length(),
+            .theme = theme->gobj(),
+            .theme_ref = theme});
+  }
+  return pixbuf;
+}
+
+Glib::RefPtr<Gdk::Pixbuf> PixbufCache::lookup(const std::string& key, const struct stat* st) {
+  std::lock_guard lock(mutex_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    ++stats_.misses;
+    return {};
+  }
+  auto entry = it->second;
+  if (st != nullptr && (entry->size != st->st_size || entry->mtime.tv_sec != st->st_mtim.tv_sec ||
+                        entry->mtime.tv_nsec != st->st_mtim.tv_nsec)) {
+    // The file changed since it was decoded
+    erase(entry);
+    ++stats_.misses;
+    return {};
+  }
+  entries_.splice(entries_.begin(), entries_, entry);
+  ++stats_.hits;
+  return entry->pixbuf;
+}
+
+void PixbufCache::insert(Entry entry) {
+  std::lock_guard lock(mutex_);
+  if (entry.bytes > budget_) {
+    return;
+  }
+  if (auto it = index_.find(entry.key); it != index_.end()) {
+    erase(it->second);
+  }
+  while (!entries_.empty() && stats_.bytes + entry.bytes > budget_) {
+    erase(std::prev(entries_.end()));
+    ++stats_.evictions;
+  }
+
+  if (entry.theme != nullptr) {
+    auto& watched = themes_[entry.theme];
+    if (watched.entries++ == 0) {
+      watched.changed = entry.theme_ref->signal_changed().connect(
+          [this, gobj = entry.theme] { dropTheme(gobj); });
+    }
+  }
+  stats_.bytes += entry.bytes;
+  entries_.push_front(std::move(entry));
+  index_.emplace(entries_.front().key, entries_.begin());
+  stats_.entries = entries_.size();
+}
+
+void PixbufCache::erase(Iterator it) {
+  if (it->theme != nullptr) {
+    auto watched = themes_.find(it->theme);
+    if (watched != themes_.end() && --watched->second.entries == 0) {
+      watched->second.changed.disconnect();
+      themes_.erase(watched);
+    }
+  }
+  stats_.bytes -= it->bytes;
+  index_.erase(it->key);
+  entries_.erase(it);
+  stats_.entries = entries_.size();
+}
+
+void PixbufCache::dropTheme(const GtkIconTheme* theme) {
+  std::lock_guard lock(mutex_);
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    auto next = std::next(it);
+    if (it->theme == theme) {
+      erase(it);
+    }
+    it = next;
+  }
+  spdlog::debug("Icon theme changed, {} cached images left ({} bytes)", stats_.entries,
+                stats_.bytes);
+}
+
+auto PixbufCache::stats() const -> Stats {
+  std::lock_guard lock(mutex_);
+  return stats_;
+}
+
+void PixbufCache::clear() {
+  std::lock_guard lock(mutex_);
+  while (!entries_.empty()) {
+    erase(entries_.begin());
+  }
+}
+
+}  // namespace waybar::util
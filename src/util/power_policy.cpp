@@ -0,0 +1,162 @@
+#include "util/power_policy.hpp"
+
+#include <glibmm/variant.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+#include "client.hpp"
+#include "ext-idle-notify-v1-client-protocol.h"
+#include "util/timer_scheduler.hpp"
+
+namespace waybar::util {
+
+namespace {
+
+// org.freedesktop.UPower.Device.State
+constexpr guint32 UPOWER_STATE_DISCHARGING = 2;
+constexpr guint32 UPOWER_STATE_PENDING_DISCHARGE = 6;
+
+}  // namespace
+
+PowerPolicy& PowerPolicy::instance() {
+  // Leaked on purpose: the idle notification listener refers to it until the process exits
+  static auto* policy = new PowerPolicy();
+  return *policy;
+}
+
+void PowerPolicy::configure(const Json::Value& config) {
+  if (config.isBool() && !config.asBool()) {
+    battery_threshold_ = 0;
+    unwatchIdle();
+    idle_ = false;
+    low_battery_ = false;
+    apply();
+    return;
+  }
+
+  factor_ = config["factor"].isUInt() ? std::max(1U, config["factor"].asUInt()) : DEFAULT_FACTOR;
+  battery_threshold_ = config["battery-threshold"].isNumeric()
+                           ? config["battery-threshold"].asDouble()
+                           : DEFAULT_BATTERY_THRESHOLD;
+  const auto idle_timeout_s =
+      config["idle-timeout"].isUInt() ? config["idle-timeout"].asUInt() : DEFAULT_IDLE_TIMEOUT_S;
+
+  if (battery_threshold_ > 0) {
+    watchBattery();
+  }
+  if (idle_timeout_s != idle_timeout_s_) {
+    unwatchIdle();
+    idle_ = false;
+    if (idle_timeout_s > 0) {
+      watchIdle(idle_timeout_s);
+    }
+  }
+  readBattery();
+  apply();
+}
+
+unsigned PowerPolicy::factor() const { return idle_ || low_battery_ ? factor_ : 1; }
+
+void PowerPolicy::apply() {
+  const auto factor = this->factor();
+  if (factor != TimerScheduler::instance().stretch()) {
+    spdlog::debug("Power saving: polling {} times less often (idle: {}, low battery: {})", factor,
+                  idle_, low_battery_);
+    TimerScheduler::instance().setStretch(factor);
+  }
+}
+
+void PowerPolicy::watchBattery() {
+  if (watching_battery_) {
+    return;
+  }
+  watching_battery_ = true;
+  Gio::DBus::Proxy::create_for_bus(Gio::DBus::BusType::BUS_TYPE_SYSTEM, "org.freedesktop.UPower",
+                                   "/org/freedesktop/UPower/devices/DisplayDevice",
+                                   "org.freedesktop.UPower.Device",
+                                   sigc::mem_fun(*this, &PowerPolicy::onBatteryProxy));
+}
+
+void PowerPolicy::onBatteryProxy(Glib::RefPtr<Gio::AsyncResult>& result) {
+  try {
+    battery_proxy_ = Gio::DBus::Proxy::create_for_bus_finish(result);
+  } catch (const Glib::Error& e) {
+    spdlog::debug("Power saving: UPower is not available: {}", std::string(e.what()));
+    return;
+  }
+  battery_proxy_->signal_properties_changed().connect(
+      [this](const Gio::DBus::Proxy::MapChangedProperties& /*changed*/,
+             const std::vector<Glib::ustring>& /*invalidated*/) {
+        readBattery();
+        apply();
+      });
+  readBattery();
+  apply();
+}
+
+void PowerPolicy::readBattery() {
+  low_battery_ = false;
+  if (!battery_proxy_ || battery_threshold_ <= 0) {
+    return;
+  }
+  Glib::Variant<guint32> state;
+  Glib::Variant<double> percentage;
+  battery_proxy_->get_cached_property(state, "State");
+  battery_proxy_->get_cached_property(percentage, "Percentage");
+  if (!state || !percentage) {
+    // No battery, or UPower isn't running
+    return;
+  }
+  const bool discharging =
+      state.get() == UPOWER_STATE_DISCHARGING || state.get() == UPOWER_STATE_PENDING_DISCHARGE;
+  low_battery_ = discharging && percentage.get() < battery_threshold_;
+}
+
+void PowerPolicy::watchIdle(unsigned timeout_s) {
+  auto* client = Client::inst();
+  if (client->idle_notifier == nullptr) {
+    spdlog::debug("Power saving: ext-idle-notify protocol not available");
+    return;
+  }
+  auto* gdk_seat = gdk_display_get_default_seat(client->gdk_display->gobj());
+  if (gdk_seat == nullptr) {
+    return;
+  }
+
+  // Unlike the input idle notification, this one respects idle inhibitors: a playing video
+  // keeps the bar up to date
+  idle_notification_ = ext_idle_notifier_v1_get_idle_notification(
+      client->idle_notifier, timeout_s * 1000, gdk_wayland_seat_get_wl_seat(gdk_seat));
+  if (idle_notification_ == nullptr) {
+    return;
+  }
+  static const struct ext_idle_notification_v1_listener listener = {
+      .idled = &PowerPolicy::handleIdled,
+      .resumed = &PowerPolicy::handleResumed,
+  };
+  ext_idle_notification_v1_add_listener(idle_notification_, &listener, this);
+  idle_timeout_s_ = timeout_s;
+}
+
+void PowerPolicy::unwatchIdle() {
+  if (idle_notification_ != nullptr) {
+    ext_idle_notification_v1_destroy(idle_notification_);
+    idle_notification_ = nullptr;
+  }
+  idle_timeout_s_ = 0;
+}
+
+void PowerPolicy::handleIdled(void* data, ext_idle_notification_v1* /*notification*/) {
+  auto* self = static_cast<PowerPolicy*>(data);
+  self->idle_ = true;
+  self->apply();
+}
+
+void PowerPolicy::handleResumed(void* data, ext_idle_notification_v1* /*notification*/) {
+  auto* self = static_cast<PowerPolicy*>(data);
+  self->idle_ = false;
+  self->apply();
+}
+
+}  // namespace waybar::util
@@ -0,0 +1,69 @@
+#include "util/procfs.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace waybar::util::procfs {
+
+namespace {
+// Large enough for /proc/meminfo and a few dozen cores worth of /proc/stat in one read
+constexpr std::size_t kInitialBufferSize = 4096;
+}  // namespace
+
+File::File(std::string path) : path_(std::move(path)) { buffer_.resize(kInitialBufferSize); }
+
+File::~File() { close(); }
+
+void File::close() {
+  if (fd_ != -1) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+std::optional<std::string_view> File::tryRead() {
+  if (fd_ == -1) {
+    fd_ = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ == -1) {
+      return std::nullopt;
+    }
+  }
+
+  std::size_t size = 0;
+  while (true) {
+    if (size == buffer_.size()) {
+      buffer_.resize(buffer_.size() * 2);
+    }
+    auto n = ::pread(fd_, buffer_.data() + size, buffer_.size() - size, size);
+    if (n == 0) {
+      break;
+    }
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      // The underlying device may be gone (e.g. a hot-unplugged interface); reopen next time
+      const int saved_errno = errno;
+      close();
+      errno = saved_errno;
+      return std::nullopt;
+    }
+    size += n;
+  }
+  return std::string_view(buffer_.data(), size);
+}
+
+std::string_view File::read() {
+  auto text = tryRead();
+  if (!text) {
+    throw std::runtime_error("Can't read " + path_ + ": " + strerror(errno));
+  }
+  return *text;
+}
+
+}  // namespace waybar::util::procfs
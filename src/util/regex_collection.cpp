@@ -10,9 +10,23 @@ namespace waybar::util {
 
 int default_priority_function(std::string& key) { return 0; }
 
+std::size_t RegexCollection::cacheSizeFromConfig(const Json::Value& config) {
+  const auto& value = config["window-rewrite-cache-size"];
+  if (value.isNull()) {
+    return DEFAULT_CACHE_SIZE;
+  }
+  if (!value.isUInt() || value.asUInt() == 0) {
+    spdlog::warn("window-rewrite-cache-size must be a positive integer, using {}",
+                 DEFAULT_CACHE_SIZE);
+    return DEFAULT_CACHE_SIZE;
+  }
+  return value.asUInt();
+}
+
 RegexCollection::RegexCollection(const Json::Value& map, std::string default_repr,
-                                 const std::function<int(std::string&)>& priority_function)
-    : default_repr(std::move(default_repr)) {
+                                 const std::function<int(std::string&)>& priority_function,
+                                 std::size_t cache_size)
+    : cache_size(std::max<std::size_t>(cache_size, 1)), default_repr(std::move(default_repr)) {
   if (!map.isObject()) {
     spdlog::warn("Mapping is not an object");
     return;
@@ -46,13 +60,14 @@ std::string RegexCollection::find_match(std::string& value, bool& matched_any) {
   return value;
 }
 
-std::string& RegexCollection::get(std::string& value, bool& matched_any) {
-  if (regex_cache.contains(value)) {
-    return regex_cache[value];
+std::string RegexCollection::get(std::string& value, bool& matched_any) {
+  std::lock_guard lock(*cache_mutex);
+  if (auto cached = regex_cache.find(value); cached != regex_cache.end()) {
+    cache_order.splice(cache_order.begin(), cache_order, cached->second);
+    ++stats.hits;
+    return cached->second->second;
   }
-
-  // std::string repr =
-  // waybar::util::find_match(value, window_rewrite_rules_, matched_any);
+  ++stats.misses;
 
   std::string repr = find_match(value, matched_any);
 
@@ -60,14 +75,25 @@ std::string& RegexCollection::get(std::string& value, bool& matched_any) {
     repr = default_repr;
   }
 
-  regex_cache.emplace(value, repr);
+  if (regex_cache.size() >= cache_size) {
+    regex_cache.erase(cache_order.back().first);
+    cache_order.pop_back();
+    ++stats.evictions;
+  }
+  cache_order.emplace_front(value, std::move(repr));
+  regex_cache.emplace(cache_order.front().first, cache_order.begin());
 
-  return regex_cache[value];  // Necessary in order to return a reference to the heap
+  return cache_order.front().second;
 }
 
-std::string& RegexCollection::get(std::string& value) {
+std::string RegexCollection::get(std::string& value) {
   bool matched_any = false;
   return get(value, matched_any);
 }
 
+RegexCollection::CacheStats RegexCollection::cache_stats() const {
+  std::lock_guard lock(*cache_mutex);
+  return stats;
+}
+
 }  // namespace waybar::util
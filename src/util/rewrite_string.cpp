@@ -2,31 +2,92 @@
 
 #include <spdlog/spdlog.h>
 
-#include <regex>
+#include <cctype>
+#include <optional>
+#include <string_view>
+#include <utility>
 
 namespace waybar::util {
-std::string rewriteString(const std::string& value, const Json::Value& rules) {
-  if (!rules.isObject()) {
-    return value;
+namespace {
+
+// Leading characters of an ECMAScript pattern that any full match must start with.
+// Conservative: gives up on alternations, escapes, classes and non-ASCII bytes.
+std::string literalPrefix(const std::string& pattern) {
+  if (pattern.find('|') != std::string::npos) {
+    return {};
   }
+  constexpr std::string_view special = "\\^$.|?*+()[]{}";
+  std::size_t i = pattern.starts_with('^') ? 1 : 0;
+  std::string prefix;
+  for (; i < pattern.size(); ++i) {
+    const auto c = static_cast<unsigned char>(pattern[i]);
+    if (c >= 0x80 || special.find(static_cast<char>(c)) != std::string_view::npos) {
+      break;
+    }
+    prefix += static_cast<char>(std::tolower(c));
+  }
+  // "ab?", "ab*" and "ab{0,1}" make the last literal optional
+  if (!prefix.empty() && i < pattern.size() &&
+      (pattern[i] == '?' || pattern[i] == '*' || pattern[i] == '{')) {
+    prefix.pop_back();
+  }
+  return prefix;
+}
 
-  std::string res = value;
+bool mayMatch(const RewriteRuleSet::Rule& rule, const std::string& value) {
+  if (value.size() < rule.prefix.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < rule.prefix.size(); ++i) {
+    if (std::tolower(static_cast<unsigned char>(value[i])) != rule.prefix[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Malformed regexes are logged and yield std::nullopt, so the rule is skipped
+std::optional<RewriteRuleSet::Rule> compile(const std::string& pattern, std::string replacement) {
+  try {
+    return RewriteRuleSet::Rule{
+        .regex = std::regex{pattern, std::regex_constants::icase | std::regex_constants::optimize},
+        .prefix = literalPrefix(pattern),
+        .replacement = std::move(replacement),
+    };
+  } catch (const std::regex_error& e) {
+    spdlog::error("Invalid rule {}: {}", pattern, e.what());
+    return std::nullopt;
+  }
+}
 
+}  // namespace
+
+std::string rewriteString(const std::string& value, const Json::Value& rules) {
+  // Compiles the rules on every call; callers that rewrite on every update keep a RewriteRuleSet
+  return RewriteRuleSet(rules).apply(value);
+}
+
+RewriteRuleSet::RewriteRuleSet(const Json::Value& rules) {
+  if (!rules.isObject()) {
+    return;
+  }
   for (auto it = rules.begin(); it != rules.end(); ++it) {
     if (it.key().isString() && it->isString()) {
-      try {
-        // malformated regexes will cause an exception.
-        // in this case, log error and try the next rule.
-        const std::regex rule{it.key().asString(), std::regex_constants::icase};
-        if (std::regex_match(res, rule)) {
-          res = std::regex_replace(res, rule, it->asString());
-        }
-      } catch (const std::regex_error& e) {
-        spdlog::error("Invalid rule {}: {}", it.key().asString(), e.what());
+      if (auto rule = compile(it.key().asString(), it->asString())) {
+        rules_.push_back(std::move(*rule));
       }
     }
   }
+}
 
+std::string RewriteRuleSet::apply(const std::string& value) const {
+  std::string res = value;
+  for (const auto& rule : rules_) {
+    if (mayMatch(rule, res) && std::regex_match(res, rule.regex)) {
+      res = std::regex_replace(res, rule.regex, rule.replacement);
+    }
+  }
   return res;
 }
+
 }  // namespace waybar::util
@@ -0,0 +1,347 @@
+#include "util/timer_scheduler.hpp"
+
+#include <pthread.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iterator>
+#include <utility>
+
+#include "util/prepare_for_sleep.h"
+
+namespace waybar::util {
+
+namespace {
+
+std::atomic<TimerScheduler*> current_scheduler = nullptr;
+
+// Workers don't survive fork(). Forget the parent's scheduler so that a child starts its own
+// if it needs one; nothing else may be done between fork() and exec().
+void forgetScheduler() { current_scheduler.store(nullptr, std::memory_order_relaxed); }
+
+}  // namespace
+
+TimerScheduler& TimerScheduler::instance() {
+  static const int atfork = pthread_atfork(nullptr, nullptr, forgetScheduler);
+  (void)atfork;
+
+  auto* scheduler = current_scheduler.load(std::memory_order_acquire);
+  if (scheduler == nullptr) {
+    // Leaked on purpose: SleeperThreads may still be stopped during static destruction
+    auto* fresh = new TimerScheduler();
+    if (current_scheduler.compare_exchange_strong(scheduler, fresh, std::memory_order_acq_rel)) {
+      scheduler = fresh;
+    } else {
+      delete fresh;
+    }
+  }
+
+  // Timers didn't run while the system was suspended; catch up with all of them at once
+  static const auto resume_connection = prepare_for_sleep().connect([](bool sleep) {
+    if (!sleep) {
+      instance().expireAll();
+    }
+  });
+  return *scheduler;
+}
+
+TimerScheduler::TimerScheduler(std::size_t max_workers, Clock::duration idle_timeout,
+                               Clock::duration stall_timeout)
+    : max_workers_(std::max<std::size_t>(1, max_workers)),
+      idle_timeout_(idle_timeout),
+      stall_timeout_(stall_timeout) {}
+
+TimerScheduler::~TimerScheduler() {
+  std::vector<std::thread> workers;
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+    workers = std::move(workers_);
+    std::ranges::move(retired_, std::back_inserter(workers));
+    retired_.clear();
+    if (watchdog_.joinable()) {
+      workers.push_back(std::move(watchdog_));
+    }
+  }
+  cv_.notify_all();
+  watchdog_cv_.notify_all();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+auto TimerScheduler::add(std::function<void()> task) -> Id {
+  std::lock_guard lock(mutex_);
+  const auto id = next_id_++;
+  tasks_.emplace(id, Task{.run = std::move(task), .timer = timers_.end()});
+  return id;
+}
+
+void TimerScheduler::remove(Id id) {
+  std::unique_lock lock(mutex_);
+  auto it = tasks_.find(id);
+  if (it == tasks_.end()) {
+    return;
+  }
+  auto& task = it->second;
+  if (task.scheduled) {
+    timers_.erase(task.timer);
+  }
+  if (task.queued) {
+    std::erase(ready_, id);
+  }
+  if (!task.running) {
+    tasks_.erase(it);
+    return;
+  }
+  task.removed = true;
+  if (task.runner != std::this_thread::get_id()) {
+    done_cv_.wait(lock, [this, id] { return !tasks_.contains(id); });
+  }
+}
+
+void TimerScheduler::schedule(Id id, Clock::time_point deadline, bool stretched) {
+  std::lock_guard lock(mutex_);
+  auto it = tasks_.find(id);
+  if (it == tasks_.end() || it->second.removed || stopping_) {
+    return;
+  }
+  auto& task = it->second;
+  if (task.queued) {
+    return;
+  }
+  if (deadline <= Clock::now()) {
+    if (task.scheduled) {
+      timers_.erase(task.timer);
+      task.scheduled = false;
+    }
+    enqueue(id, task);
+    startWorkers();
+    cv_.notify_one();
+    return;
+  }
+  if (task.scheduled) {
+    if (task.timer->first <= deadline) {
+      return;
+    }
+    timers_.erase(task.timer);
+  }
+  task.timer = timers_.emplace(deadline, id);
+  task.scheduled = true;
+  task.stretched = stretched;
+  if (task.timer == timers_.begin()) {
+    // The worker waiting for the earliest deadline has to wait less
+    startWorkers();
+    cv_.notify_all();
+  }
+}
+
+void TimerScheduler::unschedule(Id id) {
+  std::lock_guard lock(mutex_);
+  auto it = tasks_.find(id);
+  if (it == tasks_.end()) {
+    return;
+  }
+  auto& task = it->second;
+  if (task.scheduled) {
+    timers_.erase(task.timer);
+    task.scheduled = false;
+  }
+  if (task.queued) {
+    std::erase(ready_, id);
+    task.queued = false;
+  }
+  task.rerun = false;
+}
+
+void TimerScheduler::expireAll() {
+  std::lock_guard lock(mutex_);
+  timers_.clear();
+  for (auto& [id, task] : tasks_) {
+    task.scheduled = false;
+    if (!task.removed) {
+      enqueue(id, task);
+    }
+  }
+  startWorkers();
+  cv_.notify_all();
+}
+
+void TimerScheduler::setStretch(unsigned factor) {
+  factor = std::max(1U, factor);
+  if (stretch_.exchange(factor, std::memory_order_relaxed) <= factor) {
+    return;
+  }
+
+  // Sleeps stretched by a larger factor are cut short
+  std::lock_guard lock(mutex_);
+  for (auto it = timers_.begin(); it != timers_.end();) {
+    auto& task = tasks_.at(it->second);
+    if (!task.stretched) {
+      ++it;
+      continue;
+    }
+    task.scheduled = false;
+    enqueue(it->second, task);
+    it = timers_.erase(it);
+  }
+  if (!ready_.empty()) {
+    startWorkers();
+    cv_.notify_all();
+  }
+}
+
+auto TimerScheduler::stats() -> Stats {
+  std::lock_guard lock(mutex_);
+  return {.wakeups = wakeups_, .runs = runs_, .workers = workers_.size(), .stalls = stalls_};
+}
+
+auto TimerScheduler::alignedDeadline(std::chrono::system_clock::duration duration)
+    -> Clock::time_point {
+  const auto now = Clock::now();
+  if (duration >= std::chrono::hours(24 * 365)) {
+    // "once" and the like: never
+    return Clock::time_point::max();
+  }
+  if (duration < std::chrono::seconds(1)) {
+    return now + duration;
+  }
+
+  const auto wall = std::chrono::system_clock::now();
+  auto target = std::chrono::round<std::chrono::seconds>(wall + duration);
+  if (target <= wall) {
+    target += std::chrono::seconds(1);
+  }
+  return now + std::chrono::duration_cast<Clock::duration>(target - wall);
+}
+
+void TimerScheduler::enqueue(Id id, Task& task) {
+  if (task.running) {
+    task.rerun = true;
+  } else if (!task.queued) {
+    task.queued = true;
+    if (ready_.empty()) {
+      ready_since_ = Clock::now();
+    }
+    ready_.push_back(id);
+  }
+}
+
+void TimerScheduler::startWorkers() {
+  // Retired workers released the lock for good before they were handed over
+  for (auto& worker : retired_) {
+    worker.join();
+  }
+  retired_.clear();
+  // Whoever gets woken up first takes the first task, and also waits for the next deadline
+  if ((idle_ == 0 || idle_ < ready_.size()) && workers_.size() < max_workers_) {
+    workers_.emplace_back(&TimerScheduler::work, this);
+  }
+  if (workers_.size() >= max_workers_ && !watchdog_.joinable()) {
+    watchdog_ = std::thread(&TimerScheduler::watch, this);
+  }
+}
+
+void TimerScheduler::retire() {
+  auto self = std::ranges::find(workers_, std::this_thread::get_id(), &std::thread::get_id);
+  retired_.push_back(std::move(*self));
+  workers_.erase(self);
+}
+
+void TimerScheduler::watch() {
+  std::unique_lock lock(mutex_);
+  while (!stopping_ && workers_.size() >= max_workers_) {
+    watchdog_cv_.wait_for(lock, stall_timeout_);
+    if (stopping_) {
+      break;
+    }
+    // Nobody is left to run what is due: some tasks block where they shouldn't
+    const auto overdue = Clock::now() - stall_timeout_;
+    if (idle_ == 0 && ((!ready_.empty() && ready_since_ <= overdue) ||
+                       (!timers_.empty() && timers_.begin()->first <= overdue))) {
+      ++stalls_;
+      spdlog::warn("Every one of the {} timer workers has been busy for {}ms, starting another",
+                   workers_.size(),
+                   std::chrono::duration_cast<std::chrono::milliseconds>(stall_timeout_).count());
+      workers_.emplace_back(&TimerScheduler::work, this);
+    }
+  }
+  if (!stopping_) {
+    // Joined by startWorkers(), which starts the next watchdog
+    retired_.push_back(std::move(watchdog_));
+  }
+}
+
+void TimerScheduler::work() {
+  std::unique_lock lock(mutex_);
+  while (!stopping_) {
+    if (!ready_.empty()) {
+      const auto id = ready_.front();
+      ready_.pop_front();
+      ready_since_ = Clock::now();
+      if (idle_ == 0 && !timers_.empty()) {
+        // Leave a worker waiting for the next deadline while this one is busy
+        startWorkers();
+      }
+      auto& task = tasks_.at(id);
+      task.queued = false;
+      task.running = true;
+      task.runner = std::this_thread::get_id();
+      ++runs_;
+      lock.unlock();
+      try {
+        task.run();
+      } catch (const std::exception& e) {
+        spdlog::error("Scheduled task failed: {}", e.what());
+      }
+      lock.lock();
+      task.running = false;
+      task.runner = {};
+      if (task.removed) {
+        tasks_.erase(id);
+        done_cv_.notify_all();
+      } else if (std::exchange(task.rerun, false)) {
+        enqueue(id, task);
+      }
+      continue;
+    }
+
+    ++idle_;
+    const auto idle_until = Clock::now() + idle_timeout_;
+    // A copy, as the timer may be erased while waiting
+    const Clock::time_point wake_at =
+        timers_.empty() ? idle_until : std::min(idle_until, timers_.begin()->first);
+    cv_.wait_until(lock, wake_at);
+    --idle_;
+
+    const auto now = Clock::now();
+    if (stopping_) {
+      continue;
+    }
+    // Another idle worker is left to wait for the next deadline, if there is one
+    if (now >= idle_until && ready_.empty() && (timers_.empty() || idle_ > 0)) {
+      retire();
+      return;
+    }
+    if (timers_.empty() || timers_.begin()->first > now) {
+      continue;
+    }
+    // Everything due gets run after this one wakeup
+    ++wakeups_;
+    while (!timers_.empty() && timers_.begin()->first <= now) {
+      const auto id = timers_.begin()->second;
+      timers_.erase(timers_.begin());
+      auto& task = tasks_.at(id);
+      task.scheduled = false;
+      enqueue(id, task);
+    }
+    if (ready_.size() > 1) {
+      startWorkers();
+      cv_.notify_all();
+    }
+  }
+}
+
+}  // namespace waybar::util
@@ -0,0 +1,100 @@
+#include "util/update_scheduler.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace waybar::util {
+
+UpdateScheduler::UpdateScheduler(Gtk::Widget& widget) : widget_(widget) {}
+
+UpdateScheduler::~UpdateScheduler() {
+  disarm();
+  deferred_.disconnect();
+}
+
+auto UpdateScheduler::add(std::function<void()> update, std::chrono::milliseconds min_period)
+    -> Handle {
+  const auto period = std::chrono::duration_cast<std::chrono::microseconds>(min_period);
+  entries_.push_back({.update = std::move(update), .min_period_us = period.count()});
+  return entries_.size() - 1;
+}
+
+void UpdateScheduler::schedule(Handle handle) {
+  auto& entry = entries_.at(handle);
+  if (entry.pending) {
+    return;
+  }
+  entry.pending = true;
+  pending_.push_back(handle);
+  arm();
+}
+
+gboolean UpdateScheduler::onTick(GtkWidget* /*widget*/, GdkFrameClock* clock, gpointer data) {
+  auto* self = static_cast<UpdateScheduler*>(data);
+  self->tick_id_ = 0;
+  self->fallback_.disconnect();
+  self->flush(gdk_frame_clock_get_frame_time(clock));
+  return G_SOURCE_REMOVE;
+}
+
+void UpdateScheduler::arm() {
+  if (tick_id_ != 0 || fallback_.connected()) {
+    return;
+  }
+  auto flush_now = [this] {
+    disarm();
+    flush(g_get_monotonic_time());
+    return false;
+  };
+  if (!widget_.get_mapped()) {
+    // No frames are drawn for a hidden bar
+    fallback_ = Glib::signal_idle().connect(flush_now);
+    return;
+  }
+  tick_id_ = gtk_widget_add_tick_callback(widget_.gobj(), &UpdateScheduler::onTick, this, nullptr);
+  fallback_ = Glib::signal_timeout().connect(flush_now, FALLBACK_INTERVAL_MS);
+}
+
+void UpdateScheduler::disarm() {
+  if (tick_id_ != 0) {
+    gtk_widget_remove_tick_callback(widget_.gobj(), tick_id_);
+    tick_id_ = 0;
+  }
+  fallback_.disconnect();
+}
+
+void UpdateScheduler::flush(gint64 now_us) {
+  deferred_.disconnect();
+  running_.swap(pending_);
+
+  gint64 next_due_us = std::numeric_limits<gint64>::max();
+  for (auto handle : running_) {
+    auto& entry = entries_[handle];
+    if (entry.last_run_us != 0 && now_us - entry.last_run_us < entry.min_period_us) {
+      // Ran too recently; keep it pending until its period is over
+      next_due_us = std::min(next_due_us, entry.last_run_us + entry.min_period_us);
+      pending_.push_back(handle);
+      continue;
+    }
+    entry.pending = false;
+    entry.last_run_us = now_us;
+    entry.update();
+  }
+  running_.clear();
+
+  if (next_due_us != std::numeric_limits<gint64>::max()) {
+    const auto delay_ms = static_cast<unsigned>((next_due_us - now_us + 999) / 1000);
+    deferred_ = Glib::signal_timeout().connect(
+        [this] {
+          arm();
+          return false;
+        },
+        delay_ms);
+  } else if (!pending_.empty()) {
+    // Scheduled again by one of the updates that just ran
+    arm();
+  }
+}
+
+}  // namespace waybar::util
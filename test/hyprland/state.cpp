@@ -0,0 +1,138 @@
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <map>
+#include <string>
+
+#include "modules/hyprland/state.hpp"
+
+namespace hyprland = waybar::modules::hyprland;
+
+namespace {
+struct FakeHyprland {
+  std::map<std::string, std::string> replies = {
+      {"j/monitors",
+       R"([{"id":0,"name":"DP-1","focused":true,"activeWorkspace":{"id":1,"name":"1"},
+            "specialWorkspace":{"id":0,"name":""}},
+           {"id":1,"name":"DP-2","focused":false,"activeWorkspace":{"id":2,"name":"2"},
+            "specialWorkspace":{"id":0,"name":""}}])"},
+      {"j/workspaces",
+       R"([{"id":1,"name":"1","monitor":"DP-1","windows":1,"lastwindow":"0xa","lastwindowtitle":"vim"},
+           {"id":2,"name":"2","monitor":"DP-2","windows":1,"lastwindow":"0xb","lastwindowtitle":"web"},
+           {"id":3,"name":"3","monitor":"DP-1","windows":0,"lastwindow":"0x0","lastwindowtitle":""}])"},
+      {"j/clients",
+       R"([{"address":"0xa","title":"vim","workspace":{"id":1,"name":"1"}},
+           {"address":"0xb","title":"web","workspace":{"id":2,"name":"2"}}])"},
+      {"j/activeworkspace", R"({"id":1,"name":"1","windows":1,"lastwindow":"0xa"})"},
+  };
+  std::map<std::string, int> queries;
+
+  hyprland::State::Query query() {
+    return [this](const std::string& rq) {
+      ++queries[rq];
+      return replies[rq];
+    };
+  }
+};
+}  // namespace
+
+TEST_CASE("State queries on every read until live", "[hyprland][state]") {
+  FakeHyprland fake;
+  hyprland::State state(fake.query());
+
+  state.clients();
+  state.clients();
+  REQUIRE(fake.queries["j/clients"] == 2);
+
+  state.setLive(true);
+  state.clients();
+  state.clients();
+  REQUIRE(fake.queries["j/clients"] == 3);
+}
+
+TEST_CASE("State patches titles and focus without querying", "[hyprland][state]") {
+  FakeHyprland fake;
+  hyprland::State state(fake.query());
+  state.setLive(true);
+  auto before = state.clients();
+  state.workspaces();
+  state.monitors();
+  state.activeWorkspace();
+
+  state.apply("windowtitlev2>>a,vim ~/notes, draft");
+  state.apply("activewindowv2>>b");
+  state.apply("focusedmonv2>>DP-2,2");
+  state.apply("renameworkspace>>2,www");
+
+  REQUIRE((*state.clients())[0]["title"] == "vim ~/notes, draft");
+  REQUIRE((*state.clients())[1]["workspace"]["name"] == "www");
+  REQUIRE((*state.workspaces())[0]["lastwindowtitle"] == "vim ~/notes, draft");
+  REQUIRE((*state.workspaces())[1]["lastwindow"] == "0xb");
+  REQUIRE((*state.monitors())[0]["focused"] == false);
+  REQUIRE((*state.monitors())[1]["focused"] == true);
+  REQUIRE((*state.monitors())[1]["activeWorkspace"]["name"] == "www");
+  REQUIRE((*state.activeWorkspace())["id"] == 2);
+  REQUIRE((*state.activeWorkspace())["name"] == "www");
+
+  state.apply("workspacev2>>3,3");
+  REQUIRE((*state.monitors())[1]["activeWorkspace"]["id"] == 3);
+  REQUIRE((*state.activeWorkspace())["id"] == 3);
+
+  // Snapshots taken earlier are not modified in place
+  REQUIRE((*before)[0]["title"] == "vim");
+
+  for (const auto& [rq, count] : fake.queries) {
+    REQUIRE(count == 1);
+  }
+}
+
+TEST_CASE("State re-queries stale sections once per burst", "[hyprland][state]") {
+  FakeHyprland fake;
+  hyprland::State state(fake.query());
+  state.setLive(true);
+  state.workspaces();
+  state.clients();
+  state.monitors();
+
+  state.apply("openwindow>>c,1,kitty,shell");
+  state.apply("closewindow>>a");
+  state.apply("submap>>resize");
+
+  state.workspaces();
+  state.workspaces();
+  state.clients();
+  state.monitors();
+
+  REQUIRE(fake.queries["j/workspaces"] == 2);
+  REQUIRE(fake.queries["j/clients"] == 2);
+  REQUIRE(fake.queries["j/monitors"] == 1);
+
+  state.apply("activewindowv2>>unknown");
+  state.clients();
+  REQUIRE(fake.queries["j/clients"] == 3);
+}
+
+TEST_CASE("State does not cache a reply that may predate an event", "[hyprland][state]") {
+  FakeHyprland fake;
+
+  // The query runs without the lock, so events can be applied while it is in flight
+  bool applied = false;
+  hyprland::State racing([&](const std::string& rq) {
+    ++fake.queries[rq];
+    if (!applied) {
+      applied = true;
+      racing.apply("openwindow>>c,1,kitty,shell");
+    }
+    return fake.replies[rq];
+  });
+  racing.setLive(true);
+
+  REQUIRE((*racing.clients())[0]["title"] == "vim");
+  racing.clients();
+  REQUIRE(fake.queries["j/clients"] == 2);
+  racing.clients();
+  REQUIRE(fake.queries["j/clients"] == 2);
+}
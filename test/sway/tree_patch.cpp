@@ -0,0 +1,103 @@
+#include "modules/sway/ipc/tree_patch.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <string>
+
+#include "modules/sway/ipc/ipc.hpp"
+#include "util/json.hpp"
+
+namespace sway = waybar::modules::sway;
+
+namespace {
+// One output with two workspaces; window 4 on workspace 2 is focused, window 5 is floating
+const std::string kTree = R"({
+  "id": 1, "type": "root", "focused": false, "focus": [2],
+  "nodes": [{
+    "id": 2, "type": "output", "name": "DP-1", "focused": false, "focus": [3, 7],
+    "nodes": [
+      {"id": 3, "type": "workspace", "name": "2", "focused": false, "urgent": false,
+       "focus": [4, 5, 6],
+       "nodes": [{"id": 4, "type": "con", "name": "vim", "focused": true, "focus": [],
+                  "nodes": []},
+                 {"id": 6, "type": "con", "name": "term", "focused": false, "focus": [],
+                  "nodes": []}],
+       "floating_nodes": [{"id": 5, "type": "floating_con", "name": "mpv", "focused": false,
+                           "focus": [], "nodes": []}]},
+      {"id": 7, "type": "workspace", "name": "3", "focused": false, "urgent": false, "focus": [8],
+       "nodes": [{"id": 8, "type": "con", "name": "web", "focused": false, "focus": [],
+                  "nodes": []}]}
+    ]
+  }]
+})";
+
+Json::Value parse(const std::string& json) { return waybar::util::JsonParser().parse(json); }
+}  // namespace
+
+TEST_CASE("Property changes are patched into the tree", "[sway][tree]") {
+  auto tree = parse(kTree);
+
+  auto title = parse(
+      R"({"change": "title", "container": {"id": 6, "name": "htop", "focused": false}})");
+  REQUIRE(sway::isPatchableEvent(IPC_EVENT_WINDOW, title));
+  REQUIRE(sway::patchTree(tree, IPC_EVENT_WINDOW, title));
+  const auto& ws = tree["nodes"][0]["nodes"][0];
+  REQUIRE(ws["nodes"][1]["name"].asString() == "htop");
+  // The container keeps its children, and nothing else changes
+  REQUIRE(ws["nodes"][1]["nodes"].isArray());
+  REQUIRE(ws["nodes"][0]["name"].asString() == "vim");
+
+  auto urgent = parse(
+      R"({"change": "urgent", "current": {"id": 7, "type": "workspace", "urgent": true}})");
+  REQUIRE(sway::patchTree(tree, IPC_EVENT_WORKSPACE, urgent));
+  REQUIRE(tree["nodes"][0]["nodes"][1]["urgent"].asBool());
+  REQUIRE(tree["nodes"][0]["nodes"][1]["nodes"].size() == 1);
+}
+
+TEST_CASE("Focus changes within a workspace are patched into the tree", "[sway][tree]") {
+  auto tree = parse(kTree);
+
+  auto focus = parse(
+      R"({"change": "focus", "container": {"id": 5, "name": "mpv", "focused": true}})");
+  REQUIRE(sway::isPatchableEvent(IPC_EVENT_WINDOW, focus));
+  REQUIRE(sway::patchTree(tree, IPC_EVENT_WINDOW, focus));
+
+  const auto& ws = tree["nodes"][0]["nodes"][0];
+  REQUIRE_FALSE(ws["nodes"][0]["focused"].asBool());
+  REQUIRE(ws["floating_nodes"][0]["focused"].asBool());
+  REQUIRE(ws["focus"] == parse("[5, 4, 6]"));
+  REQUIRE(tree["nodes"][0]["focus"] == parse("[3, 7]"));
+}
+
+TEST_CASE("Events that need a full tree are not patched", "[sway][tree]") {
+  auto tree = parse(kTree);
+
+  SECTION("Layout changes") {
+    auto added = parse(R"({"change": "new", "container": {"id": 9, "type": "con"}})");
+    REQUIRE_FALSE(sway::isPatchableEvent(IPC_EVENT_WINDOW, added));
+    REQUIRE_FALSE(sway::patchTree(tree, IPC_EVENT_WINDOW, added));
+
+    auto ws_focus = parse(R"({"change": "focus", "current": {"id": 7, "type": "workspace"}})");
+    REQUIRE_FALSE(sway::isPatchableEvent(IPC_EVENT_WORKSPACE, ws_focus));
+  }
+
+  SECTION("Containers missing from the tree") {
+    auto title = parse(R"({"change": "title", "container": {"id": 42, "name": "gone"}})");
+    REQUIRE_FALSE(sway::patchTree(tree, IPC_EVENT_WINDOW, title));
+  }
+
+  SECTION("Focus moving to another workspace") {
+    auto focus = parse(R"({"change": "focus", "container": {"id": 8, "focused": true}})");
+    REQUIRE(sway::isPatchableEvent(IPC_EVENT_WINDOW, focus));
+    REQUIRE_FALSE(sway::patchTree(tree, IPC_EVENT_WINDOW, focus));
+  }
+
+  SECTION("Other event types") {
+    auto mode = parse(R"({"change": "urgent", "container": {"id": 4}})");
+    REQUIRE_FALSE(sway::isPatchableEvent(IPC_EVENT_MODE, mode));
+  }
+}
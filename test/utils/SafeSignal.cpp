@@ -7,6 +7,7 @@
 #else
 #include <catch2/catch.hpp>
 #endif
+#include <atomic>
 #include <thread>
 #include <type_traits>
 #include <vector>
@@ -171,4 +172,147 @@ TEST_CASE_METHOD(GlibTestsFixture, "SafeSignal queue stays bounded under burst l
   REQUIRE_FALSE(received.empty());
   REQUIRE(received.back() == NUM_EVENTS);
   REQUIRE(received.front() == NUM_EVENTS - static_cast<int>(received.size()) + 1);
+
+  const auto stats = test_signal.stats();
+  REQUIRE(stats.enqueued == NUM_EVENTS);
+  REQUIRE(stats.dropped == NUM_EVENTS - received.size());
+  REQUIRE(stats.max_depth >= received.size());
+}
+
+TEST_CASE_METHOD(GlibTestsFixture, "SafeSignal drops the oldest events while the loop is stalled",
+                 "[signal][thread][util][perf]") {
+  constexpr int NUM_EVENTS = 200;
+  constexpr std::size_t MAX_QUEUED_EVENTS = 8;
+  std::vector<int> received;
+
+  SafeSignal<int> test_signal;
+  test_signal.set_max_queued_events(MAX_QUEUED_EVENTS);
+  test_signal.connect([&](auto value) { received.push_back(value); });
+
+  // The main loop isn't running yet, so nothing is delivered while the producer emits
+  std::thread producer([&]() {
+    for (int i = 1; i <= NUM_EVENTS; ++i) {
+      test_signal.emit(i);
+    }
+  });
+  producer.join();
+
+  auto stats = test_signal.stats();
+  REQUIRE(stats.queued == MAX_QUEUED_EVENTS);
+  REQUIRE(stats.dropped == NUM_EVENTS - MAX_QUEUED_EVENTS);
+
+  setTimeout(500);
+  run([this]() { Glib::signal_timeout().connect_once([this]() { this->quit(); }, 50); });
+
+  REQUIRE(received == std::vector<int>{193, 194, 195, 196, 197, 198, 199, 200});
+  stats = test_signal.stats();
+  REQUIRE(stats.queued == 0);
+  REQUIRE(stats.max_depth == MAX_QUEUED_EVENTS);
+}
+
+TEST_CASE_METHOD(GlibTestsFixture, "SafeSignal keeps the emission order while dropping events",
+                 "[signal][thread][util][perf]") {
+  constexpr int NUM_PRODUCERS = 4;
+  constexpr int NUM_EVENTS = 5000;
+  constexpr std::size_t MAX_QUEUED_EVENTS = 8;
+  std::vector<int> last(NUM_PRODUCERS, 0);
+  std::size_t received = 0;
+  int out_of_order = 0;
+
+  SafeSignal<int, int> test_signal;
+  test_signal.set_max_queued_events(MAX_QUEUED_EVENTS);
+  test_signal.connect([&](auto producer, auto value) {
+    if (value <= last[producer]) {
+      ++out_of_order;
+    }
+    last[producer] = value;
+    ++received;
+  });
+
+  setTimeout(2000);
+
+  // Producers keep finding the queue full while the main loop drains it
+  std::atomic<int> finished = 0;
+  std::vector<std::thread> producers;
+  run([&]() {
+    for (int producer = 0; producer < NUM_PRODUCERS; ++producer) {
+      producers.emplace_back([&, producer]() {
+        for (int i = 1; i <= NUM_EVENTS; ++i) {
+          test_signal.emit(producer, i);
+        }
+        ++finished;
+      });
+    }
+    Glib::signal_timeout().connect(
+        [&]() {
+          if (finished == NUM_PRODUCERS && test_signal.stats().queued == 0) {
+            this->quit();
+            return false;
+          }
+          return true;
+        },
+        10);
+  });
+  for (auto& producer : producers) {
+    producer.join();
+  }
+
+  REQUIRE(out_of_order == 0);
+  const auto stats = test_signal.stats();
+  REQUIRE(stats.enqueued == NUM_PRODUCERS * NUM_EVENTS);
+  REQUIRE(stats.dropped + received == NUM_PRODUCERS * NUM_EVENTS);
+}
+
+TEST_CASE_METHOD(GlibTestsFixture, "SafeSignal lowering the limit drops pending events at once",
+                 "[signal][thread][util]") {
+  std::vector<int> received;
+
+  SafeSignal<int> test_signal;
+  test_signal.connect([&](auto value) { received.push_back(value); });
+
+  std::thread producer([&]() {
+    for (int i = 1; i <= 10; ++i) {
+      test_signal.emit(i);
+    }
+  });
+  producer.join();
+
+  test_signal.set_max_queued_events(3);
+  REQUIRE(test_signal.stats().queued == 3);
+  REQUIRE(test_signal.stats().dropped == 7);
+
+  setTimeout(500);
+  run([this]() { Glib::signal_timeout().connect_once([this]() { this->quit(); }, 50); });
+
+  REQUIRE(received == std::vector<int>{8, 9, 10});
+}
+
+TEST_CASE_METHOD(GlibTestsFixture, "SafeSignal coalescing delivers only the latest event",
+                 "[signal][thread][util][perf]") {
+  constexpr int NUM_EVENTS = 200;
+  std::vector<int> received;
+
+  SafeSignal<int> test_signal;
+  test_signal.set_coalescing(true);
+
+  setTimeout(500);
+
+  test_signal.connect([&](auto value) { received.push_back(value); });
+
+  run([&]() {
+    std::thread producer([&]() {
+      for (int i = 1; i <= NUM_EVENTS; ++i) {
+        test_signal.emit(i);
+      }
+    });
+    producer.join();
+
+    Glib::signal_timeout().connect_once([this]() { this->quit(); }, 50);
+  });
+
+  REQUIRE(received == std::vector<int>{NUM_EVENTS});
+  const auto stats = test_signal.stats();
+  REQUIRE(stats.enqueued == NUM_EVENTS);
+  REQUIRE(stats.coalesced == NUM_EVENTS - 1);
+  REQUIRE(stats.dropped == 0);
 }
@@ -0,0 +1,50 @@
+#include "util/clock_tick.hpp"
+
+#include <glibmm.h>
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <chrono>
+#include <memory>
+
+#include "fixtures/GlibTestsFixture.hpp"
+
+using namespace waybar::util;
+using namespace std::chrono_literals;
+
+TEST_CASE("ClockTick shares ticks by period", "[util][clock_tick]") {
+  auto a = ClockTick::acquire(1h);
+  auto b = ClockTick::acquire(1h);
+  REQUIRE(a == b);
+
+  auto c = ClockTick::acquire(2h);
+  REQUIRE(c != a);
+
+  std::weak_ptr<ClockTick> weak = ClockTick::acquire(3h);
+  REQUIRE(weak.expired());
+}
+
+TEST_CASE_METHOD(GlibTestsFixture, "ClockTick fans out one tick to every subscriber",
+                 "[util][clock_tick]") {
+  int first_calls = 0;
+  int second_calls = 0;
+  setTimeout(1000);
+
+  // The first tick is right after the tick starts, the next one is an hour away at most
+  auto first = ClockTick::subscribe(1h, [&] {
+    ++first_calls;
+    if (first_calls > 0 && second_calls > 0) quit();
+  });
+  auto second = ClockTick::subscribe(1h, [&] {
+    ++second_calls;
+    if (first_calls > 0 && second_calls > 0) quit();
+  });
+
+  run([] {});
+
+  REQUIRE(first_calls == 1);
+  REQUIRE(second_calls == 1);
+}
@@ -7,50 +7,99 @@
 #include <sys/wait.h>
 #include <unistd.h>
 
-#include <cerrno>
+#include <chrono>
 #include <list>
 #include <mutex>
+#include <stop_token>
+#include <thread>
 
 std::mutex reap_mtx;
 std::list<pid_t> reap;
 
-extern "C" int waybar_test_execl(const char* path, const char* arg, ...);
-extern "C" int waybar_test_execlp(const char* file, const char* arg, ...);
-
-#define execl waybar_test_execl
-#define execlp waybar_test_execlp
 #include "util/command.hpp"
-#undef execl
-#undef execlp
-
-extern "C" int waybar_test_execl(const char* path, const char* arg, ...) {
-  (void)path;
-  (void)arg;
-  errno = ENOENT;
-  return -1;
+
+namespace command = waybar::util::command;
+
+TEST_CASE("command::splitArgv only accepts plain command lines", "[util][command]") {
+  REQUIRE(command::splitArgv("notify-send  hello\tworld") ==
+          std::vector<std::string>{"notify-send", "hello", "world"});
+  REQUIRE_FALSE(command::splitArgv("echo $HOME"));
+  REQUIRE_FALSE(command::splitArgv("echo 'a b'"));
+  REQUIRE_FALSE(command::splitArgv("pgrep foo && echo on"));
+  REQUIRE_FALSE(command::splitArgv("ls ~/notes"));
+  REQUIRE_FALSE(command::splitArgv("FOO=1 env"));
+  REQUIRE_FALSE(command::splitArgv("exit 0"));
+  REQUIRE_FALSE(command::splitArgv(":"));
+  REQUIRE_FALSE(command::splitArgv("type sh"));
+  REQUIRE_FALSE(command::splitArgv("   "));
 }
 
-extern "C" int waybar_test_execlp(const char* file, const char* arg, ...) {
-  (void)file;
-  (void)arg;
-  errno = ENOENT;
-  return -1;
+TEST_CASE("command::exec captures output with and without the shell", "[util][command]") {
+  auto direct = command::exec("echo hello   world", "");
+  REQUIRE(direct.exit_code == 0);
+  REQUIRE(direct.out == "hello world");
+
+  auto shell = command::exec("printf 'a\\n%s\\n' \"$WAYBAR_OUTPUT_NAME\"; exit 3", "DP-1");
+  REQUIRE(shell.exit_code == 3);
+  REQUIRE(shell.out == "a\nDP-1");
+
+  auto large = command::exec("head -c 100000 /dev/zero", "");
+  REQUIRE(large.out.size() == 100000);
 }
 
-TEST_CASE("command::execNoRead returns 127 when shell exec fails", "[util][command]") {
-  const auto result = waybar::util::command::execNoRead("echo should-not-run");
-  REQUIRE(result.exit_code == waybar::util::command::kExecFailureExitCode);
+TEST_CASE("command::execNoRead returns 127 when the command can't be executed",
+          "[util][command]") {
+  const auto result = command::execNoRead("/nonexistent/should-not-run");
+  REQUIRE(result.exit_code == command::kExecFailureExitCode);
+  REQUIRE(result.out.empty());
+}
+
+TEST_CASE("command::run kills commands on timeout and stop requests", "[util][command]") {
+  using namespace std::chrono_literals;
+  const auto start = std::chrono::steady_clock::now();
+  auto result = command::run("sleep 5", {.timeout = 100ms});
+  REQUIRE(result.exit_code == command::kTimeoutExitCode);
+  // Waits for the exit after stdout is closed
+  result = command::run("exec >&-; sleep 5", {.timeout = 100ms});
+  REQUIRE(result.exit_code == command::kTimeoutExitCode);
+  result = command::run("exec >&-; sleep 0.05; exit 3", {.timeout = 1s});
+  REQUIRE(result.exit_code == 3);
+
+  std::stop_source stop;
+  std::thread stopper([&stop] {
+    std::this_thread::sleep_for(100ms);
+    stop.request_stop();
+  });
+  result = command::run("sleep 5; echo done", {.stop = stop.get_token()});
+  stopper.join();
+  REQUIRE(result.exit_code == command::kTimeoutExitCode);
   REQUIRE(result.out.empty());
+  REQUIRE(std::chrono::steady_clock::now() - start < 2s);
+}
+
+TEST_CASE("command::forkExec fails when the command can't be executed", "[util][command]") {
+  REQUIRE(command::forkExec("/nonexistent/should-not-run", "test-output") == -1);
+}
+
+TEST_CASE("command::spawn leaves commands missing from PATH to the shell", "[util][command]") {
+  // The shell may know it as a builtin; here it reports the missing command itself
+  const auto pid = command::spawn("should-not-be-a-command", "", -1);
+  REQUIRE(pid > 0);
+  int status = -1;
+  REQUIRE(waitpid(pid, &status, 0) == pid);
+  REQUIRE(WIFEXITED(status));
+  REQUIRE(WEXITSTATUS(status) == command::kExecFailureExitCode);
 }
 
-TEST_CASE("command::forkExec child exits 127 when shell exec fails", "[util][command]") {
-  const auto pid = waybar::util::command::forkExec("echo should-not-run", "test-output");
+TEST_CASE("command::forkExec starts the child in its own process group", "[util][command]") {
+  const auto pid = command::forkExec("sleep 0", "test-output");
   REQUIRE(pid > 0);
+  REQUIRE(getpgid(pid) == pid);
 
   int status = -1;
   REQUIRE(waitpid(pid, &status, 0) == pid);
   REQUIRE(WIFEXITED(status));
-  REQUIRE(WEXITSTATUS(status) == waybar::util::command::kExecFailureExitCode);
+  REQUIRE(WEXITSTATUS(status) == 0);
 
   std::scoped_lock<std::mutex> lock(reap_mtx);
   reap.remove(pid);
@@ -66,3 +66,38 @@ TEST_CASE("command::LineStream does not emit an extra line after newline-termina
   REQUIRE(*result.exit_code == 0);
   REQUIRE(result.lines == std::vector<std::string>{"first", "second"});
 }
+
+TEST_CASE("command::LineStream answers requests written to stdin", "[util][command_line_stream]") {
+  auto loop = Glib::MainLoop::create();
+  std::vector<std::string> lines;
+  bool timed_out = false;
+  auto timeout = Glib::signal_timeout().connect(
+      [&]() {
+        timed_out = true;
+        loop->quit();
+        return false;
+      },
+      3000);
+
+  waybar::util::command::LineStream stream(
+      "",
+      [&](const std::string& line) {
+        lines.push_back(line);
+        if (lines.size() == 2) {
+          loop->quit();
+        }
+      },
+      [](int) {});
+
+  stream.start("while read -r request; do echo \"reply to $request\"; done", true);
+  REQUIRE(stream.send("update"));
+  REQUIRE(stream.send("click left"));
+  loop->run();
+  timeout.disconnect();
+
+  REQUIRE_FALSE(timed_out);
+  REQUIRE(lines == std::vector<std::string>{"reply to update", "reply to click left"});
+
+  stream.stop();
+  REQUIRE_FALSE(stream.send("update"));
+}
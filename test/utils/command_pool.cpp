@@ -0,0 +1,170 @@
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "util/command_pool.hpp"
+
+using namespace std::chrono_literals;
+using waybar::util::command::Pool;
+
+namespace {
+template <typename Predicate>
+bool waitFor(Predicate predicate) {
+  const auto deadline = std::chrono::steady_clock::now() + 2s;
+  while (!predicate()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(1ms);
+  }
+  return true;
+}
+}  // namespace
+
+TEST_CASE("Pool coalesces pending tasks of the same key", "[util][command_pool]") {
+  Pool pool(2);
+  const int key = 0;
+  std::atomic<int> runs = 0;
+  std::atomic<int> last = 0;
+
+  for (int i = 1; i <= 5; ++i) {
+    pool.submit(
+        &key,
+        [&, i](std::stop_token) {
+          ++runs;
+          last = i;
+        },
+        50ms);
+  }
+  REQUIRE(waitFor([&] { return runs == 1; }));
+  std::this_thread::sleep_for(50ms);
+  REQUIRE(runs == 1);
+  REQUIRE(last == 5);
+}
+
+TEST_CASE("Pool keeps the earliest deadline of a key", "[util][command_pool]") {
+  Pool pool(1);
+  const int key = 0;
+  std::atomic<bool> ran = false;
+
+  pool.submit(&key, [&](std::stop_token) { ran = true; });
+  pool.submit(&key, [&](std::stop_token) { ran = true; }, 1h);
+  REQUIRE(waitFor([&] { return ran.load(); }));
+}
+
+TEST_CASE("Pool never runs tasks of the same key concurrently", "[util][command_pool]") {
+  Pool pool(4);
+  const int key = 0;
+  std::atomic<int> running = 0;
+  std::atomic<int> overlaps = 0;
+  std::atomic<int> runs = 0;
+
+  auto task = [&](std::stop_token) {
+    if (++running > 1) {
+      ++overlaps;
+    }
+    std::this_thread::sleep_for(20ms);
+    --running;
+    ++runs;
+  };
+  pool.submit(&key, task);
+  REQUIRE(waitFor([&] { return running == 1; }));
+  pool.submit(&key, task);
+  pool.submit(&key, task);
+  REQUIRE(waitFor([&] { return runs == 2; }));
+  REQUIRE(overlaps == 0);
+}
+
+TEST_CASE("Pool runs other keys while a task is busy", "[util][command_pool]") {
+  Pool pool(2);
+  const int slow = 0;
+  const int fast = 0;
+  std::atomic<bool> fast_ran = false;
+
+  pool.submit(&slow, [&](std::stop_token stop) {
+    while (!stop.stop_requested()) {
+      std::this_thread::sleep_for(1ms);
+    }
+  });
+  pool.submit(&fast, [&](std::stop_token) { fast_ran = true; });
+  REQUIRE(waitFor([&] { return fast_ran.load(); }));
+  pool.cancel(&slow);
+}
+
+TEST_CASE("Pool::cancel stops the running task and drops rescheduling", "[util][command_pool]") {
+  Pool pool(1);
+  const int key = 0;
+  std::atomic<bool> started = false;
+  std::atomic<int> runs = 0;
+
+  std::function<void(std::stop_token)> task = [&](std::stop_token stop) {
+    ++runs;
+    started = true;
+    while (!stop.stop_requested()) {
+      std::this_thread::sleep_for(1ms);
+    }
+    pool.submit(&key, task);
+  };
+  pool.submit(&key, task);
+  REQUIRE(waitFor([&] { return started.load(); }));
+  pool.cancel(&key);
+  std::this_thread::sleep_for(20ms);
+  REQUIRE(runs == 1);
+}
+
+TEST_CASE("Pool runs other keys while unbounded tasks hang", "[util][command_pool]") {
+  Pool pool(1);
+  const int hung = 0;
+  const int other = 0;
+  std::atomic<bool> started = false;
+  std::atomic<bool> other_ran = false;
+
+  pool.submit(
+      &hung,
+      [&](std::stop_token stop) {
+        started = true;
+        while (!stop.stop_requested()) {
+          std::this_thread::sleep_for(1ms);
+        }
+      },
+      0ms, false);
+  REQUIRE(waitFor([&] { return started.load(); }));
+  pool.submit(&other, [&](std::stop_token) { other_ran = true; });
+  REQUIRE(waitFor([&] { return other_ran.load(); }));
+  pool.cancel(&hung);
+}
+
+TEST_CASE("Pool retires the threads of finished unbounded tasks", "[util][command_pool]") {
+  Pool pool(1, 50ms);
+  const int hung = 0;
+  const int other = 0;
+  std::atomic<bool> started = false;
+  std::atomic<int> runs = 0;
+
+  pool.submit(
+      &hung,
+      [&](std::stop_token stop) {
+        started = true;
+        while (!stop.stop_requested()) {
+          std::this_thread::sleep_for(1ms);
+        }
+      },
+      0ms, false);
+  REQUIRE(waitFor([&] { return started.load(); }));
+  pool.submit(&other, [&](std::stop_token) { ++runs; });
+  REQUIRE(waitFor([&] { return runs == 1; }));
+  REQUIRE(pool.workers() == 2);
+
+  pool.cancel(&hung);
+  REQUIRE(waitFor([&] { return pool.workers() == 0; }));
+
+  // Threads are started again on demand
+  pool.submit(&other, [&](std::stop_token) { ++runs; });
+  REQUIRE(waitFor([&] { return runs == 2; }));
+}
@@ -0,0 +1,169 @@
+#include "modules/custom_script.hpp"
+
+#include <glibmm.h>
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <atomic>
+#include <chrono>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "fixtures/GlibTestsFixture.hpp"
+
+using waybar::modules::CustomScript;
+using namespace std::chrono_literals;
+
+namespace {
+Json::Value sharedConfig() {
+  Json::Value config(Json::objectValue);
+  config["exec"] = "echo shared";
+  config["interval"] = 3600;
+  config["shared"] = true;
+  return config;
+}
+
+std::shared_ptr<CustomScript> get(const Json::Value& config, const std::string& output = "DP-1") {
+  return CustomScript::get(config, "custom/test", output, 3600s);
+}
+}  // namespace
+
+TEST_CASE("CustomScript shares scripts with the same settings", "[util][custom_script]") {
+  const auto config = sharedConfig();
+  const auto first = get(config);
+
+  SECTION("Settings that don't affect the script") {
+    auto other = config;
+    other["format"] = "<b>{}</b>";
+    other["tooltip"] = false;
+    REQUIRE(get(other, "DP-2") == first);
+  }
+
+  SECTION("Settings of the script") {
+    for (const auto& [key, value] :
+         std::initializer_list<std::pair<const char*, Json::Value>>{{"exec", "echo other"},
+                                                                    {"exec-if", "true"},
+                                                                    {"exec-timeout", 5},
+                                                                    {"interval", 60},
+                                                                    {"signal", 8}}) {
+      INFO(key);
+      auto other = config;
+      other[key] = value;
+      REQUIRE(get(other) != first);
+    }
+  }
+
+  SECTION("Scripts that aren't shared") {
+    auto other = config;
+    other["shared"] = false;
+    REQUIRE(get(other) != get(other));
+    other.removeMember("shared");
+    REQUIRE(get(other) != get(other));
+  }
+
+  SECTION("Scripts reading the output name in their command line") {
+    auto other = config;
+    other["shared"] = "auto";
+    REQUIRE(get(other, "DP-2") == first);
+    other["exec"] = "echo $WAYBAR_OUTPUT_NAME";
+    REQUIRE(get(other, "DP-1") != get(other, "DP-2"));
+    other["exec"] = "echo shared";
+    other["exec-if"] = "test \"$WAYBAR_OUTPUT_NAME\" = DP-1";
+    REQUIRE(get(other, "DP-1") != get(other, "DP-2"));
+  }
+}
+
+TEST_CASE("CustomScript stops with its last user", "[util][custom_script]") {
+  auto config = sharedConfig();
+  config["exec"] = "echo teardown";
+  auto first = get(config);
+  auto second = get(config, "DP-2");
+  REQUIRE(first == second);
+
+  std::atomic<int> outputs = 0;
+  first->subscribe(&outputs, [&](const waybar::util::command::res& output) {
+    if (output.out == "teardown") {
+      ++outputs;
+    }
+  });
+  const auto deadline = std::chrono::steady_clock::now() + 2s;
+  while (outputs == 0 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(1ms);
+  }
+  REQUIRE(outputs == 1);
+  first->unsubscribe(&outputs);
+
+  std::weak_ptr<CustomScript> weak = first;
+  first.reset();
+  REQUIRE_FALSE(weak.expired());
+  second.reset();
+  REQUIRE(weak.expired());
+
+  // The next module starts the script again
+  auto third = get(config);
+  REQUIRE(third != nullptr);
+  REQUIRE(get(config, "DP-2") == third);
+}
+
+TEST_CASE("CustomScript pauses polling once all of its users are paused", "[util][custom_script]") {
+  Json::Value config(Json::objectValue);
+  config["exec"] = "echo poll";
+  config["interval"] = 0.05;
+  const auto script = CustomScript::get(config, "custom/test", "DP-1", 50ms);
+
+  std::atomic<int> outputs = 0;
+  const int first = 0;
+  const int second = 0;
+  script->subscribe(&first, [&](const waybar::util::command::res&) { ++outputs; });
+  script->subscribe(&second, [](const waybar::util::command::res&) {});
+  auto waitForOutputs = [&](int count) {
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (outputs < count && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(1ms);
+    }
+    return outputs >= count;
+  };
+
+  script->pause(&first);
+  REQUIRE(waitForOutputs(outputs + 2));
+
+  script->pause(&second);
+  // Let a run in progress finish
+  std::this_thread::sleep_for(100ms);
+  const int paused_outputs = outputs;
+  std::this_thread::sleep_for(200ms);
+  REQUIRE(outputs == paused_outputs);
+
+  script->resume(&first);
+  REQUIRE(waitForOutputs(paused_outputs + 2));
+
+  script->unsubscribe(&first);
+  script->unsubscribe(&second);
+}
+
+TEST_CASE_METHOD(GlibTestsFixture, "CustomScript asks a daemon again after a lost reply",
+                 "[util][custom_script]") {
+  Json::Value config(Json::objectValue);
+  // Never answers the first request
+  config["exec"] = "read -r line; while read -r line; do echo \"$line\"; done";
+  config["daemon"] = true;
+  setTimeout(3000);
+
+  auto script = CustomScript::get(config, "custom/daemon", "", 50ms);
+  REQUIRE(script->mode() == CustomScript::Mode::DAEMON);
+  std::string reply;
+  script->subscribe(this, [&](const waybar::util::command::res& output) {
+    reply = output.out;
+    quit();
+  });
+  run([] {});
+  script->unsubscribe(this);
+
+  REQUIRE(reply == "update");
+}
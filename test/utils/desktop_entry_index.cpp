@@ -0,0 +1,96 @@
+#include "util/desktop_entry_index.hpp"
+
+#include <glibmm.h>
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "fixtures/GlibTestsFixture.hpp"
+
+using waybar::util::DesktopEntryIndex;
+namespace fs = std::filesystem;
+
+namespace {
+class DesktopEntryIndexTest : public GlibTestsFixture {
+ public:
+  DesktopEntryIndexTest() {
+    const auto root = fs::temp_directory_path() / "waybar-desktop-entry-index-XXXXXX";
+    std::string path = root.string();
+    root_ = mkdtemp(path.data());
+    fs::create_directories(root_ / "user" / "kde");
+    fs::create_directories(root_ / "system");
+  }
+  ~DesktopEntryIndexTest() { fs::remove_all(root_); }
+
+  void write(const fs::path& dir, const std::string& name, const std::string& keys) {
+    std::ofstream(root_ / dir / name) << "[Desktop Entry]\nType=Application\n" << keys;
+  }
+
+  // Runs the main loop until the index announces a completed scan
+  void waitForScan(DesktopEntryIndex& index) {
+    setTimeout(3000);
+    auto conn = index.signal_changed.connect([this] { quit(); });
+    run([] {});
+    conn.disconnect();
+  }
+
+ protected:
+  fs::path root_;
+};
+}  // namespace
+
+TEST_CASE_METHOD(DesktopEntryIndexTest, "DesktopEntryIndex looks entries up",
+                 "[util][desktop_entry_index]") {
+  write("user", "org.example.Foot.desktop", "Icon=user-foot\nStartupWMClass=footclient\n");
+  write("user/kde", "dolphin.desktop", "Icon=dolphin\n");
+  write("system", "org.example.Foot.desktop", "Icon=system-foot\n");
+  write("system", "librewolf.desktop", "Icon=librewolf\n");
+
+  DesktopEntryIndex index({(root_ / "user").string(), (root_ / "system").string()});
+  waitForScan(index);
+
+  SECTION("by name, earlier data dirs first") {
+    auto entry = index.byName({"missing.desktop", "org.example.Foot.desktop"});
+    REQUIRE(entry);
+    REQUIRE(entry->icon == "user-foot");
+    REQUIRE(index.byName({"kde/dolphin.desktop"})->icon == "dolphin");
+    REQUIRE(index.byName({"librewolf.desktop", "org.example.Foot.desktop"})->icon == "user-foot");
+    REQUIRE_FALSE(index.byName({"dolphin.desktop"}));
+  }
+
+  SECTION("by StartupWMClass") {
+    REQUIRE(index.byStartupWMClass("footclient")->icon == "user-foot");
+    REQUIRE_FALSE(index.byStartupWMClass("Foot"));
+  }
+
+  SECTION("by suffix, also in lowercase") {
+    REQUIRE(index.bySuffix({"Foot.desktop"})->icon == "user-foot");
+    REQUIRE(index.bySuffix({"LibreWolf.desktop"})->icon == "librewolf");
+    REQUIRE(index.bySuffix({"phin.desktop"})->icon == "dolphin");
+    REQUIRE_FALSE(index.bySuffix({"kitty.desktop"}));
+  }
+}
+
+TEST_CASE_METHOD(DesktopEntryIndexTest, "DesktopEntryIndex reloads when entries change",
+                 "[util][desktop_entry_index]") {
+  write("user", "kitty.desktop", "Icon=kitty\n");
+
+  DesktopEntryIndex index({(root_ / "user").string(), (root_ / "system").string()});
+  waitForScan(index);
+  REQUIRE(index.byName({"kitty.desktop"})->icon == "kitty");
+  REQUIRE_FALSE(index.byName({"foot.desktop"}));
+
+  write("system", "foot.desktop", "Icon=foot\n");
+  fs::remove(root_ / "user" / "kitty.desktop");
+  waitForScan(index);
+
+  REQUIRE(index.byName({"foot.desktop"})->icon == "foot");
+  REQUIRE_FALSE(index.byName({"kitty.desktop"}));
+}
@@ -0,0 +1,35 @@
+#include "util/format_template.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+using waybar::util::FormatTemplate;
+
+TEST_CASE("FormatTemplate collects named arguments", "[util][format_template]") {
+  FormatTemplate tpl("{usage:>3}% {icon0}{icon12} {{icons}} {load!r}");
+  REQUIRE(tpl.references("usage"));
+  REQUIRE(tpl.references("load"));
+  REQUIRE_FALSE(tpl.references("icons"));
+  REQUIRE(tpl.referencesIndexed("icon"));
+  REQUIRE_FALSE(tpl.referencesIndexed("usage"));
+  REQUIRE_FALSE(tpl.referencesAll());
+}
+
+TEST_CASE("FormatTemplate treats untracked fields as referencing everything",
+          "[util][format_template]") {
+  REQUIRE(FormatTemplate("{}%").referencesAll());
+  REQUIRE(FormatTemplate("{0}").references("usage"));
+  REQUIRE(FormatTemplate("{usage:>{width}}").referencesIndexed("icon"));
+  REQUIRE_FALSE(FormatTemplate("plain {{text}}").referencesAll());
+}
+
+TEST_CASE("FormatTemplate reset only rebuilds on change", "[util][format_template]") {
+  FormatTemplate tpl("{usage}");
+  REQUIRE_FALSE(tpl.reset("{usage}"));
+  REQUIRE(tpl.reset("{icons}"));
+  REQUIRE(tpl.references("icons"));
+  REQUIRE_FALSE(tpl.references("usage"));
+}
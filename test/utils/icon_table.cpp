@@ -0,0 +1,52 @@
+#include "util/icon_table.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include "util/json.hpp"
+
+using waybar::util::IconTable;
+
+namespace {
+IconTable table(const std::string& json) {
+  return IconTable(waybar::util::JsonParser().parse(json));
+}
+}  // namespace
+
+TEST_CASE("IconTable spreads array icons over the range", "[util][icon_table]") {
+  auto icons = table(R"(["a", "b", "c", "d"])");
+  const auto& set = icons.select("");
+  REQUIRE(set.get(0) == "a");
+  REQUIRE(set.get(24) == "a");
+  REQUIRE(set.get(25) == "b");
+  REQUIRE(set.get(99) == "d");
+  REQUIRE(set.get(150) == "d");
+  REQUIRE(set.get(5, 10) == "c");
+}
+
+TEST_CASE("IconTable thresholds", "[util][icon_table]") {
+  auto icons = table(R"([{"icon": "low", "max": 20}, {"max": 50}, {"icon": "high", "max": 80}])");
+  const auto& set = icons.select("");
+  REQUIRE(set.get(10) == "low");
+  REQUIRE(set.get(40) == "high");
+  REQUIRE(set.get(95) == "high");
+}
+
+TEST_CASE("IconTable selects sets by alt", "[util][icon_table]") {
+  auto icons = table(R"({"default": ["d0", "d1"], "warning": "w", "bogus": 3})");
+  REQUIRE(icons.select("warning").get(90) == "w");
+  REQUIRE(icons.select("bogus").get(90) == "d1");
+  REQUIRE(icons.select("").get(10) == "d0");
+  REQUIRE(icons.select(std::vector<std::string>{"", "missing", "warning"}).get(0) == "w");
+  REQUIRE(icons.select(std::vector<std::string>{"missing"}).get(0) == "d0");
+}
+
+TEST_CASE("IconTable without usable icons", "[util][icon_table]") {
+  REQUIRE(table("null").select("").get(50).empty());
+  REQUIRE(table("[]").select("").get(50).empty());
+  REQUIRE(table(R"({"charging": ["c"]})").select("").get(50).empty());
+  REQUIRE(table(R"([1, "b"])").select("").get(0).empty());
+}
@@ -0,0 +1,80 @@
+#include "util/latest_value.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+using waybar::util::LatestValue;
+
+TEST_CASE("LatestValue hands over the latest value", "[util][latest_value]") {
+  LatestValue<std::string> value("initial");
+  REQUIRE_FALSE(value.acquire());
+  REQUIRE(value.current() == "initial");
+
+  value.publish("first");
+  REQUIRE(value.current() == "initial");
+  REQUIRE(value.acquire());
+  REQUIRE(value.current() == "first");
+  REQUIRE_FALSE(value.acquire());
+  REQUIRE(value.current() == "first");
+  REQUIRE(value.skipped() == 0);
+
+  SECTION("values replaced before being acquired are counted") {
+    value.publish("second");
+    value.publish("third");
+    value.publish("fourth");
+    REQUIRE(value.acquire());
+    REQUIRE(value.current() == "fourth");
+    REQUIRE(value.skipped() == 2);
+  }
+}
+
+TEST_CASE("LatestValue never tears values across threads", "[util][latest_value]") {
+  constexpr int producers = 2;
+  constexpr int values = 10000;
+  LatestValue<std::vector<int>> value;
+  std::atomic<int> finished = 0;
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; ++p) {
+    threads.emplace_back([&] {
+      for (int i = 1; i <= values; ++i) {
+        value.publish(std::vector<int>(16, i));
+      }
+      ++finished;
+    });
+  }
+
+  uint64_t acquired = 0;
+  auto check = [&] {
+    const auto& current = value.current();
+    REQUIRE(current.size() == 16);
+    for (int element : current) {
+      REQUIRE(element == current.front());
+    }
+    ++acquired;
+  };
+  while (finished < producers) {
+    if (value.acquire()) {
+      check();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (value.acquire()) {
+    check();
+  }
+  // Every value was either acquired or replaced by a newer one
+  REQUIRE(acquired + value.skipped() == producers * values);
+}
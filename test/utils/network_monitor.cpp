@@ -0,0 +1,181 @@
+#include "util/network_monitor.hpp"
+
+#include <arpa/inet.h>
+#include <linux/if.h>
+#include <linux/if_link.h>
+#include <linux/rtnetlink.h>
+#include <netlink/attr.h>
+#include <netlink/msg.h>
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using waybar::util::NetworkMonitor;
+
+namespace {
+
+// Tables fed by hand, as the event thread would from the kernel's messages
+class TestMonitor : public NetworkMonitor {
+ public:
+  TestMonitor() = default;
+
+  using NetworkMonitor::resync;
+
+  void feed(struct nl_msg* msg) {
+    handleEvents(msg, static_cast<NetworkMonitor*>(this));
+    nlmsg_free(msg);
+  }
+  void dumpDone() { handleEventsDone(nullptr, static_cast<NetworkMonitor*>(this)); }
+};
+
+struct nl_msg* link(int type, int index, const char* name, bool up = true) {
+  auto* msg = nlmsg_alloc_simple(type, 0);
+  struct ifinfomsg ifi = {
+      .ifi_family = AF_UNSPEC,
+      .ifi_index = index,
+      .ifi_flags = up ? static_cast<unsigned>(IFF_UP) : 0U,
+  };
+  nlmsg_append(msg, &ifi, sizeof(ifi), NLMSG_ALIGNTO);
+  nla_put_string(msg, IFLA_IFNAME, name);
+  nla_put_u8(msg, IFLA_CARRIER, up ? 1 : 0);
+  return msg;
+}
+
+struct nl_msg* address(int type, int index, const char* ip, uint8_t scope = RT_SCOPE_UNIVERSE) {
+  auto* msg = nlmsg_alloc_simple(type, 0);
+  struct ifaddrmsg ifa = {
+      .ifa_family = AF_INET,
+      .ifa_prefixlen = 24,
+      .ifa_scope = scope,
+      .ifa_index = static_cast<uint32_t>(index),
+  };
+  nlmsg_append(msg, &ifa, sizeof(ifa), NLMSG_ALIGNTO);
+  struct in_addr addr {};
+  inet_pton(AF_INET, ip, &addr);
+  nla_put(msg, IFA_LOCAL, sizeof(addr), &addr);
+  return msg;
+}
+
+struct nl_msg* route(int type, int index, const char* gateway, uint32_t priority) {
+  auto* msg = nlmsg_alloc_simple(type, 0);
+  struct rtmsg rtm = {
+      .rtm_family = AF_INET,
+      .rtm_table = RT_TABLE_MAIN,
+  };
+  nlmsg_append(msg, &rtm, sizeof(rtm), NLMSG_ALIGNTO);
+  struct in_addr addr {};
+  inet_pton(AF_INET, gateway, &addr);
+  nla_put(msg, RTA_GATEWAY, sizeof(addr), &addr);
+  nla_put_u32(msg, RTA_OIF, index);
+  nla_put_u32(msg, RTA_PRIORITY, priority);
+  return msg;
+}
+
+std::vector<std::string> addressesOf(const NetworkMonitor& monitor, int index) {
+  std::vector<std::string> addresses;
+  if (auto interface = monitor.interface(index)) {
+    for (const auto& addr : interface->addresses) {
+      addresses.push_back(addr.address);
+    }
+  }
+  return addresses;
+}
+
+}  // namespace
+
+TEST_CASE("NetworkMonitor follows link, address and route events", "[util][network_monitor]") {
+  TestMonitor monitor;
+  monitor.feed(link(RTM_NEWLINK, 2, "eth0"));
+  monitor.feed(link(RTM_NEWLINK, 3, "wlan0"));
+
+  auto eth0 = monitor.interface(2);
+  REQUIRE(eth0);
+  REQUIRE(eth0->name == "eth0");
+  REQUIRE(eth0->up);
+  REQUIRE(eth0->carrier);
+  REQUIRE(monitor.interfaces().size() == 2);
+
+  SECTION("Addresses") {
+    monitor.feed(address(RTM_NEWADDR, 2, "192.0.2.10"));
+    monitor.feed(address(RTM_NEWADDR, 2, "192.0.2.11"));
+    // Only global addresses are kept
+    monitor.feed(address(RTM_NEWADDR, 2, "169.254.0.1", RT_SCOPE_LINK));
+    // Reported again, e.g. by a dump
+    monitor.feed(address(RTM_NEWADDR, 2, "192.0.2.10"));
+    REQUIRE(addressesOf(monitor, 2) == std::vector<std::string>{"192.0.2.10", "192.0.2.11"});
+
+    monitor.feed(address(RTM_DELADDR, 2, "192.0.2.10"));
+    REQUIRE(addressesOf(monitor, 2) == std::vector<std::string>{"192.0.2.11"});
+  }
+
+  SECTION("Default routes") {
+    monitor.feed(route(RTM_NEWROUTE, 2, "192.0.2.1", 100));
+    monitor.feed(route(RTM_NEWROUTE, 3, "198.51.100.1", 600));
+    REQUIRE(monitor.defaultRoute()->index == 2);
+    REQUIRE(monitor.defaultRoute()->gateway == "192.0.2.1");
+    REQUIRE(monitor.defaultRoute(3)->gateway == "198.51.100.1");
+
+    monitor.feed(route(RTM_DELROUTE, 2, "192.0.2.1", 100));
+    REQUIRE(monitor.defaultRoute()->index == 3);
+    REQUIRE_FALSE(monitor.defaultRoute(2));
+  }
+
+  SECTION("A link that goes down loses its routes") {
+    monitor.feed(route(RTM_NEWROUTE, 2, "192.0.2.1", 100));
+    monitor.feed(link(RTM_NEWLINK, 2, "eth0", false));
+    REQUIRE_FALSE(monitor.interface(2)->up);
+    REQUIRE_FALSE(monitor.defaultRoute());
+  }
+
+  SECTION("A deleted link takes its addresses and routes along") {
+    monitor.feed(address(RTM_NEWADDR, 2, "192.0.2.10"));
+    monitor.feed(route(RTM_NEWROUTE, 2, "192.0.2.1", 100));
+    monitor.feed(link(RTM_DELLINK, 2, "eth0"));
+    REQUIRE_FALSE(monitor.interface(2));
+    REQUIRE_FALSE(monitor.defaultRoute());
+
+    // The index is reused by a new link
+    monitor.feed(link(RTM_NEWLINK, 2, "eth1"));
+    REQUIRE(addressesOf(monitor, 2).empty());
+  }
+}
+
+TEST_CASE("NetworkMonitor drops what a resync no longer reports", "[util][network_monitor]") {
+  TestMonitor monitor;
+  monitor.feed(link(RTM_NEWLINK, 2, "eth0"));
+  monitor.feed(link(RTM_NEWLINK, 3, "wlan0"));
+  monitor.feed(address(RTM_NEWADDR, 2, "192.0.2.10"));
+  monitor.feed(address(RTM_NEWADDR, 2, "192.0.2.11"));
+  monitor.feed(route(RTM_NEWROUTE, 2, "192.0.2.1", 100));
+  monitor.feed(route(RTM_NEWROUTE, 3, "198.51.100.1", 600));
+
+  // Links are dumped first, then addresses and then routes
+  monitor.resync();
+  monitor.feed(link(RTM_NEWLINK, 2, "eth0"));
+  // Nothing is dropped before the dump is done
+  REQUIRE(monitor.interface(3));
+  monitor.dumpDone();
+  REQUIRE(monitor.interface(2));
+  REQUIRE_FALSE(monitor.interface(3));
+
+  monitor.feed(address(RTM_NEWADDR, 2, "192.0.2.11"));
+  monitor.dumpDone();
+  REQUIRE(addressesOf(monitor, 2) == std::vector<std::string>{"192.0.2.11"});
+
+  monitor.feed(route(RTM_NEWROUTE, 2, "192.0.2.1", 100));
+  // Added by an event while the dump runs
+  monitor.feed(route(RTM_NEWROUTE, 2, "192.0.2.254", 50));
+  monitor.dumpDone();
+  REQUIRE(monitor.defaultRoute()->gateway == "192.0.2.254");
+  REQUIRE_FALSE(monitor.defaultRoute(3));
+
+  // The resync is over, events are applied as usual again
+  monitor.feed(route(RTM_NEWROUTE, 3, "198.51.100.1", 600));
+  REQUIRE(monitor.defaultRoute(3));
+}
@@ -0,0 +1,143 @@
+#include "util/pixbuf_cache.hpp"
+
+#include <gtkmm/main.h>
+#include <unistd.h>
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <chrono>
+#include <filesystem>
+#include <string>
+
+using waybar::util::PixbufCache;
+using namespace std::chrono_literals;
+
+namespace {
+
+// The wrappers of the GTK types are needed, but no display
+Glib::RefPtr<Gtk::IconTheme> makeTheme() {
+  Gtk::Main::init_gtkmm_internals();
+  return Gtk::IconTheme::create();
+}
+
+Glib::RefPtr<Gdk::Pixbuf> makePixbuf(int size) {
+  Gtk::Main::init_gtkmm_internals();
+  auto pixbuf = Gdk::Pixbuf::create(Gdk::COLORSPACE_RGB, false, 8, size, size);
+  pixbuf->fill(0x336699ff);
+  return pixbuf;
+}
+
+// Loads `name` from `theme` through `cache`, counting the loads that missed the cache
+Glib::RefPtr<Gdk::Pixbuf> load(PixbufCache& cache, const Glib::RefPtr<Gtk::IconTheme>& theme,
+                               const std::string& name, int& loads, int size = 16) {
+  return cache.fromTheme(theme, name, size, Gtk::ICON_LOOKUP_FORCE_SIZE, {}, [&] {
+    ++loads;
+    return makePixbuf(size);
+  });
+}
+
+void emitChanged(const Glib::RefPtr<Gtk::IconTheme>& theme) {
+  g_signal_emit_by_name(theme->gobj(), "changed");
+}
+
+}  // namespace
+
+TEST_CASE("PixbufCache evicts the least recently used images past its budget",
+          "[util][pixbuf_cache]") {
+  const std::size_t bytes = makePixbuf(16)->get_byte_length();
+  auto theme = makeTheme();
+  PixbufCache cache(bytes * 2 + bytes / 2);
+  int loads = 0;
+
+  auto a = load(cache, theme, "a", loads);
+  load(cache, theme, "b", loads);
+  REQUIRE(load(cache, theme, "a", loads) == a);  // b is now the least recently used
+  load(cache, theme, "c", loads);
+  REQUIRE(loads == 3);
+
+  auto stats = cache.stats();
+  REQUIRE(stats.entries == 2);
+  REQUIRE(stats.bytes == bytes * 2);
+  REQUIRE(stats.hits == 1);
+  REQUIRE(stats.misses == 3);
+  REQUIRE(stats.evictions == 1);
+
+  load(cache, theme, "a", loads);
+  REQUIRE(loads == 3);
+  load(cache, theme, "b", loads);
+  REQUIRE(loads == 4);
+
+  // Images larger than the whole budget are returned but not cached
+  REQUIRE(load(cache, theme, "huge", loads, 64)->get_width() == 64);
+  REQUIRE(cache.stats().entries == 2);
+  REQUIRE(cache.stats().bytes == bytes * 2);
+}
+
+TEST_CASE("PixbufCache decodes a file again once it changed", "[util][pixbuf_cache]") {
+  const auto path = std::filesystem::temp_directory_path() /
+                    ("waybar-pixbuf-cache-" + std::to_string(getpid()) + ".png");
+  makePixbuf(8)->save(path.string(), "png");
+  PixbufCache cache;
+
+  auto first = cache.fromFile(path.string());
+  REQUIRE(cache.fromFile(path.string()) == first);
+  REQUIRE(cache.stats().hits == 1);
+  REQUIRE(cache.stats().misses == 1);
+
+  // Scaled variants are separate entries
+  REQUIRE(cache.fromFile(path.string(), 4, 4)->get_width() == 4);
+  REQUIRE(cache.stats().entries == 2);
+
+  // Moved forward explicitly, as the rewrite may land within the timestamp granularity
+  makePixbuf(16)->save(path.string(), "png");
+  std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + 10s);
+  auto second = cache.fromFile(path.string());
+  REQUIRE(second != first);
+  REQUIRE(second->get_width() == 16);
+  REQUIRE(cache.stats().misses == 3);
+  REQUIRE(cache.stats().entries == 2);
+
+  // A missing file fails like Gdk::Pixbuf::create_from_file does
+  std::filesystem::remove(path);
+  REQUIRE_THROWS(cache.fromFile(path.string()));
+}
+
+TEST_CASE("PixbufCache drops the images of an icon theme that changed", "[util][pixbuf_cache]") {
+  auto first = makeTheme();
+  auto second = makeTheme();
+  PixbufCache cache;
+  int loads = 0;
+
+  load(cache, first, "a", loads);
+  load(cache, first, "b", loads);
+  load(cache, second, "a", loads);
+  REQUIRE(cache.stats().entries == 3);
+
+  emitChanged(first);
+  REQUIRE(cache.stats().entries == 1);
+  load(cache, second, "a", loads);
+  REQUIRE(loads == 3);
+
+  // Watched again as soon as it has entries again
+  load(cache, first, "a", loads);
+  REQUIRE(loads == 4);
+  emitChanged(first);
+  REQUIRE(cache.stats().entries == 1);
+
+  // No longer watched once its last entry is gone
+  cache.clear();
+  emitChanged(first);
+  emitChanged(second);
+  REQUIRE(cache.stats().entries == 0);
+
+  // A destroyed cache stops watching its themes
+  {
+    PixbufCache scoped;
+    load(scoped, first, "a", loads);
+  }
+  emitChanged(first);
+  REQUIRE(loads == 5);
+}
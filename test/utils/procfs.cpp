@@ -0,0 +1,97 @@
+#include "util/procfs.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace waybar::util;
+
+namespace {
+struct Meminfo {
+  uint64_t total{0};
+  uint64_t available{0};
+  uint64_t swap_free{0};
+};
+
+constexpr std::array<procfs::Field<Meminfo>, 3> kFields{{
+    {"MemTotal", &Meminfo::total},
+    {"MemAvailable", &Meminfo::available},
+    {"SwapFree", &Meminfo::swap_free},
+}};
+}  // namespace
+
+TEST_CASE("procfs::consumeNumber", "[util][procfs]") {
+  std::string_view text = "  123\t456 abc";
+  uint64_t value = 0;
+  REQUIRE(procfs::consumeNumber(text, value));
+  REQUIRE(value == 123);
+  REQUIRE(procfs::consumeNumber(text, value));
+  REQUIRE(value == 456);
+  REQUIRE_FALSE(procfs::consumeNumber(text, value));
+  REQUIRE(value == 456);
+
+  std::string_view empty = "   ";
+  REQUIRE_FALSE(procfs::consumeNumber(empty, value));
+}
+
+TEST_CASE("procfs::forEachLine", "[util][procfs]") {
+  std::vector<std::string_view> lines;
+  procfs::forEachLine("a\nbb\n\nccc", [&lines](std::string_view line) {
+    lines.push_back(line);
+    return true;
+  });
+  REQUIRE(lines == std::vector<std::string_view>{"a", "bb", "", "ccc"});
+
+  lines.clear();
+  procfs::forEachLine("a\nstop\nc\n", [&lines](std::string_view line) {
+    lines.push_back(line);
+    return line != "stop";
+  });
+  REQUIRE(lines == std::vector<std::string_view>{"a", "stop"});
+}
+
+TEST_CASE("procfs::parseKeyValues", "[util][procfs]") {
+  constexpr std::string_view meminfo =
+      "MemTotal:       16281768 kB\n"
+      "MemFree:         1429220 kB\n"
+      "MemAvailable:    9634016 kB\n"
+      "SwapTotal:       8388604 kB\n";
+  Meminfo out;
+  auto found = procfs::parseKeyValues(meminfo, kFields, out);
+  REQUIRE(found == 0b011);
+  REQUIRE(out.total == 16281768);
+  REQUIRE(out.available == 9634016);
+  REQUIRE(out.swap_free == 0);
+}
+
+TEST_CASE("procfs::File rereads in place", "[util][procfs]") {
+  char path[] = "/tmp/waybar-procfs-XXXXXX";
+  int fd = mkstemp(path);
+  REQUIRE(fd != -1);
+  close(fd);
+
+  std::ofstream(path) << "first";
+  procfs::File file(path);
+  REQUIRE(file.read() == "first");
+
+  // Larger than the initial buffer, to exercise growing it
+  std::string big(10000, 'x');
+  std::ofstream(path, std::ios::trunc) << big;
+  REQUIRE(file.read() == big);
+
+  std::ofstream(path, std::ios::trunc) << "short";
+  REQUIRE(file.read() == "short");
+
+  unlink(path);
+  procfs::File missing(path);
+  REQUIRE_FALSE(missing.tryRead().has_value());
+  REQUIRE_THROWS(missing.read());
+}
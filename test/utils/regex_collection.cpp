@@ -0,0 +1,101 @@
+#include "util/regex_collection.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using waybar::util::RegexCollection;
+
+namespace {
+RegexCollection makeCollection(std::size_t cache_size) {
+  Json::Value map(Json::objectValue);
+  map["firefox"] = "web";
+  map["title<(.*)>"] = "[$1]";
+  return RegexCollection(map, "?", waybar::util::default_priority_function, cache_size);
+}
+}  // namespace
+
+TEST_CASE("RegexCollection counts cache hits and misses", "[util][regex_collection]") {
+  auto collection = makeCollection(8);
+  std::string firefox = "class<firefox>";
+  std::string other = "class<kitty>";
+
+  REQUIRE(collection.get(firefox) == "web");
+  REQUIRE(collection.get(firefox) == "web");
+  REQUIRE(collection.get(other) == "?");
+
+  REQUIRE(collection.cache_stats().hits == 1);
+  REQUIRE(collection.cache_stats().misses == 2);
+  REQUIRE(collection.cache_stats().evictions == 0);
+}
+
+TEST_CASE("RegexCollection stays correct across evictions", "[util][regex_collection]") {
+  auto collection = makeCollection(2);
+  std::string a = "title<a>";
+  std::string b = "title<b>";
+  std::string c = "title<c>";
+
+  collection.get(a);
+  collection.get(b);
+  collection.get(a);  // b is now the least recently used
+  REQUIRE(collection.get(c) == "[c]");
+  REQUIRE(collection.cache_stats().evictions == 1);
+  REQUIRE(collection.get(a) == "[a]");
+  REQUIRE(collection.cache_stats().hits == 2);
+  REQUIRE(collection.get(b) == "[b]");
+  REQUIRE(collection.cache_stats().misses == 4);
+
+  for (int i = 0; i < 1000; ++i) {
+    std::string title = "title<" + std::to_string(i) + ">";
+    REQUIRE(collection.get(title) == "[" + std::to_string(i) + "]");
+  }
+  // Stays bounded on unique inputs
+  REQUIRE(collection.cache_stats().evictions == 2 + 1000);
+
+  // Moving keeps the cache usable
+  RegexCollection moved = std::move(collection);
+  std::string last = "title<999>";
+  REQUIRE(moved.get(last) == "[999]");
+  REQUIRE(moved.cache_stats().hits == 3);
+}
+
+TEST_CASE("RegexCollection reads its cache size from a module config", "[util][regex_collection]") {
+  auto cacheSize = [](const Json::Value& value) {
+    Json::Value config(Json::objectValue);
+    config["window-rewrite-cache-size"] = value;
+    return RegexCollection::cacheSizeFromConfig(config);
+  };
+  REQUIRE(RegexCollection::cacheSizeFromConfig(Json::Value(Json::objectValue)) ==
+          RegexCollection::DEFAULT_CACHE_SIZE);
+  REQUIRE(cacheSize(16) == 16);
+  REQUIRE(cacheSize(0) == RegexCollection::DEFAULT_CACHE_SIZE);
+  REQUIRE(cacheSize(-1) == RegexCollection::DEFAULT_CACHE_SIZE);
+  REQUIRE(cacheSize("big") == RegexCollection::DEFAULT_CACHE_SIZE);
+}
+
+TEST_CASE("RegexCollection can be used from several threads", "[util][regex_collection]") {
+  auto collection = makeCollection(4);
+  std::vector<std::thread> threads;
+  std::vector<int> failures(4, 0);
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < 500; ++i) {
+        std::string title = "title<" + std::to_string((i + t) % 8) + ">";
+        if (collection.get(title) != "[" + std::to_string((i + t) % 8) + "]") {
+          ++failures[t];
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  REQUIRE(failures == std::vector<int>(4, 0));
+  REQUIRE(collection.cache_stats().hits + collection.cache_stats().misses == 4 * 500);
+}
@@ -0,0 +1,50 @@
+#include "util/rewrite_string.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+using waybar::util::rewriteString;
+using waybar::util::RewriteRuleSet;
+
+namespace {
+Json::Value makeRules() {
+  Json::Value rules(Json::objectValue);
+  rules["(.*) - Mozilla Firefox"] = "🌎 $1";
+  rules["(.*) - zsh"] = "> [$1]";
+  rules["Spotify(.*)"] = "♪$1";
+  rules["colou?r picker"] = "🎨";
+  rules["foo|bar"] = "baz";
+  return rules;
+}
+}  // namespace
+
+TEST_CASE("RewriteRuleSet matches rewriteString", "[util][rewrite]") {
+  const auto rules = makeRules();
+  const RewriteRuleSet ruleset(rules);
+
+  for (const std::string title :
+       {"GitHub - Mozilla Firefox", "~ - zsh", "spotify premium", "Spotify", "color picker",
+        "Colour Picker", "bar", "foobar", "unrelated", ""}) {
+    INFO(title);
+    REQUIRE(ruleset.apply(title) == rewriteString(title, rules));
+  }
+  REQUIRE(ruleset.apply("GitHub - Mozilla Firefox") == "🌎 GitHub");
+  REQUIRE(ruleset.apply("SPOTIFY Free") == "♪ Free");
+  REQUIRE(ruleset.apply("Colour Picker") == "🎨");
+  REQUIRE(ruleset.apply("bar") == "baz");
+  REQUIRE(ruleset.apply("unrelated") == "unrelated");
+}
+
+TEST_CASE("RewriteRuleSet skips invalid rules", "[util][rewrite]") {
+  Json::Value rules(Json::objectValue);
+  rules["(unclosed"] = "x";
+  rules["ok"] = "fine";
+
+  const RewriteRuleSet ruleset(rules);
+  REQUIRE(ruleset.apply("ok") == "fine");
+  REQUIRE(rewriteString("ok", rules) == "fine");
+  REQUIRE(RewriteRuleSet(Json::Value()).empty());
+}
@@ -0,0 +1,106 @@
+#include "util/sample_hub.hpp"
+
+#include <glibmm.h>
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "fixtures/GlibTestsFixture.hpp"
+
+using namespace waybar::util;
+using namespace std::chrono_literals;
+
+TEST_CASE("SampleHub shares sources by name and interval", "[util][sample_hub]") {
+  std::atomic<int> samplers_created = 0;
+  auto make_sampler = [&samplers_created] {
+    ++samplers_created;
+    return [] { return 42; };
+  };
+
+  auto a = SampleHub<int>::acquire("test_shared", 1h, make_sampler);
+  auto b = SampleHub<int>::acquire("test_shared", 1h, make_sampler);
+  REQUIRE(a == b);
+  REQUIRE(samplers_created == 1);
+
+  auto c = SampleHub<int>::acquire("test_shared", 2h, make_sampler);
+  REQUIRE(c != a);
+  REQUIRE(samplers_created == 2);
+
+  auto d = SampleHub<int>::acquire("test_other", 1h, make_sampler);
+  REQUIRE(d != a);
+  REQUIRE(samplers_created == 3);
+}
+
+TEST_CASE("SampleHub releases a source with its last reference", "[util][sample_hub]") {
+  int samplers_created = 0;
+  auto make_sampler = [&samplers_created] {
+    ++samplers_created;
+    return [] { return 1; };
+  };
+
+  std::weak_ptr<SampleSource<int>> weak = SampleHub<int>::acquire("test_release", 1h, make_sampler);
+  REQUIRE(weak.expired());
+
+  auto source = SampleHub<int>::acquire("test_release", 1h, make_sampler);
+  REQUIRE(samplers_created == 2);
+}
+
+TEST_CASE_METHOD(GlibTestsFixture, "SampleHub fans out one sample to every subscriber",
+                 "[util][sample_hub]") {
+  std::atomic<int> samples_taken = 0;
+  std::atomic<bool> subscribed = false;
+  // Holds the first sample back until both modules subscribed
+  auto make_sampler = [&] {
+    return [&] {
+      while (!subscribed) {
+        std::this_thread::sleep_for(1ms);
+      }
+      return ++samples_taken;
+    };
+  };
+  int first_calls = 0;
+  int second_calls = 0;
+
+  setTimeout(1000);
+
+  auto first = SampleHub<int>::subscribe("test_fanout", 1h, make_sampler, [&] {
+    ++first_calls;
+    if (first_calls > 0 && second_calls > 0) quit();
+  });
+  auto second = SampleHub<int>::subscribe("test_fanout", 1h, make_sampler, [&] {
+    ++second_calls;
+    if (first_calls > 0 && second_calls > 0) quit();
+  });
+  subscribed = true;
+
+  run([] {});
+
+  REQUIRE(samples_taken == 1);
+  REQUIRE(first_calls == 1);
+  REQUIRE(second_calls == 1);
+  REQUIRE(first.latest() != nullptr);
+  REQUIRE(*first.latest() == 1);
+  REQUIRE(first.latest() == second.latest());
+}
+
+TEST_CASE_METHOD(GlibTestsFixture, "SampleHub hands the current sample to a late subscriber",
+                 "[util][sample_hub]") {
+  auto make_sampler = [] { return [] { return 7; }; };
+  setTimeout(1000);
+
+  auto first = SampleHub<int>::subscribe("test_late", 1h, make_sampler, [this] { quit(); });
+  run([] {});
+  REQUIRE(first.latest() != nullptr);
+
+  // Called right away instead of at the next sample, an hour later
+  int late_calls = 0;
+  auto late = SampleHub<int>::subscribe("test_late", 1h, make_sampler, [&] { ++late_calls; });
+  REQUIRE(late_calls == 1);
+  REQUIRE(*late.latest() == 7);
+}
@@ -7,6 +7,7 @@
 #include <sys/wait.h>
 #include <unistd.h>
 
+#include <atomic>
 #include <chrono>
 #include <thread>
 
@@ -78,3 +79,76 @@ TEST_CASE("SleeperThread control flags are stable under concurrent wake and stop
           "[util][sleeper_thread]") {
   REQUIRE(run_in_subprocess(run_control_flag_stress) == 0);
 }
+
+TEST_CASE("SleeperThread runs a sleeping loop between its sleeps", "[util][sleeper_thread]") {
+  using namespace std::chrono_literals;
+  std::atomic<int> runs = 0;
+  waybar::util::SleeperThread thread;
+  thread = [&] {
+    ++runs;
+    thread.sleep_for(1h);
+  };
+
+  std::this_thread::sleep_for(50ms);
+  REQUIRE(runs == 1);
+  thread.wake_up();
+  std::this_thread::sleep_for(50ms);
+  REQUIRE(runs == 2);
+}
+
+TEST_CASE("SleeperThread holds a paused loop until it is resumed", "[util][sleeper_thread]") {
+  using namespace std::chrono_literals;
+  std::atomic<int> runs = 0;
+  waybar::util::SleeperThread thread;
+  thread.pause();
+  thread = [&] {
+    ++runs;
+    thread.sleep_for(1ms);
+  };
+
+  std::this_thread::sleep_for(50ms);
+  REQUIRE(runs == 1);
+  thread.resume();
+  std::this_thread::sleep_for(50ms);
+  REQUIRE(runs > 1);
+}
+
+TEST_CASE("SleeperThread::stop lets a running iteration finish", "[util][sleeper_thread]") {
+  using namespace std::chrono_literals;
+  std::atomic<bool> started = false;
+  std::atomic<bool> finished = false;
+  std::atomic<int> runs = 0;
+  {
+    waybar::util::SleeperThread thread;
+    thread = [&] {
+      ++runs;
+      started = true;
+      std::this_thread::sleep_for(50ms);
+      finished = true;
+    };
+    while (!started) {
+      std::this_thread::yield();
+    }
+    thread.stop();
+  }
+  REQUIRE(finished);
+  REQUIRE(runs == 1);
+}
+
+TEST_CASE("SleeperThread::Blocking loops get a thread of their own", "[util][sleeper_thread]") {
+  std::atomic<bool> ran = false;
+  std::atomic<bool> own_thread = false;
+  const auto caller = std::this_thread::get_id();
+  waybar::util::SleeperThread thread;
+  thread = waybar::util::SleeperThread::Blocking{[&] {
+    own_thread = std::this_thread::get_id() != caller;
+    ran = true;
+    // Blocks, unlike in a scheduled loop
+    thread.sleep();
+  }};
+  while (!ran) {
+    std::this_thread::yield();
+  }
+  REQUIRE(own_thread);
+  thread.stop();
+}
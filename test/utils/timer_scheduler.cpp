@@ -0,0 +1,219 @@
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "util/timer_scheduler.hpp"
+
+using namespace std::chrono_literals;
+using waybar::util::TimerScheduler;
+
+namespace {
+template <typename Predicate>
+bool waitFor(Predicate predicate) {
+  const auto deadline = std::chrono::steady_clock::now() + 2s;
+  while (!predicate()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(1ms);
+  }
+  return true;
+}
+}  // namespace
+
+TEST_CASE("TimerScheduler aligns whole-second sleeps to the wall clock",
+          "[util][timer_scheduler]") {
+  for (auto duration : {1s, 5s, 60s}) {
+    const auto deadline = TimerScheduler::alignedDeadline(duration);
+    const auto wall = std::chrono::system_clock::now() + (deadline - TimerScheduler::Clock::now());
+    const auto offset = wall.time_since_epoch() % 1s;
+    // Off by the time spent between the two clock reads at most
+    REQUIRE((offset < 10ms || offset > 990ms));
+    REQUIRE(deadline - TimerScheduler::Clock::now() > duration - 510ms);
+    REQUIRE(deadline - TimerScheduler::Clock::now() < duration + 510ms);
+  }
+
+  const auto before = TimerScheduler::Clock::now();
+  const auto deadline = TimerScheduler::alignedDeadline(250ms);
+  REQUIRE(deadline - before >= 250ms);
+  REQUIRE(deadline - before < 260ms);
+  REQUIRE(TimerScheduler::alignedDeadline(std::chrono::hours(24 * 365 * 10)) ==
+          TimerScheduler::Clock::time_point::max());
+}
+
+TEST_CASE("TimerScheduler runs tasks with the same deadline after one wakeup",
+          "[util][timer_scheduler]") {
+  TimerScheduler scheduler;
+  std::atomic<int> runs = 0;
+  const auto a = scheduler.add([&] { ++runs; });
+  const auto b = scheduler.add([&] { ++runs; });
+  const auto c = scheduler.add([&] { ++runs; });
+
+  const auto deadline = TimerScheduler::Clock::now() + 50ms;
+  scheduler.schedule(a, deadline);
+  scheduler.schedule(b, deadline);
+  scheduler.schedule(c, deadline);
+  REQUIRE(waitFor([&] { return runs == 3; }));
+  REQUIRE(scheduler.stats().wakeups == 1);
+}
+
+TEST_CASE("TimerScheduler keeps the earliest deadline of a task", "[util][timer_scheduler]") {
+  TimerScheduler scheduler;
+  std::atomic<int> runs = 0;
+  const auto id = scheduler.add([&] { ++runs; });
+
+  scheduler.schedule(id, TimerScheduler::Clock::now() + 20ms);
+  scheduler.schedule(id, TimerScheduler::Clock::now() + 1h);
+  REQUIRE(waitFor([&] { return runs == 1; }));
+
+  scheduler.schedule(id, TimerScheduler::Clock::now() + 20ms);
+  scheduler.unschedule(id);
+  std::this_thread::sleep_for(50ms);
+  REQUIRE(runs == 1);
+}
+
+TEST_CASE("TimerScheduler never runs a task on two workers at once", "[util][timer_scheduler]") {
+  TimerScheduler scheduler;
+  std::atomic<int> running = 0;
+  std::atomic<int> overlaps = 0;
+  std::atomic<int> runs = 0;
+  const auto id = scheduler.add([&] {
+    if (++running > 1) {
+      ++overlaps;
+    }
+    std::this_thread::sleep_for(20ms);
+    --running;
+    ++runs;
+  });
+
+  scheduler.schedule(id, TimerScheduler::Clock::now());
+  REQUIRE(waitFor([&] { return running == 1; }));
+  scheduler.schedule(id, TimerScheduler::Clock::now());
+  REQUIRE(waitFor([&] { return runs == 2; }));
+  REQUIRE(overlaps == 0);
+}
+
+TEST_CASE("TimerScheduler::remove waits for a running task", "[util][timer_scheduler]") {
+  TimerScheduler scheduler;
+  std::atomic<bool> started = false;
+  std::atomic<bool> finished = false;
+  const auto id = scheduler.add([&] {
+    started = true;
+    std::this_thread::sleep_for(50ms);
+    finished = true;
+  });
+
+  scheduler.schedule(id, TimerScheduler::Clock::now());
+  REQUIRE(waitFor([&] { return started.load(); }));
+  scheduler.remove(id);
+  REQUIRE(finished);
+}
+
+TEST_CASE("TimerScheduler cuts stretched sleeps short when the stretch goes down",
+          "[util][timer_scheduler]") {
+  TimerScheduler scheduler;
+  std::atomic<int> stretched_runs = 0;
+  std::atomic<int> plain_runs = 0;
+  const auto stretched = scheduler.add([&] { ++stretched_runs; });
+  const auto plain = scheduler.add([&] { ++plain_runs; });
+
+  scheduler.setStretch(4);
+  REQUIRE(scheduler.stretch() == 4);
+  scheduler.schedule(stretched, TimerScheduler::Clock::now() + 1h, true);
+  scheduler.schedule(plain, TimerScheduler::Clock::now() + 1h);
+  scheduler.setStretch(1);
+  REQUIRE(waitFor([&] { return stretched_runs == 1; }));
+  std::this_thread::sleep_for(20ms);
+  REQUIRE(plain_runs == 0);
+}
+
+TEST_CASE("TimerScheduler runs at most max_workers tasks at once", "[util][timer_scheduler]") {
+  TimerScheduler scheduler(2);
+  std::atomic<int> running = 0;
+  std::atomic<int> most_running = 0;
+  std::atomic<int> runs = 0;
+  std::vector<TimerScheduler::Id> ids;
+  for (int i = 0; i < 6; ++i) {
+    ids.push_back(scheduler.add([&] {
+      const int now_running = ++running;
+      int most = most_running;
+      while (now_running > most && !most_running.compare_exchange_weak(most, now_running)) {
+      }
+      std::this_thread::sleep_for(10ms);
+      --running;
+      ++runs;
+    }));
+  }
+
+  for (const auto id : ids) {
+    scheduler.schedule(id, TimerScheduler::Clock::now());
+  }
+  REQUIRE(waitFor([&] { return runs == 6; }));
+  REQUIRE(most_running <= 2);
+  REQUIRE(scheduler.stats().workers <= 2);
+}
+
+TEST_CASE("TimerScheduler retires idle workers", "[util][timer_scheduler]") {
+  TimerScheduler scheduler(TimerScheduler::DEFAULT_MAX_WORKERS, 20ms);
+  std::atomic<int> runs = 0;
+  const auto a = scheduler.add([&] {
+    std::this_thread::sleep_for(10ms);
+    ++runs;
+  });
+  const auto b = scheduler.add([&] {
+    std::this_thread::sleep_for(10ms);
+    ++runs;
+  });
+
+  scheduler.schedule(a, TimerScheduler::Clock::now());
+  scheduler.schedule(b, TimerScheduler::Clock::now());
+  REQUIRE(waitFor([&] { return runs == 2; }));
+  REQUIRE(waitFor([&] { return scheduler.stats().workers == 0; }));
+
+  // A worker is started again for the next deadline
+  scheduler.schedule(a, TimerScheduler::Clock::now() + 30ms);
+  REQUIRE(waitFor([&] { return runs == 3; }));
+}
+
+TEST_CASE("TimerScheduler::expireAll also runs tasks without a deadline",
+          "[util][timer_scheduler]") {
+  TimerScheduler scheduler;
+  std::atomic<int> waiting_runs = 0;
+  std::atomic<int> sleeping_runs = 0;
+  const auto waiting = scheduler.add([&] { ++waiting_runs; });
+  const auto sleeping = scheduler.add([&] { ++sleeping_runs; });
+
+  scheduler.schedule(sleeping, TimerScheduler::Clock::now() + 1h);
+  scheduler.expireAll();
+  REQUIRE(waitFor([&] { return waiting_runs == 1 && sleeping_runs == 1; }));
+}
+
+TEST_CASE("TimerScheduler starts another worker when every worker is stuck",
+          "[util][timer_scheduler]") {
+  TimerScheduler scheduler(1, TimerScheduler::DEFAULT_IDLE_TIMEOUT, 50ms);
+  std::atomic<bool> release = false;
+  std::atomic<int> runs = 0;
+  const auto stuck = scheduler.add([&] {
+    while (!release) {
+      std::this_thread::sleep_for(1ms);
+    }
+  });
+  const auto ticking = scheduler.add([&] { ++runs; });
+
+  scheduler.schedule(stuck, TimerScheduler::Clock::now());
+  scheduler.schedule(ticking, TimerScheduler::Clock::now() + 10ms);
+  REQUIRE(waitFor([&] { return runs == 1; }));
+  REQUIRE(scheduler.stats().stalls == 1);
+  REQUIRE(scheduler.stats().workers == 2);
+
+  release = true;
+  scheduler.remove(stuck);
+  scheduler.remove(ticking);
+}
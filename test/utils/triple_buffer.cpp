@@ -0,0 +1,86 @@
+#include "util/triple_buffer.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <thread>
+#include <vector>
+
+using waybar::util::TripleBuffer;
+
+TEST_CASE("TripleBuffer hands over the latest value", "[util][triple_buffer]") {
+  TripleBuffer<int> buffer;
+  REQUIRE_FALSE(buffer.acquire());
+
+  buffer.back() = 1;
+  buffer.publish();
+  REQUIRE(buffer.acquire());
+  REQUIRE(buffer.front() == 1);
+  REQUIRE_FALSE(buffer.acquire());
+  REQUIRE(buffer.front() == 1);
+
+  SECTION("unread values are dropped") {
+    for (int i = 2; i <= 5; ++i) {
+      buffer.back() = i;
+      buffer.publish();
+    }
+    REQUIRE(buffer.acquire());
+    REQUIRE(buffer.front() == 5);
+    REQUIRE_FALSE(buffer.acquire());
+  }
+}
+
+TEST_CASE("TripleBuffer reuses slot storage", "[util][triple_buffer]") {
+  TripleBuffer<std::vector<float>> buffer;
+  for (int i = 0; i < 3; ++i) {
+    buffer.back().assign(64, static_cast<float>(i));
+    buffer.publish();
+    buffer.acquire();
+  }
+
+  std::vector<const float*> storage;
+  for (int i = 0; i < 6; ++i) {
+    auto& slot = buffer.back();
+    slot.assign(32, 1.0F);
+    storage.push_back(slot.data());
+    buffer.publish();
+    REQUIRE(buffer.acquire());
+    REQUIRE(buffer.front().size() == 32);
+  }
+  // Every slot already had enough capacity, so nothing was reallocated
+  for (std::size_t i = 3; i < storage.size(); ++i) {
+    REQUIRE(storage[i] == storage[i - 3]);
+  }
+}
+
+TEST_CASE("TripleBuffer never tears values across threads", "[util][triple_buffer]") {
+  constexpr int frames = 20000;
+  TripleBuffer<std::vector<int>> buffer;
+
+  std::thread producer([&] {
+    for (int i = 1; i <= frames; ++i) {
+      buffer.back().assign(16, i);
+      buffer.publish();
+    }
+  });
+
+  int last = 0;
+  while (last < frames) {
+    if (!buffer.acquire()) {
+      std::this_thread::yield();
+      continue;
+    }
+    const auto& frame = buffer.front();
+    REQUIRE(frame.size() == 16);
+    for (int value : frame) {
+      REQUIRE(value == frame.front());
+    }
+    // Values may be skipped but never go backwards
+    REQUIRE(frame.front() > last);
+    last = frame.front();
+  }
+  producer.join();
+}